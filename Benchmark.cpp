@@ -0,0 +1,250 @@
+#include "Benchmark.h"
+#include "MemoryAccounting.h"
+#include "VkProfiler.h"
+
+#include <algorithm>
+#include <vector>
+
+BenchmarkContext::~BenchmarkContext()
+{
+  destroy();
+}
+
+VkResult BenchmarkContext::create(VkPhysicalDevice gpu)
+{
+  destroy();
+
+  mGpu = gpu;
+  VK_CALL(mGpu, vkGetPhysicalDeviceProperties, mGpu, &mProperties);
+  VK_CALL(mGpu, vkGetPhysicalDeviceMemoryProperties, mGpu, &mMemoryProperties);
+
+  uint32_t count = 0;
+  VK_CALL(mGpu, vkGetPhysicalDeviceQueueFamilyProperties, mGpu, &count, nullptr);
+  mQueueFamilies.resize(count);
+  VK_CALL(mGpu, vkGetPhysicalDeviceQueueFamilyProperties, mGpu, &count, mQueueFamilies.data());
+
+  // Any graphics or compute queue also does transfers
+  for (uint32_t i = 0; i < count; ++i) {
+    if ((mQueueFamilies[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) != 0) {
+      mQueueFamilyIndex = i;
+      break;
+    }
+  }
+  if (mQueueFamilyIndex == UINT32_MAX) {
+    return VK_ERROR_FEATURE_NOT_PRESENT;
+  }
+
+  uint32_t maxQueueCount = 0;
+  for (const auto& family : mQueueFamilies) {
+    maxQueueCount = std::max(maxQueueCount, family.queueCount);
+  }
+  std::vector<float> priorities(maxQueueCount, 1.0f);
+
+  std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+  for (uint32_t i = 0; i < count; ++i) {
+    if (mQueueFamilies[i].queueCount == 0) {
+      continue;
+    }
+    VkDeviceQueueCreateInfo queueCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+    queueCreateInfo.queueFamilyIndex  = i;
+    queueCreateInfo.queueCount        = mQueueFamilies[i].queueCount;
+    queueCreateInfo.pQueuePriorities  = priorities.data();
+    queueCreateInfos.push_back(queueCreateInfo);
+  }
+
+  VkDeviceCreateInfo deviceCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+  deviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
+  deviceCreateInfo.pQueueCreateInfos    = queueCreateInfos.data();
+  VkResult res = VK_CALL(mGpu, vkCreateDevice, mGpu, &deviceCreateInfo, MemoryAccounting::get().allocator(), &mDevice);
+  if (res != VK_SUCCESS) {
+    mDevice = VK_NULL_HANDLE;
+    return res;
+  }
+
+  mQueues.resize(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    mQueues[i].resize(mQueueFamilies[i].queueCount);
+    for (uint32_t j = 0; j < mQueueFamilies[i].queueCount; ++j) {
+      VK_CALL(mGpu, vkGetDeviceQueue, mDevice, i, j, &mQueues[i][j]);
+    }
+  }
+  mQueue = mQueues[mQueueFamilyIndex][0];
+
+  VkCommandPoolCreateInfo poolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+  poolCreateInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  poolCreateInfo.queueFamilyIndex = mQueueFamilyIndex;
+  res = VK_CALL(mGpu, vkCreateCommandPool, mDevice, &poolCreateInfo, MemoryAccounting::get().allocator(), &mCommandPool);
+  if (res != VK_SUCCESS) {
+    return res;
+  }
+
+  VkCommandBufferAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+  allocInfo.commandPool         = mCommandPool;
+  allocInfo.level               = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount  = 1;
+  res = VK_CALL(mGpu, vkAllocateCommandBuffers, mDevice, &allocInfo, &mCommandBuffer);
+  if (res != VK_SUCCESS) {
+    return res;
+  }
+
+  VkFenceCreateInfo fenceCreateInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+  res = VK_CALL(mGpu, vkCreateFence, mDevice, &fenceCreateInfo, MemoryAccounting::get().allocator(), &mFence);
+  if (res != VK_SUCCESS) {
+    return res;
+  }
+
+  uint32_t validBits = mQueueFamilies[mQueueFamilyIndex].timestampValidBits;
+  if (validBits > 0) {
+    mTimestampMask = (validBits >= 64) ? UINT64_MAX : ((static_cast<uint64_t>(1) << validBits) - 1);
+
+    VkQueryPoolCreateInfo queryCreateInfo = { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+    queryCreateInfo.queryType   = VK_QUERY_TYPE_TIMESTAMP;
+    queryCreateInfo.queryCount  = 2;
+    res = VK_CALL(mGpu, vkCreateQueryPool, mDevice, &queryCreateInfo, MemoryAccounting::get().allocator(), &mQueryPool);
+    if (res != VK_SUCCESS) {
+      mQueryPool = VK_NULL_HANDLE;
+    }
+  }
+
+  return VK_SUCCESS;
+}
+
+void BenchmarkContext::destroy()
+{
+  if (mDevice != VK_NULL_HANDLE) {
+    VK_CALL(mGpu, vkDeviceWaitIdle, mDevice);
+    if (mQueryPool != VK_NULL_HANDLE) {
+      VK_CALL(mGpu, vkDestroyQueryPool, mDevice, mQueryPool, MemoryAccounting::get().allocator());
+    }
+    if (mFence != VK_NULL_HANDLE) {
+      VK_CALL(mGpu, vkDestroyFence, mDevice, mFence, MemoryAccounting::get().allocator());
+    }
+    if (mCommandPool != VK_NULL_HANDLE) {
+      VK_CALL(mGpu, vkDestroyCommandPool, mDevice, mCommandPool, MemoryAccounting::get().allocator());
+    }
+    VK_CALL(mGpu, vkDestroyDevice, mDevice, MemoryAccounting::get().allocator());
+  }
+
+  mDevice = VK_NULL_HANDLE;
+  mQueueFamilies.clear();
+  mQueues.clear();
+  mQueue = VK_NULL_HANDLE;
+  mQueueFamilyIndex = UINT32_MAX;
+  mCommandPool = VK_NULL_HANDLE;
+  mCommandBuffer = VK_NULL_HANDLE;
+  mFence = VK_NULL_HANDLE;
+  mQueryPool = VK_NULL_HANDLE;
+}
+
+uint32_t BenchmarkContext::findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags flags) const
+{
+  for (uint32_t i = 0; i < mMemoryProperties.memoryTypeCount; ++i) {
+    if (((typeBits & (1u << i)) != 0) && ((mMemoryProperties.memoryTypes[i].propertyFlags & flags) == flags)) {
+      return i;
+    }
+  }
+  return UINT32_MAX;
+}
+
+VkResult BenchmarkContext::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, uint32_t memoryTypeIndex, VkBuffer* pBuffer, VkDeviceMemory* pMemory)
+{
+  *pBuffer = VK_NULL_HANDLE;
+  *pMemory = VK_NULL_HANDLE;
+
+  VkBufferCreateInfo createInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+  createInfo.size         = size;
+  createInfo.usage        = usage;
+  createInfo.sharingMode  = VK_SHARING_MODE_EXCLUSIVE;
+  VkResult res = VK_CALL(mGpu, vkCreateBuffer, mDevice, &createInfo, MemoryAccounting::get().allocator(), pBuffer);
+  if (res != VK_SUCCESS) {
+    *pBuffer = VK_NULL_HANDLE;
+    return res;
+  }
+
+  VkMemoryRequirements requirements = {};
+  VK_CALL(mGpu, vkGetBufferMemoryRequirements, mDevice, *pBuffer, &requirements);
+  if ((requirements.memoryTypeBits & (1u << memoryTypeIndex)) == 0) {
+    destroyBuffer(*pBuffer, VK_NULL_HANDLE);
+    *pBuffer = VK_NULL_HANDLE;
+    return VK_ERROR_FORMAT_NOT_SUPPORTED;
+  }
+
+  VkMemoryAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+  allocInfo.allocationSize  = requirements.size;
+  allocInfo.memoryTypeIndex = memoryTypeIndex;
+  res = VK_CALL(mGpu, vkAllocateMemory, mDevice, &allocInfo, MemoryAccounting::get().allocator(), pMemory);
+  if (res != VK_SUCCESS) {
+    destroyBuffer(*pBuffer, VK_NULL_HANDLE);
+    *pBuffer = VK_NULL_HANDLE;
+    *pMemory = VK_NULL_HANDLE;
+    return res;
+  }
+
+  return VK_CALL(mGpu, vkBindBufferMemory, mDevice, *pBuffer, *pMemory, 0);
+}
+
+void BenchmarkContext::destroyBuffer(VkBuffer buffer, VkDeviceMemory memory)
+{
+  if (buffer != VK_NULL_HANDLE) {
+    VK_CALL(mGpu, vkDestroyBuffer, mDevice, buffer, MemoryAccounting::get().allocator());
+  }
+  if (memory != VK_NULL_HANDLE) {
+    VK_CALL(mGpu, vkFreeMemory, mDevice, memory, MemoryAccounting::get().allocator());
+  }
+}
+
+VkCommandBuffer BenchmarkContext::beginCommands()
+{
+  VK_CALL(mGpu, vkResetCommandBuffer, mCommandBuffer, 0);
+
+  VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  VK_CALL(mGpu, vkBeginCommandBuffer, mCommandBuffer, &beginInfo);
+
+  if (mQueryPool != VK_NULL_HANDLE) {
+    VK_CALL(mGpu, vkCmdResetQueryPool, mCommandBuffer, mQueryPool, 0, 2);
+    VK_CALL(mGpu, vkCmdWriteTimestamp, mCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mQueryPool, 0);
+  }
+
+  return mCommandBuffer;
+}
+
+VkResult BenchmarkContext::submitCommands(double* pGpuMilliseconds)
+{
+  if (mQueryPool != VK_NULL_HANDLE) {
+    VK_CALL(mGpu, vkCmdWriteTimestamp, mCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mQueryPool, 1);
+  }
+  VkResult res = VK_CALL(mGpu, vkEndCommandBuffer, mCommandBuffer);
+  if (res != VK_SUCCESS) {
+    return res;
+  }
+
+  VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers    = &mCommandBuffer;
+
+  BenchmarkTimer timer;
+  res = VK_CALL(mGpu, vkQueueSubmit, mQueue, 1, &submitInfo, mFence);
+  if (res != VK_SUCCESS) {
+    return res;
+  }
+  res = VK_CALL(mGpu, vkWaitForFences, mDevice, 1, &mFence, VK_TRUE, UINT64_MAX);
+  double hostMilliseconds = timer.elapsedMilliseconds();
+  VK_CALL(mGpu, vkResetFences, mDevice, 1, &mFence);
+  if (res != VK_SUCCESS) {
+    return res;
+  }
+
+  *pGpuMilliseconds = hostMilliseconds;
+  if (mQueryPool != VK_NULL_HANDLE) {
+    uint64_t timestamps[2] = {};
+    res = VK_CALL(mGpu, vkGetQueryPoolResults, mDevice, mQueryPool, 0, 2, sizeof(timestamps), timestamps,
+                  sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    if (res == VK_SUCCESS) {
+      uint64_t ticks = ((timestamps[1] & mTimestampMask) - (timestamps[0] & mTimestampMask)) & mTimestampMask;
+      *pGpuMilliseconds = static_cast<double>(ticks) * mProperties.limits.timestampPeriod / 1000000.0;
+    }
+  }
+
+  return VK_SUCCESS;
+}
@@ -0,0 +1,83 @@
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <vulkan/vulkan.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+//! \class BenchmarkContext
+//!
+//! Logical device with every queue of every family, plus a command buffer
+//! and timestamp queries on the primary queue, shared by the opt-in
+//! benchmarks. Only core 1.0 functionality is used so the
+//! benchmarks also run on software ICDs such as lavapipe. GPU times come
+//! from timestamps when the queue supports them, otherwise from the host
+//! around the submit and fence wait.
+//!
+class BenchmarkContext {
+public:
+  BenchmarkContext() {}
+  ~BenchmarkContext();
+
+  BenchmarkContext(const BenchmarkContext&) = delete;
+  BenchmarkContext& operator=(const BenchmarkContext&) = delete;
+
+  VkResult  create(VkPhysicalDevice gpu);
+  void      destroy();
+
+  VkPhysicalDevice  gpu() const { return mGpu; }
+  VkDevice          device() const { return mDevice; }
+  uint32_t          queueFamilyIndex() const { return mQueueFamilyIndex; }
+  VkQueue           queue() const { return mQueue; }
+  bool              hasTimestamps() const { return mQueryPool != VK_NULL_HANDLE; }
+
+  const std::vector<VkQueueFamilyProperties>& queueFamilies() const { return mQueueFamilies; }
+  VkQueue           queue(uint32_t familyIndex, uint32_t queueIndex) const { return mQueues[familyIndex][queueIndex]; }
+
+  const VkPhysicalDeviceProperties&        properties() const { return mProperties; }
+  const VkPhysicalDeviceMemoryProperties&  memoryProperties() const { return mMemoryProperties; }
+
+  //! Picks the first memory type allowed by typeBits that has all of flags
+  uint32_t  findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags flags) const;
+
+  VkResult  createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, uint32_t memoryTypeIndex, VkBuffer* pBuffer, VkDeviceMemory* pMemory);
+  void      destroyBuffer(VkBuffer buffer, VkDeviceMemory memory);
+
+  //! Begins the shared command buffer and writes the start timestamp
+  VkCommandBuffer beginCommands();
+  //! Writes the end timestamp, submits and waits
+  VkResult        submitCommands(double* pGpuMilliseconds);
+
+private:
+  VkPhysicalDevice                  mGpu = VK_NULL_HANDLE;
+  VkPhysicalDeviceProperties        mProperties = {};
+  VkPhysicalDeviceMemoryProperties  mMemoryProperties = {};
+  VkDevice                          mDevice = VK_NULL_HANDLE;
+  std::vector<VkQueueFamilyProperties> mQueueFamilies;
+  std::vector<std::vector<VkQueue>> mQueues;
+  uint32_t                          mQueueFamilyIndex = UINT32_MAX;
+  VkQueue                           mQueue = VK_NULL_HANDLE;
+  VkCommandPool                     mCommandPool = VK_NULL_HANDLE;
+  VkCommandBuffer                   mCommandBuffer = VK_NULL_HANDLE;
+  VkFence                           mFence = VK_NULL_HANDLE;
+  VkQueryPool                       mQueryPool = VK_NULL_HANDLE;
+  uint64_t                          mTimestampMask = 0;
+};
+
+//! Host stopwatch for the CPU side of the benchmarks
+class BenchmarkTimer {
+public:
+  BenchmarkTimer() : mStart(std::chrono::steady_clock::now()) {}
+
+  double elapsedMilliseconds() const
+  {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mStart).count();
+  }
+
+private:
+  std::chrono::steady_clock::time_point mStart;
+};
+
+#endif // __BENCHMARK_H__
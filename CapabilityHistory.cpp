@@ -0,0 +1,291 @@
+#include "CapabilityHistory.h"
+#include "FormatTable.h"
+#include "ToString.h"
+#include "Trace.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QJsonArray>
+#include <QMap>
+#include <QSysInfo>
+#include <QUrl>
+
+#include <cmath>
+
+static const char* sDeviceKey = "device";
+
+static QString toHistoryValue(const QJsonValue& value)
+{
+  if (value.isBool()) {
+    return value.toBool() ? "true" : "false";
+  }
+  if (value.isDouble()) {
+    // Integers up to 2^53 print exactly, limits like pointSizeGranularity don't have to
+    double number = value.toDouble();
+    if ((std::floor(number) == number) && (std::fabs(number) < 9007199254740992.0)) {
+      return QString::number(static_cast<qint64>(number));
+    }
+    return QString::number(number, 'g', 9);
+  }
+  return value.toString();
+}
+
+static void flatten(const QJsonValue& value, const QString& path, QMap<QString, QString>* pValues)
+{
+  if (value.isObject()) {
+    QJsonObject object = value.toObject();
+    for (auto it = object.begin(); it != object.end(); ++it) {
+      flatten(it.value(), path + "." + it.key(), pValues);
+    }
+  }
+  else if (value.isArray()) {
+    QJsonArray array = value.toArray();
+    for (int i = 0; i < array.size(); ++i) {
+      flatten(array[i], QString("%1[%2]").arg(path).arg(i), pValues);
+    }
+  }
+  else {
+    pValues->insert(path, toHistoryValue(value));
+  }
+}
+
+//! One entry per value a device reports, keyed by its path
+static QMap<QString, QString> flattenDevice(const QJsonObject& device)
+{
+  QMap<QString, QString> values;
+
+  QJsonObject properties = device["properties"].toObject();
+  flatten(properties["limits"], "limits", &values);
+  flatten(properties["sparseProperties"], "sparse", &values);
+  properties.remove("limits");
+  properties.remove("sparseProperties");
+  flatten(properties, "properties", &values);
+
+  flatten(device["features"], "features", &values);
+
+  // Keyed by name and format rather than position, so an insertion is one change
+  for (const auto& value : device["extensions"].toArray()) {
+    QJsonObject item = value.toObject();
+    values["extensions." + item["extensionName"].toString()] = toHistoryValue(item["specVersion"]);
+  }
+  for (const auto& value : device["formats"].toArray()) {
+    QJsonObject item = value.toObject();
+    QString prefix = "formats." + toStringVkFormat(static_cast<VkFormat>(item["format"].toInt()));
+    for (const char* field : { "linearTilingFeatures", "optimalTilingFeatures", "bufferFeatures" }) {
+      values[prefix + "." + field] = "0x" + QString::number(static_cast<uint32_t>(item[field].toDouble()), 16);
+    }
+  }
+
+  flatten(device["queueFamilies"], "queueFamilies", &values);
+  flatten(device["memoryTypes"], "memoryTypes", &values);
+  flatten(device["memoryHeaps"], "memoryHeaps", &values);
+  return values;
+}
+
+struct HistoryDevice {
+  QString                 name;
+  QString                 driverVersion;
+  QMap<QString, QString>  values;
+};
+
+//! Keyed by vendorID:deviceID:deviceName, the occurrence count tells identical boards apart
+static QMap<QString, HistoryDevice> getHistoryDevices(const DeviceProfileSet& profileSet)
+{
+  QMap<QString, HistoryDevice> devices;
+  QMap<QString, int> occurrences;
+  for (const auto& profile : profileSet.devices) {
+    const VkPhysicalDeviceProperties& properties = profile.properties;
+    QString key = QString("%1:%2:%3").arg(properties.vendorID, 0, 16).arg(properties.deviceID, 0, 16).arg(QString::fromUtf8(properties.deviceName));
+    key += "#" + QString::number(occurrences[key]++);
+
+    HistoryDevice& device = devices[key];
+    device.name = QString::fromUtf8(properties.deviceName);
+    // Raw, like the General tab; drivers don't all use the Vulkan version packing
+    device.driverVersion = QString::number(properties.driverVersion);
+    device.values = flattenDevice(deviceProfileToJson(profile));
+  }
+  return devices;
+}
+
+static QByteArray toChangeLine(const CapabilityHistory::Change& change)
+{
+  QList<QByteArray> fields;
+  for (const QString* field : { &change.time, &change.machine, &change.gpu, &change.oldDriverVersion, &change.newDriverVersion,
+                                &change.key, &change.oldValue, &change.newValue }) {
+    fields.append(QUrl::toPercentEncoding(*field));
+  }
+  return fields.join('\t') + '\n';
+}
+
+QString CapabilityHistory::defaultMachine()
+{
+  return QSysInfo::machineHostName();
+}
+
+bool CapabilityHistory::open(const QString& dirPath)
+{
+  TRACE_SCOPE("qt", "CapabilityHistory::open");
+
+  close();
+  if (! mArchive.open(dirPath)) {
+    return false;
+  }
+  mDirPath = QDir(dirPath).absolutePath();
+
+  mChanges.setFileName(mDirPath + "/changes.idx");
+  return mChanges.open(QIODevice::ReadWrite);
+}
+
+void CapabilityHistory::close()
+{
+  mChanges.close();
+  mArchive.close();
+  mDirPath.clear();
+}
+
+int CapabilityHistory::append(const QString& machine, const DeviceProfileSet& profileSet)
+{
+  TRACE_SCOPE("qt", "CapabilityHistory::append");
+
+  if (! mChanges.isOpen()) {
+    return -1;
+  }
+
+  // Another process appending between the load and the ingest would have
+  // its snapshot diffed against twice, or its changes interleaved with ours
+  if (! mArchive.lock()) {
+    return -1;
+  }
+  int result = appendLocked(machine, profileSet);
+  mArchive.unlock();
+  return result;
+}
+
+int CapabilityHistory::appendLocked(const QString& machine, const DeviceProfileSet& profileSet)
+{
+  // The first snapshot of a machine is the baseline, it has nothing to differ from
+  DeviceProfileSet previousSet;
+  bool hasPrevious = mArchive.load(machine, &previousSet);
+
+  if (! mArchive.ingest(machine, profileSet)) {
+    return -1;
+  }
+  if (! hasPrevious) {
+    return 0;
+  }
+
+  QMap<QString, HistoryDevice> previous = getHistoryDevices(previousSet);
+  QMap<QString, HistoryDevice> current = getHistoryDevices(profileSet);
+  QString time = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+
+  std::vector<Change> changes;
+  auto addChange = [&](const HistoryDevice& oldDevice, const HistoryDevice& newDevice, const QString& key, const QString& oldValue, const QString& newValue) {
+    Change change;
+    change.time             = time;
+    change.machine          = machine;
+    change.gpu              = newDevice.name.isEmpty() ? oldDevice.name : newDevice.name;
+    change.oldDriverVersion = oldDevice.driverVersion;
+    change.newDriverVersion = newDevice.driverVersion;
+    change.key              = key;
+    change.oldValue         = oldValue;
+    change.newValue         = newValue;
+    changes.push_back(change);
+  };
+
+  static const HistoryDevice sNoDevice;
+  for (auto it = current.begin(); it != current.end(); ++it) {
+    auto previousIt = previous.find(it.key());
+    if (previousIt == previous.end()) {
+      addChange(sNoDevice, it.value(), sDeviceKey, "", "present");
+      continue;
+    }
+
+    const QMap<QString, QString>& oldValues = previousIt.value().values;
+    const QMap<QString, QString>& newValues = it.value().values;
+    for (auto valueIt = newValues.begin(); valueIt != newValues.end(); ++valueIt) {
+      QString oldValue = oldValues.value(valueIt.key());
+      if (oldValue != valueIt.value()) {
+        addChange(previousIt.value(), it.value(), valueIt.key(), oldValue, valueIt.value());
+      }
+    }
+    for (auto valueIt = oldValues.begin(); valueIt != oldValues.end(); ++valueIt) {
+      if (! newValues.contains(valueIt.key())) {
+        addChange(previousIt.value(), it.value(), valueIt.key(), valueIt.value(), "");
+      }
+    }
+  }
+  for (auto it = previous.begin(); it != previous.end(); ++it) {
+    if (! current.contains(it.key())) {
+      addChange(it.value(), sNoDevice, sDeviceKey, "present", "");
+    }
+  }
+
+  QByteArray lines;
+  for (const auto& change : changes) {
+    lines += toChangeLine(change);
+  }
+
+  // A line cut short by a crash is dropped so the append starts on a fresh
+  // line; only done under the lock, readers just stop before it
+  qint64 size = mChanges.size();
+  if ((size > 0) && mChanges.seek(size - 1) && (mChanges.read(1) != "\n")) {
+    mChanges.seek(0);
+    QByteArray content = mChanges.readAll();
+    size = content.lastIndexOf('\n') + 1;
+    if (! mChanges.resize(size)) {
+      return -1;
+    }
+  }
+  if ((! mChanges.seek(size)) || (mChanges.write(lines) != lines.size()) || (! mChanges.flush())) {
+    return -1;
+  }
+  return static_cast<int>(changes.size());
+}
+
+void CapabilityHistory::loadChanges(const QString& dirPath, qint64* pOffset, std::vector<Change>* pChanges)
+{
+  TRACE_SCOPE("qt", "CapabilityHistory::loadChanges");
+
+  QFile file(QDir(dirPath).filePath("changes.idx"));
+  if ((! file.open(QIODevice::ReadOnly)) || (! file.seek(*pOffset))) {
+    return;
+  }
+
+  QByteArray content = file.readAll();
+  int start = 0;
+  for (int end = content.indexOf('\n'); end >= 0; start = end + 1, end = content.indexOf('\n', start)) {
+    QList<QByteArray> fields = content.mid(start, end - start).split('\t');
+    if (fields.size() != 8) {
+      continue;
+    }
+    Change change;
+    QString* targets[] = { &change.time, &change.machine, &change.gpu, &change.oldDriverVersion, &change.newDriverVersion,
+                           &change.key, &change.oldValue, &change.newValue };
+    for (int i = 0; i < 8; ++i) {
+      *targets[i] = QUrl::fromPercentEncoding(fields[i]);
+    }
+    pChanges->push_back(change);
+  }
+  *pOffset += start;
+}
+
+QString CapabilityHistory::describeChange(const Change& change)
+{
+  if ((! change.key.startsWith("formats.")) || (! change.key.endsWith("Features"))) {
+    return QString();
+  }
+
+  // A format that appeared or went away counts as all zeros on the other side
+  uint32_t oldFlags = change.oldValue.toUInt(nullptr, 0);
+  uint32_t newFlags = change.newValue.toUInt(nullptr, 0);
+  QStringList parts;
+  for (VkFormatFeatureFlagBits flag : getFormatFeatureFlags()) {
+    if ((newFlags & flag) && (! (oldFlags & flag))) {
+      parts << "+" + toStringFormatFeatureShort(flag);
+    }
+    else if ((oldFlags & flag) && (! (newFlags & flag))) {
+      parts << "-" + toStringFormatFeatureShort(flag);
+    }
+  }
+  return parts.join(" ");
+}
@@ -0,0 +1,78 @@
+#ifndef __CAPABILITY_HISTORY_H__
+#define __CAPABILITY_HISTORY_H__
+
+#include "DeviceProfile.h"
+#include "SnapshotArchive.h"
+
+#include <QFile>
+#include <QString>
+
+#include <vector>
+
+//! \class CapabilityHistory
+//!
+//! Opt-in (VIV_HISTORY_DIR) record of this machine's devices over time.
+//! Every append stores a snapshot in a SnapshotArchive in the same
+//! directory, so unchanged sections cost a hash and changed ones a delta,
+//! and diffs it against the machine's previous snapshot. Loading, ingesting
+//! and writing the changes all happen under the archive's ingest lock:
+//!
+//!   <dir>/changes.idx    one line per changed value, append only
+//!
+//! Lines are tab separated and percent encoded:
+//!
+//!   time  machine  gpu  old driverVersion  new driverVersion  key  old  new
+//!
+//! Keys are flattened paths, e.g. limits.maxImageDimension2D,
+//! features.geometryShader, extensions.VK_KHR_swapchain or
+//! formats.VK_FORMAT_R8G8B8A8_UNORM.optimalTilingFeatures. A GPU that
+//! appears or goes away is a change of the key "device". The timeline only
+//! reads changes.idx, never the snapshots, and after the first load only
+//! the lines appended since. `--archive <dir> --extract <machine>` prints
+//! the newest snapshot.
+//!
+class CapabilityHistory {
+public:
+  struct Change {
+    QString time;
+    QString machine;
+    QString gpu;
+    QString oldDriverVersion;
+    QString newDriverVersion;
+    QString key;
+    QString oldValue;
+    QString newValue;
+  };
+
+  CapabilityHistory() {}
+
+  CapabilityHistory(const CapabilityHistory&) = delete;
+  CapabilityHistory& operator=(const CapabilityHistory&) = delete;
+
+  static QString  defaultMachine();
+
+  bool      open(const QString& dirPath);
+  void      close();
+
+  //! Appends the snapshot and its changes since the previous one of machine,
+  //! returns the number of changes or -1 on failure. The first snapshot of a
+  //! machine has no changes.
+  int       append(const QString& machine, const DeviceProfileSet& profileSet);
+
+  //! Adds the changes recorded in dirPath past *pOffset to pChanges, oldest
+  //! first, and moves *pOffset to the end of the last whole line read. A
+  //! line still being written is read by the next call.
+  static void     loadChanges(const QString& dirPath, qint64* pOffset, std::vector<Change>* pChanges);
+  //! Readable difference for format feature keys ("+BLIT_SRC -STORAGE_IMAGE"), empty for others
+  static QString  describeChange(const Change& change);
+
+private:
+  int             appendLocked(const QString& machine, const DeviceProfileSet& profileSet);
+
+private:
+  QString         mDirPath;
+  SnapshotArchive mArchive;
+  QFile           mChanges;
+};
+
+#endif // __CAPABILITY_HISTORY_H__
@@ -0,0 +1,255 @@
+#include "CapabilityServer.h"
+#include "DeviceCapture.h"
+#include "DeviceMonitor.h"
+#include "Trace.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QtConcurrent/QtConcurrentRun>
+
+// Requests are a word and a few arguments, anything longer is a broken or hostile client
+static const qint64 kMaxRequestLength = 4096;
+
+static QByteArray toCompactJson(const QJsonValue& value)
+{
+  // QJsonDocument only holds objects and arrays, scalars go through a one element array
+  if (value.isObject()) {
+    return QJsonDocument(value.toObject()).toJson(QJsonDocument::Compact);
+  }
+  if (value.isArray()) {
+    return QJsonDocument(value.toArray()).toJson(QJsonDocument::Compact);
+  }
+  QByteArray json = QJsonDocument(QJsonArray({ value })).toJson(QJsonDocument::Compact);
+  return json.mid(1, json.size() - 2);
+}
+
+static QByteArray okReply(const QByteArray& json)
+{
+  return "ok " + json + "\n";
+}
+
+static QByteArray errorReply(const QByteArray& message)
+{
+  return "error " + message + "\n";
+}
+
+CapabilityServer::CapabilityServer(QObject* parent)
+  : QObject(parent)
+{
+  mServer.setSocketOptions(QLocalServer::UserAccessOption);
+  connect(&mServer, SIGNAL(newConnection()), this, SLOT(on_newConnection()));
+  connect(&mCapture, SIGNAL(finished()), this, SLOT(on_captureFinished()));
+
+  mDeviceMonitor = new DeviceMonitor(this);
+  connect(mDeviceMonitor, SIGNAL(devicesChanged()), this, SLOT(on_devicesChanged()));
+}
+
+CapabilityServer::~CapabilityServer()
+{
+  mCapture.waitForFinished();
+}
+
+QString CapabilityServer::defaultServerName()
+{
+  return "VulkanInfoViewer";
+}
+
+bool CapabilityServer::listen(const QString& name)
+{
+  // A socket file left by a crashed daemon refuses connections and blocks listen()
+  QLocalSocket probe;
+  probe.connectToServer(name);
+  if (probe.waitForConnected(100)) {
+    probe.disconnectFromServer();
+    return false;
+  }
+  QLocalServer::removeServer(name);
+
+  if (! mServer.listen(name)) {
+    return false;
+  }
+  // Resident, so only the file watches trigger a recapture
+  mDeviceMonitor->start(false);
+  return true;
+}
+
+VkResult CapabilityServer::capture()
+{
+  DeviceProfileSet profileSet;
+  VkResult res = captureDeviceProfileSet(&profileSet);
+  buildReplies(profileSet);
+  return res;
+}
+
+void CapabilityServer::startCapture()
+{
+  if (mCapture.isRunning()) {
+    mCapturePending = true;
+    return;
+  }
+  mCapture.setFuture(QtConcurrent::run([]() -> Capture {
+    Capture capture;
+    capture.result = captureDeviceProfileSet(&capture.profileSet);
+    return capture;
+  }));
+}
+
+void CapabilityServer::on_captureFinished()
+{
+  Capture capture = mCapture.result();
+  // A failed recapture keeps serving the previous devices
+  if (capture.result == VK_SUCCESS) {
+    buildReplies(capture.profileSet);
+  }
+  if (mCapturePending) {
+    mCapturePending = false;
+    startCapture();
+  }
+}
+
+void CapabilityServer::on_devicesChanged()
+{
+  startCapture();
+}
+
+void CapabilityServer::buildReplies(const DeviceProfileSet& profileSet)
+{
+  TRACE_SCOPE("qt", "buildReplies");
+
+  mDevices.clear();
+  QJsonArray devices;
+  for (size_t i = 0; i < profileSet.devices.size(); ++i) {
+    const DeviceProfile& profile = profileSet.devices[i];
+    QJsonObject json = deviceProfileToJson(profile);
+    QJsonObject properties = json["properties"].toObject();
+
+    Device device;
+    device.extensions = ExtensionSet(profile.extensions);
+    device.features = json["features"].toObject();
+    device.limits   = properties["limits"].toObject();
+    device.formats  = okReply(toCompactJson(json["formats"]));
+    device.profile  = okReply(toCompactJson(json));
+    mDevices.push_back(device);
+
+    QJsonObject summary;
+    summary["index"] = static_cast<int>(i);
+    for (const char* key : { "deviceName", "deviceType", "vendorID", "deviceID", "apiVersion", "driverVersion", "pipelineCacheUUID" }) {
+      summary[key] = properties[key];
+    }
+    devices.append(summary);
+  }
+  mDevicesReply  = okReply(toCompactJson(devices));
+  mSnapshotReply = okReply(toCompactJson(deviceProfileSetToJson(profileSet)));
+}
+
+const CapabilityServer::Device* CapabilityServer::findDevice(const QByteArray& index) const
+{
+  bool ok = false;
+  uint value = index.toUInt(&ok);
+  if ((! ok) || (value >= mDevices.size())) {
+    return nullptr;
+  }
+  return &mDevices[value];
+}
+
+QByteArray CapabilityServer::reply(const QByteArray& request) const
+{
+  QList<QByteArray> args = request.simplified().split(' ');
+  const QByteArray& command = args[0];
+
+  if (command == "ping") {
+    return okReply("\"pong\"");
+  }
+  if (command == "devices") {
+    return mDevicesReply;
+  }
+  if (command == "snapshot") {
+    return mSnapshotReply;
+  }
+
+  // Everything else names a device
+  if ((command == "extension") || (command == "feature") || (command == "limit") || (command == "formats") || (command == "device")) {
+    const Device* device = (args.size() >= 2) ? findDevice(args[1]) : nullptr;
+    if (device == nullptr) {
+      return errorReply("no such gpu");
+    }
+    if (command == "formats") {
+      return device->formats;
+    }
+    if (command == "device") {
+      return device->profile;
+    }
+    if (args.size() < 3) {
+      return errorReply("missing name");
+    }
+
+    const QByteArray& name = args[2];
+    if (command == "extension") {
+      return okReply(device->extensions.contains(name.constData()) ? "true" : "false");
+    }
+    const QJsonObject& fields = (command == "feature") ? device->features : device->limits;
+    auto it = fields.constFind(QString::fromLatin1(name));
+    if (it == fields.constEnd()) {
+      return errorReply("unknown " + command);
+    }
+    return okReply(toCompactJson(it.value()));
+  }
+
+  return errorReply("unknown request");
+}
+
+void CapabilityServer::on_newConnection()
+{
+  while (QLocalSocket* socket = mServer.nextPendingConnection()) {
+    connect(socket, SIGNAL(readyRead()), this, SLOT(on_readyRead()));
+    connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+  }
+}
+
+void CapabilityServer::on_readyRead()
+{
+  QLocalSocket* socket = qobject_cast<QLocalSocket*>(sender());
+  Q_ASSERT(socket);
+
+  // Clients may pipeline several requests
+  while (socket->canReadLine()) {
+    QByteArray request = socket->readLine().trimmed();
+    if (request.isEmpty()) {
+      continue;
+    }
+    if (request == "refresh") {
+      startCapture();
+      socket->write(okReply("\"capturing\""));
+      continue;
+    }
+    socket->write(reply(request));
+  }
+
+  // What is left has no newline yet, it must not grow without bound
+  if (socket->bytesAvailable() > kMaxRequestLength) {
+    disconnect(socket, SIGNAL(readyRead()), this, SLOT(on_readyRead()));
+    socket->write(errorReply("request too long"));
+    socket->disconnectFromServer();
+  }
+}
+
+QByteArray CapabilityServer::query(const QString& serverName, const QString& request, int timeoutMs)
+{
+  QLocalSocket socket;
+  socket.connectToServer(serverName);
+  if (! socket.waitForConnected(timeoutMs)) {
+    return QByteArray();
+  }
+
+  socket.write(request.toUtf8() + "\n");
+  if (! socket.waitForBytesWritten(timeoutMs)) {
+    return QByteArray();
+  }
+  while (! socket.canReadLine()) {
+    if (! socket.waitForReadyRead(timeoutMs)) {
+      return QByteArray();
+    }
+  }
+  return socket.readLine();
+}
@@ -0,0 +1,100 @@
+#ifndef __CAPABILITY_SERVER_H__
+#define __CAPABILITY_SERVER_H__
+
+#include "DeviceProfile.h"
+#include "ExtensionSet.h"
+
+#include <QByteArray>
+#include <QFutureWatcher>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QObject>
+#include <QString>
+
+#include <vector>
+
+class DeviceMonitor;
+
+//! \class CapabilityServer
+//!
+//! Daemon mode (--daemon): captures every device once and answers queries
+//! on a QLocalServer socket so other tools don't have to create their own
+//! instance. Every reply is built at capture time, so answering a request
+//! is a lookup. DeviceMonitor triggers a recapture on a worker thread when
+//! GPUs or drivers change; queries keep getting the previous capture until
+//! it finishes.
+//!
+//! The protocol is line based: one request per line, one reply per line.
+//! Replies start with "ok " followed by compact JSON, or "error " followed
+//! by a message. <gpu> is the index from "devices".
+//!
+//!   ping                      ok "pong"
+//!   devices                   ok [{"index":0,"deviceName":...,"vendorID":...}, ...]
+//!   extension <gpu> <name>    ok true|false
+//!   feature <gpu> <name>      ok true|false
+//!   limit <gpu> <name>        ok <value>
+//!   formats <gpu>             ok [{"format":...,"linearTilingFeatures":...}, ...]
+//!   device <gpu>              ok {...}   one device of the mock ICD profile format
+//!   snapshot                  ok {...}   the whole mock ICD profile
+//!   refresh                   ok "capturing"
+//!
+//! A snapshot reply is a valid VIV_MOCK_ICD_PROFILE, so tests can replay a
+//! machine through the mock ICD, or stand in for the daemon with a script
+//! that prints canned lines.
+//!
+class CapabilityServer : public QObject {
+  Q_OBJECT
+public:
+  explicit CapabilityServer(QObject* parent = nullptr);
+  ~CapabilityServer();
+
+  static QString  defaultServerName();
+
+  //! Fails if another daemon already answers on name, otherwise replaces any stale socket
+  bool        listen(const QString& name);
+  QString     fullServerName() const { return mServer.fullServerName(); }
+  QString     errorString() const { return mServer.errorString(); }
+
+  //! Synchronous capture, used once before listen()
+  VkResult    capture();
+  QByteArray  reply(const QByteArray& request) const;
+
+  //! Client side of --query: sends request and returns the reply line, empty on failure
+  static QByteArray query(const QString& serverName, const QString& request, int timeoutMs);
+
+private slots:
+  void on_newConnection();
+  void on_readyRead();
+  void on_devicesChanged();
+  void on_captureFinished();
+
+private:
+  struct Device {
+    ExtensionSet      extensions;
+    QJsonObject       features;
+    QJsonObject       limits;
+    QByteArray        formats;
+    QByteArray        profile;
+  };
+
+  struct Capture {
+    VkResult          result = VK_SUCCESS;
+    DeviceProfileSet  profileSet;
+  };
+
+  void        startCapture();
+  void        buildReplies(const DeviceProfileSet& profileSet);
+  const Device* findDevice(const QByteArray& index) const;
+
+private:
+  QLocalServer            mServer;
+  DeviceMonitor*          mDeviceMonitor = nullptr;
+  QFutureWatcher<Capture> mCapture;
+  bool                    mCapturePending = false;
+
+  std::vector<Device>     mDevices;
+  QByteArray              mDevicesReply;
+  QByteArray              mSnapshotReply;
+};
+
+#endif // __CAPABILITY_SERVER_H__
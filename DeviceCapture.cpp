@@ -0,0 +1,115 @@
+#include "DeviceCapture.h"
+#include "FormatTable.h"
+#include "MemoryAccounting.h"
+#include "Trace.h"
+#include "VkProfiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+uint32_t getLoaderApiVersion()
+{
+  // vkEnumerateInstanceVersion only exists in 1.1+ loaders
+  auto pfnEnumerateInstanceVersion = reinterpret_cast<PFN_vkEnumerateInstanceVersion>(
+    vkGetInstanceProcAddr(VK_NULL_HANDLE, "vkEnumerateInstanceVersion"));
+
+  uint32_t apiVersion = VK_API_VERSION_1_0;
+  if (pfnEnumerateInstanceVersion != nullptr) {
+    VkResult res = pfnEnumerateInstanceVersion(&apiVersion);
+    if (res != VK_SUCCESS) {
+      apiVersion = VK_API_VERSION_1_0;
+    }
+  }
+  return apiVersion;
+}
+
+DeviceProfile captureDeviceProfile(VkPhysicalDevice gpu, const VkPhysicalDeviceProperties& properties,
+                                   const std::vector<VkExtensionProperties>& extensions)
+{
+  DeviceProfile profile;
+  profile.properties = properties;
+  profile.extensions = extensions;
+  VK_CALL(gpu, vkGetPhysicalDeviceFeatures, gpu, &profile.features);
+  VK_CALL(gpu, vkGetPhysicalDeviceMemoryProperties, gpu, &profile.memoryProperties);
+
+  uint32_t count = 0;
+  VK_CALL(gpu, vkGetPhysicalDeviceQueueFamilyProperties, gpu, &count, nullptr);
+  profile.queueFamilies.resize(count);
+  VK_CALL(gpu, vkGetPhysicalDeviceQueueFamilyProperties, gpu, &count, profile.queueFamilies.data());
+
+  for (VkFormat format : getSupportedFormats(properties.apiVersion, ExtensionSet(extensions))) {
+    VkFormatProperties formatProperties = {};
+    VK_CALL(gpu, vkGetPhysicalDeviceFormatProperties, gpu, format, &formatProperties);
+    if ((formatProperties.linearTilingFeatures != 0) || (formatProperties.optimalTilingFeatures != 0) || (formatProperties.bufferFeatures != 0)) {
+      profile.formats[format] = formatProperties;
+    }
+  }
+
+  return profile;
+}
+
+VkResult captureDeviceProfileSet(DeviceProfileSet* pProfileSet)
+{
+  TRACE_SCOPE("driver", "captureDeviceProfileSet");
+
+  uint32_t count = 0;
+  VkResult res = VK_CALL(VK_NULL_HANDLE, vkEnumerateInstanceExtensionProperties, nullptr, &count, nullptr);
+  if (res != VK_SUCCESS) {
+    return res;
+  }
+  pProfileSet->instanceExtensions.resize(count);
+  res = VK_CALL(VK_NULL_HANDLE, vkEnumerateInstanceExtensionProperties, nullptr, &count, pProfileSet->instanceExtensions.data());
+  if (res != VK_SUCCESS) {
+    return res;
+  }
+
+  VkApplicationInfo appInfo = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+  appInfo.pApplicationName    = "Vulkan Info Viewer";
+  appInfo.applicationVersion  = 1;
+  appInfo.pEngineName         = "Vulkan Info Viewer";
+  appInfo.engineVersion       = 1;
+  appInfo.apiVersion          = getLoaderApiVersion();
+
+  VkInstanceCreateInfo createInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+  createInfo.pApplicationInfo = &appInfo;
+
+  VkInstance instance = VK_NULL_HANDLE;
+  res = VK_CALL(VK_NULL_HANDLE, vkCreateInstance, &createInfo, MemoryAccounting::get().allocator(), &instance);
+  if (res != VK_SUCCESS) {
+    return res;
+  }
+
+  std::vector<VkPhysicalDevice> gpus;
+  res = VK_CALL(VK_NULL_HANDLE, vkEnumeratePhysicalDevices, instance, &count, nullptr);
+  if (res == VK_SUCCESS) {
+    gpus.resize(count);
+    res = VK_CALL(VK_NULL_HANDLE, vkEnumeratePhysicalDevices, instance, &count, gpus.data());
+  }
+  if (res != VK_SUCCESS) {
+    gpus.clear();
+  }
+
+  pProfileSet->devices.clear();
+  for (VkPhysicalDevice gpu : gpus) {
+    VkPhysicalDeviceProperties properties = {};
+    VK_CALL(gpu, vkGetPhysicalDeviceProperties, gpu, &properties);
+
+    std::vector<VkExtensionProperties> extensions;
+    uint32_t extensionCount = 0;
+    if (VK_CALL(gpu, vkEnumerateDeviceExtensionProperties, gpu, nullptr, &extensionCount, nullptr) == VK_SUCCESS) {
+      extensions.resize(extensionCount);
+      VK_CALL(gpu, vkEnumerateDeviceExtensionProperties, gpu, nullptr, &extensionCount, extensions.data());
+      extensions.resize(extensionCount);
+    }
+    std::sort(
+      std::begin(extensions),
+      std::end(extensions),
+      [](const VkExtensionProperties& a, const VkExtensionProperties& b) -> bool {
+        return (strcmp(a.extensionName, b.extensionName) < 0); });
+
+    pProfileSet->devices.push_back(captureDeviceProfile(gpu, properties, extensions));
+  }
+
+  VK_CALL(VK_NULL_HANDLE, vkDestroyInstance, instance, MemoryAccounting::get().allocator());
+  return res;
+}
@@ -0,0 +1,22 @@
+#ifndef __DEVICE_CAPTURE_H__
+#define __DEVICE_CAPTURE_H__
+
+#include "DeviceProfile.h"
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+//! Highest instance version the loader supports, 1.0 for 1.0 loaders
+uint32_t      getLoaderApiVersion();
+
+//! Queries everything in DeviceProfile from gpu. properties and extensions
+//! are already known to the caller, the rest is read from the driver.
+DeviceProfile captureDeviceProfile(VkPhysicalDevice gpu, const VkPhysicalDeviceProperties& properties,
+                                   const std::vector<VkExtensionProperties>& extensions);
+
+//! Creates a throwaway instance without extensions at the loader's version
+//! and captures every physical device it enumerates.
+VkResult      captureDeviceProfileSet(DeviceProfileSet* pProfileSet);
+
+#endif // __DEVICE_CAPTURE_H__
@@ -0,0 +1,414 @@
+#include "DeviceGroups.h"
+#include "Benchmark.h"
+#include "MemoryAccounting.h"
+#include "Trace.h"
+#include "VkProfiler.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#define RUN_COUNT   3
+
+static double toGBs(VkDeviceSize bytes, double milliseconds)
+{
+  return (milliseconds > 0.0) ? (static_cast<double>(bytes) / (milliseconds * 1000000.0)) : -1.0;
+}
+
+//! Logical device spanning every physical device of a group, with one
+//! queue that does transfers. Calls are attributed to the first device.
+struct GroupDevice {
+  VkPhysicalDevice                  gpu = VK_NULL_HANDLE;
+  uint32_t                          deviceCount = 0;
+  VkPhysicalDeviceMemoryProperties  memoryProperties = {};
+  VkDevice                          device = VK_NULL_HANDLE;
+  uint32_t                          queueFamilyIndex = UINT32_MAX;
+  VkQueue                           queue = VK_NULL_HANDLE;
+
+  GroupDevice() {}
+  ~GroupDevice();
+
+  GroupDevice(const GroupDevice&) = delete;
+  GroupDevice& operator=(const GroupDevice&) = delete;
+
+  VkResult create(const DeviceGroup& group);
+};
+
+GroupDevice::~GroupDevice()
+{
+  if (device != VK_NULL_HANDLE) {
+    VK_CALL(gpu, vkDeviceWaitIdle, device);
+    VK_CALL(gpu, vkDestroyDevice, device, MemoryAccounting::get().allocator());
+  }
+}
+
+VkResult GroupDevice::create(const DeviceGroup& group)
+{
+  // Device groups and the peer memory query are core 1.1
+  if (group.physicalDevices.empty() || (group.apiVersion < VK_API_VERSION_1_1)) {
+    return VK_ERROR_FEATURE_NOT_PRESENT;
+  }
+
+  gpu = group.physicalDevices[0];
+  deviceCount = static_cast<uint32_t>(group.physicalDevices.size());
+  VK_CALL(gpu, vkGetPhysicalDeviceMemoryProperties, gpu, &memoryProperties);
+
+  uint32_t count = 0;
+  VK_CALL(gpu, vkGetPhysicalDeviceQueueFamilyProperties, gpu, &count, nullptr);
+  std::vector<VkQueueFamilyProperties> queueFamilies(count);
+  VK_CALL(gpu, vkGetPhysicalDeviceQueueFamilyProperties, gpu, &count, queueFamilies.data());
+
+  // Any graphics or compute queue also does transfers
+  for (uint32_t i = 0; i < count; ++i) {
+    if ((queueFamilies[i].queueCount > 0) && ((queueFamilies[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) != 0)) {
+      queueFamilyIndex = i;
+      break;
+    }
+  }
+  if (queueFamilyIndex == UINT32_MAX) {
+    return VK_ERROR_FEATURE_NOT_PRESENT;
+  }
+
+  float priority = 1.0f;
+  VkDeviceQueueCreateInfo queueCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+  queueCreateInfo.queueFamilyIndex  = queueFamilyIndex;
+  queueCreateInfo.queueCount        = 1;
+  queueCreateInfo.pQueuePriorities  = &priority;
+
+  VkDeviceGroupDeviceCreateInfo groupCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_GROUP_DEVICE_CREATE_INFO };
+  groupCreateInfo.physicalDeviceCount = static_cast<uint32_t>(group.physicalDevices.size());
+  groupCreateInfo.pPhysicalDevices    = group.physicalDevices.data();
+
+  VkDeviceCreateInfo deviceCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+  deviceCreateInfo.pNext                = &groupCreateInfo;
+  deviceCreateInfo.queueCreateInfoCount = 1;
+  deviceCreateInfo.pQueueCreateInfos    = &queueCreateInfo;
+  VkResult res = VK_CALL(gpu, vkCreateDevice, gpu, &deviceCreateInfo, MemoryAccounting::get().allocator(), &device);
+  if (res != VK_SUCCESS) {
+    device = VK_NULL_HANDLE;
+    return res;
+  }
+
+  VK_CALL(gpu, vkGetDeviceQueue, device, queueFamilyIndex, 0, &queue);
+  return VK_SUCCESS;
+}
+
+std::vector<DeviceGroup> enumerateDeviceGroups(VkInstance instance, uint32_t instanceApiVersion)
+{
+  TRACE_SCOPE("driver", "vkEnumeratePhysicalDeviceGroups");
+
+  // A 1.0 instance only has the entry point of VK_KHR_device_group_creation
+  const char* function = "vkEnumeratePhysicalDeviceGroups";
+  PFN_vkEnumeratePhysicalDeviceGroups pfnEnumeratePhysicalDeviceGroups = vkEnumeratePhysicalDeviceGroups;
+  if (instanceApiVersion < VK_API_VERSION_1_1) {
+    function = "vkEnumeratePhysicalDeviceGroupsKHR";
+    pfnEnumeratePhysicalDeviceGroups = reinterpret_cast<PFN_vkEnumeratePhysicalDeviceGroupsKHR>(vkGetInstanceProcAddr(instance, function));
+  }
+
+  std::vector<DeviceGroup> groups;
+  if (pfnEnumeratePhysicalDeviceGroups == nullptr) {
+    return groups;
+  }
+
+  uint32_t count = 0;
+  VkResult res = (VkProfileScope(function, VK_NULL_HANDLE), pfnEnumeratePhysicalDeviceGroups(instance, &count, nullptr));
+  if (res != VK_SUCCESS) {
+    return groups;
+  }
+
+  VkPhysicalDeviceGroupProperties initial = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GROUP_PROPERTIES };
+  std::vector<VkPhysicalDeviceGroupProperties> properties(count, initial);
+  res = (VkProfileScope(function, VK_NULL_HANDLE), pfnEnumeratePhysicalDeviceGroups(instance, &count, properties.data()));
+  if (res < 0) {
+    return groups;
+  }
+  properties.resize(count);
+
+  for (const auto& groupProperties : properties) {
+    if (groupProperties.physicalDeviceCount == 0) {
+      continue;
+    }
+
+    DeviceGroup group;
+    group.physicalDevices.assign(groupProperties.physicalDevices, groupProperties.physicalDevices + groupProperties.physicalDeviceCount);
+    group.subsetAllocation = groupProperties.subsetAllocation;
+
+    VkPhysicalDeviceProperties deviceProperties = {};
+    VK_CALL(group.physicalDevices[0], vkGetPhysicalDeviceProperties, group.physicalDevices[0], &deviceProperties);
+    group.apiVersion = std::min(instanceApiVersion, deviceProperties.apiVersion);
+    groups.push_back(group);
+  }
+  return groups;
+}
+
+void queryPeerMemoryFeatures(DeviceGroup* pGroup)
+{
+  TRACE_SCOPE("driver", "queryPeerMemoryFeatures");
+
+  pGroup->peerMemory.clear();
+  uint32_t deviceCount = static_cast<uint32_t>(pGroup->physicalDevices.size());
+  if (deviceCount < 2) {
+    pGroup->peerMemoryResult = VK_SUCCESS;
+    return;
+  }
+
+  GroupDevice groupDevice;
+  pGroup->peerMemoryResult = groupDevice.create(*pGroup);
+  if (pGroup->peerMemoryResult != VK_SUCCESS) {
+    return;
+  }
+
+  for (uint32_t heapIndex = 0; heapIndex < groupDevice.memoryProperties.memoryHeapCount; ++heapIndex) {
+    for (uint32_t local = 0; local < deviceCount; ++local) {
+      for (uint32_t remote = 0; remote < deviceCount; ++remote) {
+        if (local == remote) {
+          continue;
+        }
+        PeerMemoryFeatures entry = { heapIndex, local, remote, 0 };
+        VK_CALL(groupDevice.gpu, vkGetDeviceGroupPeerMemoryFeatures, groupDevice.device, heapIndex, local, remote, &entry.features);
+        pGroup->peerMemory.push_back(entry);
+      }
+    }
+  }
+}
+
+//! Copies size bytes between the pairs that go through one multi-instance
+//! memory type and appends a result for each, attributed to the type's heap
+static void timePeerCopies(const GroupDevice& groupDevice, uint32_t typeIndex, const std::vector<std::pair<uint32_t, uint32_t>>& pairs, VkDeviceSize size, VkCommandBuffer commandBuffer, VkFence fence, std::vector<PeerCopyBenchmark>* pResults)
+{
+  VkPhysicalDevice gpu = groupDevice.gpu;
+  VkDevice device = groupDevice.device;
+  const VkAllocationCallbacks* pAllocator = MemoryAccounting::get().allocator();
+  uint32_t deviceCount = groupDevice.deviceCount;
+
+  VkBufferCreateInfo bufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+  bufferCreateInfo.size         = size;
+  bufferCreateInfo.usage        = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+  bufferCreateInfo.sharingMode  = VK_SHARING_MODE_EXCLUSIVE;
+
+  VkBuffer srcBuffer = VK_NULL_HANDLE;
+  VkBuffer dstBuffer = VK_NULL_HANDLE;
+  VkDeviceMemory srcMemory = VK_NULL_HANDLE;
+  VkDeviceMemory dstMemory = VK_NULL_HANDLE;
+
+  VkResult res = VK_CALL(gpu, vkCreateBuffer, device, &bufferCreateInfo, pAllocator, &srcBuffer);
+  if (res == VK_SUCCESS) {
+    res = VK_CALL(gpu, vkCreateBuffer, device, &bufferCreateInfo, pAllocator, &dstBuffer);
+  }
+
+  if (res == VK_SUCCESS) {
+    VkMemoryRequirements requirements = {};
+    VK_CALL(gpu, vkGetBufferMemoryRequirements, device, srcBuffer, &requirements);
+
+    VkMemoryAllocateFlagsInfo flagsInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO };
+    flagsInfo.flags       = VK_MEMORY_ALLOCATE_DEVICE_MASK_BIT;
+    flagsInfo.deviceMask  = (1u << deviceCount) - 1;
+
+    VkMemoryAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+    allocInfo.pNext           = &flagsInfo;
+    allocInfo.allocationSize  = requirements.size;
+    allocInfo.memoryTypeIndex = typeIndex;
+    res = VK_CALL(gpu, vkAllocateMemory, device, &allocInfo, pAllocator, &srcMemory);
+    if (res == VK_SUCCESS) {
+      res = VK_CALL(gpu, vkAllocateMemory, device, &allocInfo, pAllocator, &dstMemory);
+    }
+  }
+
+  // Without device indices each device binds its own instance
+  if (res == VK_SUCCESS) {
+    res = VK_CALL(gpu, vkBindBufferMemory, device, srcBuffer, srcMemory, 0);
+  }
+  if (res == VK_SUCCESS) {
+    res = VK_CALL(gpu, vkBindBufferMemory, device, dstBuffer, dstMemory, 0);
+  }
+
+  for (size_t pairIndex = 0; (res == VK_SUCCESS) && (pairIndex < pairs.size()); ++pairIndex) {
+    uint32_t local = pairs[pairIndex].first;
+    uint32_t remote = pairs[pairIndex].second;
+
+    PeerCopyBenchmark result;
+    result.heapIndex          = groupDevice.memoryProperties.memoryTypes[typeIndex].heapIndex;
+    result.localDeviceIndex   = local;
+    result.remoteDeviceIndex  = remote;
+
+    // local's instance of the peer buffer is remote's instance of dstMemory
+    VkBuffer peerBuffer = VK_NULL_HANDLE;
+    VkResult pairRes = VK_SUCCESS;
+    if (local != remote) {
+      pairRes = VK_CALL(gpu, vkCreateBuffer, device, &bufferCreateInfo, pAllocator, &peerBuffer);
+      if (pairRes == VK_SUCCESS) {
+        std::vector<uint32_t> deviceIndices(deviceCount);
+        for (uint32_t i = 0; i < deviceCount; ++i) {
+          deviceIndices[i] = (i == local) ? remote : i;
+        }
+        VkBindBufferMemoryDeviceGroupInfo deviceGroupInfo = { VK_STRUCTURE_TYPE_BIND_BUFFER_MEMORY_DEVICE_GROUP_INFO };
+        deviceGroupInfo.deviceIndexCount  = deviceCount;
+        deviceGroupInfo.pDeviceIndices    = deviceIndices.data();
+
+        VkBindBufferMemoryInfo bindInfo = { VK_STRUCTURE_TYPE_BIND_BUFFER_MEMORY_INFO };
+        bindInfo.pNext        = &deviceGroupInfo;
+        bindInfo.buffer       = peerBuffer;
+        bindInfo.memory       = dstMemory;
+        bindInfo.memoryOffset = 0;
+        pairRes = VK_CALL(gpu, vkBindBufferMemory2, device, 1, &bindInfo);
+      }
+    }
+
+    uint32_t deviceMask = 1u << local;
+    if (pairRes == VK_SUCCESS) {
+      VkDeviceGroupCommandBufferBeginInfo deviceGroupBeginInfo = { VK_STRUCTURE_TYPE_DEVICE_GROUP_COMMAND_BUFFER_BEGIN_INFO };
+      deviceGroupBeginInfo.deviceMask = deviceMask;
+
+      VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+      beginInfo.pNext = &deviceGroupBeginInfo;
+      VK_CALL(gpu, vkResetCommandBuffer, commandBuffer, 0);
+      VK_CALL(gpu, vkBeginCommandBuffer, commandBuffer, &beginInfo);
+      VkBufferCopy region = { 0, 0, size };
+      VK_CALL(gpu, vkCmdCopyBuffer, commandBuffer, srcBuffer, (local != remote) ? peerBuffer : dstBuffer, 1, &region);
+      pairRes = VK_CALL(gpu, vkEndCommandBuffer, commandBuffer);
+    }
+
+    double copyMs = -1.0;
+    for (int run = 0; (pairRes == VK_SUCCESS) && (run < RUN_COUNT); ++run) {
+      VkDeviceGroupSubmitInfo deviceGroupSubmitInfo = { VK_STRUCTURE_TYPE_DEVICE_GROUP_SUBMIT_INFO };
+      deviceGroupSubmitInfo.commandBufferCount        = 1;
+      deviceGroupSubmitInfo.pCommandBufferDeviceMasks = &deviceMask;
+
+      VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+      submitInfo.pNext              = &deviceGroupSubmitInfo;
+      submitInfo.commandBufferCount = 1;
+      submitInfo.pCommandBuffers    = &commandBuffer;
+
+      VK_CALL(gpu, vkResetFences, device, 1, &fence);
+      BenchmarkTimer timer;
+      pairRes = VK_CALL(gpu, vkQueueSubmit, groupDevice.queue, 1, &submitInfo, fence);
+      if (pairRes == VK_SUCCESS) {
+        pairRes = VK_CALL(gpu, vkWaitForFences, device, 1, &fence, VK_TRUE, UINT64_MAX);
+      }
+      double ms = timer.elapsedMilliseconds();
+      if (pairRes == VK_SUCCESS) {
+        copyMs = (copyMs < 0.0) ? ms : std::min(copyMs, ms);
+      }
+    }
+    result.copyGBs = toGBs(size, copyMs);
+    pResults->push_back(result);
+
+    if (peerBuffer != VK_NULL_HANDLE) {
+      VK_CALL(gpu, vkDestroyBuffer, device, peerBuffer, pAllocator);
+    }
+  }
+
+  VK_CALL(gpu, vkDeviceWaitIdle, device);
+  for (VkBuffer buffer : { srcBuffer, dstBuffer }) {
+    if (buffer != VK_NULL_HANDLE) {
+      VK_CALL(gpu, vkDestroyBuffer, device, buffer, pAllocator);
+    }
+  }
+  for (VkDeviceMemory memory : { srcMemory, dstMemory }) {
+    if (memory != VK_NULL_HANDLE) {
+      VK_CALL(gpu, vkFreeMemory, device, memory, pAllocator);
+    }
+  }
+}
+
+std::vector<PeerCopyBenchmark> runPeerCopyBenchmark(const DeviceGroup& group, VkDeviceSize size)
+{
+  TRACE_SCOPE("driver", "runPeerCopyBenchmark");
+
+  std::vector<PeerCopyBenchmark> results;
+  GroupDevice groupDevice;
+  if (groupDevice.create(group) != VK_SUCCESS) {
+    return results;
+  }
+  VkPhysicalDevice gpu = groupDevice.gpu;
+  VkDevice device = groupDevice.device;
+  const VkAllocationCallbacks* pAllocator = MemoryAccounting::get().allocator();
+  uint32_t deviceCount = groupDevice.deviceCount;
+
+  // The requirements only depend on the create info, not on the memory bound later
+  VkBufferCreateInfo bufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+  bufferCreateInfo.size         = size;
+  bufferCreateInfo.usage        = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+  bufferCreateInfo.sharingMode  = VK_SHARING_MODE_EXCLUSIVE;
+
+  VkBuffer buffer = VK_NULL_HANDLE;
+  VkMemoryRequirements requirements = {};
+  VkResult res = VK_CALL(gpu, vkCreateBuffer, device, &bufferCreateInfo, pAllocator, &buffer);
+  if (res == VK_SUCCESS) {
+    VK_CALL(gpu, vkGetBufferMemoryRequirements, device, buffer, &requirements);
+    VK_CALL(gpu, vkDestroyBuffer, device, buffer, pAllocator);
+  }
+
+  // Only a multi-instance heap gives every device its own copy to read from
+  // and write to. The first usable type of each such heap stands for it.
+  std::vector<uint32_t> candidateTypes;
+  const VkPhysicalDeviceMemoryProperties& memoryProperties = groupDevice.memoryProperties;
+  for (uint32_t i = 0; (res == VK_SUCCESS) && (i < memoryProperties.memoryTypeCount); ++i) {
+    const VkMemoryType& type = memoryProperties.memoryTypes[i];
+    bool heapTaken = std::any_of(candidateTypes.begin(), candidateTypes.end(),
+      [&memoryProperties, &type](uint32_t candidate) { return memoryProperties.memoryTypes[candidate].heapIndex == type.heapIndex; });
+    if (((requirements.memoryTypeBits & (1u << i)) != 0) &&
+        ((type.propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0) &&
+        ((memoryProperties.memoryHeaps[type.heapIndex].flags & VK_MEMORY_HEAP_MULTI_INSTANCE_BIT) != 0) &&
+        !heapTaken) {
+      candidateTypes.push_back(i);
+    }
+  }
+
+  // The spec only promises COPY_DST on some device local heap, so each pair
+  // uses the first heap that has it. Pairs without one are left out.
+  std::map<uint32_t, std::vector<std::pair<uint32_t, uint32_t>>> pairsByType;
+  for (uint32_t local = 0; local < deviceCount; ++local) {
+    for (uint32_t remote = 0; remote < deviceCount; ++remote) {
+      for (uint32_t typeIndex : candidateTypes) {
+        VkPeerMemoryFeatureFlags features = 0;
+        if (local != remote) {
+          uint32_t heapIndex = memoryProperties.memoryTypes[typeIndex].heapIndex;
+          VK_CALL(gpu, vkGetDeviceGroupPeerMemoryFeatures, device, heapIndex, local, remote, &features);
+        }
+        if ((local == remote) || ((features & VK_PEER_MEMORY_FEATURE_COPY_DST_BIT) != 0)) {
+          pairsByType[typeIndex].push_back(std::make_pair(local, remote));
+          break;
+        }
+      }
+    }
+  }
+
+  VkCommandPool commandPool = VK_NULL_HANDLE;
+  VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+  VkFence fence = VK_NULL_HANDLE;
+  if (pairsByType.empty()) {
+    res = VK_ERROR_FEATURE_NOT_PRESENT;
+  }
+  if (res == VK_SUCCESS) {
+    VkCommandPoolCreateInfo poolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+    poolCreateInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolCreateInfo.queueFamilyIndex = groupDevice.queueFamilyIndex;
+    res = VK_CALL(gpu, vkCreateCommandPool, device, &poolCreateInfo, pAllocator, &commandPool);
+  }
+  if (res == VK_SUCCESS) {
+    VkCommandBufferAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+    allocInfo.commandPool         = commandPool;
+    allocInfo.level               = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount  = 1;
+    res = VK_CALL(gpu, vkAllocateCommandBuffers, device, &allocInfo, &commandBuffer);
+  }
+  if (res == VK_SUCCESS) {
+    VkFenceCreateInfo fenceCreateInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+    res = VK_CALL(gpu, vkCreateFence, device, &fenceCreateInfo, pAllocator, &fence);
+  }
+
+  if (res == VK_SUCCESS) {
+    for (const auto& entry : pairsByType) {
+      timePeerCopies(groupDevice, entry.first, entry.second, size, commandBuffer, fence, &results);
+    }
+  }
+
+  if (fence != VK_NULL_HANDLE) {
+    VK_CALL(gpu, vkDestroyFence, device, fence, pAllocator);
+  }
+  if (commandPool != VK_NULL_HANDLE) {
+    VK_CALL(gpu, vkDestroyCommandPool, device, commandPool, pAllocator);
+  }
+  return results;
+}
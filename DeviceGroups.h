@@ -0,0 +1,54 @@
+#ifndef __DEVICE_GROUPS_H__
+#define __DEVICE_GROUPS_H__
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+//! vkGetDeviceGroupPeerMemoryFeatures for memory allocated on remoteDevice
+//! in heapIndex when it is accessed from localDevice. Indices are within
+//! the group.
+struct PeerMemoryFeatures {
+  uint32_t                  heapIndex;
+  uint32_t                  localDeviceIndex;
+  uint32_t                  remoteDeviceIndex;
+  VkPeerMemoryFeatureFlags  features;
+};
+
+//! One vkEnumeratePhysicalDeviceGroups entry. peerMemory needs a logical
+//! device created for the whole group, so it is only queried on request;
+//! peerMemoryResult is VK_NOT_READY until then. A group of one device has
+//! no pairs to query.
+struct DeviceGroup {
+  std::vector<VkPhysicalDevice>     physicalDevices;
+  VkBool32                          subsetAllocation = VK_FALSE;
+  uint32_t                          apiVersion = VK_API_VERSION_1_0;    // Of the instance and first device
+  std::vector<PeerMemoryFeatures>   peerMemory;
+  VkResult                          peerMemoryResult = VK_NOT_READY;
+};
+
+//! Per (local, remote) device pair results, negative values mean not
+//! measured. local == remote is the copy within one device for reference.
+struct PeerCopyBenchmark {
+  uint32_t  heapIndex = 0;
+  uint32_t  localDeviceIndex = 0;
+  uint32_t  remoteDeviceIndex = 0;
+  double    copyGBs = -1.0;         // vkCmdCopyBuffer on local into remote's memory instance
+};
+
+//! Needs a 1.1 instance or VK_KHR_device_group_creation. Peer memory and
+//! the benchmark also need instanceApiVersion and the devices at 1.1.
+std::vector<DeviceGroup> enumerateDeviceGroups(VkInstance instance, uint32_t instanceApiVersion);
+
+//! Fills peerMemory for every heap and every pair of devices in the group
+void queryPeerMemoryFeatures(DeviceGroup* pGroup);
+
+//! Allocates size bytes from a device local, multi-instance heap so every
+//! device of the group has its own instance, and copies between each pair
+//! from local's instance to remote's. The spec only guarantees COPY_DST for
+//! at least one device local heap, so each pair uses the first such heap
+//! that has it and pairs with none are skipped. Timed on the host around
+//! the submit, best of a few runs is kept.
+std::vector<PeerCopyBenchmark> runPeerCopyBenchmark(const DeviceGroup& group, VkDeviceSize size);
+
+#endif // __DEVICE_GROUPS_H__
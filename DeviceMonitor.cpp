@@ -0,0 +1,161 @@
+#include "DeviceMonitor.h"
+#include "ManifestScanner.h"
+#include "MemoryAccounting.h"
+#include "Trace.h"
+
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+#define DEBOUNCE_INTERVAL_MS      500
+
+DeviceMonitor::DeviceMonitor(QObject* parent)
+  : QObject(parent)
+{
+  connect(&mWatcher, SIGNAL(directoryChanged(QString)), this, SLOT(on_pathChanged(QString)));
+  connect(&mWatcher, SIGNAL(fileChanged(QString)), this, SLOT(on_pathChanged(QString)));
+  connect(&mPollTimer, SIGNAL(timeout()), this, SLOT(probe()));
+  connect(&mProbe, SIGNAL(finished()), this, SLOT(on_probeFinished()));
+
+  // File system events arrive in bursts while a driver installs
+  mDebounceTimer.setSingleShot(true);
+  mDebounceTimer.setInterval(DEBOUNCE_INTERVAL_MS);
+  connect(&mDebounceTimer, SIGNAL(timeout()), this, SLOT(probe()));
+}
+
+DeviceMonitor::~DeviceMonitor()
+{
+  mPollTimer.stop();
+  mDebounceTimer.stop();
+  mProbe.waitForFinished();
+}
+
+void DeviceMonitor::start(bool allowPolling)
+{
+  // Directories, or the files listed in VK_ICD_FILENAMES and VK_LAYER_PATH.
+  // Layers can hide or add devices too.
+  QStringList paths;
+  QStringList manifestPaths = ManifestScanner::icdManifestPaths();
+  manifestPaths << ManifestScanner::layerManifestPaths(false) << ManifestScanner::layerManifestPaths(true);
+  for (const auto& path : manifestPaths) {
+    if (QFileInfo(path).exists() && ! paths.contains(path)) {
+      paths << path;
+    }
+  }
+
+#if defined(__linux__)
+  // Render nodes appear and disappear with eGPU attach/detach
+  if (QFileInfo("/dev/dri").isDir()) {
+    paths << "/dev/dri";
+  }
+#endif
+
+  if (! paths.isEmpty()) {
+    mWatcher.addPaths(paths);
+  }
+
+  int interval = qEnvironmentVariableIntValue("VIV_DEVICE_MONITOR_INTERVAL_MS");
+  if (allowPolling && (interval > 0)) {
+    mPollTimer.start(interval);
+  }
+
+  // Establish the baseline
+  probe();
+}
+
+void DeviceMonitor::on_pathChanged(const QString& path)
+{
+  // Some editors and package managers replace files, which drops the watch
+  if (QFileInfo(path).exists() && ! mWatcher.files().contains(path) && ! mWatcher.directories().contains(path)) {
+    mWatcher.addPath(path);
+  }
+  mDebounceTimer.start();
+}
+
+void DeviceMonitor::setSuspended(bool suspended)
+{
+  mSuspended = suspended;
+  if ((! mSuspended) && mProbePending) {
+    mProbePending = false;
+    probe();
+  }
+}
+
+void DeviceMonitor::probe()
+{
+  if (mSuspended) {
+    mProbePending = true;
+    return;
+  }
+  if (mProbe.isRunning()) {
+    return;
+  }
+  mProbe.setFuture(QtConcurrent::run(&DeviceMonitor::probeDeviceSignatures));
+}
+
+void DeviceMonitor::on_probeFinished()
+{
+  QStringList signatures = mProbe.result();
+  if (! mHasSignatures) {
+    mSignatures = signatures;
+    mHasSignatures = true;
+    return;
+  }
+
+  if (signatures != mSignatures) {
+    mSignatures = signatures;
+    emit devicesChanged();
+  }
+}
+
+QStringList DeviceMonitor::probeDeviceSignatures()
+{
+  TRACE_SCOPE("loader", "DeviceMonitor::probe");
+
+  QStringList signatures;
+
+  // Bare instance: no layers, no extensions, nothing the probe doesn't need.
+  // Calls aren't routed through VK_CALL so the periodic probe stays out of
+  // the profiler numbers.
+  VkApplicationInfo appInfo = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+  appInfo.pApplicationName  = "Vulkan Info Viewer Device Monitor";
+  appInfo.apiVersion        = VK_MAKE_VERSION(1, 0, 3);
+
+  VkInstanceCreateInfo createInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+  createInfo.pApplicationInfo = &appInfo;
+
+  VkInstance instance = VK_NULL_HANDLE;
+  VkResult res = vkCreateInstance(&createInfo, MemoryAccounting::get().allocator(), &instance);
+  if (res != VK_SUCCESS) {
+    return signatures;
+  }
+
+  uint32_t count = 0;
+  res = vkEnumeratePhysicalDevices(instance, &count, nullptr);
+  std::vector<VkPhysicalDevice> gpus(count);
+  if ((res == VK_SUCCESS) && (count > 0)) {
+    res = vkEnumeratePhysicalDevices(instance, &count, gpus.data());
+  }
+
+  if (res == VK_SUCCESS) {
+    for (uint32_t i = 0; i < count; ++i) {
+      VkPhysicalDeviceProperties properties = {};
+      vkGetPhysicalDeviceProperties(gpus[i], &properties);
+
+      QByteArray uuid(reinterpret_cast<const char*>(properties.pipelineCacheUUID), VK_UUID_SIZE);
+      signatures << QString("%1:%2:%3:%4:%5")
+                      .arg(properties.vendorID, 0, 16)
+                      .arg(properties.deviceID, 0, 16)
+                      .arg(properties.driverVersion)
+                      .arg(QString::fromUtf8(properties.deviceName))
+                      .arg(QString::fromLatin1(uuid.toHex()));
+    }
+  }
+
+  vkDestroyInstance(instance, MemoryAccounting::get().allocator());
+
+  return signatures;
+}
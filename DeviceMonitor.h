@@ -0,0 +1,56 @@
+#ifndef __DEVICE_MONITOR_H__
+#define __DEVICE_MONITOR_H__
+
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+//! \class DeviceMonitor
+//!
+//! Watches for GPUs or drivers coming and going. ICD and layer manifest
+//! directories (and /dev/dri on Linux) are watched through
+//! QFileSystemWatcher, which is inotify backed on Linux, and a change
+//! probes the loader with a throwaway instance. Probing happens off the UI
+//! thread and only reads VkPhysicalDeviceProperties; devicesChanged() is
+//! emitted when the probed device signatures differ from the previous probe.
+//!
+//! A probe is a full vkCreateInstance, so polling is opt-in:
+//! VIV_DEVICE_MONITOR_INTERVAL_MS sets a probe interval for driver updates
+//! the watches can't see. Daemons never poll.
+//!
+class DeviceMonitor : public QObject {
+  Q_OBJECT
+public:
+  explicit DeviceMonitor(QObject* parent = nullptr);
+  ~DeviceMonitor();
+
+  //! Without allowPolling only the file watches trigger probes
+  void start(bool allowPolling);
+  //! While suspended probes are held back, one runs on resume if any was due
+  void setSuspended(bool suspended);
+
+signals:
+  void devicesChanged();
+
+private slots:
+  void on_pathChanged(const QString& path);
+  void on_probeFinished();
+  void probe();
+
+private:
+  static QStringList probeDeviceSignatures();
+
+private:
+  QFileSystemWatcher        mWatcher;
+  QTimer                    mPollTimer;
+  QTimer                    mDebounceTimer;
+  QFutureWatcher<QStringList> mProbe;
+  QStringList               mSignatures;
+  bool                      mHasSignatures = false;
+  bool                      mSuspended = false;
+  bool                      mProbePending = false;
+};
+
+#endif // __DEVICE_MONITOR_H__
@@ -0,0 +1,634 @@
+#include "DeviceProfile.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QStringList>
+
+#include <algorithm>
+#include <cstring>
+
+#define LIMITS_FIELDS(X)                              \
+  X(maxImageDimension1D)                              \
+  X(maxImageDimension2D)                              \
+  X(maxImageDimension3D)                              \
+  X(maxImageDimensionCube)                            \
+  X(maxImageArrayLayers)                              \
+  X(maxTexelBufferElements)                           \
+  X(maxUniformBufferRange)                            \
+  X(maxStorageBufferRange)                            \
+  X(maxPushConstantsSize)                             \
+  X(maxMemoryAllocationCount)                         \
+  X(maxSamplerAllocationCount)                        \
+  X(bufferImageGranularity)                           \
+  X(sparseAddressSpaceSize)                           \
+  X(maxBoundDescriptorSets)                           \
+  X(maxPerStageDescriptorSamplers)                    \
+  X(maxPerStageDescriptorUniformBuffers)              \
+  X(maxPerStageDescriptorStorageBuffers)              \
+  X(maxPerStageDescriptorSampledImages)               \
+  X(maxPerStageDescriptorStorageImages)               \
+  X(maxPerStageDescriptorInputAttachments)            \
+  X(maxPerStageResources)                             \
+  X(maxDescriptorSetSamplers)                         \
+  X(maxDescriptorSetUniformBuffers)                   \
+  X(maxDescriptorSetUniformBuffersDynamic)            \
+  X(maxDescriptorSetStorageBuffers)                   \
+  X(maxDescriptorSetStorageBuffersDynamic)            \
+  X(maxDescriptorSetSampledImages)                    \
+  X(maxDescriptorSetStorageImages)                    \
+  X(maxDescriptorSetInputAttachments)                 \
+  X(maxVertexInputAttributes)                         \
+  X(maxVertexInputBindings)                           \
+  X(maxVertexInputAttributeOffset)                    \
+  X(maxVertexInputBindingStride)                      \
+  X(maxVertexOutputComponents)                        \
+  X(maxTessellationGenerationLevel)                   \
+  X(maxTessellationPatchSize)                         \
+  X(maxTessellationControlPerVertexInputComponents)   \
+  X(maxTessellationControlPerVertexOutputComponents)  \
+  X(maxTessellationControlPerPatchOutputComponents)   \
+  X(maxTessellationControlTotalOutputComponents)      \
+  X(maxTessellationEvaluationInputComponents)         \
+  X(maxTessellationEvaluationOutputComponents)        \
+  X(maxGeometryShaderInvocations)                     \
+  X(maxGeometryInputComponents)                       \
+  X(maxGeometryOutputComponents)                      \
+  X(maxGeometryOutputVertices)                        \
+  X(maxGeometryTotalOutputComponents)                 \
+  X(maxFragmentInputComponents)                       \
+  X(maxFragmentOutputAttachments)                     \
+  X(maxFragmentDualSrcAttachments)                    \
+  X(maxFragmentCombinedOutputResources)               \
+  X(maxComputeSharedMemorySize)                       \
+  X(maxComputeWorkGroupCount)                         \
+  X(maxComputeWorkGroupInvocations)                   \
+  X(maxComputeWorkGroupSize)                          \
+  X(subPixelPrecisionBits)                            \
+  X(subTexelPrecisionBits)                            \
+  X(mipmapPrecisionBits)                              \
+  X(maxDrawIndexedIndexValue)                         \
+  X(maxDrawIndirectCount)                             \
+  X(maxSamplerLodBias)                                \
+  X(maxSamplerAnisotropy)                             \
+  X(maxViewports)                                     \
+  X(maxViewportDimensions)                            \
+  X(viewportBoundsRange)                              \
+  X(viewportSubPixelBits)                             \
+  X(minMemoryMapAlignment)                            \
+  X(minTexelBufferOffsetAlignment)                    \
+  X(minUniformBufferOffsetAlignment)                  \
+  X(minStorageBufferOffsetAlignment)                  \
+  X(minTexelOffset)                                   \
+  X(maxTexelOffset)                                   \
+  X(minTexelGatherOffset)                             \
+  X(maxTexelGatherOffset)                             \
+  X(minInterpolationOffset)                           \
+  X(maxInterpolationOffset)                           \
+  X(subPixelInterpolationOffsetBits)                  \
+  X(maxFramebufferWidth)                              \
+  X(maxFramebufferHeight)                             \
+  X(maxFramebufferLayers)                             \
+  X(framebufferColorSampleCounts)                     \
+  X(framebufferDepthSampleCounts)                     \
+  X(framebufferStencilSampleCounts)                   \
+  X(framebufferNoAttachmentsSampleCounts)             \
+  X(maxColorAttachments)                              \
+  X(sampledImageColorSampleCounts)                    \
+  X(sampledImageIntegerSampleCounts)                  \
+  X(sampledImageDepthSampleCounts)                    \
+  X(sampledImageStencilSampleCounts)                  \
+  X(storageImageSampleCounts)                         \
+  X(maxSampleMaskWords)                               \
+  X(timestampComputeAndGraphics)                      \
+  X(timestampPeriod)                                  \
+  X(maxClipDistances)                                 \
+  X(maxCullDistances)                                 \
+  X(maxCombinedClipAndCullDistances)                  \
+  X(discreteQueuePriorities)                          \
+  X(pointSizeRange)                                   \
+  X(lineWidthRange)                                   \
+  X(pointSizeGranularity)                             \
+  X(lineWidthGranularity)                             \
+  X(strictLines)                                      \
+  X(standardSampleLocations)                          \
+  X(optimalBufferCopyOffsetAlignment)                 \
+  X(optimalBufferCopyRowPitchAlignment)               \
+  X(nonCoherentAtomSize)
+
+#define SPARSE_FIELDS(X)                              \
+  X(residencyStandard2DBlockShape)                    \
+  X(residencyStandard2DMultisampleBlockShape)         \
+  X(residencyStandard3DBlockShape)                    \
+  X(residencyAlignedMipSize)                          \
+  X(residencyNonResidentStrict)
+
+#define FEATURES_FIELDS(X)                            \
+  X(robustBufferAccess)                               \
+  X(fullDrawIndexUint32)                              \
+  X(imageCubeArray)                                   \
+  X(independentBlend)                                 \
+  X(geometryShader)                                   \
+  X(tessellationShader)                               \
+  X(sampleRateShading)                                \
+  X(dualSrcBlend)                                     \
+  X(logicOp)                                          \
+  X(multiDrawIndirect)                                \
+  X(drawIndirectFirstInstance)                        \
+  X(depthClamp)                                       \
+  X(depthBiasClamp)                                   \
+  X(fillModeNonSolid)                                 \
+  X(depthBounds)                                      \
+  X(wideLines)                                        \
+  X(largePoints)                                      \
+  X(alphaToOne)                                       \
+  X(multiViewport)                                    \
+  X(samplerAnisotropy)                                \
+  X(textureCompressionETC2)                           \
+  X(textureCompressionASTC_LDR)                       \
+  X(textureCompressionBC)                             \
+  X(occlusionQueryPrecise)                            \
+  X(pipelineStatisticsQuery)                          \
+  X(vertexPipelineStoresAndAtomics)                   \
+  X(fragmentStoresAndAtomics)                         \
+  X(shaderTessellationAndGeometryPointSize)           \
+  X(shaderImageGatherExtended)                        \
+  X(shaderStorageImageExtendedFormats)                \
+  X(shaderStorageImageMultisample)                    \
+  X(shaderStorageImageReadWithoutFormat)              \
+  X(shaderStorageImageWriteWithoutFormat)             \
+  X(shaderUniformBufferArrayDynamicIndexing)          \
+  X(shaderSampledImageArrayDynamicIndexing)           \
+  X(shaderStorageBufferArrayDynamicIndexing)          \
+  X(shaderStorageImageArrayDynamicIndexing)           \
+  X(shaderClipDistance)                               \
+  X(shaderCullDistance)                               \
+  X(shaderFloat64)                                    \
+  X(shaderInt64)                                      \
+  X(shaderInt16)                                      \
+  X(shaderResourceResidency)                          \
+  X(shaderResourceMinLod)                             \
+  X(sparseBinding)                                    \
+  X(sparseResidencyBuffer)                            \
+  X(sparseResidencyImage2D)                           \
+  X(sparseResidencyImage3D)                           \
+  X(sparseResidency2Samples)                          \
+  X(sparseResidency4Samples)                          \
+  X(sparseResidency8Samples)                          \
+  X(sparseResidency16Samples)                         \
+  X(sparseResidencyAliased)                           \
+  X(variableMultisampleRate)                          \
+  X(inheritedQueries)
+
+// 2^53, largest integer a JSON number (double) holds exactly
+static const unsigned long long kMaxExactJsonInteger = 9007199254740992ULL;
+
+// -------------------------------------------------------------------------------------------------
+// Writers
+// -------------------------------------------------------------------------------------------------
+static QJsonValue toJsonValue(unsigned int value)
+{
+  return static_cast<double>(value);
+}
+
+static QJsonValue toJsonValue(int value)
+{
+  return static_cast<double>(value);
+}
+
+static QJsonValue toJsonValue(unsigned long long value)
+{
+  // Values that don't survive the round trip through a double are stored as strings
+  if (value > kMaxExactJsonInteger) {
+    return QString::number(value);
+  }
+  return static_cast<double>(value);
+}
+
+static QJsonValue toJsonValue(unsigned long value)
+{
+  return toJsonValue(static_cast<unsigned long long>(value));
+}
+
+static QJsonValue toJsonValue(float value)
+{
+  return static_cast<double>(value);
+}
+
+template <typename T, size_t N>
+static QJsonValue toJsonValue(const T (&values)[N])
+{
+  QJsonArray array;
+  for (size_t i = 0; i < N; ++i) {
+    array.append(toJsonValue(values[i]));
+  }
+  return array;
+}
+
+static QJsonValue toJsonBool(VkBool32 value)
+{
+  return (value == VK_TRUE);
+}
+
+static QJsonArray toJsonExtensions(const std::vector<VkExtensionProperties>& extensions)
+{
+  QJsonArray array;
+  for (const auto& ext : extensions) {
+    QJsonObject item;
+    item["extensionName"] = QString::fromUtf8(ext.extensionName);
+    item["specVersion"]   = toJsonValue(ext.specVersion);
+    array.append(item);
+  }
+  return array;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Readers - only keys that are present overwrite the destination
+// -------------------------------------------------------------------------------------------------
+static unsigned long long toU64(const QJsonValue& value)
+{
+  if (value.isString()) {
+    return value.toString().toULongLong(nullptr, 0);
+  }
+  return static_cast<unsigned long long>(value.toDouble());
+}
+
+static void readValue(const QJsonValue& value, unsigned int* pDst)
+{
+  if (value.isBool()) {
+    *pDst = value.toBool() ? VK_TRUE : VK_FALSE;
+  }
+  else if (value.isDouble() || value.isString()) {
+    *pDst = static_cast<unsigned int>(toU64(value));
+  }
+}
+
+static void readValue(const QJsonValue& value, int* pDst)
+{
+  if (value.isDouble()) {
+    *pDst = static_cast<int>(value.toDouble());
+  }
+}
+
+static void readValue(const QJsonValue& value, unsigned long long* pDst)
+{
+  if (value.isDouble() || value.isString()) {
+    *pDst = toU64(value);
+  }
+}
+
+static void readValue(const QJsonValue& value, unsigned long* pDst)
+{
+  if (value.isDouble() || value.isString()) {
+    *pDst = static_cast<unsigned long>(toU64(value));
+  }
+}
+
+static void readValue(const QJsonValue& value, float* pDst)
+{
+  if (value.isDouble()) {
+    *pDst = static_cast<float>(value.toDouble());
+  }
+}
+
+template <typename T, size_t N>
+static void readValue(const QJsonValue& value, T (*pDst)[N])
+{
+  QJsonArray array = value.toArray();
+  for (size_t i = 0; (i < N) && (i < static_cast<size_t>(array.size())); ++i) {
+    readValue(array[static_cast<int>(i)], &(*pDst)[i]);
+  }
+}
+
+static uint32_t readVersion(const QJsonValue& value, uint32_t defaultValue)
+{
+  // Accept either the packed number or "major.minor.patch"
+  if (value.isString()) {
+    QStringList parts = value.toString().split('.');
+    uint32_t major = (parts.size() > 0) ? parts[0].toUInt() : 0;
+    uint32_t minor = (parts.size() > 1) ? parts[1].toUInt() : 0;
+    uint32_t patch = (parts.size() > 2) ? parts[2].toUInt() : 0;
+    return VK_MAKE_VERSION(major, minor, patch);
+  }
+  if (value.isDouble()) {
+    return static_cast<uint32_t>(value.toDouble());
+  }
+  return defaultValue;
+}
+
+static void readExtensions(const QJsonValue& value, std::vector<VkExtensionProperties>* pExtensions)
+{
+  if (! value.isArray()) {
+    return;
+  }
+
+  pExtensions->clear();
+  for (const auto& elem : value.toArray()) {
+    QJsonObject item = elem.toObject();
+    VkExtensionProperties ext = {};
+    QByteArray name = item["extensionName"].toString().toUtf8();
+    strncpy(ext.extensionName, name.constData(), VK_MAX_EXTENSION_NAME_SIZE - 1);
+    readValue(item["specVersion"], &ext.specVersion);
+    pExtensions->push_back(ext);
+  }
+}
+
+template <typename T>
+static bool isSameField(const T& a, const T& b)
+{
+  return a == b;
+}
+
+template <typename T, size_t N>
+static bool isSameField(const T (&a)[N], const T (&b)[N])
+{
+  return std::equal(a, a + N, b);
+}
+
+// -------------------------------------------------------------------------------------------------
+// DeviceProfile
+// -------------------------------------------------------------------------------------------------
+bool isSamePhysicalDeviceProperties(const VkPhysicalDeviceProperties& a, const VkPhysicalDeviceProperties& b)
+{
+  // Field by field, the padding inside the struct is not guaranteed to match
+  if ((a.apiVersion != b.apiVersion) ||
+      (a.driverVersion != b.driverVersion) ||
+      (a.vendorID != b.vendorID) ||
+      (a.deviceID != b.deviceID) ||
+      (a.deviceType != b.deviceType) ||
+      (strncmp(a.deviceName, b.deviceName, VK_MAX_PHYSICAL_DEVICE_NAME_SIZE) != 0) ||
+      (! isSameField(a.pipelineCacheUUID, b.pipelineCacheUUID))) {
+    return false;
+  }
+
+#define COMPARE_FIELD(name) if (! isSameField(a.limits.name, b.limits.name)) return false;
+  LIMITS_FIELDS(COMPARE_FIELD)
+#undef COMPARE_FIELD
+
+#define COMPARE_FIELD(name) if (a.sparseProperties.name != b.sparseProperties.name) return false;
+  SPARSE_FIELDS(COMPARE_FIELD)
+#undef COMPARE_FIELD
+
+  return true;
+}
+
+QJsonObject deviceProfileToJson(const DeviceProfile& profile)
+{
+  const VkPhysicalDeviceProperties& props = profile.properties;
+
+  QJsonObject limits;
+#define WRITE_FIELD(name) limits[#name] = toJsonValue(props.limits.name);
+  LIMITS_FIELDS(WRITE_FIELD)
+#undef WRITE_FIELD
+
+  QJsonObject sparse;
+#define WRITE_FIELD(name) sparse[#name] = toJsonBool(props.sparseProperties.name);
+  SPARSE_FIELDS(WRITE_FIELD)
+#undef WRITE_FIELD
+
+  QByteArray uuid(reinterpret_cast<const char*>(props.pipelineCacheUUID), VK_UUID_SIZE);
+
+  QJsonObject properties;
+  properties["apiVersion"]        = toJsonValue(props.apiVersion);
+  properties["driverVersion"]     = toJsonValue(props.driverVersion);
+  properties["vendorID"]          = toJsonValue(props.vendorID);
+  properties["deviceID"]          = toJsonValue(props.deviceID);
+  properties["deviceType"]        = static_cast<int>(props.deviceType);
+  properties["deviceName"]        = QString::fromUtf8(props.deviceName);
+  properties["pipelineCacheUUID"] = QString::fromLatin1(uuid.toHex());
+  properties["limits"]            = limits;
+  properties["sparseProperties"]  = sparse;
+
+  QJsonObject features;
+#define WRITE_FIELD(name) features[#name] = toJsonBool(profile.features.name);
+  FEATURES_FIELDS(WRITE_FIELD)
+#undef WRITE_FIELD
+
+  QJsonArray queueFamilies;
+  for (const auto& family : profile.queueFamilies) {
+    QJsonObject item;
+    item["queueFlags"]          = toJsonValue(family.queueFlags);
+    item["queueCount"]          = toJsonValue(family.queueCount);
+    item["timestampValidBits"]  = toJsonValue(family.timestampValidBits);
+    QJsonArray granularity;
+    granularity.append(toJsonValue(family.minImageTransferGranularity.width));
+    granularity.append(toJsonValue(family.minImageTransferGranularity.height));
+    granularity.append(toJsonValue(family.minImageTransferGranularity.depth));
+    item["minImageTransferGranularity"] = granularity;
+    queueFamilies.append(item);
+  }
+
+  QJsonArray memoryTypes;
+  for (uint32_t i = 0; i < profile.memoryProperties.memoryTypeCount; ++i) {
+    QJsonObject item;
+    item["propertyFlags"] = toJsonValue(profile.memoryProperties.memoryTypes[i].propertyFlags);
+    item["heapIndex"]     = toJsonValue(profile.memoryProperties.memoryTypes[i].heapIndex);
+    memoryTypes.append(item);
+  }
+
+  QJsonArray memoryHeaps;
+  for (uint32_t i = 0; i < profile.memoryProperties.memoryHeapCount; ++i) {
+    QJsonObject item;
+    item["size"]  = toJsonValue(static_cast<unsigned long long>(profile.memoryProperties.memoryHeaps[i].size));
+    item["flags"] = toJsonValue(profile.memoryProperties.memoryHeaps[i].flags);
+    memoryHeaps.append(item);
+  }
+
+  QJsonArray formats;
+  for (const auto& it : profile.formats) {
+    QJsonObject item;
+    item["format"]                = static_cast<int>(it.first);
+    item["linearTilingFeatures"]  = toJsonValue(it.second.linearTilingFeatures);
+    item["optimalTilingFeatures"] = toJsonValue(it.second.optimalTilingFeatures);
+    item["bufferFeatures"]        = toJsonValue(it.second.bufferFeatures);
+    formats.append(item);
+  }
+
+  QJsonObject json;
+  json["properties"]    = properties;
+  json["features"]      = features;
+  json["extensions"]    = toJsonExtensions(profile.extensions);
+  json["queueFamilies"] = queueFamilies;
+  json["memoryTypes"]   = memoryTypes;
+  json["memoryHeaps"]   = memoryHeaps;
+  json["formats"]       = formats;
+  return json;
+}
+
+bool deviceProfileFromJson(const QJsonObject& json, DeviceProfile* pProfile)
+{
+  if (pProfile == nullptr) {
+    return false;
+  }
+
+  VkPhysicalDeviceProperties& props = pProfile->properties;
+
+  if (json.contains("properties")) {
+    QJsonObject properties = json["properties"].toObject();
+    props.apiVersion = readVersion(properties["apiVersion"], props.apiVersion);
+    props.driverVersion = readVersion(properties["driverVersion"], props.driverVersion);
+    readValue(properties["vendorID"], &props.vendorID);
+    readValue(properties["deviceID"], &props.deviceID);
+    if (properties.contains("deviceType")) {
+      props.deviceType = static_cast<VkPhysicalDeviceType>(properties["deviceType"].toInt());
+    }
+    if (properties.contains("deviceName")) {
+      QByteArray name = properties["deviceName"].toString().toUtf8();
+      memset(props.deviceName, 0, sizeof(props.deviceName));
+      strncpy(props.deviceName, name.constData(), VK_MAX_PHYSICAL_DEVICE_NAME_SIZE - 1);
+    }
+    if (properties.contains("pipelineCacheUUID")) {
+      QByteArray uuid = QByteArray::fromHex(properties["pipelineCacheUUID"].toString().toLatin1());
+      memset(props.pipelineCacheUUID, 0, VK_UUID_SIZE);
+      memcpy(props.pipelineCacheUUID, uuid.constData(), std::min<size_t>(uuid.size(), VK_UUID_SIZE));
+    }
+
+    QJsonObject limits = properties["limits"].toObject();
+#define READ_FIELD(name) readValue(limits[#name], &props.limits.name);
+    LIMITS_FIELDS(READ_FIELD)
+#undef READ_FIELD
+
+    QJsonObject sparse = properties["sparseProperties"].toObject();
+#define READ_FIELD(name) readValue(sparse[#name], &props.sparseProperties.name);
+    SPARSE_FIELDS(READ_FIELD)
+#undef READ_FIELD
+  }
+
+  QJsonObject features = json["features"].toObject();
+#define READ_FIELD(name) readValue(features[#name], &pProfile->features.name);
+  FEATURES_FIELDS(READ_FIELD)
+#undef READ_FIELD
+
+  readExtensions(json["extensions"], &pProfile->extensions);
+
+  if (json.contains("queueFamilies")) {
+    pProfile->queueFamilies.clear();
+    for (const auto& elem : json["queueFamilies"].toArray()) {
+      QJsonObject item = elem.toObject();
+      VkQueueFamilyProperties family = {};
+      family.timestampValidBits = 64;
+      family.minImageTransferGranularity = { 1, 1, 1 };
+      readValue(item["queueFlags"], &family.queueFlags);
+      readValue(item["queueCount"], &family.queueCount);
+      readValue(item["timestampValidBits"], &family.timestampValidBits);
+      QJsonArray granularity = item["minImageTransferGranularity"].toArray();
+      if (granularity.size() == 3) {
+        readValue(granularity[0], &family.minImageTransferGranularity.width);
+        readValue(granularity[1], &family.minImageTransferGranularity.height);
+        readValue(granularity[2], &family.minImageTransferGranularity.depth);
+      }
+      pProfile->queueFamilies.push_back(family);
+    }
+  }
+
+  VkPhysicalDeviceMemoryProperties& memory = pProfile->memoryProperties;
+  if (json.contains("memoryTypes")) {
+    QJsonArray memoryTypes = json["memoryTypes"].toArray();
+    memory.memoryTypeCount = std::min<uint32_t>(memoryTypes.size(), VK_MAX_MEMORY_TYPES);
+    for (uint32_t i = 0; i < memory.memoryTypeCount; ++i) {
+      QJsonObject item = memoryTypes[static_cast<int>(i)].toObject();
+      memory.memoryTypes[i] = {};
+      readValue(item["propertyFlags"], &memory.memoryTypes[i].propertyFlags);
+      readValue(item["heapIndex"], &memory.memoryTypes[i].heapIndex);
+    }
+  }
+  if (json.contains("memoryHeaps")) {
+    QJsonArray memoryHeaps = json["memoryHeaps"].toArray();
+    memory.memoryHeapCount = std::min<uint32_t>(memoryHeaps.size(), VK_MAX_MEMORY_HEAPS);
+    for (uint32_t i = 0; i < memory.memoryHeapCount; ++i) {
+      QJsonObject item = memoryHeaps[static_cast<int>(i)].toObject();
+      memory.memoryHeaps[i] = {};
+      memory.memoryHeaps[i].size = static_cast<VkDeviceSize>(toU64(item["size"]));
+      readValue(item["flags"], &memory.memoryHeaps[i].flags);
+    }
+  }
+
+  if (json.contains("formats")) {
+    pProfile->formats.clear();
+    for (const auto& elem : json["formats"].toArray()) {
+      QJsonObject item = elem.toObject();
+      VkFormat format = static_cast<VkFormat>(item["format"].toInt());
+      VkFormatProperties properties = {};
+      readValue(item["linearTilingFeatures"], &properties.linearTilingFeatures);
+      readValue(item["optimalTilingFeatures"], &properties.optimalTilingFeatures);
+      readValue(item["bufferFeatures"], &properties.bufferFeatures);
+      pProfile->formats[format] = properties;
+    }
+  }
+
+  return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+// DeviceProfileSet
+// -------------------------------------------------------------------------------------------------
+QJsonObject deviceProfileSetToJson(const DeviceProfileSet& profileSet)
+{
+  QJsonArray devices;
+  for (const auto& device : profileSet.devices) {
+    devices.append(deviceProfileToJson(device));
+  }
+
+  QJsonObject json;
+  json["latencyUs"]           = toJsonValue(profileSet.latencyUs);
+  json["deviceCount"]         = toJsonValue(profileSet.deviceCount);
+  json["extraExtensionCount"] = toJsonValue(profileSet.extraExtensionCount);
+  json["instanceExtensions"]  = toJsonExtensions(profileSet.instanceExtensions);
+  json["devices"]             = devices;
+  return json;
+}
+
+bool deviceProfileSetFromJson(const QJsonObject& json, DeviceProfileSet* pProfileSet)
+{
+  if (pProfileSet == nullptr) {
+    return false;
+  }
+
+  readValue(json["latencyUs"], &pProfileSet->latencyUs);
+  readValue(json["deviceCount"], &pProfileSet->deviceCount);
+  readValue(json["extraExtensionCount"], &pProfileSet->extraExtensionCount);
+  readExtensions(json["instanceExtensions"], &pProfileSet->instanceExtensions);
+
+  if (json.contains("devices")) {
+    // Each device starts from the first existing entry so the built-in defaults
+    // fill in anything the profile leaves out.
+    DeviceProfile base = pProfileSet->devices.empty() ? DeviceProfile() : pProfileSet->devices.front();
+    pProfileSet->devices.clear();
+    for (const auto& elem : json["devices"].toArray()) {
+      DeviceProfile device = base;
+      if (! deviceProfileFromJson(elem.toObject(), &device)) {
+        return false;
+      }
+      pProfileSet->devices.push_back(device);
+    }
+  }
+
+  return true;
+}
+
+bool loadDeviceProfileSet(const QString& filePath, DeviceProfileSet* pProfileSet)
+{
+  QFile file(filePath);
+  if (! file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QJsonParseError error = {};
+  QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+  if (error.error != QJsonParseError::NoError || ! doc.isObject()) {
+    return false;
+  }
+
+  return deviceProfileSetFromJson(doc.object(), pProfileSet);
+}
+
+bool saveDeviceProfileSet(const QString& filePath, const DeviceProfileSet& profileSet)
+{
+  QFile file(filePath);
+  if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    return false;
+  }
+
+  QJsonDocument doc(deviceProfileSetToJson(profileSet));
+  return file.write(doc.toJson()) >= 0;
+}
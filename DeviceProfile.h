@@ -0,0 +1,54 @@
+#ifndef __DEVICE_PROFILE_H__
+#define __DEVICE_PROFILE_H__
+
+#include <QJsonObject>
+#include <QString>
+
+#include <vulkan/vulkan.h>
+
+#include <map>
+#include <vector>
+
+//! \struct DeviceProfile
+//!
+//! Plain copy of everything the viewer reads from a physical device. Used
+//! as the JSON profile format served by the mock ICD (see mockicd/).
+//!
+struct DeviceProfile {
+  VkPhysicalDeviceProperties              properties = {};
+  VkPhysicalDeviceFeatures                features = {};
+  std::vector<VkExtensionProperties>      extensions;
+  std::vector<VkQueueFamilyProperties>    queueFamilies;
+  VkPhysicalDeviceMemoryProperties        memoryProperties = {};
+  std::map<VkFormat, VkFormatProperties>  formats;
+};
+
+//! \struct DeviceProfileSet
+//!
+//! Top level of a profile file: the devices plus the knobs the mock ICD
+//! uses to simulate slow drivers and large configurations.
+//!
+struct DeviceProfileSet {
+  // Artificial delay added to every entry point, in microseconds
+  uint32_t                            latencyUs = 0;
+  // Devices are replicated round robin until there are this many
+  uint32_t                            deviceCount = 0;
+  // Synthetic VK_MOCK_extension_N entries appended to every device
+  uint32_t                            extraExtensionCount = 0;
+  std::vector<VkExtensionProperties>  instanceExtensions;
+  std::vector<DeviceProfile>          devices;
+};
+
+//! Compares every field that is reported, unlike memcmp() over the struct
+bool        isSamePhysicalDeviceProperties(const VkPhysicalDeviceProperties& a, const VkPhysicalDeviceProperties& b);
+
+QJsonObject deviceProfileToJson(const DeviceProfile& profile);
+bool        deviceProfileFromJson(const QJsonObject& json, DeviceProfile* pProfile);
+
+QJsonObject deviceProfileSetToJson(const DeviceProfileSet& profileSet);
+bool        deviceProfileSetFromJson(const QJsonObject& json, DeviceProfileSet* pProfileSet);
+
+bool        loadDeviceProfileSet(const QString& filePath, DeviceProfileSet* pProfileSet);
+bool        saveDeviceProfileSet(const QString& filePath, const DeviceProfileSet& profileSet);
+
+#endif // __DEVICE_PROFILE_H__
@@ -0,0 +1,222 @@
+#include "ExtensionSet.h"
+#include "FormatTable.h"
+#include "PNextChain.h"
+
+#include <algorithm>
+
+static bool lessName(const std::pair<const char*, uint32_t>& entry, const char* name)
+{
+  return strcmp(entry.first, name) < 0;
+}
+
+// -------------------------------------------------------------------------------------------------
+// ExtensionRegistry
+// -------------------------------------------------------------------------------------------------
+size_t ExtensionRegistry::NameHash::operator()(const char* name) const
+{
+  // FNV-1a
+  size_t hash = 2166136261u;
+  for (; *name != '\0'; ++name) {
+    hash = (hash ^ static_cast<unsigned char>(*name)) * 16777619u;
+  }
+  return hash;
+}
+
+ExtensionRegistry& ExtensionRegistry::get()
+{
+  static ExtensionRegistry sRegistry;
+  std::call_once(sRegistry.mKnownOnce, [] { sRegistry.registerKnownNames(); });
+  return sRegistry;
+}
+
+void ExtensionRegistry::registerKnownNames()
+{
+  std::vector<const char*> names = PNextChain::extensionNames();
+  for (const auto& range : getFormatRanges()) {
+    if (range.extensionName != nullptr) {
+      names.push_back(range.extensionName);
+    }
+  }
+
+  for (const char* name : names) {
+    if (mIds.find(name) == mIds.end()) {
+      uint32_t id = static_cast<uint32_t>(mNames.size());
+      mNames.push_back(name);
+      mIds.emplace(mNames.back().c_str(), id);
+      mKnown.push_back(std::make_pair(mNames.back().c_str(), id));
+    }
+  }
+  std::sort(mKnown.begin(), mKnown.end(), [](const std::pair<const char*, uint32_t>& a, const std::pair<const char*, uint32_t>& b) {
+    return strcmp(a.first, b.first) < 0;
+  });
+}
+
+uint32_t ExtensionRegistry::findKnown(const char* name) const
+{
+  auto it = std::lower_bound(mKnown.begin(), mKnown.end(), name, lessName);
+  return ((it != mKnown.end()) && (strcmp(it->first, name) == 0)) ? it->second : kInvalidId;
+}
+
+uint32_t ExtensionRegistry::intern(const char* name)
+{
+  uint32_t id = findKnown(name);
+  if (id != kInvalidId) {
+    return id;
+  }
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto it = mIds.find(name);
+  if (it != mIds.end()) {
+    return it->second;
+  }
+  id = static_cast<uint32_t>(mNames.size());
+  mNames.push_back(name);
+  mIds.emplace(mNames.back().c_str(), id);
+  return id;
+}
+
+uint32_t ExtensionRegistry::find(const char* name) const
+{
+  uint32_t id = findKnown(name);
+  if (id != kInvalidId) {
+    return id;
+  }
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto it = mIds.find(name);
+  return (it != mIds.end()) ? it->second : kInvalidId;
+}
+
+std::string ExtensionRegistry::name(uint32_t id) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return (id < mNames.size()) ? mNames[id] : std::string();
+}
+
+uint32_t ExtensionRegistry::size() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return static_cast<uint32_t>(mNames.size());
+}
+
+// -------------------------------------------------------------------------------------------------
+// ExtensionSet
+// -------------------------------------------------------------------------------------------------
+ExtensionSet::ExtensionSet(const std::vector<VkExtensionProperties>& extensions)
+{
+  for (const auto& extension : extensions) {
+    insert(extension);
+  }
+}
+
+void ExtensionSet::reserveWords(size_t wordCount)
+{
+  if (wordCount > mBits.size()) {
+    mBits.resize(wordCount, 0);
+    mSpecVersions.resize(wordCount * 64, 0);
+  }
+}
+
+void ExtensionSet::insert(uint32_t id, uint32_t specVersion)
+{
+  reserveWords(id / 64 + 1);
+  mBits[id / 64] |= (1ull << (id % 64));
+  mSpecVersions[id] = specVersion;
+}
+
+void ExtensionSet::insert(const VkExtensionProperties& extension)
+{
+  insert(ExtensionRegistry::get().intern(extension.extensionName), extension.specVersion);
+}
+
+bool ExtensionSet::contains(const char* name) const
+{
+  uint32_t id = ExtensionRegistry::get().find(name);
+  return (id != ExtensionRegistry::kInvalidId) && contains(id);
+}
+
+uint32_t ExtensionSet::specVersion(uint32_t id) const
+{
+  return contains(id) ? mSpecVersions[id] : 0;
+}
+
+size_t ExtensionSet::count() const
+{
+  size_t n = 0;
+  for (uint64_t word : mBits) {
+    for (; word != 0; word &= word - 1) {
+      ++n;
+    }
+  }
+  return n;
+}
+
+std::vector<uint32_t> ExtensionSet::ids() const
+{
+  std::vector<uint32_t> result;
+  for (size_t i = 0; i < mBits.size(); ++i) {
+    for (uint64_t word = mBits[i]; word != 0; word &= word - 1) {
+      uint32_t bit = 0;
+      while (((word >> bit) & 1) == 0) {
+        ++bit;
+      }
+      result.push_back(static_cast<uint32_t>(i * 64 + bit));
+    }
+  }
+  return result;
+}
+
+ExtensionSet& ExtensionSet::operator|=(const ExtensionSet& other)
+{
+  reserveWords(other.mBits.size());
+  for (size_t i = 0; i < other.mBits.size(); ++i) {
+    mBits[i] |= other.mBits[i];
+  }
+  for (size_t id = 0; id < other.mSpecVersions.size(); ++id) {
+    mSpecVersions[id] = std::max(mSpecVersions[id], other.mSpecVersions[id]);
+  }
+  return *this;
+}
+
+ExtensionSet& ExtensionSet::operator&=(const ExtensionSet& other)
+{
+  for (size_t i = 0; i < mBits.size(); ++i) {
+    mBits[i] &= (i < other.mBits.size()) ? other.mBits[i] : 0;
+  }
+  for (size_t id = 0; id < mSpecVersions.size(); ++id) {
+    mSpecVersions[id] = contains(static_cast<uint32_t>(id)) ? std::min(mSpecVersions[id], other.mSpecVersions[id]) : 0;
+  }
+  return *this;
+}
+
+ExtensionSet& ExtensionSet::operator-=(const ExtensionSet& other)
+{
+  for (size_t i = 0; i < std::min(mBits.size(), other.mBits.size()); ++i) {
+    mBits[i] &= ~other.mBits[i];
+  }
+  for (size_t id = 0; id < std::min(mSpecVersions.size(), other.mSpecVersions.size()); ++id) {
+    if (! contains(static_cast<uint32_t>(id))) {
+      mSpecVersions[id] = 0;
+    }
+  }
+  return *this;
+}
+
+bool ExtensionSet::operator==(const ExtensionSet& other) const
+{
+  // Sets that grew to different word counts can still be equal
+  const ExtensionSet& larger = (mBits.size() >= other.mBits.size()) ? *this : other;
+  const ExtensionSet& smaller = (mBits.size() >= other.mBits.size()) ? other : *this;
+  for (size_t i = 0; i < larger.mBits.size(); ++i) {
+    uint64_t word = (i < smaller.mBits.size()) ? smaller.mBits[i] : 0;
+    if (larger.mBits[i] != word) {
+      return false;
+    }
+  }
+  for (size_t id = 0; id < smaller.mSpecVersions.size(); ++id) {
+    if (larger.mSpecVersions[id] != smaller.mSpecVersions[id]) {
+      return false;
+    }
+  }
+  return true;
+}
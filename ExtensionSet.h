@@ -0,0 +1,108 @@
+#ifndef __EXTENSION_SET_H__
+#define __EXTENSION_SET_H__
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//! \class ExtensionRegistry
+//!
+//! Process wide interning of extension names into small dense IDs. IDs are
+//! only meaningful within one run. Thread safe, captures run on worker
+//! threads.
+//!
+//! The names the viewer itself tests for (the format and pNext tables) are
+//! registered once on first use and never change, so finding them is a
+//! binary search without a lock or an allocation. Names only a device or a
+//! daemon query mentions get their ID on first sight, under the lock.
+//!
+class ExtensionRegistry {
+public:
+  enum : uint32_t { kInvalidId = UINT32_MAX };
+
+  static ExtensionRegistry& get();
+
+  uint32_t    intern(const char* name);
+  //! kInvalidId if no device has reported name, which also means no set contains it
+  uint32_t    find(const char* name) const;
+  std::string name(uint32_t id) const;
+  uint32_t    size() const;
+
+private:
+  ExtensionRegistry() {}
+  void        registerKnownNames();
+  uint32_t    findKnown(const char* name) const;
+
+  struct NameHash {
+    size_t operator()(const char* name) const;
+  };
+  struct NameEqual {
+    bool operator()(const char* a, const char* b) const { return strcmp(a, b) == 0; }
+  };
+
+private:
+  std::once_flag                                        mKnownOnce;
+  std::vector<std::pair<const char*, uint32_t>>         mKnown;     // sorted by name, immutable once filled
+  mutable std::mutex                                    mMutex;
+  // Keys point into mNames, a deque doesn't move its elements
+  std::unordered_map<const char*, uint32_t, NameHash, NameEqual> mIds;
+  std::deque<std::string>                               mNames;
+};
+
+//! \class ExtensionSet
+//!
+//! One bit per interned extension plus its spec version. Membership is a
+//! bit test, and comparing devices is a pass over a few words:
+//!
+//!   ExtensionSet common  = a & b;   // spec version is the lower of the two
+//!   ExtensionSet either  = a | b;   // spec version is the higher of the two
+//!   ExtensionSet onlyInA = a - b;
+//!
+class ExtensionSet {
+public:
+  ExtensionSet() {}
+  explicit ExtensionSet(const std::vector<VkExtensionProperties>& extensions);
+
+  void      insert(uint32_t id, uint32_t specVersion);
+  void      insert(const VkExtensionProperties& extension);
+
+  bool      contains(uint32_t id) const {
+    return ((id / 64) < mBits.size()) && (((mBits[id / 64] >> (id % 64)) & 1) != 0);
+  }
+  bool      contains(const char* name) const;
+  //! 0 if the extension isn't in the set
+  uint32_t  specVersion(uint32_t id) const;
+
+  size_t    count() const;
+  bool      empty() const { return count() == 0; }
+  //! Ascending, which is interning order rather than name order
+  std::vector<uint32_t> ids() const;
+
+  ExtensionSet& operator|=(const ExtensionSet& other);
+  ExtensionSet& operator&=(const ExtensionSet& other);
+  ExtensionSet& operator-=(const ExtensionSet& other);
+
+  //! Same extensions at the same spec versions
+  bool      operator==(const ExtensionSet& other) const;
+  bool      operator!=(const ExtensionSet& other) const { return ! (*this == other); }
+
+private:
+  void      reserveWords(size_t wordCount);
+
+private:
+  std::vector<uint64_t> mBits;
+  std::vector<uint32_t> mSpecVersions;    // indexed by ID, 64 per word of mBits
+};
+
+inline ExtensionSet operator|(ExtensionSet a, const ExtensionSet& b) { return a |= b; }
+inline ExtensionSet operator&(ExtensionSet a, const ExtensionSet& b) { return a &= b; }
+inline ExtensionSet operator-(ExtensionSet a, const ExtensionSet& b) { return a -= b; }
+
+#endif // __EXTENSION_SET_H__
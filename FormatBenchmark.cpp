@@ -0,0 +1,306 @@
+#include "FormatBenchmark.h"
+#include "MemoryAccounting.h"
+#include "Trace.h"
+#include "VkProfiler.h"
+
+#include <algorithm>
+
+#define IMAGE_SIZE      1024
+#define REPEAT_COUNT    4
+
+uint32_t getFormatTexelSize(VkFormat format)
+{
+  // Core formats are laid out in runs of equal texel size
+  struct Range {
+    uint32_t first;
+    uint32_t last;
+    uint32_t size;
+  };
+
+  static const Range sRanges[] = {
+    { VK_FORMAT_R4G4_UNORM_PACK8,           VK_FORMAT_R4G4_UNORM_PACK8,           1 },
+    { VK_FORMAT_R4G4B4A4_UNORM_PACK16,      VK_FORMAT_A1R5G5B5_UNORM_PACK16,      2 },
+    { VK_FORMAT_R8_UNORM,                   VK_FORMAT_R8_SRGB,                    1 },
+    { VK_FORMAT_R8G8_UNORM,                 VK_FORMAT_R8G8_SRGB,                  2 },
+    { VK_FORMAT_R8G8B8_UNORM,               VK_FORMAT_B8G8R8_SRGB,                3 },
+    { VK_FORMAT_R8G8B8A8_UNORM,             VK_FORMAT_A2B10G10R10_SINT_PACK32,    4 },
+    { VK_FORMAT_R16_UNORM,                  VK_FORMAT_R16_SFLOAT,                 2 },
+    { VK_FORMAT_R16G16_UNORM,               VK_FORMAT_R16G16_SFLOAT,              4 },
+    { VK_FORMAT_R16G16B16_UNORM,            VK_FORMAT_R16G16B16_SFLOAT,           6 },
+    { VK_FORMAT_R16G16B16A16_UNORM,         VK_FORMAT_R16G16B16A16_SFLOAT,        8 },
+    { VK_FORMAT_R32_UINT,                   VK_FORMAT_R32_SFLOAT,                 4 },
+    { VK_FORMAT_R32G32_UINT,                VK_FORMAT_R32G32_SFLOAT,              8 },
+    { VK_FORMAT_R32G32B32_UINT,             VK_FORMAT_R32G32B32_SFLOAT,           12 },
+    { VK_FORMAT_R32G32B32A32_UINT,          VK_FORMAT_R32G32B32A32_SFLOAT,        16 },
+    { VK_FORMAT_R64_UINT,                   VK_FORMAT_R64_SFLOAT,                 8 },
+    { VK_FORMAT_R64G64_UINT,                VK_FORMAT_R64G64_SFLOAT,              16 },
+    { VK_FORMAT_R64G64B64_UINT,             VK_FORMAT_R64G64B64_SFLOAT,           24 },
+    { VK_FORMAT_R64G64B64A64_UINT,          VK_FORMAT_R64G64B64A64_SFLOAT,        32 },
+    { VK_FORMAT_B10G11R11_UFLOAT_PACK32,    VK_FORMAT_E5B9G9R9_UFLOAT_PACK32,     4 },
+    { VK_FORMAT_D16_UNORM,                  VK_FORMAT_D16_UNORM,                  2 },
+    { VK_FORMAT_X8_D24_UNORM_PACK32,        VK_FORMAT_D32_SFLOAT,                 4 },
+    { VK_FORMAT_S8_UINT,                    VK_FORMAT_S8_UINT,                    1 },
+    { VK_FORMAT_D16_UNORM_S8_UINT,          VK_FORMAT_D16_UNORM_S8_UINT,          3 },
+    { VK_FORMAT_D24_UNORM_S8_UINT,          VK_FORMAT_D24_UNORM_S8_UINT,          4 },
+    { VK_FORMAT_D32_SFLOAT_S8_UINT,         VK_FORMAT_D32_SFLOAT_S8_UINT,         5 },
+    // VK_EXT_4444_formats
+    { 1000340000,                           1000340001,                           2 },
+  };
+
+  uint32_t value = static_cast<uint32_t>(format);
+  for (const auto& range : sRanges) {
+    if ((value >= range.first) && (value <= range.last)) {
+      return range.size;
+    }
+  }
+  return 0;
+}
+
+static VkImageAspectFlags getFormatAspect(VkFormat format)
+{
+  switch (format) {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+      return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_S8_UINT:
+      return VK_IMAGE_ASPECT_STENCIL_BIT;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+      return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+      return VK_IMAGE_ASPECT_COLOR_BIT;
+  }
+}
+
+static double toGBs(VkDeviceSize bytes, double milliseconds)
+{
+  return (milliseconds > 0.0) ? (static_cast<double>(bytes) * REPEAT_COUNT / (milliseconds * 1000000.0)) : -1.0;
+}
+
+struct BenchmarkImage {
+  VkImage         image = VK_NULL_HANDLE;
+  VkDeviceMemory  memory = VK_NULL_HANDLE;
+};
+
+static VkResult createImage(BenchmarkContext& context, VkFormat format, VkExtent3D extent, BenchmarkImage* pImage)
+{
+  VkPhysicalDevice gpu = context.gpu();
+  VkDevice device = context.device();
+
+  VkImageCreateInfo createInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+  createInfo.imageType     = VK_IMAGE_TYPE_2D;
+  createInfo.format        = format;
+  createInfo.extent        = extent;
+  createInfo.mipLevels     = 1;
+  createInfo.arrayLayers   = 1;
+  createInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+  createInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+  createInfo.usage         = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+  createInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+  createInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  VkResult res = VK_CALL(gpu, vkCreateImage, device, &createInfo, MemoryAccounting::get().allocator(), &pImage->image);
+  if (res != VK_SUCCESS) {
+    pImage->image = VK_NULL_HANDLE;
+    return res;
+  }
+
+  VkMemoryRequirements requirements = {};
+  VK_CALL(gpu, vkGetImageMemoryRequirements, device, pImage->image, &requirements);
+  uint32_t typeIndex = context.findMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  if (typeIndex == UINT32_MAX) {
+    typeIndex = context.findMemoryType(requirements.memoryTypeBits, 0);
+  }
+
+  VkMemoryAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+  allocInfo.allocationSize  = requirements.size;
+  allocInfo.memoryTypeIndex = typeIndex;
+  res = VK_CALL(gpu, vkAllocateMemory, device, &allocInfo, MemoryAccounting::get().allocator(), &pImage->memory);
+  if (res != VK_SUCCESS) {
+    pImage->memory = VK_NULL_HANDLE;
+    return res;
+  }
+
+  return VK_CALL(gpu, vkBindImageMemory, device, pImage->image, pImage->memory, 0);
+}
+
+static void destroyImage(BenchmarkContext& context, BenchmarkImage* pImage)
+{
+  if (pImage->image != VK_NULL_HANDLE) {
+    VK_CALL(context.gpu(), vkDestroyImage, context.device(), pImage->image, MemoryAccounting::get().allocator());
+  }
+  if (pImage->memory != VK_NULL_HANDLE) {
+    VK_CALL(context.gpu(), vkFreeMemory, context.device(), pImage->memory, MemoryAccounting::get().allocator());
+  }
+  *pImage = BenchmarkImage();
+}
+
+// Serializes the repeated transfers so they don't overlap
+static void transferBarrier(BenchmarkContext& context, VkCommandBuffer cmd)
+{
+  VkMemoryBarrier barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+  VK_CALL(context.gpu(), vkCmdPipelineBarrier, cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+          0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+static void benchmarkFormat(BenchmarkContext& context, VkFormat format, VkBuffer stagingBuffer, FormatBenchmark* pResult)
+{
+  VkPhysicalDevice gpu = context.gpu();
+
+  uint32_t texelSize = getFormatTexelSize(format);
+  if (texelSize == 0) {
+    return;
+  }
+
+  VkFormatProperties formatProperties = {};
+  VK_CALL(gpu, vkGetPhysicalDeviceFormatProperties, gpu, format, &formatProperties);
+
+  VkImageFormatProperties imageProperties = {};
+  VkResult res = VK_CALL(gpu, vkGetPhysicalDeviceImageFormatProperties, gpu, format, VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
+                         VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, 0, &imageProperties);
+  if (res != VK_SUCCESS) {
+    return;
+  }
+
+  VkExtent3D extent = { std::min<uint32_t>(IMAGE_SIZE, imageProperties.maxExtent.width),
+                        std::min<uint32_t>(IMAGE_SIZE, imageProperties.maxExtent.height), 1 };
+  VkDeviceSize bytes = static_cast<VkDeviceSize>(extent.width) * extent.height * texelSize;
+  VkImageAspectFlags aspect = getFormatAspect(format);
+  bool isColor = (aspect == VK_IMAGE_ASPECT_COLOR_BIT);
+
+  BenchmarkImage src;
+  BenchmarkImage dst;
+  if ((createImage(context, format, extent, &src) != VK_SUCCESS) ||
+      (createImage(context, format, extent, &dst) != VK_SUCCESS)) {
+    destroyImage(context, &dst);
+    destroyImage(context, &src);
+    return;
+  }
+
+  VkImageSubresourceRange range = { aspect, 0, 1, 0, 1 };
+  VkImageSubresourceLayers layers = { aspect, 0, 0, 1 };
+
+  // GENERAL for everything, the benchmark doesn't care about layout transitions
+  {
+    VkImageMemoryBarrier barriers[2] = {};
+    for (int i = 0; i < 2; ++i) {
+      barriers[i].sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+      barriers[i].dstAccessMask       = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+      barriers[i].oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+      barriers[i].newLayout           = VK_IMAGE_LAYOUT_GENERAL;
+      barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barriers[i].image               = (i == 0) ? src.image : dst.image;
+      barriers[i].subresourceRange    = range;
+    }
+    VkCommandBuffer cmd = context.beginCommands();
+    VK_CALL(gpu, vkCmdPipelineBarrier, cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 2, barriers);
+    double ms = 0.0;
+    if (context.submitCommands(&ms) != VK_SUCCESS) {
+      destroyImage(context, &dst);
+      destroyImage(context, &src);
+      return;
+    }
+  }
+
+  double ms = -1.0;
+
+  // Buffer to image, depth/stencil uploads have per aspect packing rules, skip them
+  if (isColor && (stagingBuffer != VK_NULL_HANDLE)) {
+    VkCommandBuffer cmd = context.beginCommands();
+    VkBufferImageCopy region = {};
+    region.imageSubresource = layers;
+    region.imageExtent      = extent;
+    for (int i = 0; i < REPEAT_COUNT; ++i) {
+      VK_CALL(gpu, vkCmdCopyBufferToImage, cmd, stagingBuffer, src.image, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+      transferBarrier(context, cmd);
+    }
+    if (context.submitCommands(&ms) == VK_SUCCESS) {
+      pResult->uploadGBs = toGBs(bytes, ms);
+    }
+  }
+
+  // Image to image
+  {
+    VkCommandBuffer cmd = context.beginCommands();
+    VkImageCopy region = {};
+    region.srcSubresource = layers;
+    region.dstSubresource = layers;
+    region.extent         = extent;
+    for (int i = 0; i < REPEAT_COUNT; ++i) {
+      VK_CALL(gpu, vkCmdCopyImage, cmd, src.image, VK_IMAGE_LAYOUT_GENERAL, dst.image, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+      transferBarrier(context, cmd);
+    }
+    if (context.submitCommands(&ms) == VK_SUCCESS) {
+      pResult->copyGBs = toGBs(bytes, ms);
+    }
+  }
+
+  // Blit
+  VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+  if (isColor && ((formatProperties.optimalTilingFeatures & blitFeatures) == blitFeatures)) {
+    VkCommandBuffer cmd = context.beginCommands();
+    VkImageBlit region = {};
+    region.srcSubresource = layers;
+    region.srcOffsets[1]  = { static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1 };
+    region.dstSubresource = layers;
+    region.dstOffsets[1]  = region.srcOffsets[1];
+    for (int i = 0; i < REPEAT_COUNT; ++i) {
+      VK_CALL(gpu, vkCmdBlitImage, cmd, src.image, VK_IMAGE_LAYOUT_GENERAL, dst.image, VK_IMAGE_LAYOUT_GENERAL, 1, &region, VK_FILTER_NEAREST);
+      transferBarrier(context, cmd);
+    }
+    if (context.submitCommands(&ms) == VK_SUCCESS) {
+      pResult->blitGBs = toGBs(bytes, ms);
+    }
+  }
+
+  // Clear
+  {
+    VkCommandBuffer cmd = context.beginCommands();
+    for (int i = 0; i < REPEAT_COUNT; ++i) {
+      if (isColor) {
+        VkClearColorValue color = {};
+        VK_CALL(gpu, vkCmdClearColorImage, cmd, dst.image, VK_IMAGE_LAYOUT_GENERAL, &color, 1, &range);
+      }
+      else {
+        VkClearDepthStencilValue depthStencil = { 1.0f, 0 };
+        VK_CALL(gpu, vkCmdClearDepthStencilImage, cmd, dst.image, VK_IMAGE_LAYOUT_GENERAL, &depthStencil, 1, &range);
+      }
+      transferBarrier(context, cmd);
+    }
+    if (context.submitCommands(&ms) == VK_SUCCESS) {
+      pResult->clearGBs = toGBs(bytes, ms);
+    }
+  }
+
+  destroyImage(context, &dst);
+  destroyImage(context, &src);
+}
+
+std::map<VkFormat, FormatBenchmark> runFormatBenchmark(BenchmarkContext& context, const std::vector<VkFormat>& formats)
+{
+  TRACE_SCOPE("driver", "runFormatBenchmark");
+
+  // Big enough for the widest texel, contents don't matter
+  VkBuffer stagingBuffer = VK_NULL_HANDLE;
+  VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+  uint32_t typeIndex = context.findMemoryType(UINT32_MAX, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+  if (typeIndex != UINT32_MAX) {
+    VkDeviceSize size = static_cast<VkDeviceSize>(IMAGE_SIZE) * IMAGE_SIZE * 32;
+    context.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, typeIndex, &stagingBuffer, &stagingMemory);
+  }
+
+  std::map<VkFormat, FormatBenchmark> results;
+  for (VkFormat format : formats) {
+    FormatBenchmark& result = results[format];
+    benchmarkFormat(context, format, stagingBuffer, &result);
+  }
+
+  context.destroyBuffer(stagingBuffer, stagingMemory);
+
+  return results;
+}
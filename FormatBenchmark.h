@@ -0,0 +1,24 @@
+#ifndef __FORMAT_BENCHMARK_H__
+#define __FORMAT_BENCHMARK_H__
+
+#include "Benchmark.h"
+
+#include <map>
+#include <vector>
+
+//! Per format transfer throughput on optimally tiled 2D images, negative
+//! values mean not supported or not measured. Bytes are counted as
+//! width * height * texel size of the destination.
+struct FormatBenchmark {
+  double  uploadGBs = -1.0;   // vkCmdCopyBufferToImage, color formats
+  double  copyGBs = -1.0;     // vkCmdCopyImage
+  double  blitGBs = -1.0;     // vkCmdBlitImage, same size, nearest
+  double  clearGBs = -1.0;    // vkCmdClearColorImage / vkCmdClearDepthStencilImage
+};
+
+//! Bytes per texel of an uncompressed, single plane format, 0 otherwise
+uint32_t getFormatTexelSize(VkFormat format);
+
+std::map<VkFormat, FormatBenchmark> runFormatBenchmark(BenchmarkContext& context, const std::vector<VkFormat>& formats);
+
+#endif // __FORMAT_BENCHMARK_H__
@@ -0,0 +1,286 @@
+#include "FormatMatrixWidget.h"
+#include "FormatTable.h"
+#include "ToString.h"
+
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QToolTip>
+
+#include <algorithm>
+
+#define TILING_COUNT  3
+#define GROUP_GAP     6
+#define MARGIN        4
+
+static const char* sTilingNames[TILING_COUNT] = { "Linear", "Optimal", "Buffer" };
+
+static int getTextWidth(const QFontMetrics& fm, const QString& text)
+{
+  // width() is deprecated from 5.11 on, the README still allows 5.8
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+  return fm.horizontalAdvance(text);
+#else
+  return fm.width(text);
+#endif
+}
+
+FormatMatrixWidget::FormatMatrixWidget(QWidget* parent)
+  : QAbstractScrollArea(parent)
+{
+  viewport()->setMouseTracking(true);
+  viewport()->setAutoFillBackground(true);
+  viewport()->setBackgroundRole(QPalette::Base);
+  horizontalScrollBar()->setSingleStep(mCellSize);
+  verticalScrollBar()->setSingleStep(1);
+  updateLayout();
+}
+
+void FormatMatrixWidget::setFormats(const std::map<VkFormat, VkFormatProperties>& formatProperties)
+{
+  mRows.clear();
+  mRows.reserve(formatProperties.size());
+  for (const auto& it : formatProperties) {
+    Row row;
+    row.format      = it.first;
+    row.name        = toStringVkFormat(it.first);
+    row.features[0] = it.second.linearTilingFeatures;
+    row.features[1] = it.second.optimalTilingFeatures;
+    row.features[2] = it.second.bufferFeatures;
+    if (row.name.startsWith("VK_FORMAT_")) {
+      row.name.remove(0, 10);
+    }
+    mRows.push_back(row);
+  }
+  updateFilter();
+}
+
+void FormatMatrixWidget::setFilter(const QString& filterText)
+{
+  mFilterText = filterText;
+  updateFilter();
+}
+
+void FormatMatrixWidget::updateFilter()
+{
+  mVisibleRows.clear();
+  for (uint32_t i = 0; i < mRows.size(); ++i) {
+    if (mFilterText.isEmpty() || mRows[i].name.contains(mFilterText, Qt::CaseInsensitive)) {
+      mVisibleRows.push_back(i);
+    }
+  }
+  mHoverRow = -1;
+  mHoverColumn = -1;
+  updateLayout();
+  viewport()->update();
+}
+
+int FormatMatrixWidget::columnCount() const
+{
+  return TILING_COUNT * static_cast<int>(getFormatFeatureFlags().size());
+}
+
+// Header and name widths only change with the font and the format list
+void FormatMatrixWidget::updateLayout()
+{
+  QFontMetrics fm = fontMetrics();
+  mCellSize = std::max(fm.height(), 12);
+
+  mNameWidth = 0;
+  for (const auto& row : mRows) {
+    mNameWidth = std::max(mNameWidth, getTextWidth(fm, row.name));
+  }
+  mNameWidth += 2 * MARGIN;
+
+  int featureWidth = 0;
+  for (const auto& flag : getFormatFeatureFlags()) {
+    featureWidth = std::max(featureWidth, getTextWidth(fm, toStringFormatFeatureShort(flag)));
+  }
+  mHeaderHeight = fm.height() + featureWidth + 2 * MARGIN;
+
+  int featureCount = static_cast<int>(getFormatFeatureFlags().size());
+  int cellsWidth = columnCount() * mCellSize + (TILING_COUNT - 1) * GROUP_GAP + MARGIN;
+  int cellsVisibleWidth = std::max(0, viewport()->width() - mNameWidth);
+  horizontalScrollBar()->setRange(0, std::max(0, cellsWidth - cellsVisibleWidth));
+  horizontalScrollBar()->setPageStep(std::max(cellsVisibleWidth, mCellSize * featureCount));
+
+  int rowsVisible = std::max(1, (viewport()->height() - mHeaderHeight) / mCellSize);
+  verticalScrollBar()->setRange(0, std::max(0, static_cast<int>(mVisibleRows.size()) - rowsVisible));
+  verticalScrollBar()->setPageStep(rowsVisible);
+}
+
+bool FormatMatrixWidget::cellAt(const QPoint& pos, int* pRow, int* pColumn) const
+{
+  if ((pos.x() < mNameWidth) || (pos.y() < mHeaderHeight)) {
+    return false;
+  }
+
+  int row = verticalScrollBar()->value() + (pos.y() - mHeaderHeight) / mCellSize;
+  if (row >= static_cast<int>(mVisibleRows.size())) {
+    return false;
+  }
+
+  int featureCount = static_cast<int>(getFormatFeatureFlags().size());
+  int groupWidth = featureCount * mCellSize + GROUP_GAP;
+  int x = pos.x() - mNameWidth + horizontalScrollBar()->value();
+  int group = x / groupWidth;
+  int offset = x % groupWidth;
+  if ((group >= TILING_COUNT) || (offset >= featureCount * mCellSize)) {
+    return false;
+  }
+
+  *pRow = row;
+  *pColumn = group * featureCount + offset / mCellSize;
+  return true;
+}
+
+void FormatMatrixWidget::paintEvent(QPaintEvent* event)
+{
+  (void)event;
+
+  QPainter painter(viewport());
+  const QPalette& pal = palette();
+  QRect area = viewport()->rect();
+
+  const auto& flags = getFormatFeatureFlags();
+  int featureCount = static_cast<int>(flags.size());
+  int groupWidth = featureCount * mCellSize + GROUP_GAP;
+  int scrollX = horizontalScrollBar()->value();
+  int firstRow = verticalScrollBar()->value();
+  int lastRow = std::min(static_cast<int>(mVisibleRows.size()), firstRow + (area.height() - mHeaderHeight) / mCellSize + 1);
+
+  static const QColor sGroupColors[TILING_COUNT] = { QColor(70, 130, 200), QColor(60, 160, 90), QColor(210, 140, 50) };
+  QColor unsupported = pal.color(QPalette::AlternateBase);
+  QColor highlight = pal.color(QPalette::Highlight);
+  highlight.setAlpha(60);
+
+  // Cells, clipped to the right of the names and below the header
+  painter.save();
+  painter.setClipRect(QRect(mNameWidth, mHeaderHeight, area.width() - mNameWidth, area.height() - mHeaderHeight));
+  int firstGroup = std::max(0, scrollX / groupWidth);
+  for (int r = firstRow; r < lastRow; ++r) {
+    const Row& row = mRows[mVisibleRows[r]];
+    int y = mHeaderHeight + (r - firstRow) * mCellSize;
+    for (int g = firstGroup; g < TILING_COUNT; ++g) {
+      int groupX = mNameWidth + g * groupWidth - scrollX;
+      if (groupX > area.right()) {
+        break;
+      }
+      for (int f = 0; f < featureCount; ++f) {
+        int x = groupX + f * mCellSize;
+        if ((x + mCellSize < mNameWidth) || (x > area.right())) {
+          continue;
+        }
+        bool supported = (row.features[g] & flags[f]) != 0;
+        painter.fillRect(x, y, mCellSize - 1, mCellSize - 1, supported ? sGroupColors[g] : unsupported);
+      }
+    }
+    if (r == mHoverRow) {
+      painter.fillRect(mNameWidth, y, area.width() - mNameWidth, mCellSize - 1, highlight);
+    }
+  }
+  if (mHoverColumn >= 0) {
+    int x = mNameWidth + (mHoverColumn / featureCount) * groupWidth + (mHoverColumn % featureCount) * mCellSize - scrollX;
+    painter.fillRect(x, mHeaderHeight, mCellSize - 1, area.height() - mHeaderHeight, highlight);
+  }
+  painter.restore();
+
+  // Format names
+  painter.setPen(pal.color(QPalette::Text));
+  for (int r = firstRow; r < lastRow; ++r) {
+    int y = mHeaderHeight + (r - firstRow) * mCellSize;
+    if (r == mHoverRow) {
+      painter.fillRect(0, y, mNameWidth, mCellSize - 1, highlight);
+    }
+    painter.drawText(QRect(MARGIN, y, mNameWidth - 2 * MARGIN, mCellSize), Qt::AlignLeft | Qt::AlignVCenter, mRows[mVisibleRows[r]].name);
+  }
+
+  // Header: tiling names over each group, feature names rotated below
+  painter.setClipRect(QRect(mNameWidth, 0, area.width() - mNameWidth, mHeaderHeight));
+  int labelHeight = fontMetrics().height();
+  for (int g = 0; g < TILING_COUNT; ++g) {
+    int groupX = mNameWidth + g * groupWidth - scrollX;
+    painter.setPen(sGroupColors[g]);
+    painter.drawText(QRect(groupX, MARGIN, featureCount * mCellSize, labelHeight), Qt::AlignCenter, sTilingNames[g]);
+    painter.setPen(pal.color(QPalette::Text));
+    for (int f = 0; f < featureCount; ++f) {
+      int x = groupX + f * mCellSize;
+      if ((x + mCellSize < mNameWidth) || (x > area.right())) {
+        continue;
+      }
+      painter.save();
+      painter.translate(x, mHeaderHeight - MARGIN);
+      painter.rotate(-90);
+      painter.drawText(QRect(0, 0, mHeaderHeight - labelHeight - 2 * MARGIN, mCellSize), Qt::AlignLeft | Qt::AlignVCenter,
+                       toStringFormatFeatureShort(flags[f]));
+      painter.restore();
+    }
+  }
+}
+
+void FormatMatrixWidget::resizeEvent(QResizeEvent* event)
+{
+  QAbstractScrollArea::resizeEvent(event);
+  updateLayout();
+}
+
+void FormatMatrixWidget::mouseMoveEvent(QMouseEvent* event)
+{
+  int row = -1;
+  int column = -1;
+  if (! cellAt(event->pos(), &row, &column)) {
+    row = -1;
+    column = -1;
+  }
+  if ((row != mHoverRow) || (column != mHoverColumn)) {
+    mHoverRow = row;
+    mHoverColumn = column;
+    viewport()->update();
+  }
+}
+
+void FormatMatrixWidget::leaveEvent(QEvent* event)
+{
+  QAbstractScrollArea::leaveEvent(event);
+  mHoverRow = -1;
+  mHoverColumn = -1;
+  viewport()->update();
+}
+
+bool FormatMatrixWidget::viewportEvent(QEvent* event)
+{
+  if (event->type() == QEvent::ToolTip) {
+    QHelpEvent* helpEvent = static_cast<QHelpEvent*>(event);
+    int row = -1;
+    int column = -1;
+    if (cellAt(helpEvent->pos(), &row, &column)) {
+      const auto& flags = getFormatFeatureFlags();
+      int featureCount = static_cast<int>(flags.size());
+      const Row& format = mRows[mVisibleRows[row]];
+      VkFormatFeatureFlagBits flag = flags[column % featureCount];
+      bool supported = (format.features[column / featureCount] & flag) != 0;
+      QToolTip::showText(helpEvent->globalPos(),
+                         QString("%1\n%2 %3: %4")
+                           .arg(toStringVkFormat(format.format))
+                           .arg(sTilingNames[column / featureCount])
+                           .arg(toStringFormatFeature(flag))
+                           .arg(supported ? "supported" : "not supported"),
+                         viewport());
+    }
+    else {
+      QToolTip::hideText();
+    }
+    return true;
+  }
+  return QAbstractScrollArea::viewportEvent(event);
+}
+
+void FormatMatrixWidget::scrollContentsBy(int dx, int dy)
+{
+  (void)dx;
+  (void)dy;
+  mHoverRow = -1;
+  mHoverColumn = -1;
+  viewport()->update();
+}
@@ -0,0 +1,60 @@
+#ifndef __FORMAT_MATRIX_WIDGET_H__
+#define __FORMAT_MATRIX_WIDGET_H__
+
+#include <QAbstractScrollArea>
+#include <QString>
+
+#include <vulkan/vulkan.h>
+
+#include <map>
+#include <vector>
+
+//! \class FormatMatrixWidget
+//!
+//! Formats as rows and (tiling x feature) as columns, painted straight from
+//! the feature bitmasks. Only the rows and columns inside the viewport are
+//! drawn and there are no per-cell objects, so the whole table scrolls at
+//! display rate. The header and the format names stay in place while the
+//! cells scroll. Promoted from a plain QWidget in mainwindow.ui.
+//!
+class FormatMatrixWidget : public QAbstractScrollArea {
+  Q_OBJECT
+public:
+  explicit FormatMatrixWidget(QWidget* parent = nullptr);
+
+  void  setFormats(const std::map<VkFormat, VkFormatProperties>& formatProperties);
+  void  setFilter(const QString& filterText);
+
+protected:
+  virtual void paintEvent(QPaintEvent* event);
+  virtual void resizeEvent(QResizeEvent* event);
+  virtual void mouseMoveEvent(QMouseEvent* event);
+  virtual void leaveEvent(QEvent* event);
+  virtual bool viewportEvent(QEvent* event);
+  virtual void scrollContentsBy(int dx, int dy);
+
+private:
+  struct Row {
+    VkFormat              format;
+    QString               name;
+    VkFormatFeatureFlags  features[3];   // linear, optimal, buffer
+  };
+
+  void  updateLayout();
+  void  updateFilter();
+  int   columnCount() const;
+  //! Row index into mVisibleRows and column under a viewport position, false outside the cells
+  bool  cellAt(const QPoint& pos, int* pRow, int* pColumn) const;
+
+private:
+  std::vector<Row>      mRows;
+  std::vector<uint32_t> mVisibleRows;
+  QString               mFilterText;
+  int                   mNameWidth = 0;
+  int                   mHeaderHeight = 0;
+  int                   mCellSize = 14;
+  int                   mHoverRow = -1;
+  int                   mHoverColumn = -1;
+};
+
+#endif // __FORMAT_MATRIX_WIDGET_H__
@@ -0,0 +1,67 @@
+#include "FormatTable.h"
+
+const std::vector<FormatRange>& getFormatRanges()
+{
+  static const std::vector<FormatRange> sRanges = {
+    // VK_FORMAT_UNDEFINED .. VK_FORMAT_ASTC_12x12_SRGB_BLOCK
+    { 0,          185,  nullptr,                                0 },
+    // VK_FORMAT_PVRTC1_2BPP_UNORM_BLOCK_IMG .. VK_FORMAT_PVRTC2_4BPP_SRGB_BLOCK_IMG
+    { 1000054000, 8,    "VK_IMG_format_pvrtc",                  0 },
+    // VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK_EXT .. VK_FORMAT_ASTC_12x12_SFLOAT_BLOCK_EXT
+    { 1000066000, 14,   "VK_EXT_texture_compression_astc_hdr",  VK_MAKE_VERSION(1, 3, 0) },
+    // VK_FORMAT_G8B8G8R8_422_UNORM .. VK_FORMAT_G16_B16_R16_3PLANE_444_UNORM
+    { 1000156000, 34,   "VK_KHR_sampler_ycbcr_conversion",      VK_MAKE_VERSION(1, 1, 0) },
+    // VK_FORMAT_G8_B8R8_2PLANE_444_UNORM_EXT .. VK_FORMAT_G16_B16R16_2PLANE_444_UNORM_EXT
+    { 1000330000, 4,    "VK_EXT_ycbcr_2plane_444_formats",      VK_MAKE_VERSION(1, 3, 0) },
+    // VK_FORMAT_A4R4G4B4_UNORM_PACK16_EXT .. VK_FORMAT_A4B4G4R4_UNORM_PACK16_EXT
+    { 1000340000, 2,    "VK_EXT_4444_formats",                  VK_MAKE_VERSION(1, 3, 0) },
+  };
+  return sRanges;
+}
+
+bool isFormatRangeSupported(const FormatRange& range, uint32_t apiVersion, const ExtensionSet& extensions)
+{
+  if (range.extensionName == nullptr) {
+    return true;
+  }
+  if ((range.coreVersion != 0) && (apiVersion >= range.coreVersion)) {
+    return true;
+  }
+  return extensions.contains(range.extensionName);
+}
+
+std::vector<VkFormat> getSupportedFormats(uint32_t apiVersion, const ExtensionSet& extensions)
+{
+  std::vector<VkFormat> formats;
+  for (const auto& range : getFormatRanges()) {
+    if (! isFormatRangeSupported(range, apiVersion, extensions)) {
+      continue;
+    }
+    for (uint32_t i = 0; i < range.count; ++i) {
+      formats.push_back(static_cast<VkFormat>(range.first + i));
+    }
+  }
+  return formats;
+}
+
+const std::vector<VkFormatFeatureFlagBits>& getFormatFeatureFlags()
+{
+  static const std::vector<VkFormatFeatureFlagBits> sFlags = {
+    VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT,
+    VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT,
+    VK_FORMAT_FEATURE_STORAGE_IMAGE_ATOMIC_BIT,
+    VK_FORMAT_FEATURE_UNIFORM_TEXEL_BUFFER_BIT,
+    VK_FORMAT_FEATURE_STORAGE_TEXEL_BUFFER_BIT,
+    VK_FORMAT_FEATURE_STORAGE_TEXEL_BUFFER_ATOMIC_BIT,
+    VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT,
+    VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT,
+    VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT,
+    VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT,
+    VK_FORMAT_FEATURE_BLIT_SRC_BIT,
+    VK_FORMAT_FEATURE_BLIT_DST_BIT,
+    VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT,
+    VK_FORMAT_FEATURE_TRANSFER_SRC_BIT_KHR,
+    VK_FORMAT_FEATURE_TRANSFER_DST_BIT_KHR,
+  };
+  return sFlags;
+}
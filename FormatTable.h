@@ -0,0 +1,32 @@
+#ifndef __FORMAT_TABLE_H__
+#define __FORMAT_TABLE_H__
+
+#include "ExtensionSet.h"
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+//! A run of consecutive VkFormat values added together. Extension formats
+//! live at 1000000000 + (extension number - 1) * 1000 + n, so the enum is
+//! sparse and has to be walked range by range.
+struct FormatRange {
+  uint32_t    first;
+  uint32_t    count;
+  const char* extensionName;  // nullptr for core 1.0
+  uint32_t    coreVersion;    // API version the range was promoted to core in, 0 if never
+};
+
+//! Every range the viewer knows about, core 1.0 first. Values are listed by
+//! number so ranges newer than the Vulkan headers still build.
+const std::vector<FormatRange>& getFormatRanges();
+
+bool isFormatRangeSupported(const FormatRange& range, uint32_t apiVersion, const ExtensionSet& extensions);
+
+//! Formats a device can be queried for, in table order
+std::vector<VkFormat> getSupportedFormats(uint32_t apiVersion, const ExtensionSet& extensions);
+
+//! Feature bits shown per tiling in the Formats tab, in display order
+const std::vector<VkFormatFeatureFlagBits>& getFormatFeatureFlags();
+
+#endif // __FORMAT_TABLE_H__
@@ -0,0 +1,342 @@
+#include "ManifestScanner.h"
+#include "Trace.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QtConcurrent/QtConcurrentMap>
+
+#if defined(_WIN32)
+  #include <Windows.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static uint32_t parseVersion(const QString& s)
+{
+  QStringList parts = s.split('.');
+  uint32_t major = (parts.size() > 0) ? parts[0].toUInt() : 0;
+  uint32_t minor = (parts.size() > 1) ? parts[1].toUInt() : 0;
+  uint32_t patch = (parts.size() > 2) ? parts[2].toUInt() : 0;
+  return VK_MAKE_VERSION(major, minor, patch);
+}
+
+static void copyString(char* dst, size_t dstSize, const QString& src)
+{
+  QByteArray utf8 = src.toUtf8();
+  size_t n = std::min(dstSize - 1, static_cast<size_t>(utf8.size()));
+  memcpy(dst, utf8.constData(), n);
+  dst[n] = '\0';
+}
+
+// Relative library paths are relative to the manifest, bare file names go
+// through the system search path and are left alone.
+static QString resolveLibraryPath(const QString& manifestPath, const QString& libraryPath)
+{
+  if (libraryPath.contains('/') || libraryPath.contains('\\')) {
+    QFileInfo info(libraryPath);
+    if (info.isRelative()) {
+      return QDir::cleanPath(QFileInfo(manifestPath).absolutePath() + "/" + libraryPath);
+    }
+  }
+  return libraryPath;
+}
+
+static ManifestScanner::LayerManifest parseLayer(const QString& path, const QString& type, const QJsonObject& obj)
+{
+  ManifestScanner::LayerManifest layer = {};
+  layer.path        = path;
+  layer.type        = type;
+  layer.libraryPath = resolveLibraryPath(path, obj.value("library_path").toString());
+
+  copyString(layer.properties.layerName, sizeof(layer.properties.layerName), obj.value("name").toString());
+  copyString(layer.properties.description, sizeof(layer.properties.description), obj.value("description").toString());
+  layer.properties.specVersion           = parseVersion(obj.value("api_version").toString());
+  layer.properties.implementationVersion = obj.value("implementation_version").toString().toUInt();
+
+  for (const auto& value : obj.value("instance_extensions").toArray()) {
+    QJsonObject extObj = value.toObject();
+    VkExtensionProperties ext = {};
+    copyString(ext.extensionName, sizeof(ext.extensionName), extObj.value("name").toString());
+    ext.specVersion = extObj.value("spec_version").toString().toUInt();
+    layer.instanceExtensions.push_back(ext);
+  }
+
+  // A single "VARIABLE": "value" pair each
+  QJsonObject disableObj = obj.value("disable_environment").toObject();
+  if (! disableObj.isEmpty()) {
+    layer.disableVariable = disableObj.begin().key();
+    layer.disableValue    = disableObj.begin().value().toString();
+  }
+  QJsonObject enableObj = obj.value("enable_environment").toObject();
+  if (! enableObj.isEmpty()) {
+    layer.enableVariable = enableObj.begin().key();
+    layer.enableValue    = enableObj.begin().value().toString();
+  }
+  return layer;
+}
+
+#if defined(_WIN32)
+// Manifests are registered as value names under these keys
+static void appendRegistryManifests(HKEY root, const wchar_t* subKey, QStringList* pPaths)
+{
+  HKEY key = nullptr;
+  if (RegOpenKeyExW(root, subKey, 0, KEY_READ, &key) != ERROR_SUCCESS) {
+    return;
+  }
+
+  wchar_t name[MAX_PATH * 2];
+  for (DWORD i = 0; ; ++i) {
+    DWORD nameLength = sizeof(name) / sizeof(name[0]);
+    DWORD type = 0;
+    DWORD value = 0;
+    DWORD valueSize = sizeof(value);
+    LONG res = RegEnumValueW(key, i, name, &nameLength, nullptr, &type, reinterpret_cast<LPBYTE>(&value), &valueSize);
+    if (res == ERROR_NO_MORE_ITEMS) {
+      break;
+    }
+    // A non-zero value means the manifest is disabled
+    if ((res == ERROR_SUCCESS) && (type == REG_DWORD) && (value == 0)) {
+      *pPaths << QDir::fromNativeSeparators(QString::fromWCharArray(name, static_cast<int>(nameLength)));
+    }
+  }
+
+  RegCloseKey(key);
+}
+
+// Drivers installed through the driver store register their manifests on
+// the adapter's driver key instead, as REG_SZ or REG_MULTI_SZ. 32-bit
+// processes on 64-bit Windows read the "Wow" variant of the value.
+static void appendAdapterManifests(const QString& valueName, QStringList* pPaths)
+{
+  static const wchar_t* sClassKeys[] = {
+    L"SYSTEM\\CurrentControlSet\\Control\\Class\\{4d36e968-e325-11ce-bfc1-08002be10318}",  // Display adapters
+    L"SYSTEM\\CurrentControlSet\\Control\\Class\\{5c4c3332-344d-483c-8739-259e934c9cc8}",  // Software components
+  };
+
+  BOOL wow64 = FALSE;
+  IsWow64Process(GetCurrentProcess(), &wow64);
+  std::wstring value = (wow64 ? (valueName + "Wow") : valueName).toStdWString();
+
+  for (const wchar_t* classKey : sClassKeys) {
+    HKEY key = nullptr;
+    if (RegOpenKeyExW(HKEY_LOCAL_MACHINE, classKey, 0, KEY_READ, &key) != ERROR_SUCCESS) {
+      continue;
+    }
+
+    wchar_t adapter[256];
+    for (DWORD i = 0; ; ++i) {
+      DWORD adapterLength = sizeof(adapter) / sizeof(adapter[0]);
+      LONG res = RegEnumKeyExW(key, i, adapter, &adapterLength, nullptr, nullptr, nullptr, nullptr);
+      if (res == ERROR_NO_MORE_ITEMS) {
+        break;
+      }
+      DWORD size = 0;
+      if ((res != ERROR_SUCCESS) ||
+          (RegGetValueW(key, adapter, value.c_str(), RRF_RT_REG_SZ | RRF_RT_REG_MULTI_SZ, nullptr, nullptr, &size) != ERROR_SUCCESS)) {
+        continue;
+      }
+      // One extra terminator so a REG_SZ reads like a single entry REG_MULTI_SZ
+      std::vector<wchar_t> data(size / sizeof(wchar_t) + 2, L'\0');
+      size = static_cast<DWORD>((data.size() - 1) * sizeof(wchar_t));
+      if (RegGetValueW(key, adapter, value.c_str(), RRF_RT_REG_SZ | RRF_RT_REG_MULTI_SZ, nullptr, data.data(), &size) != ERROR_SUCCESS) {
+        continue;
+      }
+      for (const wchar_t* entry = data.data(); *entry != L'\0'; entry += wcslen(entry) + 1) {
+        *pPaths << QDir::fromNativeSeparators(QString::fromWCharArray(entry));
+      }
+    }
+
+    RegCloseKey(key);
+  }
+}
+#else
+static QStringList searchDirectories(const QString& relativePath)
+{
+  QStringList configDirs = QString::fromLocal8Bit(qgetenv("XDG_CONFIG_DIRS")).split(':', QString::SkipEmptyParts);
+  QStringList dataDirs = QString::fromLocal8Bit(qgetenv("XDG_DATA_DIRS")).split(':', QString::SkipEmptyParts);
+  if (configDirs.isEmpty()) {
+    configDirs << "/etc/xdg";
+  }
+  if (dataDirs.isEmpty()) {
+    dataDirs << "/usr/local/share" << "/usr/share";
+  }
+  QString configHome = QString::fromLocal8Bit(qgetenv("XDG_CONFIG_HOME"));
+  if (configHome.isEmpty()) {
+    configHome = QDir::homePath() + "/.config";
+  }
+  QString dataHome = QString::fromLocal8Bit(qgetenv("XDG_DATA_HOME"));
+  if (dataHome.isEmpty()) {
+    dataHome = QDir::homePath() + "/.local/share";
+  }
+
+  // Same order as the loader
+  QStringList dirs;
+  dirs << configHome + "/" + relativePath;
+  for (const auto& dir : configDirs) {
+    dirs << dir + "/" + relativePath;
+  }
+  dirs << "/etc/" + relativePath;
+  dirs << dataHome + "/" + relativePath;
+  for (const auto& dir : dataDirs) {
+    dirs << dir + "/" + relativePath;
+  }
+  dirs.removeDuplicates();
+  return dirs;
+}
+#endif
+
+// Directories expand to the JSON files they hold
+static QStringList expandManifestPaths(const QStringList& paths)
+{
+  QStringList files;
+  for (const auto& path : paths) {
+    QFileInfo info(path);
+    if (info.isDir()) {
+      for (const auto& entry : QDir(path).entryInfoList(QStringList() << "*.json", QDir::Files, QDir::Name)) {
+        files << entry.absoluteFilePath();
+      }
+    }
+    else if (info.isFile()) {
+      files << info.absoluteFilePath();
+    }
+  }
+  return files;
+}
+
+// -------------------------------------------------------------------------------------------------
+// ManifestScanner
+// -------------------------------------------------------------------------------------------------
+QStringList ManifestScanner::icdManifestPaths()
+{
+  QString icdFilenames = QString::fromLocal8Bit(qgetenv("VK_ICD_FILENAMES"));
+  if (! icdFilenames.isEmpty()) {
+    return icdFilenames.split(QDir::listSeparator(), QString::SkipEmptyParts);
+  }
+
+  QStringList paths;
+#if defined(_WIN32)
+  appendAdapterManifests("VulkanDriverName", &paths);
+  appendRegistryManifests(HKEY_LOCAL_MACHINE, L"SOFTWARE\\Khronos\\Vulkan\\Drivers", &paths);
+#else
+  paths = searchDirectories("vulkan/icd.d");
+#endif
+  return paths;
+}
+
+QStringList ManifestScanner::layerManifestPaths(bool implicit)
+{
+  if (! implicit) {
+    QString layerPath = QString::fromLocal8Bit(qgetenv("VK_LAYER_PATH"));
+    if (! layerPath.isEmpty()) {
+      return layerPath.split(QDir::listSeparator(), QString::SkipEmptyParts);
+    }
+  }
+
+  QStringList paths;
+#if defined(_WIN32)
+  const wchar_t* subKey = implicit ? L"SOFTWARE\\Khronos\\Vulkan\\ImplicitLayers" : L"SOFTWARE\\Khronos\\Vulkan\\ExplicitLayers";
+  appendAdapterManifests(implicit ? "VulkanImplicitLayers" : "VulkanExplicitLayers", &paths);
+  appendRegistryManifests(HKEY_LOCAL_MACHINE, subKey, &paths);
+  appendRegistryManifests(HKEY_CURRENT_USER, subKey, &paths);
+#else
+  paths = searchDirectories(implicit ? "vulkan/implicit_layer.d" : "vulkan/explicit_layer.d");
+#endif
+  return paths;
+}
+
+ManifestScanner::Manifest ManifestScanner::parse(const QString& path, const QString& layerType)
+{
+  QFileInfo info(path);
+  {
+    std::lock_guard<std::mutex> lock(mCacheMutex);
+    auto it = mCache.find(path);
+    if ((it != mCache.end()) && (it->modified == info.lastModified()) && (it->size == info.size())) {
+      return *it;
+    }
+  }
+
+  TRACE_SCOPE("loader", "parse " + path.toStdString());
+
+  Manifest manifest;
+  manifest.modified = info.lastModified();
+  manifest.size     = info.size();
+
+  QFile file(path);
+  if (file.open(QIODevice::ReadOnly)) {
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (layerType.isEmpty()) {
+      QJsonObject icdObj = root.value("ICD").toObject();
+      if (! icdObj.isEmpty()) {
+        IcdManifest icd;
+        icd.path        = path;
+        icd.libraryPath = resolveLibraryPath(path, icdObj.value("library_path").toString());
+        icd.apiVersion  = parseVersion(icdObj.value("api_version").toString());
+        manifest.icds.push_back(icd);
+      }
+    }
+    else {
+      // File format 1.0.1 allows several layers per manifest
+      if (root.contains("layer")) {
+        manifest.layers.push_back(parseLayer(path, layerType, root.value("layer").toObject()));
+      }
+      for (const auto& value : root.value("layers").toArray()) {
+        manifest.layers.push_back(parseLayer(path, layerType, value.toObject()));
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mCacheMutex);
+  mCache[path] = manifest;
+  return manifest;
+}
+
+void ManifestScanner::scan()
+{
+  TRACE_SCOPE("loader", "ManifestScanner::scan");
+
+  struct Item {
+    QString   path;
+    QString   layerType;
+    Manifest  manifest;
+  };
+
+  QVector<Item> items;
+  QSet<QString> seen;
+  auto append = [&items, &seen](const QStringList& paths, const QString& layerType) {
+    for (const auto& path : expandManifestPaths(paths)) {
+      if (! seen.contains(path)) {
+        seen.insert(path);
+        items.push_back(Item{ path, layerType, Manifest() });
+      }
+    }
+  };
+  append(layerManifestPaths(false), "explicit");
+  append(layerManifestPaths(true), "implicit");
+  append(icdManifestPaths(), QString());
+
+  QtConcurrent::blockingMap(items, [this](Item& item) {
+    item.manifest = parse(item.path, item.layerType);
+  });
+
+  mLayers.clear();
+  mIcds.clear();
+  QSet<QString> layerNames;
+  for (const auto& item : items) {
+    for (const auto& layer : item.manifest.layers) {
+      QString name = QString::fromUtf8(layer.properties.layerName);
+      if (! name.isEmpty() && ! layerNames.contains(name)) {
+        layerNames.insert(name);
+        mLayers.push_back(layer);
+      }
+    }
+    mIcds.insert(mIcds.end(), item.manifest.icds.begin(), item.manifest.icds.end());
+  }
+}
@@ -0,0 +1,82 @@
+#ifndef __MANIFEST_SCANNER_H__
+#define __MANIFEST_SCANNER_H__
+
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <vulkan/vulkan.h>
+
+#include <mutex>
+#include <vector>
+
+//! \class ManifestScanner
+//!
+//! Reads layer and ICD JSON manifests straight from the loader's search
+//! paths, without going through the loader and without loading any layer
+//! or driver library. VK_LAYER_PATH replaces the explicit layer search and
+//! VK_ICD_FILENAMES replaces the ICD search, as they do for the loader.
+//!
+//! On Windows the search covers HKLM\SOFTWARE\Khronos\Vulkan and the
+//! VulkanDriverName / VulkanImplicitLayers / VulkanExplicitLayers values of
+//! every display adapter and software component driver key. The loader
+//! only reads the adapters present right now, so an unplugged adapter's
+//! driver can be listed here and not be loaded.
+//!
+//! Implicit layers keep their disable_environment and enable_environment
+//! pairs. The loader only loads a layer with enable_environment while that
+//! variable has that value; the startup profiler clears it to keep the
+//! layer off.
+//!
+//! Manifests are parsed in parallel and cached by path, size and
+//! modification time, so rescanning only parses files that changed.
+//!
+class ManifestScanner {
+public:
+  struct LayerManifest {
+    QString                             path;
+    QString                             type;
+    QString                             libraryPath;
+    VkLayerProperties                   properties;
+    std::vector<VkExtensionProperties>  instanceExtensions;
+    // Implicit layers only, the variables the loader checks to turn them off or on
+    QString                             disableVariable;
+    QString                             disableValue;
+    QString                             enableVariable;
+    QString                             enableValue;
+  };
+
+  struct IcdManifest {
+    QString   path;
+    QString   libraryPath;
+    uint32_t  apiVersion = 0;
+  };
+
+  static QStringList icdManifestPaths();
+  static QStringList layerManifestPaths(bool implicit);
+
+  void  scan();
+
+  //! Deduplicated by layer name, the first manifest found wins like in the loader
+  const std::vector<LayerManifest>& layers() const { return mLayers; }
+  const std::vector<IcdManifest>&   icds() const { return mIcds; }
+
+private:
+  struct Manifest {
+    QDateTime                   modified;
+    qint64                      size = -1;
+    std::vector<LayerManifest>  layers;
+    std::vector<IcdManifest>    icds;
+  };
+
+  Manifest  parse(const QString& path, const QString& layerType);
+
+private:
+  std::mutex                  mCacheMutex;
+  QHash<QString, Manifest>    mCache;
+  std::vector<LayerManifest>  mLayers;
+  std::vector<IcdManifest>    mIcds;
+};
+
+#endif // __MANIFEST_SCANNER_H__
@@ -0,0 +1,198 @@
+#include "MemoryAccounting.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <tuple>
+
+#if defined(_WIN32)
+  #include <malloc.h>
+#endif
+
+static thread_local MemoryAccounting::Counters* sCurrentCounters = nullptr;
+
+// Sits right in front of every block handed to the driver
+struct AllocationHeader {
+  MemoryAccounting::Counters* counters;
+  size_t                      size;
+  size_t                      offset;     // from the start of the underlying block
+};
+
+static void* allocateAligned(size_t size, size_t alignment)
+{
+#if defined(_WIN32)
+  return _aligned_malloc(size, alignment);
+#else
+  void* block = nullptr;
+  return (posix_memalign(&block, alignment, size) == 0) ? block : nullptr;
+#endif
+}
+
+static void freeAligned(void* block)
+{
+#if defined(_WIN32)
+  _aligned_free(block);
+#else
+  free(block);
+#endif
+}
+
+static AllocationHeader* getHeader(void* pMemory)
+{
+  return reinterpret_cast<AllocationHeader*>(pMemory) - 1;
+}
+
+static void* VKAPI_PTR trackingAllocation(void* pUserData, size_t size, size_t alignment, VkSystemAllocationScope allocationScope)
+{
+  (void)pUserData;
+  (void)allocationScope;
+
+  // Alignment is a power of two, the header needs its own alignment in front of the block
+  alignment = std::max(alignment, std::max(alignof(AllocationHeader), sizeof(void*)));
+  size_t offset = (sizeof(AllocationHeader) + alignment - 1) & ~(alignment - 1);
+  char* block = static_cast<char*>(allocateAligned(offset + size, alignment));
+  if (block == nullptr) {
+    return nullptr;
+  }
+
+  void* pMemory = block + offset;
+  AllocationHeader* header = getHeader(pMemory);
+  header->counters = MemoryAccounting::current();
+  header->size     = size;
+  header->offset   = offset;
+
+  header->counters->liveBytes += static_cast<int64_t>(size);
+  header->counters->liveAllocations += 1;
+  header->counters->allocations += 1;
+  return pMemory;
+}
+
+static void VKAPI_PTR trackingFree(void* pUserData, void* pMemory)
+{
+  (void)pUserData;
+
+  if (pMemory == nullptr) {
+    return;
+  }
+  AllocationHeader* header = getHeader(pMemory);
+  header->counters->liveBytes -= static_cast<int64_t>(header->size);
+  header->counters->liveAllocations -= 1;
+  freeAligned(static_cast<char*>(pMemory) - header->offset);
+}
+
+static void* VKAPI_PTR trackingReallocation(void* pUserData, void* pOriginal, size_t size, size_t alignment, VkSystemAllocationScope allocationScope)
+{
+  if (pOriginal == nullptr) {
+    return trackingAllocation(pUserData, size, alignment, allocationScope);
+  }
+  if (size == 0) {
+    trackingFree(pUserData, pOriginal);
+    return nullptr;
+  }
+
+  // On failure the original has to stay valid
+  void* pMemory = trackingAllocation(pUserData, size, alignment, allocationScope);
+  if (pMemory == nullptr) {
+    return nullptr;
+  }
+  memcpy(pMemory, pOriginal, std::min(size, getHeader(pOriginal)->size));
+  trackingFree(pUserData, pOriginal);
+  return pMemory;
+}
+
+static void VKAPI_PTR trackingInternalAllocation(void* pUserData, size_t size, VkInternalAllocationType allocationType, VkSystemAllocationScope allocationScope)
+{
+  (void)pUserData;
+  (void)allocationType;
+  (void)allocationScope;
+  MemoryAccounting::current()->internalBytes += static_cast<int64_t>(size);
+}
+
+static void VKAPI_PTR trackingInternalFree(void* pUserData, size_t size, VkInternalAllocationType allocationType, VkSystemAllocationScope allocationScope)
+{
+  (void)pUserData;
+  (void)allocationType;
+  (void)allocationScope;
+  // No header to remember the scope by, this is charged to whoever frees it
+  MemoryAccounting::current()->internalBytes -= static_cast<int64_t>(size);
+}
+
+MemoryAccounting::MemoryAccounting()
+{
+  mCallbacks.pUserData              = this;
+  mCallbacks.pfnAllocation          = trackingAllocation;
+  mCallbacks.pfnReallocation        = trackingReallocation;
+  mCallbacks.pfnFree                = trackingFree;
+  mCallbacks.pfnInternalAllocation  = trackingInternalAllocation;
+  mCallbacks.pfnInternalFree        = trackingInternalFree;
+}
+
+MemoryAccounting& MemoryAccounting::get()
+{
+  static MemoryAccounting sAccounting;
+  return sAccounting;
+}
+
+MemoryAccounting::Counters* MemoryAccounting::counters(const std::string& scope, int gpu, const std::string& gpuName)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  // Counters holds atomics, so it is built in place
+  auto it = mCounters.emplace(std::piecewise_construct, std::forward_as_tuple(scope, gpu), std::forward_as_tuple()).first;
+  it->second.gpuName = gpuName;
+  return &it->second.counters;
+}
+
+MemoryAccounting::Counters* MemoryAccounting::current()
+{
+  static Counters* sUnscoped = get().counters("", NO_GPU, "");
+  return (sCurrentCounters != nullptr) ? sCurrentCounters : sUnscoped;
+}
+
+void MemoryAccounting::recordPopulate(const std::string& scope, int gpu, const std::string& gpuName, uint64_t itemsCreated)
+{
+  Counters* entry = counters(scope, gpu, gpuName);
+  entry->populates += 1;
+  entry->itemsCreated += itemsCreated;
+}
+
+std::vector<MemoryAccounting::Row> MemoryAccounting::snapshot() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  std::vector<Row> rows;
+  for (const auto& it : mCounters) {
+    const Counters& entry = it.second.counters;
+    Row row;
+    row.scope           = it.first.first;
+    row.gpu             = it.first.second;
+    row.gpuName         = it.second.gpuName;
+    row.liveBytes       = entry.liveBytes;
+    row.liveAllocations = entry.liveAllocations;
+    row.allocations     = entry.allocations;
+    row.internalBytes   = entry.internalBytes;
+    row.populates       = entry.populates;
+    row.itemsCreated    = entry.itemsCreated;
+    rows.push_back(row);
+  }
+  return rows;
+}
+
+void MemoryAccounting::resetTotals()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  for (auto& it : mCounters) {
+    it.second.counters.allocations = 0;
+    it.second.counters.populates = 0;
+    it.second.counters.itemsCreated = 0;
+  }
+}
+
+MemoryScope::MemoryScope(const std::string& scope, int gpu, const std::string& gpuName)
+  : mPrevious(sCurrentCounters)
+{
+  sCurrentCounters = MemoryAccounting::get().counters(scope, gpu, gpuName);
+}
+
+MemoryScope::~MemoryScope()
+{
+  sCurrentCounters = mPrevious;
+}
@@ -0,0 +1,105 @@
+#ifndef __MEMORY_ACCOUNTING_H__
+#define __MEMORY_ACCOUNTING_H__
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! \class MemoryAccounting
+//!
+//! Attributes memory to the page and GPU that caused it. Driver memory is
+//! tracked through allocator(), which is passed to every vkCreate*/vkDestroy*
+//! the viewer makes; the loader and ICDs also use the instance allocator for
+//! their own per instance state. Each allocation is charged to the
+//! MemoryScope active on the calling thread and released from that same
+//! scope, wherever it is freed.
+//!
+//! Tree population is counted per populate, the items a page currently
+//! holds are counted from its widgets when the Diagnostics page refreshes.
+//!
+//! GPUs are told apart by their index in vkEnumeratePhysicalDevices order,
+//! two identical cards have the same name. NO_GPU is instance wide.
+//!
+class MemoryAccounting {
+public:
+  struct Counters {
+    std::atomic<int64_t>  liveBytes{0};
+    std::atomic<int64_t>  liveAllocations{0};
+    std::atomic<uint64_t> allocations{0};
+    // Reported through pfnInternalAllocation, the driver owns the memory
+    std::atomic<int64_t>  internalBytes{0};
+    std::atomic<uint64_t> populates{0};
+    std::atomic<uint64_t> itemsCreated{0};
+  };
+
+  static const int NO_GPU = -1;
+
+  //! Plain copy of one Counters entry
+  struct Row {
+    std::string scope;
+    int         gpu = NO_GPU;
+    std::string gpuName;
+    int64_t     liveBytes = 0;
+    int64_t     liveAllocations = 0;
+    uint64_t    allocations = 0;
+    int64_t     internalBytes = 0;
+    uint64_t    populates = 0;
+    uint64_t    itemsCreated = 0;
+  };
+
+  static MemoryAccounting& get();
+
+  //! Has to be the same for the create and the destroy of an object
+  const VkAllocationCallbacks* allocator() const { return &mCallbacks; }
+
+  //! Entries are never removed, live allocations point at them. gpuName is
+  //! only shown, the latest one is kept.
+  Counters*         counters(const std::string& scope, int gpu, const std::string& gpuName);
+  //! Counters of the MemoryScope active on this thread, unscoped otherwise
+  static Counters*  current();
+
+  void              recordPopulate(const std::string& scope, int gpu, const std::string& gpuName, uint64_t itemsCreated);
+  std::vector<Row>  snapshot() const;
+  //! Clears the running totals, live bytes and allocations are kept
+  void              resetTotals();
+
+private:
+  MemoryAccounting();
+
+private:
+  using Key = std::pair<std::string, int>;
+
+  struct Entry {
+    std::string gpuName;
+    Counters    counters;
+  };
+
+  VkAllocationCallbacks   mCallbacks = {};
+  mutable std::mutex      mMutex;
+  std::map<Key, Entry>    mCounters;
+};
+
+//! \class MemoryScope
+//!
+//! Charges driver allocations made on this thread to scope and gpu while
+//! alive, nests.
+//!
+class MemoryScope {
+public:
+  MemoryScope(const std::string& scope, int gpu, const std::string& gpuName);
+  ~MemoryScope();
+
+  MemoryScope(const MemoryScope&) = delete;
+  MemoryScope& operator=(const MemoryScope&) = delete;
+
+private:
+  MemoryAccounting::Counters* mPrevious;
+};
+
+#endif // __MEMORY_ACCOUNTING_H__
@@ -0,0 +1,145 @@
+#include "MemoryBenchmark.h"
+#include "Trace.h"
+#include "VkProfiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#define RUN_COUNT   3
+
+static double toGBs(VkDeviceSize bytes, double milliseconds)
+{
+  return (milliseconds > 0.0) ? (static_cast<double>(bytes) / (milliseconds * 1000000.0)) : -1.0;
+}
+
+static void benchmarkMapped(BenchmarkContext& context, uint32_t typeIndex, VkDeviceSize size, MemoryTypeBenchmark* pResult)
+{
+  VkPhysicalDevice gpu = context.gpu();
+  VkDevice device = context.device();
+
+  VkBuffer buffer = VK_NULL_HANDLE;
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  if (context.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, typeIndex, &buffer, &memory) != VK_SUCCESS) {
+    return;
+  }
+
+  void* pMapped = nullptr;
+  if (VK_CALL(gpu, vkMapMemory, device, memory, 0, VK_WHOLE_SIZE, 0, &pMapped) == VK_SUCCESS) {
+    uint64_t* pWords = static_cast<uint64_t*>(pMapped);
+    size_t wordCount = static_cast<size_t>(size / sizeof(uint64_t));
+
+    VkMappedMemoryRange range = { VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE };
+    range.memory  = memory;
+    range.offset  = 0;
+    range.size    = VK_WHOLE_SIZE;
+
+    double writeMs = -1.0;
+    double readMs = -1.0;
+    double flushMs = -1.0;
+    double invalidateMs = -1.0;
+    volatile uint64_t sink = 0;
+    for (int run = 0; run < RUN_COUNT; ++run) {
+      {
+        BenchmarkTimer timer;
+        std::fill(pWords, pWords + wordCount, static_cast<uint64_t>(run));
+        double ms = timer.elapsedMilliseconds();
+        writeMs = (writeMs < 0.0) ? ms : std::min(writeMs, ms);
+      }
+      {
+        BenchmarkTimer timer;
+        VK_CALL(gpu, vkFlushMappedMemoryRanges, device, 1, &range);
+        double ms = timer.elapsedMilliseconds();
+        flushMs = (flushMs < 0.0) ? ms : std::min(flushMs, ms);
+      }
+      {
+        BenchmarkTimer timer;
+        VK_CALL(gpu, vkInvalidateMappedMemoryRanges, device, 1, &range);
+        double ms = timer.elapsedMilliseconds();
+        invalidateMs = (invalidateMs < 0.0) ? ms : std::min(invalidateMs, ms);
+      }
+      {
+        // Uncached types show up here, reads go across the bus word by word
+        BenchmarkTimer timer;
+        uint64_t sum = 0;
+        for (size_t i = 0; i < wordCount; ++i) {
+          sum += pWords[i];
+        }
+        sink = sink + sum;
+        double ms = timer.elapsedMilliseconds();
+        readMs = (readMs < 0.0) ? ms : std::min(readMs, ms);
+      }
+    }
+    (void)sink;
+
+    pResult->writeGBs     = toGBs(size, writeMs);
+    pResult->readGBs      = toGBs(size, readMs);
+    pResult->flushUs      = flushMs * 1000.0;
+    pResult->invalidateUs = invalidateMs * 1000.0;
+
+    VK_CALL(gpu, vkUnmapMemory, device, memory);
+  }
+
+  context.destroyBuffer(buffer, memory);
+}
+
+static void benchmarkCopy(BenchmarkContext& context, uint32_t typeIndex, VkDeviceSize size, MemoryTypeBenchmark* pResult)
+{
+  VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+  VkBuffer srcBuffer = VK_NULL_HANDLE;
+  VkDeviceMemory srcMemory = VK_NULL_HANDLE;
+  VkBuffer dstBuffer = VK_NULL_HANDLE;
+  VkDeviceMemory dstMemory = VK_NULL_HANDLE;
+  if ((context.createBuffer(size, usage, typeIndex, &srcBuffer, &srcMemory) == VK_SUCCESS) &&
+      (context.createBuffer(size, usage, typeIndex, &dstBuffer, &dstMemory) == VK_SUCCESS)) {
+    double copyMs = -1.0;
+    for (int run = 0; run < RUN_COUNT; ++run) {
+      VkCommandBuffer cmd = context.beginCommands();
+      VkBufferCopy region = { 0, 0, size };
+      VK_CALL(context.gpu(), vkCmdCopyBuffer, cmd, srcBuffer, dstBuffer, 1, &region);
+      double ms = -1.0;
+      if (context.submitCommands(&ms) != VK_SUCCESS) {
+        break;
+      }
+      copyMs = (copyMs < 0.0) ? ms : std::min(copyMs, ms);
+    }
+    pResult->copyGBs = toGBs(size, copyMs);
+  }
+
+  context.destroyBuffer(dstBuffer, dstMemory);
+  context.destroyBuffer(srcBuffer, srcMemory);
+}
+
+std::vector<MemoryTypeBenchmark> runMemoryBenchmark(BenchmarkContext& context, VkDeviceSize size)
+{
+  TRACE_SCOPE("driver", "runMemoryBenchmark");
+
+  const VkPhysicalDeviceMemoryProperties& memoryProperties = context.memoryProperties();
+  std::vector<MemoryTypeBenchmark> results(memoryProperties.memoryTypeCount);
+
+  for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+    const VkMemoryType& type = memoryProperties.memoryTypes[i];
+    // Lazily allocated memory can't back buffers, protected memory needs a protected queue
+    if ((type.propertyFlags & (VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT | VK_MEMORY_PROPERTY_PROTECTED_BIT)) != 0) {
+      continue;
+    }
+
+    TRACE_SCOPE("driver", "memory type " + std::to_string(i));
+
+    // Leave room on small heaps, two copy buffers have to fit
+    VkDeviceSize heapSize = memoryProperties.memoryHeaps[type.heapIndex].size;
+    VkDeviceSize typeSize = std::min(size, heapSize / 4);
+    typeSize &= ~static_cast<VkDeviceSize>(0xFFFF);
+    if (typeSize == 0) {
+      continue;
+    }
+
+    if ((type.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0) {
+      benchmarkMapped(context, i, typeSize, &results[i]);
+    }
+    benchmarkCopy(context, i, typeSize, &results[i]);
+  }
+
+  return results;
+}
@@ -0,0 +1,23 @@
+#ifndef __MEMORY_BENCHMARK_H__
+#define __MEMORY_BENCHMARK_H__
+
+#include "Benchmark.h"
+
+#include <vector>
+
+//! Per memory type results, negative values mean not measured
+struct MemoryTypeBenchmark {
+  double  writeGBs = -1.0;      // Mapped sequential write
+  double  readGBs = -1.0;       // Mapped sequential read
+  double  flushUs = -1.0;       // vkFlushMappedMemoryRanges over the whole buffer
+  double  invalidateUs = -1.0;  // vkInvalidateMappedMemoryRanges over the whole buffer
+  double  copyGBs = -1.0;       // vkCmdCopyBuffer within the type
+};
+
+//! Allocates up to size bytes from each memory type in turn. Host visible
+//! types are mapped and timed on the CPU, every type is also timed with a
+//! GPU copy. Best of a few runs is kept to hide page faults and clocks
+//! ramping up.
+std::vector<MemoryTypeBenchmark> runMemoryBenchmark(BenchmarkContext& context, VkDeviceSize size);
+
+#endif // __MEMORY_BENCHMARK_H__
@@ -0,0 +1,159 @@
+#include "MemoryBudgetMonitor.h"
+
+#include <QCoreApplication>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+#define RING_CAPACITY   1024
+
+MemoryBudgetMonitor::MemoryBudgetMonitor()
+  : mRing(RING_CAPACITY)
+{
+  mSharedMemory.setKey(sharedMemoryKey());
+}
+
+MemoryBudgetMonitor::~MemoryBudgetMonitor()
+{
+  stop();
+}
+
+bool MemoryBudgetMonitor::isSupported(const ExtensionSet& extensions)
+{
+#if defined(VK_EXT_memory_budget)
+  static const uint32_t sMemoryBudgetId = ExtensionRegistry::get().intern(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+  return extensions.contains(sMemoryBudgetId);
+#else
+  (void)extensions;
+#endif
+  return false;
+}
+
+QString MemoryBudgetMonitor::sharedMemoryKey() const
+{
+  return QString("VulkanInfoViewer.MemoryBudget.%1").arg(QCoreApplication::applicationPid());
+}
+
+void MemoryBudgetMonitor::start(VkPhysicalDevice gpu, uint32_t rateHz)
+{
+  stop();
+
+  mGpu = gpu;
+  mRateHz = (rateHz > 0) ? rateHz : 1;
+  mStopRequested = false;
+
+  // Sharing is best effort, sampling works without it
+  if (mSharedHeader == nullptr) {
+    int size = static_cast<int>(sizeof(SharedHeader) + kSharedCapacity * sizeof(SharedSlot));
+    if (mSharedMemory.create(size) || mSharedMemory.attach()) {
+      mSharedHeader = new (mSharedMemory.data()) SharedHeader();
+      mSharedHeader->magic      = kSharedMagic;
+      mSharedHeader->version    = kSharedVersion;
+      mSharedHeader->capacity   = kSharedCapacity;
+      mSharedHeader->slotSize   = sizeof(SharedSlot);
+      mSharedHeader->writeCount.store(0, std::memory_order_relaxed);
+      mSharedSlots = reinterpret_cast<SharedSlot*>(reinterpret_cast<char*>(mSharedHeader) + sizeof(SharedHeader));
+      for (int i = 0; i < kSharedCapacity; ++i) {
+        new (&mSharedSlots[i].sequence) std::atomic<uint64_t>(0);
+      }
+    }
+  }
+
+  mThread = std::thread(&MemoryBudgetMonitor::run, this);
+}
+
+void MemoryBudgetMonitor::stop()
+{
+  if (! mThread.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopRequested = true;
+  }
+  mStopCondition.notify_all();
+  mThread.join();
+}
+
+size_t MemoryBudgetMonitor::drain(std::vector<Sample>* pSamples)
+{
+  size_t count = 0;
+  Sample sample;
+  while (mRing.pop(&sample)) {
+    pSamples->push_back(sample);
+    ++count;
+  }
+  return count;
+}
+
+void MemoryBudgetMonitor::publish(const Sample& sample)
+{
+  if (mSharedHeader == nullptr) {
+    return;
+  }
+
+  // The release fence keeps the sample stores after the odd sequence
+  uint64_t n = mSharedHeader->writeCount.load(std::memory_order_relaxed);
+  SharedSlot& slot = mSharedSlots[n % kSharedCapacity];
+  slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.sample = sample;
+  slot.sequence.store(2 * n + 2, std::memory_order_release);
+  mSharedHeader->writeCount.store(n + 1, std::memory_order_release);
+}
+
+bool MemoryBudgetMonitor::readSharedSample(const SharedHeader* pHeader, uint64_t n, Sample* pSample)
+{
+  if ((pHeader->version != kSharedVersion) || (pHeader->slotSize != sizeof(SharedSlot)) || (pHeader->capacity == 0)) {
+    return false;
+  }
+
+  const SharedSlot* pSlots = reinterpret_cast<const SharedSlot*>(reinterpret_cast<const char*>(pHeader) + sizeof(SharedHeader));
+  const SharedSlot& slot = pSlots[n % pHeader->capacity];
+  uint64_t expected = 2 * n + 2;
+  if (slot.sequence.load(std::memory_order_acquire) != expected) {
+    return false;
+  }
+  *pSample = slot.sample;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return (slot.sequence.load(std::memory_order_relaxed) == expected);
+}
+
+void MemoryBudgetMonitor::run()
+{
+#if defined(VK_EXT_memory_budget)
+  using clock = std::chrono::steady_clock;
+  const auto period = std::chrono::microseconds(1000000 / mRateHz);
+  const auto epoch = clock::now();
+  auto next = epoch;
+
+  for (;;) {
+    // Not routed through VK_CALL, the profiler's lock would cost more than the query
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT };
+    VkPhysicalDeviceMemoryProperties2 properties2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2 };
+    properties2.pNext = &budget;
+    vkGetPhysicalDeviceMemoryProperties2(mGpu, &properties2);
+
+    Sample sample;
+    sample.timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - epoch).count();
+    sample.heapCount = properties2.memoryProperties.memoryHeapCount;
+    memcpy(sample.heapBudget, budget.heapBudget, sizeof(sample.heapBudget));
+    memcpy(sample.heapUsage, budget.heapUsage, sizeof(sample.heapUsage));
+
+    if (! mRing.push(sample)) {
+      mDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    publish(sample);
+
+    // Fixed rate, a slow query doesn't shift later samples
+    next += period;
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mStopCondition.wait_until(lock, next, [this]() { return mStopRequested; })) {
+      break;
+    }
+  }
+#endif
+}
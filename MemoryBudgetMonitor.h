@@ -0,0 +1,102 @@
+#ifndef __MEMORY_BUDGET_MONITOR_H__
+#define __MEMORY_BUDGET_MONITOR_H__
+
+#include "ExtensionSet.h"
+#include "SpscRing.h"
+
+#include <QSharedMemory>
+#include <QString>
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! \class MemoryBudgetMonitor
+//!
+//! Samples VK_EXT_memory_budget heapBudget/heapUsage on a dedicated thread.
+//! Each sample is a single vkGetPhysicalDeviceMemoryProperties2 call pushed
+//! into a lock-free ring the UI drains on its own schedule, samples are
+//! dropped rather than ever blocking the sampler.
+//!
+//! Samples are also published to other processes through a QSharedMemory
+//! segment named by sharedMemoryKey(), laid out as a SharedHeader followed
+//! by SharedHeader::capacity SharedSlots. Sample n lives in slot
+//! n % capacity and each slot is a seqlock: the writer stores 2n + 1 to
+//! sequence before copying the sample in and 2n + 2 after, then bumps
+//! writeCount to n + 1. A reader wanting sample n loads sequence with
+//! acquire, copies the sample, loads sequence again after an acquire
+//! fence and keeps the copy only if both loads were 2n + 2. Anything else
+//! means the slot was being written or has been lapped, so the sample is
+//! gone and the reader moves on. readSharedSample() does exactly that.
+//!
+class MemoryBudgetMonitor {
+public:
+  enum {
+    kSharedMagic    = 0x42564956, // "VIVB"
+    kSharedVersion  = 2,
+    kSharedCapacity = 4096,
+  };
+
+  struct Sample {
+    int64_t   timestampUs;
+    uint32_t  heapCount;
+    uint64_t  heapBudget[VK_MAX_MEMORY_HEAPS];
+    uint64_t  heapUsage[VK_MAX_MEMORY_HEAPS];
+  };
+
+  struct SharedHeader {
+    uint32_t              magic;
+    uint32_t              version;
+    uint32_t              capacity;
+    uint32_t              slotSize;
+    std::atomic<uint64_t> writeCount;
+  };
+
+  struct SharedSlot {
+    std::atomic<uint64_t> sequence;     // Odd while being written
+    Sample                sample;
+  };
+
+  MemoryBudgetMonitor();
+  ~MemoryBudgetMonitor();
+
+  static bool isSupported(const ExtensionSet& extensions);
+
+  void    start(VkPhysicalDevice gpu, uint32_t rateHz);
+  void    stop();
+  bool    isRunning() const { return mThread.joinable(); }
+
+  //! Consumer side of the ring, call from one thread only
+  size_t  drain(std::vector<Sample>* pSamples);
+  uint64_t droppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+
+  QString sharedMemoryKey() const;
+
+  //! Reader side of the shared segment, false if sample n is being written
+  //! or has already been overwritten
+  static bool readSharedSample(const SharedHeader* pHeader, uint64_t n, Sample* pSample);
+
+private:
+  void    run();
+  void    publish(const Sample& sample);
+
+private:
+  VkPhysicalDevice        mGpu = VK_NULL_HANDLE;
+  uint32_t                mRateHz = 10;
+  std::thread             mThread;
+  std::mutex              mMutex;
+  std::condition_variable mStopCondition;
+  bool                    mStopRequested = false;
+  SpscRing<Sample>        mRing;
+  std::atomic<uint64_t>   mDropped { 0 };
+  QSharedMemory           mSharedMemory;
+  SharedHeader*           mSharedHeader = nullptr;
+  SharedSlot*             mSharedSlots = nullptr;
+};
+
+#endif // __MEMORY_BUDGET_MONITOR_H__
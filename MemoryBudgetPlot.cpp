@@ -0,0 +1,122 @@
+#include "MemoryBudgetPlot.h"
+
+#include <QPainter>
+#include <QPainterPath>
+
+#include <algorithm>
+
+#define MARGIN  8
+
+MemoryBudgetPlot::MemoryBudgetPlot(QWidget* parent)
+  : QWidget(parent)
+{
+  setMinimumHeight(160);
+  setAutoFillBackground(true);
+  setBackgroundRole(QPalette::Base);
+}
+
+void MemoryBudgetPlot::clear()
+{
+  mSamples.clear();
+  update();
+}
+
+void MemoryBudgetPlot::setWindowSeconds(double seconds)
+{
+  mWindowUs = static_cast<int64_t>(seconds * 1000000.0);
+  update();
+}
+
+void MemoryBudgetPlot::appendSamples(const std::vector<MemoryBudgetMonitor::Sample>& samples)
+{
+  if (samples.empty()) {
+    return;
+  }
+
+  mSamples.insert(mSamples.end(), samples.begin(), samples.end());
+
+  int64_t oldest = mSamples.back().timestampUs - mWindowUs;
+  while ((mSamples.size() > 2) && (mSamples[1].timestampUs < oldest)) {
+    mSamples.pop_front();
+  }
+
+  update();
+}
+
+void MemoryBudgetPlot::paintEvent(QPaintEvent* event)
+{
+  QWidget::paintEvent(event);
+
+  QPainter painter(this);
+  painter.setRenderHint(QPainter::Antialiasing);
+
+  QRectF area = QRectF(rect()).adjusted(MARGIN, MARGIN, -MARGIN, -MARGIN);
+  painter.setPen(palette().color(QPalette::Mid));
+  painter.drawRect(area);
+
+  if (mSamples.empty()) {
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawText(area, Qt::AlignCenter, "No samples");
+    return;
+  }
+
+  const MemoryBudgetMonitor::Sample& latest = mSamples.back();
+  uint32_t heapCount = latest.heapCount;
+
+  uint64_t maxBytes = 1;
+  for (const auto& sample : mSamples) {
+    for (uint32_t i = 0; i < std::min(heapCount, sample.heapCount); ++i) {
+      maxBytes = std::max(maxBytes, std::max(sample.heapBudget[i], sample.heapUsage[i]));
+    }
+  }
+
+  int64_t start = latest.timestampUs - mWindowUs;
+  auto toPoint = [&](int64_t timestampUs, uint64_t bytes) -> QPointF {
+    double x = area.left() + area.width() * static_cast<double>(timestampUs - start) / static_cast<double>(mWindowUs);
+    double y = area.bottom() - area.height() * static_cast<double>(bytes) / static_cast<double>(maxBytes);
+    return QPointF(std::max(x, area.left()), y);
+  };
+
+  static const Qt::GlobalColor sColors[] = { Qt::blue, Qt::red, Qt::darkGreen, Qt::magenta, Qt::darkCyan, Qt::darkYellow };
+  const size_t colorCount = sizeof(sColors) / sizeof(sColors[0]);
+
+  QFontMetrics fm = painter.fontMetrics();
+  for (uint32_t heap = 0; heap < heapCount; ++heap) {
+    QPainterPath usagePath;
+    QPainterPath budgetPath;
+    bool first = true;
+    for (const auto& sample : mSamples) {
+      if (heap >= sample.heapCount) {
+        continue;
+      }
+      QPointF usage = toPoint(sample.timestampUs, sample.heapUsage[heap]);
+      QPointF budget = toPoint(sample.timestampUs, sample.heapBudget[heap]);
+      if (first) {
+        usagePath.moveTo(usage);
+        budgetPath.moveTo(budget);
+        first = false;
+      }
+      else {
+        usagePath.lineTo(usage);
+        budgetPath.lineTo(budget);
+      }
+    }
+
+    QColor color = sColors[heap % colorCount];
+    painter.setPen(QPen(color, 1.5, Qt::SolidLine));
+    painter.drawPath(usagePath);
+    painter.setPen(QPen(color, 1.0, Qt::DashLine));
+    painter.drawPath(budgetPath);
+
+    QString legend = QString("Heap %1: %2 / %3 MB")
+      .arg(heap)
+      .arg(latest.heapUsage[heap] / 1048576.0, 0, 'f', 1)
+      .arg(latest.heapBudget[heap] / 1048576.0, 0, 'f', 1);
+    painter.setPen(color);
+    painter.drawText(QPointF(area.left() + 4, area.top() + (heap + 1) * fm.height()), legend);
+  }
+
+  painter.setPen(palette().color(QPalette::Text));
+  painter.drawText(area.adjusted(0, 0, -4, 0), Qt::AlignRight | Qt::AlignTop,
+                   QString("%1 MB").arg(maxBytes / 1048576.0, 0, 'f', 0));
+}
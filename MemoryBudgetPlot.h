@@ -0,0 +1,33 @@
+#ifndef __MEMORY_BUDGET_PLOT_H__
+#define __MEMORY_BUDGET_PLOT_H__
+
+#include "MemoryBudgetMonitor.h"
+
+#include <QWidget>
+
+#include <deque>
+#include <vector>
+
+//! \class MemoryBudgetPlot
+//!
+//! Usage (solid) and budget (dashed) per heap over the last window of
+//! samples. Promoted from a plain QWidget in mainwindow.ui.
+//!
+class MemoryBudgetPlot : public QWidget {
+  Q_OBJECT
+public:
+  explicit MemoryBudgetPlot(QWidget* parent = nullptr);
+
+  void  clear();
+  void  appendSamples(const std::vector<MemoryBudgetMonitor::Sample>& samples);
+  void  setWindowSeconds(double seconds);
+
+protected:
+  virtual void paintEvent(QPaintEvent* event);
+
+private:
+  std::deque<MemoryBudgetMonitor::Sample> mSamples;
+  int64_t                                 mWindowUs = 60 * 1000000;
+};
+
+#endif // __MEMORY_BUDGET_PLOT_H__
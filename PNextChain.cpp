@@ -0,0 +1,156 @@
+#include "PNextChain.h"
+#include "Trace.h"
+#include "VkProfiler.h"
+
+
+// Every chained struct starts with these two members
+struct ChainHeader {
+  VkStructureType sType;
+  void*           pNext;
+};
+
+struct ChainStruct {
+  const char*     extensionName;  // nullptr for core only structs
+  uint32_t        coreVersion;    // 0 for extension only structs
+  bool            feature;
+  VkStructureType sType;
+  size_t          size;
+};
+
+#define PROPERTIES(ext, core, type, sType)  { ext, core, false, sType, sizeof(type) }
+#define FEATURES(ext, core, type, sType)    { ext, core, true, sType, sizeof(type) }
+
+// New structs only need a line here, lookups go through PNextChain::find
+static const ChainStruct sChainStructs[] = {
+  PROPERTIES(nullptr,                                   VK_API_VERSION_1_1, VkPhysicalDeviceIDProperties,                         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES),
+  PROPERTIES(nullptr,                                   VK_API_VERSION_1_1, VkPhysicalDeviceSubgroupProperties,                   VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES),
+  PROPERTIES(nullptr,                                   VK_API_VERSION_1_1, VkPhysicalDeviceProtectedMemoryProperties,            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROTECTED_MEMORY_PROPERTIES),
+  PROPERTIES(VK_KHR_MAINTENANCE2_EXTENSION_NAME,        VK_API_VERSION_1_1, VkPhysicalDevicePointClippingProperties,              VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_POINT_CLIPPING_PROPERTIES),
+  PROPERTIES(VK_KHR_MAINTENANCE3_EXTENSION_NAME,        VK_API_VERSION_1_1, VkPhysicalDeviceMaintenance3Properties,               VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_3_PROPERTIES),
+  PROPERTIES(VK_KHR_MULTIVIEW_EXTENSION_NAME,           VK_API_VERSION_1_1, VkPhysicalDeviceMultiviewProperties,                  VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_PROPERTIES),
+  PROPERTIES(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME,     0,                  VkPhysicalDevicePushDescriptorPropertiesKHR,          VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR),
+  PROPERTIES(VK_EXT_BLEND_OPERATION_ADVANCED_EXTENSION_NAME, 0,             VkPhysicalDeviceBlendOperationAdvancedPropertiesEXT,  VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BLEND_OPERATION_ADVANCED_PROPERTIES_EXT),
+  PROPERTIES(VK_EXT_CONSERVATIVE_RASTERIZATION_EXTENSION_NAME, 0,           VkPhysicalDeviceConservativeRasterizationPropertiesEXT, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CONSERVATIVE_RASTERIZATION_PROPERTIES_EXT),
+  PROPERTIES(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME, 0,                  VkPhysicalDeviceDescriptorIndexingPropertiesEXT,      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT),
+  PROPERTIES(VK_EXT_DISCARD_RECTANGLES_EXTENSION_NAME,  0,                  VkPhysicalDeviceDiscardRectanglePropertiesEXT,        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DISCARD_RECTANGLE_PROPERTIES_EXT),
+  PROPERTIES(VK_EXT_SAMPLE_LOCATIONS_EXTENSION_NAME,    0,                  VkPhysicalDeviceSampleLocationsPropertiesEXT,         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SAMPLE_LOCATIONS_PROPERTIES_EXT),
+  PROPERTIES(VK_EXT_SAMPLER_FILTER_MINMAX_EXTENSION_NAME, 0,                VkPhysicalDeviceSamplerFilterMinmaxPropertiesEXT,     VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SAMPLER_FILTER_MINMAX_PROPERTIES_EXT),
+  PROPERTIES(VK_AMD_SHADER_CORE_PROPERTIES_EXTENSION_NAME, 0,               VkPhysicalDeviceShaderCorePropertiesAMD,              VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_CORE_PROPERTIES_AMD),
+
+  FEATURES(nullptr,                                     VK_API_VERSION_1_1, VkPhysicalDeviceProtectedMemoryFeatures,              VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROTECTED_MEMORY_FEATURES),
+  FEATURES(VK_KHR_16BIT_STORAGE_EXTENSION_NAME,         VK_API_VERSION_1_1, VkPhysicalDevice16BitStorageFeatures,                 VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES),
+  FEATURES(VK_KHR_MULTIVIEW_EXTENSION_NAME,             VK_API_VERSION_1_1, VkPhysicalDeviceMultiviewFeatures,                    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES),
+  FEATURES(VK_KHR_SAMPLER_YCBCR_CONVERSION_EXTENSION_NAME, VK_API_VERSION_1_1, VkPhysicalDeviceSamplerYcbcrConversionFeatures,    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SAMPLER_YCBCR_CONVERSION_FEATURES),
+  FEATURES(VK_KHR_VARIABLE_POINTERS_EXTENSION_NAME,     VK_API_VERSION_1_1, VkPhysicalDeviceVariablePointerFeatures,              VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VARIABLE_POINTER_FEATURES),
+  FEATURES(VK_EXT_BLEND_OPERATION_ADVANCED_EXTENSION_NAME, 0,               VkPhysicalDeviceBlendOperationAdvancedFeaturesEXT,    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BLEND_OPERATION_ADVANCED_FEATURES_EXT),
+  FEATURES(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,   0,                  VkPhysicalDeviceDescriptorIndexingFeaturesEXT,        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT),
+};
+
+static size_t alignedSize(size_t size)
+{
+  return (size + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+}
+
+PNextChain::PNextChain(const PNextChain& other)
+  : mArena(other.mArena),
+    mLinks(other.mLinks)
+{
+  relink();
+}
+
+PNextChain& PNextChain::operator=(const PNextChain& other)
+{
+  if (this != &other) {
+    mArena = other.mArena;
+    mLinks = other.mLinks;
+    relink();
+  }
+  return *this;
+}
+
+std::vector<const char*> PNextChain::extensionNames()
+{
+  std::vector<const char*> names;
+  for (const auto& entry : sChainStructs) {
+    if (entry.extensionName != nullptr) {
+      names.push_back(entry.extensionName);
+    }
+  }
+  return names;
+}
+
+void PNextChain::build(uint32_t apiVersion, const ExtensionSet& extensions)
+{
+  TRACE_SCOPE("vulkan", "PNextChain::build");
+
+  mLinks.clear();
+  size_t size = 0;
+  auto append = [this, &size](VkStructureType sType, size_t structSize, bool feature) {
+    mLinks.push_back({ sType, size, feature });
+    size += alignedSize(structSize);
+  };
+
+  append(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, sizeof(VkPhysicalDeviceProperties2), false);
+  append(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, sizeof(VkPhysicalDeviceFeatures2), true);
+  for (const auto& entry : sChainStructs) {
+    bool core = (entry.coreVersion != 0) && (apiVersion >= entry.coreVersion);
+    bool extension = (entry.extensionName != nullptr) && extensions.contains(entry.extensionName);
+    if (core || extension) {
+      append(entry.sType, entry.size, entry.feature);
+    }
+  }
+
+  // Zeroed, so every output member not written by the driver reads as 0
+  mArena.assign(size / sizeof(uint64_t), 0);
+  for (const auto& link : mLinks) {
+    reinterpret_cast<ChainHeader*>(reinterpret_cast<char*>(mArena.data()) + link.offset)->sType = link.sType;
+  }
+  relink();
+}
+
+void PNextChain::relink()
+{
+  char* base = reinterpret_cast<char*>(mArena.data());
+  ChainHeader* tails[2] = {};
+  for (const auto& link : mLinks) {
+    ChainHeader* header = reinterpret_cast<ChainHeader*>(base + link.offset);
+    header->pNext = nullptr;
+    ChainHeader*& tail = tails[link.feature ? 1 : 0];
+    if (tail != nullptr) {
+      tail->pNext = header;
+    }
+    tail = header;
+  }
+}
+
+void PNextChain::query(VkPhysicalDevice gpu)
+{
+  if (mLinks.empty()) {
+    return;
+  }
+
+  VK_CALL(gpu, vkGetPhysicalDeviceProperties2, gpu,
+          reinterpret_cast<VkPhysicalDeviceProperties2*>(reinterpret_cast<char*>(mArena.data()) + mLinks[0].offset));
+  VK_CALL(gpu, vkGetPhysicalDeviceFeatures2, gpu,
+          reinterpret_cast<VkPhysicalDeviceFeatures2*>(reinterpret_cast<char*>(mArena.data()) + mLinks[1].offset));
+}
+
+const VkPhysicalDeviceProperties2* PNextChain::properties2() const
+{
+  return find<VkPhysicalDeviceProperties2>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2);
+}
+
+const VkPhysicalDeviceFeatures2* PNextChain::features2() const
+{
+  return find<VkPhysicalDeviceFeatures2>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2);
+}
+
+const void* PNextChain::findStruct(VkStructureType sType) const
+{
+  for (const auto& link : mLinks) {
+    if (link.sType == sType) {
+      return reinterpret_cast<const char*>(mArena.data()) + link.offset;
+    }
+  }
+  return nullptr;
+}
@@ -0,0 +1,63 @@
+#ifndef __PNEXT_CHAIN_H__
+#define __PNEXT_CHAIN_H__
+
+#include "ExtensionSet.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//! \class PNextChain
+//!
+//! Every extended property and feature struct a device supports, chained
+//! behind one VkPhysicalDeviceProperties2 and one VkPhysicalDeviceFeatures2
+//! in a single allocation. build() checks the device's extension set
+//! against the table in PNextChain.cpp, query() fills everything with one
+//! call of each, so adding a struct to the table doesn't add driver calls.
+//!
+//! The chains point into the arena, copies relink their own.
+//!
+class PNextChain {
+public:
+  PNextChain() {}
+  PNextChain(const PNextChain& other);
+  PNextChain& operator=(const PNextChain& other);
+
+  //! Every extension the table depends on, registered once by ExtensionRegistry
+  static std::vector<const char*> extensionNames();
+
+  //! Lays out the structs enabled by apiVersion or by an extension in extensions
+  void  build(uint32_t apiVersion, const ExtensionSet& extensions);
+  //! One vkGetPhysicalDeviceProperties2 and one vkGetPhysicalDeviceFeatures2 call
+  void  query(VkPhysicalDevice gpu);
+
+  //! Null before build()
+  const VkPhysicalDeviceProperties2*  properties2() const;
+  const VkPhysicalDeviceFeatures2*    features2() const;
+
+  //! The struct with sType from either chain, null if the device doesn't have it
+  template <typename T>
+  const T*  find(VkStructureType sType) const {
+    return static_cast<const T*>(findStruct(sType));
+  }
+
+  size_t    structCount() const { return mLinks.size(); }
+
+private:
+  struct Link {
+    VkStructureType sType;
+    size_t          offset;     // in bytes from the start of the arena
+    bool            feature;
+  };
+
+  const void* findStruct(VkStructureType sType) const;
+  void        relink();
+
+private:
+  std::vector<uint64_t> mArena;
+  std::vector<Link>     mLinks;       // [0] properties2, [1] features2, then the table order
+};
+
+#endif // __PNEXT_CHAIN_H__
@@ -0,0 +1,101 @@
+#include "PipelineCacheInspector.h"
+#include "Trace.h"
+
+#include <QFile>
+
+#include <algorithm>
+#include <cstring>
+
+// headerSize, headerVersion, vendorID, deviceID, pipelineCacheUUID
+#define PIPELINE_CACHE_HEADER_SIZE  (4 * sizeof(uint32_t) + VK_UUID_SIZE)
+
+// The spec stores the header fields least significant byte first
+static uint32_t readU32(const char* pData)
+{
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(pData);
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+bool readPipelineCacheHeader(const QString& filePath, PipelineCacheHeader* pHeader)
+{
+  TRACE_SCOPE("qt", "readPipelineCacheHeader");
+
+  *pHeader = PipelineCacheHeader();
+  pHeader->filePath = filePath;
+
+  QFile file(filePath);
+  if (! file.open(QIODevice::ReadOnly)) {
+    pHeader->error = "Unable to open";
+    return false;
+  }
+  pHeader->fileSize = file.size();
+
+  QByteArray data = file.read(PIPELINE_CACHE_HEADER_SIZE);
+  if (static_cast<size_t>(data.size()) < PIPELINE_CACHE_HEADER_SIZE) {
+    pHeader->error = "Too small for a header";
+    return false;
+  }
+
+  const char* pData = data.constData();
+  pHeader->headerSize    = readU32(pData + 0);
+  pHeader->headerVersion = readU32(pData + 4);
+  pHeader->vendorID      = readU32(pData + 8);
+  pHeader->deviceID      = readU32(pData + 12);
+  std::memcpy(pHeader->pipelineCacheUUID, pData + 16, VK_UUID_SIZE);
+
+  if (pHeader->headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+    pHeader->error = QString("Unknown header version %1").arg(pHeader->headerVersion);
+    return false;
+  }
+  if ((pHeader->headerSize < PIPELINE_CACHE_HEADER_SIZE) || (pHeader->headerSize > pHeader->fileSize)) {
+    pHeader->error = QString("Bad header size %1").arg(pHeader->headerSize);
+    return false;
+  }
+
+  pHeader->valid = true;
+  return true;
+}
+
+static bool isSameKey(uint32_t vendorA, uint32_t deviceA, const uint8_t* uuidA,
+                      uint32_t vendorB, uint32_t deviceB, const uint8_t* uuidB)
+{
+  return (vendorA == vendorB) && (deviceA == deviceB) && (std::memcmp(uuidA, uuidB, VK_UUID_SIZE) == 0);
+}
+
+bool isPipelineCacheCompatible(const PipelineCacheHeader& header, const PipelineCacheTarget& target)
+{
+  return header.valid &&
+         isSameKey(header.vendorID, header.deviceID, header.pipelineCacheUUID,
+                   target.vendorID, target.deviceID, target.pipelineCacheUUID);
+}
+
+std::vector<PipelineCacheGroup> groupPipelineCacheTargets(
+  const std::vector<PipelineCacheTarget>& targets,
+  const std::vector<PipelineCacheHeader>& headers)
+{
+  // Fleets are small, a linear search keeps first seen order
+  std::vector<PipelineCacheGroup> groups;
+  for (size_t i = 0; i < targets.size(); ++i) {
+    const PipelineCacheTarget& target = targets[i];
+    auto it = std::find_if(groups.begin(), groups.end(), [&target](const PipelineCacheGroup& group) {
+      return isSameKey(group.vendorID, group.deviceID, group.pipelineCacheUUID,
+                       target.vendorID, target.deviceID, target.pipelineCacheUUID);
+    });
+    if (it == groups.end()) {
+      PipelineCacheGroup group;
+      group.vendorID = target.vendorID;
+      group.deviceID = target.deviceID;
+      std::memcpy(group.pipelineCacheUUID, target.pipelineCacheUUID, VK_UUID_SIZE);
+      for (size_t j = 0; j < headers.size(); ++j) {
+        if (isPipelineCacheCompatible(headers[j], target)) {
+          group.caches.push_back(j);
+        }
+      }
+      groups.push_back(group);
+      it = groups.end() - 1;
+    }
+    it->targets.push_back(i);
+  }
+  return groups;
+}
@@ -0,0 +1,56 @@
+#ifndef __PIPELINE_CACHE_INSPECTOR_H__
+#define __PIPELINE_CACHE_INSPECTOR_H__
+
+#include <QString>
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+//! Header of a VkPipelineCache blob (VK_PIPELINE_CACHE_HEADER_VERSION_ONE),
+//! the only part of the data the spec defines. Drivers reject a cache whose
+//! vendor ID, device ID or pipelineCacheUUID differ from the device's.
+struct PipelineCacheHeader {
+  QString   filePath;
+  qint64    fileSize = 0;
+  bool      valid = false;
+  QString   error;
+  uint32_t  headerSize = 0;
+  uint32_t  headerVersion = 0;
+  uint32_t  vendorID = 0;
+  uint32_t  deviceID = 0;
+  uint8_t   pipelineCacheUUID[VK_UUID_SIZE] = {};
+};
+
+//! A device a cache could be shipped to, either a live GPU or a device
+//! from a saved snapshot (DeviceProfileSet file)
+struct PipelineCacheTarget {
+  QString   name;
+  QString   source;
+  uint32_t  vendorID = 0;
+  uint32_t  deviceID = 0;
+  uint8_t   pipelineCacheUUID[VK_UUID_SIZE] = {};
+};
+
+//! Targets sharing vendor ID, device ID and UUID, one prebuilt cache serves
+//! all of them
+struct PipelineCacheGroup {
+  uint32_t              vendorID = 0;
+  uint32_t              deviceID = 0;
+  uint8_t               pipelineCacheUUID[VK_UUID_SIZE] = {};
+  std::vector<size_t>   targets;
+  std::vector<size_t>   caches;
+};
+
+//! Only reads the header, the rest of the blob is driver private
+bool readPipelineCacheHeader(const QString& filePath, PipelineCacheHeader* pHeader);
+
+bool isPipelineCacheCompatible(const PipelineCacheHeader& header, const PipelineCacheTarget& target);
+
+//! Groups targets in first seen order and attaches every valid cache that
+//! matches a group. Indices refer to the input vectors.
+std::vector<PipelineCacheGroup> groupPipelineCacheTargets(
+  const std::vector<PipelineCacheTarget>& targets,
+  const std::vector<PipelineCacheHeader>& headers);
+
+#endif // __PIPELINE_CACHE_INSPECTOR_H__
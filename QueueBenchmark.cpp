@@ -0,0 +1,183 @@
+#include "QueueBenchmark.h"
+#include "MemoryAccounting.h"
+#include "Trace.h"
+#include "VkProfiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <thread>
+
+#define LATENCY_SUBMIT_COUNT      200
+#define THROUGHPUT_SUBMIT_COUNT   500
+#define MAX_THREADS_PER_FAMILY    4
+
+struct SubmitTarget {
+  VkQueue queue = VK_NULL_HANDLE;
+  VkFence fence = VK_NULL_HANDLE;
+  double  milliseconds = -1.0;
+};
+
+// Recorded once per loop by the callers, after their own timing
+static const char* kSubmitLoopFunction = "submitLoop (vkQueueSubmit, vkWaitForFences, vkResetFences)";
+
+// Empty submits, each waited on before the next one. The entry points are
+// called directly, VK_CALL's lock would serialize concurrent loops and
+// show up in the round trips.
+static bool submitLoop(BenchmarkContext& context, VkQueue queue, VkFence fence, int count, std::vector<double>* pRoundTripsUs)
+{
+  VkDevice device = context.device();
+  for (int i = 0; i < count; ++i) {
+    BenchmarkTimer timer;
+    if (vkQueueSubmit(queue, 0, nullptr, fence) != VK_SUCCESS) {
+      return false;
+    }
+    if (vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX) != VK_SUCCESS) {
+      return false;
+    }
+    if (pRoundTripsUs != nullptr) {
+      pRoundTripsUs->push_back(timer.elapsedMilliseconds() * 1000.0);
+    }
+    vkResetFences(device, 1, &fence);
+  }
+  return true;
+}
+
+// One thread per target, released together so the submissions overlap
+static bool runConcurrent(BenchmarkContext& context, std::vector<SubmitTarget>* pTargets)
+{
+  std::atomic<bool> go(false);
+  std::atomic<bool> ok(true);
+  std::vector<std::thread> threads;
+  for (auto& target : *pTargets) {
+    SubmitTarget* pTarget = &target;
+    threads.push_back(std::thread([&context, &go, &ok, pTarget]() {
+      while (! go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      BenchmarkTimer timer;
+      if (! submitLoop(context, pTarget->queue, pTarget->fence, THROUGHPUT_SUBMIT_COUNT, nullptr)) {
+        ok = false;
+      }
+      pTarget->milliseconds = timer.elapsedMilliseconds();
+      VkProfiler::get().record(kSubmitLoopFunction, context.gpu(), static_cast<uint64_t>(pTarget->milliseconds * 1000000.0));
+    }));
+  }
+  go.store(true, std::memory_order_release);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return ok;
+}
+
+static double toRate(const SubmitTarget& target)
+{
+  return (target.milliseconds > 0.0) ? (THROUGHPUT_SUBMIT_COUNT * 1000.0 / target.milliseconds) : -1.0;
+}
+
+std::vector<QueueFamilyBenchmark> runQueueBenchmark(BenchmarkContext& context)
+{
+  TRACE_SCOPE("driver", "runQueueBenchmark");
+
+  VkPhysicalDevice gpu = context.gpu();
+  VkDevice device = context.device();
+  const auto& families = context.queueFamilies();
+  std::vector<QueueFamilyBenchmark> results(families.size());
+
+  // One fence per potential thread
+  std::vector<VkFence> fences(MAX_THREADS_PER_FAMILY + families.size(), VK_NULL_HANDLE);
+  for (auto& fence : fences) {
+    VkFenceCreateInfo createInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+    if (VK_CALL(gpu, vkCreateFence, device, &createInfo, MemoryAccounting::get().allocator(), &fence) != VK_SUCCESS) {
+      fence = VK_NULL_HANDLE;
+    }
+  }
+  bool fencesValid = std::none_of(fences.begin(), fences.end(), [](VkFence fence) { return fence == VK_NULL_HANDLE; });
+
+  for (uint32_t i = 0; fencesValid && (i < families.size()); ++i) {
+    if (families[i].queueCount == 0) {
+      continue;
+    }
+    TRACE_SCOPE("driver", "queue family " + std::to_string(i));
+
+    QueueFamilyBenchmark& result = results[i];
+    VkQueue queue = context.queue(i, 0);
+
+    // Latency and jitter, after a short warm up
+    std::vector<double> roundTripsUs;
+    submitLoop(context, queue, fences[0], 10, nullptr);
+    bool latencyOk = false;
+    {
+      VkProfileScope profileScope(kSubmitLoopFunction, gpu);
+      latencyOk = submitLoop(context, queue, fences[0], LATENCY_SUBMIT_COUNT, &roundTripsUs);
+    }
+    if (latencyOk) {
+      std::vector<double> sorted = roundTripsUs;
+      std::sort(sorted.begin(), sorted.end());
+      result.latencyUs = sorted[sorted.size() / 2];
+
+      double mean = 0.0;
+      for (double us : roundTripsUs) {
+        mean += us;
+      }
+      mean /= roundTripsUs.size();
+      double variance = 0.0;
+      for (double us : roundTripsUs) {
+        variance += (us - mean) * (us - mean);
+      }
+      result.jitterUs = std::sqrt(variance / roundTripsUs.size());
+    }
+
+    // One thread
+    std::vector<SubmitTarget> targets(1);
+    targets[0].queue = queue;
+    targets[0].fence = fences[0];
+    if (runConcurrent(context, &targets)) {
+      result.singleRate = toRate(targets[0]);
+    }
+
+    // N threads, N queues of this family
+    uint32_t threadCount = std::min<uint32_t>(families[i].queueCount, MAX_THREADS_PER_FAMILY);
+    if (threadCount > 1) {
+      targets.resize(threadCount);
+      for (uint32_t t = 0; t < threadCount; ++t) {
+        targets[t].queue = context.queue(i, t);
+        targets[t].fence = fences[t];
+      }
+      if (runConcurrent(context, &targets)) {
+        result.sameFamilyRate = 0.0;
+        for (const auto& target : targets) {
+          result.sameFamilyRate += toRate(target);
+        }
+        result.sameFamilyThreads = threadCount;
+      }
+    }
+  }
+
+  // One thread per family, all at once
+  std::vector<SubmitTarget> targets;
+  std::vector<uint32_t> targetFamilies;
+  for (uint32_t i = 0; fencesValid && (i < families.size()); ++i) {
+    if (families[i].queueCount > 0) {
+      SubmitTarget target;
+      target.queue = context.queue(i, 0);
+      target.fence = fences[MAX_THREADS_PER_FAMILY + i];
+      targets.push_back(target);
+      targetFamilies.push_back(i);
+    }
+  }
+  if ((targets.size() > 1) && runConcurrent(context, &targets)) {
+    for (size_t t = 0; t < targets.size(); ++t) {
+      results[targetFamilies[t]].crossFamilyRate = toRate(targets[t]);
+    }
+  }
+
+  for (auto& fence : fences) {
+    if (fence != VK_NULL_HANDLE) {
+      VK_CALL(gpu, vkDestroyFence, device, fence, MemoryAccounting::get().allocator());
+    }
+  }
+
+  return results;
+}
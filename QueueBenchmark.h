@@ -0,0 +1,22 @@
+#ifndef __QUEUE_BENCHMARK_H__
+#define __QUEUE_BENCHMARK_H__
+
+#include "Benchmark.h"
+
+#include <vector>
+
+//! Per queue family results, negative values mean not measured. Every
+//! submission is an empty vkQueueSubmit followed by a fence wait, so the
+//! numbers are driver and scheduler overhead rather than GPU work.
+struct QueueFamilyBenchmark {
+  double    latencyUs = -1.0;         // Median submit to fence signaled round trip
+  double    jitterUs = -1.0;          // Standard deviation of the round trip
+  double    singleRate = -1.0;        // Submits/s, one thread on one queue
+  double    sameFamilyRate = -1.0;    // Submits/s summed over sameFamilyThreads queues of this family
+  uint32_t  sameFamilyThreads = 0;
+  double    crossFamilyRate = -1.0;   // Submits/s on this family while every family is busy
+};
+
+std::vector<QueueFamilyBenchmark> runQueueBenchmark(BenchmarkContext& context);
+
+#endif // __QUEUE_BENCHMARK_H__
@@ -0,0 +1,480 @@
+#include "SnapshotArchive.h"
+#include "Trace.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QUrl>
+
+// Sections, not bytes; a fleet of one GPU model needs a handful of bases
+static const int kSectionCacheSize = 512;
+static const int kLockTimeoutMs = 30000;
+
+// Fixed order, also the order sections are written to a record
+static const char* sDeviceSections[] = {
+  "properties", "limits", "sparse", "features", "extensions", "queues", "memory", "formats"
+};
+
+static QByteArray toCompactJson(const QJsonObject& object)
+{
+  return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+// Arrays are keyed so a delta can touch single entries
+static QJsonObject arrayToObject(const QJsonArray& array, const QString& key)
+{
+  QJsonObject object;
+  for (const auto& value : array) {
+    QJsonObject item = value.toObject();
+    QString name = item[key].toVariant().toString();
+    item.remove(key);
+    object[name] = item;
+  }
+  return object;
+}
+
+static QJsonArray objectToArray(const QJsonObject& object, const QString& key, bool numericKey)
+{
+  QJsonArray array;
+  for (auto it = object.begin(); it != object.end(); ++it) {
+    QJsonObject item = it.value().toObject();
+    item[key] = numericKey ? QJsonValue(it.key().toDouble()) : QJsonValue(it.key());
+    array.append(item);
+  }
+  return array;
+}
+
+static QJsonObject makeDelta(const QJsonObject& base, const QJsonObject& target)
+{
+  QJsonObject set;
+  for (auto it = target.begin(); it != target.end(); ++it) {
+    if (base.value(it.key()) != it.value()) {
+      set[it.key()] = it.value();
+    }
+  }
+  QJsonArray unset;
+  for (auto it = base.begin(); it != base.end(); ++it) {
+    if (! target.contains(it.key())) {
+      unset.append(it.key());
+    }
+  }
+
+  QJsonObject delta;
+  delta["set"] = set;
+  if (! unset.isEmpty()) {
+    delta["unset"] = unset;
+  }
+  return delta;
+}
+
+static QJsonObject applyDelta(QJsonObject base, const QJsonObject& delta)
+{
+  QJsonObject set = delta["set"].toObject();
+  for (auto it = set.begin(); it != set.end(); ++it) {
+    base[it.key()] = it.value();
+  }
+  for (const auto& key : delta["unset"].toArray()) {
+    base.remove(key.toString());
+  }
+  return base;
+}
+
+static QHash<QString, QJsonObject> splitDevice(const QJsonObject& device)
+{
+  QHash<QString, QJsonObject> sections;
+
+  QJsonObject properties = device["properties"].toObject();
+  sections["limits"] = properties["limits"].toObject();
+  sections["sparse"] = properties["sparseProperties"].toObject();
+  properties.remove("limits");
+  properties.remove("sparseProperties");
+  sections["properties"] = properties;
+
+  sections["features"] = device["features"].toObject();
+
+  QJsonObject extensions;
+  for (const auto& value : device["extensions"].toArray()) {
+    QJsonObject item = value.toObject();
+    extensions[item["extensionName"].toString()] = item["specVersion"];
+  }
+  sections["extensions"] = extensions;
+
+  QJsonObject queues;
+  queues["queueFamilies"] = device["queueFamilies"];
+  sections["queues"] = queues;
+
+  QJsonObject memory;
+  memory["memoryTypes"] = device["memoryTypes"];
+  memory["memoryHeaps"] = device["memoryHeaps"];
+  sections["memory"] = memory;
+
+  sections["formats"] = arrayToObject(device["formats"].toArray(), "format");
+  return sections;
+}
+
+static QJsonObject joinDevice(const QHash<QString, QJsonObject>& sections)
+{
+  QJsonObject properties = sections["properties"];
+  properties["limits"] = sections["limits"];
+  properties["sparseProperties"] = sections["sparse"];
+
+  QJsonArray extensions;
+  QJsonObject extensionSection = sections["extensions"];
+  for (auto it = extensionSection.begin(); it != extensionSection.end(); ++it) {
+    QJsonObject item;
+    item["extensionName"] = it.key();
+    item["specVersion"]   = it.value();
+    extensions.append(item);
+  }
+
+  QJsonObject device;
+  device["properties"]    = properties;
+  device["features"]      = sections["features"];
+  device["extensions"]    = extensions;
+  device["queueFamilies"] = sections["queues"]["queueFamilies"];
+  device["memoryTypes"]   = sections["memory"]["memoryTypes"];
+  device["memoryHeaps"]   = sections["memory"]["memoryHeaps"];
+  device["formats"]       = objectToArray(sections["formats"], "format", true);
+  return device;
+}
+
+SnapshotArchive::SnapshotArchive()
+  : mSectionCache(kSectionCacheSize)
+{
+}
+
+SnapshotArchive::~SnapshotArchive()
+{
+  close();
+}
+
+bool SnapshotArchive::open(const QString& dirPath)
+{
+  TRACE_SCOPE("qt", "SnapshotArchive::open");
+
+  close();
+
+  QDir dir(dirPath);
+  if (! dir.mkpath("sections")) {
+    return false;
+  }
+  mDirPath = dir.absolutePath();
+
+  // Section names are their hashes, so the directory listing is the set.
+  // QSaveFile writes next to the target as "<hash>.XXXXXX" until commit.
+  QDir sectionsDir(dir.filePath("sections"));
+  for (const auto& fanout : sectionsDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+    for (const auto& info : QDir(sectionsDir.filePath(fanout)).entryInfoList(QDir::Files)) {
+      QString name = info.fileName();
+      if ((name.size() != 40) || name.contains('.')) {
+        continue;
+      }
+      mSections.insert(name.toLatin1());
+      mStats.sectionBytes += info.size();
+    }
+  }
+  mStats.sectionCount = mSections.size();
+
+  loadBases();
+
+  mIndex.setFileName(dir.filePath("machines.idx"));
+  if (! mIndex.open(QIODevice::ReadWrite)) {
+    return false;
+  }
+  return indexRecords(false);
+}
+
+bool SnapshotArchive::indexRecords(bool repair)
+{
+  if (! mIndex.seek(mIndexEnd)) {
+    return false;
+  }
+  while (! mIndex.atEnd()) {
+    qint64 offset = mIndex.pos();
+    QByteArray line = mIndex.readLine();
+    int tab = line.indexOf('\t');
+    if ((tab < 0) || (! line.endsWith('\n'))) {
+      // Without the lock it may still be written, with it a crash cut it
+      // short and it goes so the next append starts on a fresh line
+      if (repair && (! mIndex.resize(offset))) {
+        return false;
+      }
+      break;
+    }
+    mMachines[QUrl::fromPercentEncoding(line.left(tab))] = offset;
+    mStats.recordCount += 1;
+    mIndexEnd = mIndex.pos();
+  }
+  mStats.recordBytes = mIndexEnd;
+  mStats.machineCount = mMachines.size();
+  return true;
+}
+
+void SnapshotArchive::close()
+{
+  if (mBasesDirty) {
+    saveBases();
+  }
+  unlock();
+  mIndex.close();
+  mMachines.clear();
+  mIndexEnd = 0;
+  mSections.clear();
+  mBases.clear();
+  mSectionCache.clear();
+  mStats = Stats();
+  mDirPath.clear();
+}
+
+QString SnapshotArchive::sectionPath(const QByteArray& hash) const
+{
+  return QString("%1/sections/%2/%3").arg(mDirPath).arg(QString::fromLatin1(hash.left(2))).arg(QString::fromLatin1(hash));
+}
+
+bool SnapshotArchive::loadBases()
+{
+  QFile file(mDirPath + "/bases.json");
+  if (! file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+  for (auto it = json.begin(); it != json.end(); ++it) {
+    mBases[it.key()] = it.value().toString().toLatin1();
+  }
+  return true;
+}
+
+bool SnapshotArchive::saveBases()
+{
+  QJsonObject json;
+  for (auto it = mBases.begin(); it != mBases.end(); ++it) {
+    json[it.key()] = QString::fromLatin1(it.value());
+  }
+
+  QSaveFile file(mDirPath + "/bases.json");
+  if (! file.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+  file.write(QJsonDocument(json).toJson());
+  mBasesDirty = ! file.commit();
+  return ! mBasesDirty;
+}
+
+QByteArray SnapshotArchive::storeSection(const QString& kind, const QString& baseKey, const QJsonObject& section)
+{
+  QByteArray json = toCompactJson(section);
+  QByteArray hash = QCryptographicHash::hash(json, QCryptographicHash::Sha1).toHex();
+  if (mSections.contains(hash)) {
+    return hash;
+  }
+  QString path = sectionPath(hash);
+  // Written by another process since open()
+  if (QFileInfo::exists(path)) {
+    mSections.insert(hash);
+    return hash;
+  }
+
+  // Close to the last full section of this kind for the same GPU: store only the difference
+  QByteArray content = json;
+  bool isDelta = false;
+  QString key = kind + "/" + baseKey;
+  auto base = mBases.find(key);
+  QJsonObject baseSection;
+  if ((base != mBases.end()) && readSection(base.value(), &baseSection)) {
+    QJsonObject delta;
+    delta["@base"]  = QString::fromLatin1(base.value());
+    delta["@delta"] = makeDelta(baseSection, section);
+    QByteArray deltaJson = toCompactJson(delta);
+    if (deltaJson.size() * 4 < json.size()) {
+      content = deltaJson;
+      isDelta = true;
+    }
+  }
+
+  QDir().mkpath(QFileInfo(path).path());
+  QSaveFile file(path);
+  if (! file.open(QIODevice::WriteOnly)) {
+    return QByteArray();
+  }
+  QByteArray compressed = qCompress(content);
+  file.write(compressed);
+  if (! file.commit()) {
+    return QByteArray();
+  }
+
+  mSections.insert(hash);
+  mSectionCache.insert(hash, new QJsonObject(section));
+  mStats.sectionCount += 1;
+  mStats.sectionBytes += compressed.size();
+  // Deltas always point at a full section, never at another delta
+  if (! isDelta) {
+    mBases[key] = hash;
+    mBasesDirty = true;
+  }
+  return hash;
+}
+
+bool SnapshotArchive::readSection(const QByteArray& hash, QJsonObject* pSection)
+{
+  if (const QJsonObject* pCached = mSectionCache.object(hash)) {
+    *pSection = *pCached;
+    return true;
+  }
+
+  QFile file(sectionPath(hash));
+  if (! file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  QJsonDocument doc = QJsonDocument::fromJson(qUncompress(file.readAll()));
+  if (! doc.isObject()) {
+    return false;
+  }
+
+  QJsonObject section = doc.object();
+  if (section.contains("@base")) {
+    QJsonObject base;
+    if (! readSection(section["@base"].toString().toLatin1(), &base)) {
+      return false;
+    }
+    section = applyDelta(base, section["@delta"].toObject());
+  }
+
+  mSectionCache.insert(hash, new QJsonObject(section));
+  *pSection = section;
+  return true;
+}
+
+bool SnapshotArchive::lock()
+{
+  if (! mIndex.isOpen()) {
+    return false;
+  }
+  if (mLock) {
+    return true;
+  }
+
+  mLock.reset(new QLockFile(mDirPath + "/ingest.lock"));
+  if (! mLock->tryLock(kLockTimeoutMs)) {
+    mLock.reset();
+    return false;
+  }
+
+  // Another writer may have added records and bases since we last looked
+  if (! mBasesDirty) {
+    loadBases();
+  }
+  if (! indexRecords(true)) {
+    unlock();
+    return false;
+  }
+  return true;
+}
+
+void SnapshotArchive::unlock()
+{
+  mLock.reset();
+}
+
+bool SnapshotArchive::ingest(const QString& machine, const DeviceProfileSet& profileSet)
+{
+  TRACE_SCOPE("qt", "SnapshotArchive::ingest");
+
+  if (mLock) {
+    return ingestLocked(machine, profileSet);
+  }
+  if (! lock()) {
+    return false;
+  }
+  bool result = ingestLocked(machine, profileSet);
+  unlock();
+  return result;
+}
+
+bool SnapshotArchive::ingestLocked(const QString& machine, const DeviceProfileSet& profileSet)
+{
+  QJsonObject json = deviceProfileSetToJson(profileSet);
+  QJsonArray devices = json["devices"].toArray();
+  json.remove("devices");
+
+  QJsonObject record;
+  record["time"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+  QByteArray instance = storeSection("instance", "", json);
+  if (instance.isEmpty()) {
+    return false;
+  }
+  record["instance"] = QString::fromLatin1(instance);
+
+  QJsonArray deviceRecords;
+  for (const auto& device : devices) {
+    QHash<QString, QJsonObject> sections = splitDevice(device.toObject());
+    const QJsonObject& properties = sections["properties"];
+    QString baseKey = QString("%1:%2").arg(properties["vendorID"].toVariant().toString())
+                                      .arg(properties["deviceID"].toVariant().toString());
+    QJsonObject deviceRecord;
+    for (const char* kind : sDeviceSections) {
+      QByteArray hash = storeSection(kind, baseKey, sections[kind]);
+      if (hash.isEmpty()) {
+        return false;
+      }
+      deviceRecord[kind] = QString::fromLatin1(hash);
+    }
+    deviceRecords.append(deviceRecord);
+  }
+  record["devices"] = deviceRecords;
+
+  // Sections and bases land before the record that references them
+  if (mBasesDirty && (! saveBases())) {
+    return false;
+  }
+
+  QByteArray line = QUrl::toPercentEncoding(machine) + '\t' + toCompactJson(record) + '\n';
+  qint64 offset = mIndexEnd;
+  if ((! mIndex.seek(offset)) || (mIndex.write(line) != line.size()) || (! mIndex.flush())) {
+    return false;
+  }
+
+  mIndexEnd = offset + line.size();
+  mMachines[machine] = offset;
+  mStats.machineCount = mMachines.size();
+  mStats.recordCount += 1;
+  mStats.recordBytes += line.size();
+  return true;
+}
+
+bool SnapshotArchive::load(const QString& machine, DeviceProfileSet* pProfileSet)
+{
+  TRACE_SCOPE("qt", "SnapshotArchive::load");
+
+  auto it = mMachines.find(machine);
+  if ((it == mMachines.end()) || (! mIndex.seek(it.value()))) {
+    return false;
+  }
+  QByteArray line = mIndex.readLine();
+  QJsonObject record = QJsonDocument::fromJson(line.mid(line.indexOf('\t') + 1)).object();
+
+  QJsonObject json;
+  if (! readSection(record["instance"].toString().toLatin1(), &json)) {
+    return false;
+  }
+
+  QJsonArray devices;
+  for (const auto& value : record["devices"].toArray()) {
+    QJsonObject deviceRecord = value.toObject();
+    QHash<QString, QJsonObject> sections;
+    for (const char* kind : sDeviceSections) {
+      if (! readSection(deviceRecord[kind].toString().toLatin1(), &sections[kind])) {
+        return false;
+      }
+    }
+    devices.append(joinDevice(sections));
+  }
+  json["devices"] = devices;
+
+  *pProfileSet = DeviceProfileSet();
+  return deviceProfileSetFromJson(json, pProfileSet);
+}
@@ -0,0 +1,101 @@
+#ifndef __SNAPSHOT_ARCHIVE_H__
+#define __SNAPSHOT_ARCHIVE_H__
+
+#include "DeviceProfile.h"
+
+#include <QCache>
+#include <QFile>
+#include <QHash>
+#include <QJsonObject>
+#include <QLockFile>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+
+//! \class SnapshotArchive
+//!
+//! Fleet storage for device snapshots. Every device is split into sections
+//! (properties, limits, sparse, features, extensions, queues, memory,
+//! formats, plus one instance section per machine) and each section is
+//! stored once, content addressed by the SHA-1 of its compact JSON:
+//!
+//!   <dir>/sections/ab/abcdef...   qCompress'd section JSON
+//!   <dir>/machines.idx            one record per ingest, append only
+//!   <dir>/bases.json              latest full section per (kind, GPU)
+//!
+//! A machine record only references section hashes. A new section that is
+//! close to the last full section of the same kind for the same
+//! vendorID/deviceID is stored as a one level delta against it (typically
+//! heap sizes or a driver version), still under its own hash, so machines
+//! sharing it share the delta too.
+//!
+//! Records are "<percent encoded machine>\t<json>\n", so open() indexes
+//! the newest record per machine without parsing any JSON and load() is
+//! one seek plus the sections it references. Writers hold <dir>/ingest.lock
+//! and first pick up what other processes appended since, so the command
+//! line ingest and the history appender can share an archive. Only a
+//! writer truncates a record cut short by a crash; readers stop before it.
+//!
+class SnapshotArchive {
+public:
+  struct Stats {
+    int     machineCount = 0;
+    int     recordCount = 0;
+    int     sectionCount = 0;
+    qint64  sectionBytes = 0;
+    qint64  recordBytes = 0;
+  };
+
+  SnapshotArchive();
+  ~SnapshotArchive();
+
+  SnapshotArchive(const SnapshotArchive&) = delete;
+  SnapshotArchive& operator=(const SnapshotArchive&) = delete;
+
+  //! Creates the directory layout if it doesn't exist
+  bool        open(const QString& dirPath);
+  void        close();
+
+  //! Takes <dir>/ingest.lock and picks up what other writers appended, so
+  //! a load() and an ingest() in between see no other writer's records.
+  //! ingest() takes the lock itself when it isn't held.
+  bool        lock();
+  void        unlock();
+
+  //! Appends a record, a machine ingested again keeps its older records
+  bool        ingest(const QString& machine, const DeviceProfileSet& profileSet);
+  //! Rebuilds the newest record of machine
+  bool        load(const QString& machine, DeviceProfileSet* pProfileSet);
+
+  QStringList machines() const { return mMachines.keys(); }
+  Stats       stats() const { return mStats; }
+
+private:
+  QString     sectionPath(const QByteArray& hash) const;
+  //! Returns the section hash, empty if it couldn't be written
+  QByteArray  storeSection(const QString& kind, const QString& baseKey, const QJsonObject& section);
+  bool        readSection(const QByteArray& hash, QJsonObject* pSection);
+  bool        ingestLocked(const QString& machine, const DeviceProfileSet& profileSet);
+  bool        loadBases();
+  bool        saveBases();
+  //! Indexes the whole records appended since mIndexEnd and stops at a
+  //! partial one. Only a writer holding the lock may repair it.
+  bool        indexRecords(bool repair);
+
+private:
+  QString                     mDirPath;
+  QFile                       mIndex;
+  std::unique_ptr<QLockFile>  mLock;
+  QHash<QString, qint64>      mMachines;      // newest record offset per machine
+  qint64                      mIndexEnd = 0;
+  QSet<QByteArray>            mSections;
+  QHash<QString, QByteArray>  mBases;         // "<kind>/<vendorID>:<deviceID>" -> hash
+  bool                        mBasesDirty = false;
+  // Least recently used sections, deltas keep hitting their base
+  QCache<QByteArray, QJsonObject> mSectionCache;
+  Stats                       mStats;
+};
+
+#endif // __SNAPSHOT_ARCHIVE_H__
@@ -0,0 +1,101 @@
+#ifndef __SORTABLE_TREE_WIDGET_ITEM_H__
+#define __SORTABLE_TREE_WIDGET_ITEM_H__
+
+#include <QTreeWidget>
+#include <QTreeWidgetItem>
+
+//! Role holding a numeric sort key for a column, the displayed text
+//! (locale separators, units, "n/a") doesn't sort correctly as a string
+#define SORT_ROLE   (Qt::UserRole + 1)
+
+//! \class SortableTreeWidgetItem
+//!
+//! Sorts by SORT_ROLE when both items have it for the sort column and by
+//! text otherwise. Items without a key sort after items with one. Integer
+//! keys compare as integers, a double would round 64-bit sizes and masks.
+//!
+class SortableTreeWidgetItem : public QTreeWidgetItem {
+public:
+  SortableTreeWidgetItem() {}
+  explicit SortableTreeWidgetItem(const QStringList& strings) : QTreeWidgetItem(strings) {}
+
+  bool operator<(const QTreeWidgetItem& other) const override
+  {
+    int column = (treeWidget() != nullptr) ? treeWidget()->sortColumn() : 0;
+    QVariant a = data(column, SORT_ROLE);
+    QVariant b = other.data(column, SORT_ROLE);
+    if (a.isValid() && b.isValid()) {
+      if (isInteger(a) && isInteger(b)) {
+        // Negative values are below every unsigned one
+        bool aNegative = isSigned(a) && (a.toLongLong() < 0);
+        bool bNegative = isSigned(b) && (b.toLongLong() < 0);
+        if (aNegative || bNegative) {
+          return (aNegative == bNegative) ? (a.toLongLong() < b.toLongLong()) : aNegative;
+        }
+        return a.toULongLong() < b.toULongLong();
+      }
+      return a.toDouble() < b.toDouble();
+    }
+    if (a.isValid() != b.isValid()) {
+      return a.isValid();
+    }
+    return QTreeWidgetItem::operator<(other);
+  }
+
+private:
+  static bool isSigned(const QVariant& value)
+  {
+    switch (static_cast<QMetaType::Type>(value.userType())) {
+      case QMetaType::Int:
+      case QMetaType::Long:
+      case QMetaType::LongLong:
+      case QMetaType::Short:
+      case QMetaType::SChar:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  static bool isInteger(const QVariant& value)
+  {
+    switch (static_cast<QMetaType::Type>(value.userType())) {
+      case QMetaType::UInt:
+      case QMetaType::ULong:
+      case QMetaType::ULongLong:
+      case QMetaType::UShort:
+      case QMetaType::UChar:
+        return true;
+      default:
+        return isSigned(value);
+    }
+  }
+};
+
+//! \class TreeSortingBlocker
+//!
+//! Turns sorting off while a tree is filled or updated by row index and
+//! back on when it goes out of scope, which sorts once instead of on every
+//! insert and keeps topLevelItem(i) stable in between.
+//!
+class TreeSortingBlocker {
+public:
+  explicit TreeSortingBlocker(QTreeWidget* tw) : mTreeWidget(tw), mSorting(tw->isSortingEnabled())
+  {
+    mTreeWidget->setSortingEnabled(false);
+  }
+
+  ~TreeSortingBlocker()
+  {
+    mTreeWidget->setSortingEnabled(mSorting);
+  }
+
+  TreeSortingBlocker(const TreeSortingBlocker&) = delete;
+  TreeSortingBlocker& operator=(const TreeSortingBlocker&) = delete;
+
+private:
+  QTreeWidget*  mTreeWidget = nullptr;
+  bool          mSorting = false;
+};
+
+#endif // __SORTABLE_TREE_WIDGET_ITEM_H__
@@ -0,0 +1,83 @@
+#include "SparseImageFormats.h"
+#include "Trace.h"
+#include "VkProfiler.h"
+
+#include <QtConcurrent/QtConcurrentMap>
+
+static const VkImageUsageFlags sUsages[] = {
+  VK_IMAGE_USAGE_SAMPLED_BIT,
+  VK_IMAGE_USAGE_STORAGE_BIT,
+  VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+  VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+};
+
+static const VkSampleCountFlagBits sSampleCounts[] = {
+  VK_SAMPLE_COUNT_1_BIT,
+  VK_SAMPLE_COUNT_2_BIT,
+  VK_SAMPLE_COUNT_4_BIT,
+  VK_SAMPLE_COUNT_8_BIT,
+  VK_SAMPLE_COUNT_16_BIT,
+};
+
+static std::vector<SparseImageFormat> enumerateFormat(VkPhysicalDevice gpu, VkFormat format)
+{
+  std::vector<SparseImageFormat> results;
+  std::vector<VkSparseImageFormatProperties> properties;
+
+  for (VkImageType type : { VK_IMAGE_TYPE_2D, VK_IMAGE_TYPE_3D }) {
+    for (VkImageUsageFlags usage : sUsages) {
+      // Sparse queries are only meaningful for combinations the image query accepts
+      VkImageFormatProperties imageProperties = {};
+      VkResult res = VK_CALL(gpu, vkGetPhysicalDeviceImageFormatProperties, gpu, format, type, VK_IMAGE_TILING_OPTIMAL, usage,
+                             VK_IMAGE_CREATE_SPARSE_BINDING_BIT | VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT, &imageProperties);
+      if (res != VK_SUCCESS) {
+        continue;
+      }
+
+      for (VkSampleCountFlagBits samples : sSampleCounts) {
+        if ((imageProperties.sampleCounts & samples) == 0) {
+          continue;
+        }
+        if ((type == VK_IMAGE_TYPE_3D) && (samples != VK_SAMPLE_COUNT_1_BIT)) {
+          continue;
+        }
+
+        uint32_t count = 0;
+        VK_CALL(gpu, vkGetPhysicalDeviceSparseImageFormatProperties, gpu, format, type, samples, usage, VK_IMAGE_TILING_OPTIMAL, &count, nullptr);
+        properties.resize(count);
+        VK_CALL(gpu, vkGetPhysicalDeviceSparseImageFormatProperties, gpu, format, type, samples, usage, VK_IMAGE_TILING_OPTIMAL, &count, properties.data());
+        for (uint32_t i = 0; i < count; ++i) {
+          results.push_back({ format, type, samples, usage, properties[i] });
+        }
+      }
+    }
+  }
+
+  return results;
+}
+
+std::vector<SparseImageFormat> enumerateSparseImageFormats(VkPhysicalDevice gpu, const std::vector<VkFormat>& formats)
+{
+  TRACE_SCOPE("driver", "enumerateSparseImageFormats");
+
+  struct Item {
+    VkFormat                        format;
+    std::vector<SparseImageFormat>  results;
+  };
+
+  std::vector<Item> items;
+  for (VkFormat format : formats) {
+    items.push_back({ format, {} });
+  }
+
+  // Physical device queries need no external synchronization
+  QtConcurrent::blockingMap(items, [gpu](Item& item) {
+    item.results = enumerateFormat(gpu, item.format);
+  });
+
+  std::vector<SparseImageFormat> results;
+  for (const auto& item : items) {
+    results.insert(results.end(), item.results.begin(), item.results.end());
+  }
+  return results;
+}
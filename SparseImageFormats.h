@@ -0,0 +1,24 @@
+#ifndef __SPARSE_IMAGE_FORMATS_H__
+#define __SPARSE_IMAGE_FORMATS_H__
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+//! One vkGetPhysicalDeviceSparseImageFormatProperties result, i.e. one
+//! aspect of one (format, type, samples, usage) combination with optimal
+//! tiling. imageGranularity is the sparse block shape in texels.
+struct SparseImageFormat {
+  VkFormat                        format;
+  VkImageType                     type;
+  VkSampleCountFlagBits           samples;
+  VkImageUsageFlags               usage;
+  VkSparseImageFormatProperties   properties;
+};
+
+//! Queries every combination of formats x {2D, 3D} x sample counts x usage
+//! that vkGetPhysicalDeviceImageFormatProperties accepts with sparse
+//! residency, one format per worker thread. Results are in format order.
+std::vector<SparseImageFormat> enumerateSparseImageFormats(VkPhysicalDevice gpu, const std::vector<VkFormat>& formats);
+
+#endif // __SPARSE_IMAGE_FORMATS_H__
@@ -0,0 +1,66 @@
+#ifndef __SPSC_RING_H__
+#define __SPSC_RING_H__
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+//! \class SpscRing
+//!
+//! Fixed capacity single producer, single consumer ring buffer. push() and
+//! pop() never block or allocate; when the consumer falls behind, push()
+//! fails and the caller decides what to drop. Capacity is rounded up to a
+//! power of two.
+//!
+template <typename T>
+class SpscRing {
+public:
+  explicit SpscRing(size_t capacity)
+  {
+    size_t n = 1;
+    while (n < capacity) {
+      n <<= 1;
+    }
+    mBuffer.resize(n);
+    mMask = n - 1;
+  }
+
+  //! Producer only
+  bool push(const T& value)
+  {
+    size_t head = mHead.load(std::memory_order_relaxed);
+    size_t tail = mTail.load(std::memory_order_acquire);
+    if (head - tail > mMask) {
+      return false;
+    }
+    mBuffer[head & mMask] = value;
+    mHead.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! Consumer only
+  bool pop(T* pValue)
+  {
+    size_t tail = mTail.load(std::memory_order_relaxed);
+    size_t head = mHead.load(std::memory_order_acquire);
+    if (tail == head) {
+      return false;
+    }
+    *pValue = mBuffer[tail & mMask];
+    mTail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t capacity() const { return mBuffer.size(); }
+
+private:
+  std::vector<T>      mBuffer;
+  size_t              mMask = 0;
+  // Padded apart so producer and consumer don't false share
+  char                mPad0[64];
+  std::atomic<size_t> mHead { 0 };
+  char                mPad1[64];
+  std::atomic<size_t> mTail { 0 };
+};
+
+#endif // __SPSC_RING_H__
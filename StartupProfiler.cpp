@@ -0,0 +1,205 @@
+#include "StartupProfiler.h"
+#include "Trace.h"
+#include "VkProfiler.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QProcessEnvironment>
+
+#include <chrono>
+#include <cstdio>
+
+static const int kProbeRepeats = 3;
+static const int kProbeTimeoutMs = 30000;
+static const int kCancelPollMs = 100;
+
+static const char* sProbeTag = "startup-probe";
+
+const char* kProbeApiVersionOption = "probe-api-version";
+const char* kProbeExtensionsOption = "probe-extensions";
+
+//! Turns off every implicit layer except keepLayer, and whatever the user
+//! forces on through the loader's variables
+static QProcessEnvironment getProbeEnvironment(const std::vector<ManifestScanner::LayerManifest>& layers, const QString& keepLayer)
+{
+  QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+  environment.remove("VK_INSTANCE_LAYERS");
+  environment.remove("VK_LOADER_LAYERS_ENABLE");
+
+  for (const auto& layer : layers) {
+    if (layer.type != "implicit") {
+      continue;
+    }
+    if (QString::fromUtf8(layer.properties.layerName) == keepLayer) {
+      if (! layer.disableVariable.isEmpty()) {
+        environment.remove(layer.disableVariable);
+      }
+      if (! layer.enableVariable.isEmpty()) {
+        environment.insert(layer.enableVariable, layer.enableValue);
+      }
+    }
+    else {
+      // A layer with enable_environment is only loaded while its variable is set
+      if (! layer.enableVariable.isEmpty()) {
+        environment.remove(layer.enableVariable);
+      }
+      if (! layer.disableVariable.isEmpty()) {
+        environment.insert(layer.disableVariable, layer.disableValue.isEmpty() ? QString("1") : layer.disableValue);
+      }
+    }
+  }
+  return environment;
+}
+
+static bool parseProbe(const QByteArray& output, StartupProbe* pProbe)
+{
+  // Layers and drivers are free to print to stdout too
+  for (const auto& line : output.split('\n')) {
+    QList<QByteArray> fields = line.trimmed().split(' ');
+    if ((fields.size() != 5) || (fields[0] != sProbeTag)) {
+      continue;
+    }
+    pProbe->createMs    = fields[1].toDouble();
+    pProbe->enumerateMs = fields[2].toDouble();
+    pProbe->gpuCount    = fields[3].toUInt();
+    pProbe->result      = static_cast<VkResult>(fields[4].toInt());
+    return true;
+  }
+  return false;
+}
+
+static StartupProbe runProbe(const QProcessEnvironment& environment, const QStringList& probeArguments, const QString& label, const std::atomic<bool>* pCancel)
+{
+  TRACE_SCOPE("loader", "startup probe " + label.toStdString());
+
+  StartupProbe best;
+  for (int i = 0; i < kProbeRepeats; ++i) {
+    if (*pCancel) {
+      return StartupProbe();
+    }
+
+    QStringList arguments;
+    arguments << QString("--") + sProbeTag << probeArguments;
+
+    QProcess process;
+    process.setProcessEnvironment(environment);
+    process.start(QCoreApplication::applicationFilePath(), arguments);
+    // Waits in slices so a cancel doesn't have to sit out a hanging layer
+    QElapsedTimer elapsed;
+    elapsed.start();
+    while ((process.state() != QProcess::NotRunning) && (! *pCancel) && (elapsed.elapsed() < kProbeTimeoutMs)) {
+      process.waitForFinished(kCancelPollMs);
+    }
+    if (process.state() != QProcess::NotRunning) {
+      // A layer that hangs startup is reported as failed
+      process.kill();
+      process.waitForFinished();
+      return StartupProbe();
+    }
+
+    StartupProbe probe;
+    if ((! parseProbe(process.readAllStandardOutput(), &probe)) || (probe.result != VK_SUCCESS)) {
+      return probe;
+    }
+    if ((best.createMs < 0.0) || (probe.createMs < best.createMs)) {
+      best = probe;
+    }
+  }
+  return best;
+}
+
+StartupProfile runStartupProfile(const std::vector<ManifestScanner::LayerManifest>& layers,
+                                 const std::vector<ManifestScanner::IcdManifest>& icds,
+                                 const std::atomic<bool>* pCancel)
+{
+  TRACE_SCOPE("loader", "runStartupProfile");
+
+  StartupProfile profile;
+  QProcessEnvironment baseEnvironment = getProbeEnvironment(layers, QString());
+  profile.baseline = runProbe(baseEnvironment, QStringList(), "baseline", pCancel);
+  profile.defaults = runProbe(QProcessEnvironment::systemEnvironment(), QStringList(), "defaults", pCancel);
+
+  for (const auto& layer : layers) {
+    QString name = QString::fromUtf8(layer.properties.layerName);
+    if (layer.type == "implicit") {
+      profile.layers[layer.path] = runProbe(getProbeEnvironment(layers, name), QStringList(), name, pCancel);
+    }
+    else {
+      profile.layers[layer.path] = runProbe(baseEnvironment, QStringList(name), name, pCancel);
+    }
+  }
+
+  for (const auto& icd : icds) {
+    // VK_DRIVER_FILES replaces VK_ICD_FILENAMES in newer loaders
+    QProcessEnvironment environment = baseEnvironment;
+    environment.insert("VK_ICD_FILENAMES", QDir::toNativeSeparators(icd.path));
+    environment.insert("VK_DRIVER_FILES", QDir::toNativeSeparators(icd.path));
+    environment.remove("VK_ADD_DRIVER_FILES");
+    profile.icds[icd.path] = runProbe(environment, QStringList(), icd.path, pCancel);
+  }
+  return profile;
+}
+
+StartupProbe runInstanceProbe(uint32_t apiVersion, const QStringList& extensions, const std::atomic<bool>* pCancel)
+{
+  TRACE_SCOPE("loader", "runInstanceProbe");
+
+  QStringList arguments;
+  arguments << QString("--%1=%2").arg(kProbeApiVersionOption).arg(apiVersion);
+  if (! extensions.isEmpty()) {
+    arguments << QString("--%1=%2").arg(kProbeExtensionsOption).arg(extensions.join(','));
+  }
+  return runProbe(QProcessEnvironment::systemEnvironment(), arguments, QString("%1 extensions").arg(extensions.size()), pCancel);
+}
+
+int runStartupProbe(const QString& layerName, uint32_t apiVersion, const QStringList& extensions)
+{
+  QByteArray name = layerName.toUtf8();
+  const char* layerNames[] = { name.constData() };
+
+  std::vector<QByteArray> extensionNames;
+  std::vector<const char*> extensionPointers;
+  for (const auto& extension : extensions) {
+    extensionNames.push_back(extension.toUtf8());
+  }
+  for (const auto& extension : extensionNames) {
+    extensionPointers.push_back(extension.constData());
+  }
+
+  VkApplicationInfo appInfo = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+  appInfo.pApplicationName    = "Vulkan Info Viewer";
+  appInfo.applicationVersion  = 1;
+  appInfo.pEngineName         = "Vulkan Info Viewer";
+  appInfo.engineVersion       = 1;
+  appInfo.apiVersion          = apiVersion;
+
+  VkInstanceCreateInfo createInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+  createInfo.pApplicationInfo         = &appInfo;
+  createInfo.enabledLayerCount        = layerName.isEmpty() ? 0 : 1;
+  createInfo.ppEnabledLayerNames      = layerName.isEmpty() ? nullptr : layerNames;
+  createInfo.enabledExtensionCount    = static_cast<uint32_t>(extensionPointers.size());
+  createInfo.ppEnabledExtensionNames  = extensionPointers.empty() ? nullptr : extensionPointers.data();
+
+  // No allocation callbacks, an application's startup doesn't have them either
+  VkInstance instance = VK_NULL_HANDLE;
+  auto start = std::chrono::steady_clock::now();
+  VkResult res = VK_CALL(VK_NULL_HANDLE, vkCreateInstance, &createInfo, nullptr, &instance);
+  auto created = std::chrono::steady_clock::now();
+
+  uint32_t gpuCount = 0;
+  auto enumerated = created;
+  if (res == VK_SUCCESS) {
+    VK_CALL(VK_NULL_HANDLE, vkEnumeratePhysicalDevices, instance, &gpuCount, nullptr);
+    enumerated = std::chrono::steady_clock::now();
+    VK_CALL(VK_NULL_HANDLE, vkDestroyInstance, instance, nullptr);
+  }
+
+  printf("%s %.3f %.3f %u %d\n", sProbeTag,
+         std::chrono::duration<double, std::milli>(created - start).count(),
+         std::chrono::duration<double, std::milli>(enumerated - created).count(),
+         gpuCount, static_cast<int>(res));
+  fflush(stdout);
+  return (res == VK_SUCCESS) ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#ifndef __STARTUP_PROFILER_H__
+#define __STARTUP_PROFILER_H__
+
+#include "ManifestScanner.h"
+
+#include <QHash>
+#include <QString>
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+
+//! One vkCreateInstance and vkEnumeratePhysicalDevices in a child process,
+//! negative times mean the probe failed or never ran.
+struct StartupProbe {
+  double    createMs = -1.0;
+  double    enumerateMs = -1.0;
+  uint32_t  gpuCount = 0;
+  VkResult  result = VK_ERROR_INITIALIZATION_FAILED;
+};
+
+//! Startup cost of every layer and ICD the manifest scanner found.
+//!
+//! Each probe runs this executable again with --startup-probe, so every
+//! layer and driver library is loaded into a fresh process like it is for
+//! an application, and a layer that crashes only takes the probe down.
+//! Implicit layers are turned off through their disable_environment
+//! variable, which is what they cost every Vulkan application on the
+//! machine when they aren't:
+//!
+//!   baseline    no layers, every ICD
+//!   defaults    implicit layers as the loader picks them, every ICD
+//!   layers      baseline plus that one layer
+//!   icds        no layers, VK_ICD_FILENAMES set to that manifest only
+//!
+//! Every probe runs a few times and keeps the fastest, the first one pays
+//! for the disk cache.
+struct StartupProfile {
+  StartupProbe                  baseline;
+  StartupProbe                  defaults;
+  QHash<QString, StartupProbe>  layers;   // by manifest path, two manifests can name the same layer
+  QHash<QString, StartupProbe>  icds;     // by manifest path
+};
+
+//! Setting *pCancel kills the probe running and skips the rest, what
+//! wasn't measured is left failed
+StartupProfile runStartupProfile(const std::vector<ManifestScanner::LayerManifest>& layers,
+                                 const std::vector<ManifestScanner::IcdManifest>& icds,
+                                 const std::atomic<bool>* pCancel);
+
+//! vkCreateInstance at apiVersion with extensions enabled and the implicit
+//! layers the loader picks, probed the same way as the profile's defaults
+StartupProbe runInstanceProbe(uint32_t apiVersion, const QStringList& extensions, const std::atomic<bool>* pCancel);
+
+//! Child side of a probe, prints one line for the parent and returns the
+//! exit code. layerName is enabled with ppEnabledLayerNames if not empty.
+int runStartupProbe(const QString& layerName, uint32_t apiVersion, const QStringList& extensions);
+
+//! Options of the child besides --startup-probe
+extern const char* kProbeApiVersionOption;
+extern const char* kProbeExtensionsOption;
+
+#endif // __STARTUP_PROFILER_H__
@@ -1,5 +1,7 @@
 #include "ToString.h"
 
+#include <QStringList>
+
 #include <map>
 #include <sstream>
 
@@ -27,6 +29,82 @@ QString toStringDeviceType(VkPhysicalDeviceType type)
   return result;
 }
 
+// Extension formats by value, the ranges match FormatTable.cpp and some
+// are newer than the headers the viewer builds against
+static const char* sAstcHdrFormatStrings[] = {
+  "VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK_EXT",
+  "VK_FORMAT_ASTC_5x4_SFLOAT_BLOCK_EXT",
+  "VK_FORMAT_ASTC_5x5_SFLOAT_BLOCK_EXT",
+  "VK_FORMAT_ASTC_6x5_SFLOAT_BLOCK_EXT",
+  "VK_FORMAT_ASTC_6x6_SFLOAT_BLOCK_EXT",
+  "VK_FORMAT_ASTC_8x5_SFLOAT_BLOCK_EXT",
+  "VK_FORMAT_ASTC_8x6_SFLOAT_BLOCK_EXT",
+  "VK_FORMAT_ASTC_8x8_SFLOAT_BLOCK_EXT",
+  "VK_FORMAT_ASTC_10x5_SFLOAT_BLOCK_EXT",
+  "VK_FORMAT_ASTC_10x6_SFLOAT_BLOCK_EXT",
+  "VK_FORMAT_ASTC_10x8_SFLOAT_BLOCK_EXT",
+  "VK_FORMAT_ASTC_10x10_SFLOAT_BLOCK_EXT",
+  "VK_FORMAT_ASTC_12x10_SFLOAT_BLOCK_EXT",
+  "VK_FORMAT_ASTC_12x12_SFLOAT_BLOCK_EXT",
+};
+
+static const char* sYcbcrFormatStrings[] = {
+  "VK_FORMAT_G8B8G8R8_422_UNORM",
+  "VK_FORMAT_B8G8R8G8_422_UNORM",
+  "VK_FORMAT_G8_B8_R8_3PLANE_420_UNORM",
+  "VK_FORMAT_G8_B8R8_2PLANE_420_UNORM",
+  "VK_FORMAT_G8_B8_R8_3PLANE_422_UNORM",
+  "VK_FORMAT_G8_B8R8_2PLANE_422_UNORM",
+  "VK_FORMAT_G8_B8_R8_3PLANE_444_UNORM",
+  "VK_FORMAT_R10X6_UNORM_PACK16",
+  "VK_FORMAT_R10X6G10X6_UNORM_2PACK16",
+  "VK_FORMAT_R10X6G10X6B10X6A10X6_UNORM_4PACK16",
+  "VK_FORMAT_G10X6B10X6G10X6R10X6_422_UNORM_4PACK16",
+  "VK_FORMAT_B10X6G10X6R10X6G10X6_422_UNORM_4PACK16",
+  "VK_FORMAT_G10X6_B10X6_R10X6_3PLANE_420_UNORM_3PACK16",
+  "VK_FORMAT_G10X6_B10X6R10X6_2PLANE_420_UNORM_3PACK16",
+  "VK_FORMAT_G10X6_B10X6_R10X6_3PLANE_422_UNORM_3PACK16",
+  "VK_FORMAT_G10X6_B10X6R10X6_2PLANE_422_UNORM_3PACK16",
+  "VK_FORMAT_G10X6_B10X6_R10X6_3PLANE_444_UNORM_3PACK16",
+  "VK_FORMAT_R12X4_UNORM_PACK16",
+  "VK_FORMAT_R12X4G12X4_UNORM_2PACK16",
+  "VK_FORMAT_R12X4G12X4B12X4A12X4_UNORM_4PACK16",
+  "VK_FORMAT_G12X4B12X4G12X4R12X4_422_UNORM_4PACK16",
+  "VK_FORMAT_B12X4G12X4R12X4G12X4_422_UNORM_4PACK16",
+  "VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_420_UNORM_3PACK16",
+  "VK_FORMAT_G12X4_B12X4R12X4_2PLANE_420_UNORM_3PACK16",
+  "VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_422_UNORM_3PACK16",
+  "VK_FORMAT_G12X4_B12X4R12X4_2PLANE_422_UNORM_3PACK16",
+  "VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_444_UNORM_3PACK16",
+  "VK_FORMAT_G16B16G16R16_422_UNORM",
+  "VK_FORMAT_B16G16R16G16_422_UNORM",
+  "VK_FORMAT_G16_B16_R16_3PLANE_420_UNORM",
+  "VK_FORMAT_G16_B16R16_2PLANE_420_UNORM",
+  "VK_FORMAT_G16_B16_R16_3PLANE_422_UNORM",
+  "VK_FORMAT_G16_B16R16_2PLANE_422_UNORM",
+  "VK_FORMAT_G16_B16_R16_3PLANE_444_UNORM",
+};
+
+static const char* sYcbcr2Plane444FormatStrings[] = {
+  "VK_FORMAT_G8_B8R8_2PLANE_444_UNORM_EXT",
+  "VK_FORMAT_G10X6_B10X6R10X6_2PLANE_444_UNORM_3PACK16_EXT",
+  "VK_FORMAT_G12X4_B12X4R12X4_2PLANE_444_UNORM_3PACK16_EXT",
+  "VK_FORMAT_G16_B16R16_2PLANE_444_UNORM_EXT",
+};
+
+static const char* s4444FormatStrings[] = {
+  "VK_FORMAT_A4R4G4B4_UNORM_PACK16_EXT",
+  "VK_FORMAT_A4B4G4R4_UNORM_PACK16_EXT",
+};
+
+template <size_t N>
+static void addFormatStrings(uint32_t first, const char* (&names)[N])
+{
+  for (size_t i = 0; i < N; ++i) {
+    sFormatStrings[static_cast<VkFormat>(first + i)] = names[i];
+  }
+}
+
 QString toStringVkFormat(VkFormat format)
 {
   if (sFormatStrings.empty()) {
@@ -223,6 +301,10 @@ QString toStringVkFormat(VkFormat format)
     sFormatStrings[VK_FORMAT_PVRTC1_4BPP_SRGB_BLOCK_IMG] = "VK_FORMAT_PVRTC1_4BPP_SRGB_BLOCK_IMG";
     sFormatStrings[VK_FORMAT_PVRTC2_2BPP_SRGB_BLOCK_IMG] = "VK_FORMAT_PVRTC2_2BPP_SRGB_BLOCK_IMG";
     sFormatStrings[VK_FORMAT_PVRTC2_4BPP_SRGB_BLOCK_IMG] = "VK_FORMAT_PVRTC2_4BPP_SRGB_BLOCK_IMG";
+    addFormatStrings(1000066000, sAstcHdrFormatStrings);
+    addFormatStrings(1000156000, sYcbcrFormatStrings);
+    addFormatStrings(1000330000, sYcbcr2Plane444FormatStrings);
+    addFormatStrings(1000340000, s4444FormatStrings);
   }
 
   QString result;
@@ -396,3 +478,53 @@ QString toStringSampleCounts(VkSampleCountFlags value)
   return result;
 }
 
+QString toStringImageAspectFlags(VkImageAspectFlags value)
+{
+  QStringList result;
+  if (value & VK_IMAGE_ASPECT_COLOR_BIT) {
+    result << "COLOR";
+  }
+  if (value & VK_IMAGE_ASPECT_DEPTH_BIT) {
+    result << "DEPTH";
+  }
+  if (value & VK_IMAGE_ASPECT_STENCIL_BIT) {
+    result << "STENCIL";
+  }
+  if (value & VK_IMAGE_ASPECT_METADATA_BIT) {
+    result << "METADATA";
+  }
+  if (value & VK_IMAGE_ASPECT_PLANE_0_BIT) {
+    result << "PLANE_0";
+  }
+  if (value & VK_IMAGE_ASPECT_PLANE_1_BIT) {
+    result << "PLANE_1";
+  }
+  if (value & VK_IMAGE_ASPECT_PLANE_2_BIT) {
+    result << "PLANE_2";
+  }
+  return result.join(" / ");
+}
+
+QString toStringSparseImageFormatFlags(VkSparseImageFormatFlags value)
+{
+  QStringList result;
+  if (value & VK_SPARSE_IMAGE_FORMAT_SINGLE_MIPTAIL_BIT) {
+    result << "SINGLE_MIPTAIL";
+  }
+  if (value & VK_SPARSE_IMAGE_FORMAT_ALIGNED_MIP_SIZE_BIT) {
+    result << "ALIGNED_MIP_SIZE";
+  }
+  if (value & VK_SPARSE_IMAGE_FORMAT_NONSTANDARD_BLOCK_SIZE_BIT) {
+    result << "NONSTANDARD_BLOCK_SIZE";
+  }
+  return result.join(" / ");
+}
+
+QString toStringUuid(const uint8_t (&uuid)[VK_UUID_SIZE])
+{
+  QString result;
+  for (size_t i = 0; i < VK_UUID_SIZE; ++i) {
+    result.append(QString("%1").arg(static_cast<uint>(uuid[i]), 2, 16, QChar('0')));
+  }
+  return result.toUpper();
+}
@@ -19,5 +19,9 @@ QString toStringImageTypeShort(VkImageType value);
 QString toStringImageUsageFlagShort(VkImageUsageFlagBits value);
 
 QString toStringSampleCounts(VkSampleCountFlags value);
+QString toStringImageAspectFlags(VkImageAspectFlags value);
+QString toStringSparseImageFormatFlags(VkSparseImageFormatFlags value);
+
+QString toStringUuid(const uint8_t (&uuid)[VK_UUID_SIZE]);
 
 #endif // __TO_STRING_H__
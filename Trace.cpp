@@ -0,0 +1,138 @@
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QFile>
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct TraceEvent {
+  const char* category;
+  std::string name;
+  int64_t     startUs;
+  int64_t     durationUs;
+  uint32_t    threadId;
+};
+
+struct TraceState {
+  std::mutex                            mutex;
+  std::vector<TraceEvent>               events;
+  std::map<std::thread::id, uint32_t>   threadIds;
+  std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+  QString                               filePath;
+  bool                                  enabled = false;
+
+  TraceState()
+  {
+    filePath = QString::fromLocal8Bit(qgetenv("VIV_TRACE_FILE"));
+    enabled = ! filePath.isEmpty();
+    if (enabled) {
+      events.reserve(4096);
+    }
+  }
+};
+
+static TraceState& traceState()
+{
+  static TraceState sState;
+  return sState;
+}
+
+static QByteArray escapeJson(const std::string& s)
+{
+  QByteArray result;
+  result.reserve(static_cast<int>(s.size()));
+  for (char c : s) {
+    switch (c) {
+      case '"'  : result += "\\\""; break;
+      case '\\' : result += "\\\\"; break;
+      case '\n' : result += "\\n"; break;
+      default   : result += c; break;
+    }
+  }
+  return result;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Trace
+// -------------------------------------------------------------------------------------------------
+bool Trace::isEnabled()
+{
+  return traceState().enabled;
+}
+
+void Trace::addCompleteEvent(const char* category, const std::string& name,
+                             std::chrono::steady_clock::time_point start,
+                             std::chrono::steady_clock::time_point end)
+{
+  TraceState& state = traceState();
+  if (! state.enabled) {
+    return;
+  }
+
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+
+  TraceEvent event = {};
+  event.category   = category;
+  event.name       = name;
+  event.startUs    = duration_cast<microseconds>(start - state.epoch).count();
+  event.durationUs = duration_cast<microseconds>(end - start).count();
+
+  std::lock_guard<std::mutex> lock(state.mutex);
+  auto it = state.threadIds.find(std::this_thread::get_id());
+  if (it == state.threadIds.end()) {
+    uint32_t id = static_cast<uint32_t>(state.threadIds.size()) + 1;
+    it = state.threadIds.insert(std::make_pair(std::this_thread::get_id(), id)).first;
+  }
+  event.threadId = it->second;
+  state.events.push_back(event);
+}
+
+void Trace::flush()
+{
+  TraceState& state = traceState();
+  if (! state.enabled) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(state.mutex);
+
+  QFile file(state.filePath);
+  if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qWarning("Trace: unable to write %s", qPrintable(state.filePath));
+    return;
+  }
+
+  const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+
+  // Written by hand rather than through QJsonDocument, traces get large
+  file.write("{\"traceEvents\":[\n");
+  for (size_t i = 0; i < state.events.size(); ++i) {
+    const TraceEvent& event = state.events[i];
+    QByteArray line;
+    line += "{\"ph\":\"X\",\"pid\":" + pid;
+    line += ",\"tid\":" + QByteArray::number(event.threadId);
+    line += ",\"ts\":" + QByteArray::number(static_cast<qlonglong>(event.startUs));
+    line += ",\"dur\":" + QByteArray::number(static_cast<qlonglong>(event.durationUs));
+    line += ",\"cat\":\"" + QByteArray(event.category) + "\"";
+    line += ",\"name\":\"" + escapeJson(event.name) + "\"}";
+    line += (i + 1 < state.events.size()) ? ",\n" : "\n";
+    file.write(line);
+  }
+  file.write("],\"displayTimeUnit\":\"ms\"}\n");
+
+  state.events.clear();
+}
+
+// -------------------------------------------------------------------------------------------------
+// TraceScope
+// -------------------------------------------------------------------------------------------------
+TraceScope::~TraceScope()
+{
+  if (mEnabled) {
+    Trace::addCompleteEvent(mCategory, mName, mStart, std::chrono::steady_clock::now());
+  }
+}
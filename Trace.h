@@ -0,0 +1,61 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <chrono>
+#include <string>
+
+//! \class Trace
+//!
+//! Opt-in recorder for Chrome trace_event JSON (chrome://tracing, Perfetto).
+//! Enabled when VIV_TRACE_FILE names the output file; the file is written
+//! by flush() when the application exits.
+//!
+//! Categories used by the viewer:
+//!   loader - instance creation and loader-side enumeration
+//!   layer  - per-layer queries
+//!   driver - physical device queries
+//!   qt     - widget population, column sizing and filtering
+//!
+class Trace {
+public:
+  static bool isEnabled();
+  static void addCompleteEvent(const char* category, const std::string& name,
+                               std::chrono::steady_clock::time_point start,
+                               std::chrono::steady_clock::time_point end);
+  static void flush();
+};
+
+//! \class TraceScope
+//!
+//! Records one complete ("X") event covering its lifetime. TRACE_SCOPE
+//! hands the name over as a callable, so a name built from strings costs
+//! nothing while tracing is off.
+//!
+class TraceScope {
+public:
+  ~TraceScope();
+
+  template <typename GetName>
+  TraceScope(const char* category, GetName getName)
+    : mEnabled(Trace::isEnabled())
+  {
+    if (mEnabled) {
+      mCategory = category;
+      mName = getName();
+      mStart = std::chrono::steady_clock::now();
+    }
+  }
+
+private:
+  bool                                  mEnabled = false;
+  const char*                           mCategory = nullptr;
+  std::string                           mName;
+  std::chrono::steady_clock::time_point mStart;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(category, name) \
+  TraceScope TRACE_CONCAT(traceScope_, __LINE__)(category, [&]() -> std::string { return name; })
+
+#endif // __TRACE_H__
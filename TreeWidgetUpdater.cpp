@@ -0,0 +1,134 @@
+#include "TreeWidgetUpdater.h"
+#include "Trace.h"
+
+static uint64_t sItemsCreated = 0;
+
+static QString getKey(const QTreeWidgetItem* item)
+{
+  return item->data(0, UPDATER_KEY_ROLE).toString();
+}
+
+TreeWidgetUpdater::TreeWidgetUpdater(QTreeWidget* tw)
+  : mTreeWidget(tw), mSorting(tw->isSortingEnabled())
+{
+  mTreeWidget->setSortingEnabled(false);
+  // The top level is cleaned up even if nothing is asked for
+  mReused.push_back(mTreeWidget->invisibleRootItem());
+}
+
+TreeWidgetUpdater::~TreeWidgetUpdater()
+{
+  finish();
+}
+
+void TreeWidgetUpdater::finish()
+{
+  if (mFinished) {
+    return;
+  }
+  mFinished = true;
+
+  TRACE_SCOPE("qt", "TreeWidgetUpdater " + mTreeWidget->objectName().toStdString());
+
+  // Items that had children last time but weren't asked for any now
+  for (QTreeWidgetItem* item : mReused) {
+    if ((item->childCount() > 0) && (! mLevels.contains(item))) {
+      qDeleteAll(item->takeChildren());
+    }
+  }
+  for (auto it = mLevels.begin(); it != mLevels.end(); ++it) {
+    finishLevel(it.key(), &it.value());
+  }
+
+  mTreeWidget->setSortingEnabled(mSorting);
+}
+
+QTreeWidgetItem* TreeWidgetUpdater::item(QTreeWidgetItem* parent, const QString& key, bool* pCreated)
+{
+  Q_ASSERT(! mFinished);
+  if (parent == nullptr) {
+    parent = mTreeWidget->invisibleRootItem();
+  }
+  Level& level = mLevels[parent];
+
+  // A similar device asks for the same keys in the same order, that needs no lookup
+  QTreeWidgetItem* item = nullptr;
+  if ((! level.indexed) && (level.cursor < parent->childCount()) && (getKey(parent->child(level.cursor)) == key)) {
+    item = parent->child(level.cursor++);
+  }
+  else {
+    if (! level.indexed) {
+      // Inserted back to front, QMultiHash::find() returns the last one inserted
+      for (int i = parent->childCount() - 1; i >= level.cursor; --i) {
+        level.unmatched.insert(getKey(parent->child(i)), parent->child(i));
+      }
+      level.indexed = true;
+    }
+    auto it = level.unmatched.find(key);
+    if (it != level.unmatched.end()) {
+      item = it.value();
+      level.unmatched.erase(it);
+    }
+  }
+
+  if (pCreated != nullptr) {
+    *pCreated = (item == nullptr);
+  }
+  if (item != nullptr) {
+    mReused.push_back(item);
+  }
+  else {
+    item = new SortableTreeWidgetItem();
+    item->setData(0, UPDATER_KEY_ROLE, key);
+    parent->addChild(item);
+    ++sItemsCreated;
+  }
+  level.order.push_back(item);
+  return item;
+}
+
+void TreeWidgetUpdater::finishLevel(QTreeWidgetItem* parent, Level* pLevel)
+{
+  if (! pLevel->indexed) {
+    // Everything asked for matched in place, the rest is left over
+    while (parent->childCount() > pLevel->cursor) {
+      delete parent->takeChild(parent->childCount() - 1);
+    }
+    return;
+  }
+
+  qDeleteAll(pLevel->unmatched);
+  pLevel->unmatched.clear();
+
+  // A tree sorted on a column sorts again anyway
+  if (mSorting && (mTreeWidget->sortColumn() >= 0)) {
+    return;
+  }
+  bool inOrder = true;
+  for (int i = 0; inOrder && (i < parent->childCount()); ++i) {
+    inOrder = (parent->child(i) == pLevel->order[i]);
+  }
+  if (inOrder) {
+    return;
+  }
+
+  // Taking the rows out loses their expansion in the view
+  QList<QTreeWidgetItem*> children;
+  std::vector<QTreeWidgetItem*> expanded;
+  for (QTreeWidgetItem* child : pLevel->order) {
+    children.append(child);
+    if (child->isExpanded()) {
+      expanded.push_back(child);
+    }
+  }
+  parent->takeChildren();
+  parent->addChildren(children);
+  for (QTreeWidgetItem* child : expanded) {
+    child->setExpanded(true);
+  }
+}
+
+uint64_t TreeWidgetUpdater::itemsCreated()
+{
+  return sItemsCreated;
+}
@@ -0,0 +1,67 @@
+#ifndef __TREE_WIDGET_UPDATER_H__
+#define __TREE_WIDGET_UPDATER_H__
+
+#include "SortableTreeWidgetItem.h"
+
+#include <QHash>
+#include <QMultiHash>
+#include <QString>
+
+#include <cstdint>
+#include <vector>
+
+//! Role holding the key an item was created for by TreeWidgetUpdater
+#define UPDATER_KEY_ROLE   (Qt::UserRole + 2)
+
+//! \class TreeWidgetUpdater
+//!
+//! Refills a tree in place instead of clear() and rebuild. Items are asked
+//! for by parent and key; one the tree already has for that key is handed
+//! back, anything else is created, and whatever wasn't asked for again is
+//! removed when the updater goes out of scope. QTreeWidgetItem::setData()
+//! ignores a value equal to the current one, so rewriting a reused item only
+//! costs for the cells that differ, and reused items keep their expansion,
+//! selection, hidden state and the scroll position.
+//!
+//! Sorting is off while alive like with TreeSortingBlocker. Unless the tree
+//! is sorted on a column, rows end up in the order they were asked for.
+//!
+class TreeWidgetUpdater {
+public:
+  explicit TreeWidgetUpdater(QTreeWidget* tw);
+  ~TreeWidgetUpdater();
+
+  TreeWidgetUpdater(const TreeWidgetUpdater&) = delete;
+  TreeWidgetUpdater& operator=(const TreeWidgetUpdater&) = delete;
+
+  //! Item for key under parent, nullptr for a top level item. Keys only
+  //! have to be unique among siblings; repeated keys are matched in order.
+  QTreeWidgetItem*  item(QTreeWidgetItem* parent, const QString& key, bool* pCreated = nullptr);
+
+  //! Removes what wasn't asked for and turns sorting back on, done by the
+  //! destructor otherwise. Call it before sizing columns to the contents.
+  void              finish();
+
+  //! Items created by every updater so far, for memory accounting
+  static uint64_t   itemsCreated();
+
+private:
+  struct Level {
+    // Children [0, cursor) matched in place, the rest is indexed on the first miss
+    int                                       cursor = 0;
+    bool                                      indexed = false;
+    QMultiHash<QString, QTreeWidgetItem*>     unmatched;
+    std::vector<QTreeWidgetItem*>             order;
+  };
+
+  void              finishLevel(QTreeWidgetItem* parent, Level* pLevel);
+
+private:
+  QTreeWidget*                        mTreeWidget = nullptr;
+  bool                                mSorting = false;
+  bool                                mFinished = false;
+  QHash<QTreeWidgetItem*, Level>      mLevels;
+  std::vector<QTreeWidgetItem*>       mReused;
+};
+
+#endif // __TREE_WIDGET_UPDATER_H__
@@ -0,0 +1,101 @@
+#include "VkProfiler.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstdint>
+
+// -------------------------------------------------------------------------------------------------
+// VkProfiler
+// -------------------------------------------------------------------------------------------------
+uint64_t VkProfiler::Stats::percentileNs(double percentile) const
+{
+  if (count == 0) {
+    return 0;
+  }
+
+  uint64_t threshold = static_cast<uint64_t>(percentile * count);
+  uint64_t accumulated = 0;
+  for (size_t i = 0; i < histogram.size(); ++i) {
+    accumulated += histogram[i];
+    if (accumulated > threshold) {
+      return std::min<uint64_t>(maxNs, (static_cast<uint64_t>(2) << i) - 1);
+    }
+  }
+  return maxNs;
+}
+
+void VkProfiler::Stats::merge(const Stats& other)
+{
+  count += other.count;
+  totalNs += other.totalNs;
+  minNs = std::min(minNs, other.minNs);
+  maxNs = std::max(maxNs, other.maxNs);
+  for (size_t i = 0; i < histogram.size(); ++i) {
+    histogram[i] += other.histogram[i];
+  }
+}
+
+VkProfiler& VkProfiler::get()
+{
+  static VkProfiler sProfiler;
+  return sProfiler;
+}
+
+void VkProfiler::record(const char* function, VkPhysicalDevice gpu, uint64_t durationNs)
+{
+  size_t bucket = 0;
+  while ((bucket + 1 < kBucketCount) && ((durationNs >> (bucket + 1)) != 0)) {
+    ++bucket;
+  }
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  Stats& stats = mStats[RecordKey(function, gpu)];
+  stats.count += 1;
+  stats.totalNs += durationNs;
+  stats.minNs = std::min(stats.minNs, durationNs);
+  stats.maxNs = std::max(stats.maxNs, durationNs);
+  stats.histogram[bucket] += 1;
+}
+
+VkProfiler::StatsMap VkProfiler::snapshot() const
+{
+  std::map<RecordKey, Stats> stats;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    stats = mStats;
+  }
+
+  // The same name can come from literals in different translation units
+  StatsMap statsMap;
+  for (const auto& entry : stats) {
+    statsMap[Key(entry.first.first, entry.first.second)].merge(entry.second);
+  }
+  return statsMap;
+}
+
+void VkProfiler::reset()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mStats.clear();
+}
+
+// -------------------------------------------------------------------------------------------------
+// VkProfileScope
+// -------------------------------------------------------------------------------------------------
+VkProfileScope::VkProfileScope(const char* function, VkPhysicalDevice gpu)
+  : mFunction(function),
+    mGpu(gpu),
+    mStart(std::chrono::steady_clock::now())
+{
+}
+
+VkProfileScope::~VkProfileScope()
+{
+  auto end = std::chrono::steady_clock::now();
+  auto durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - mStart).count();
+  VkProfiler::get().record(mFunction, mGpu, static_cast<uint64_t>(durationNs));
+
+  if ((mGpu != VK_NULL_HANDLE) && Trace::isEnabled()) {
+    Trace::addCompleteEvent("driver", mFunction, mStart, end);
+  }
+}
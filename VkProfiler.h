@@ -0,0 +1,76 @@
+#ifndef __VK_PROFILER_H__
+#define __VK_PROFILER_H__
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+//! \class VkProfiler
+//!
+//! Call counts and latency histograms per Vulkan entry point and physical
+//! device. Calls are routed through VK_CALL, which times them and feeds the
+//! process wide profiler; instance-level calls use VK_NULL_HANDLE.
+//!
+//! record() keys by the function name pointer, which must outlive the
+//! profiler (VK_CALL passes a string literal); names only become strings
+//! in snapshot().
+//!
+class VkProfiler {
+public:
+  // Bucket i counts calls that took [2^i, 2^(i+1)) nanoseconds
+  enum { kBucketCount = 32 };
+
+  struct Stats {
+    uint64_t                              count = 0;
+    uint64_t                              totalNs = 0;
+    uint64_t                              minNs = UINT64_MAX;
+    uint64_t                              maxNs = 0;
+    std::array<uint64_t, kBucketCount>    histogram = {};
+
+    //! Upper bound of the bucket holding the given percentile, in nanoseconds
+    uint64_t percentileNs(double percentile) const;
+    void     merge(const Stats& other);
+  };
+
+  using Key = std::pair<std::string, VkPhysicalDevice>;
+  using StatsMap = std::map<Key, Stats>;
+
+  static VkProfiler& get();
+
+  void      record(const char* function, VkPhysicalDevice gpu, uint64_t durationNs);
+  StatsMap  snapshot() const;
+  void      reset();
+
+private:
+  using RecordKey = std::pair<const char*, VkPhysicalDevice>;
+
+  mutable std::mutex              mMutex;
+  std::map<RecordKey, Stats>      mStats;
+};
+
+//! \class VkProfileScope
+//!
+//! Times its own lifetime. Device-level calls also show up as "driver"
+//! events when tracing is enabled.
+//!
+class VkProfileScope {
+public:
+  VkProfileScope(const char* function, VkPhysicalDevice gpu);
+  ~VkProfileScope();
+
+private:
+  const char*                           mFunction;
+  VkPhysicalDevice                      mGpu;
+  std::chrono::steady_clock::time_point mStart;
+};
+
+//! Wraps a Vulkan call, the temporary lives until the end of the full expression:
+//!   VkResult res = VK_CALL(gpu, vkGetPhysicalDeviceImageFormatProperties, gpu, format, ...);
+#define VK_CALL(gpu, func, ...) (VkProfileScope(#func, gpu), func(__VA_ARGS__))
+
+#endif // __VK_PROFILER_H__
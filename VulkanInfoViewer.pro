@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+QT       += core gui concurrent network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -27,12 +27,80 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 SOURCES += main.cpp\
         mainwindow.cpp \
-    ToString.cpp
+    Benchmark.cpp \
+    CapabilityHistory.cpp \
+    CapabilityServer.cpp \
+    DeviceCapture.cpp \
+    DeviceGroups.cpp \
+    DeviceMonitor.cpp \
+    DeviceProfile.cpp \
+    ExtensionSet.cpp \
+    FormatBenchmark.cpp \
+    FormatMatrixWidget.cpp \
+    FormatTable.cpp \
+    ManifestScanner.cpp \
+    MemoryAccounting.cpp \
+    MemoryBenchmark.cpp \
+    MemoryBudgetMonitor.cpp \
+    MemoryBudgetPlot.cpp \
+    PipelineCacheInspector.cpp \
+    PNextChain.cpp \
+    QueueBenchmark.cpp \
+    SnapshotArchive.cpp \
+    SparseImageFormats.cpp \
+    StartupProfiler.cpp \
+    ToString.cpp \
+    Trace.cpp \
+    TreeWidgetUpdater.cpp \
+    VkProfiler.cpp
 
 HEADERS  += mainwindow.h \
-    ToString.h
+    Benchmark.h \
+    CapabilityHistory.h \
+    CapabilityServer.h \
+    DeviceCapture.h \
+    DeviceGroups.h \
+    DeviceMonitor.h \
+    DeviceProfile.h \
+    ExtensionSet.h \
+    FormatBenchmark.h \
+    FormatMatrixWidget.h \
+    FormatTable.h \
+    ManifestScanner.h \
+    MemoryAccounting.h \
+    MemoryBenchmark.h \
+    MemoryBudgetMonitor.h \
+    MemoryBudgetPlot.h \
+    PipelineCacheInspector.h \
+    PNextChain.h \
+    QueueBenchmark.h \
+    SnapshotArchive.h \
+    SortableTreeWidgetItem.h \
+    SparseImageFormats.h \
+    SpscRing.h \
+    StartupProfiler.h \
+    ToString.h \
+    Trace.h \
+    TreeWidgetUpdater.h \
+    VkProfiler.h
 
-FORMS    += mainwindow.ui
+FORMS    += mainwindow.ui \
+    pages/AboutPage.ui \
+    pages/DeviceGroupsPage.ui \
+    pages/DiagnosticsPage.ui \
+    pages/ExtensionsPage.ui \
+    pages/FeaturesPage.ui \
+    pages/FormatsPage.ui \
+    pages/GeneralPage.ui \
+    pages/HistoryPage.ui \
+    pages/LayersPage.ui \
+    pages/LimitsPage.ui \
+    pages/MemoryPage.ui \
+    pages/PipelineCachePage.ui \
+    pages/ProfilerPage.ui \
+    pages/QueuesPage.ui \
+    pages/SparsePage.ui \
+    pages/SurfacePage.ui
 
 unix:INCLUDEPATH += "$$(VULKAN_SDK)/include"
 unix:LIBS += -L"$$(VULKAN_SDK)/lib"
@@ -1,16 +1,188 @@
 #include "mainwindow.h"
+#include "CapabilityServer.h"
+#include "SnapshotArchive.h"
+#include "StartupProfiler.h"
+#include "Trace.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QEvent>
+#include <QFileInfo>
+#include <QJsonDocument>
 #include <QStyleFactory>
 
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+//! Records main() to the first paint of the window as the "firstPaint"
+//! event, the cold start figure to compare between builds
+class FirstPaintTracer : public QObject {
+public:
+  explicit FirstPaintTracer(std::chrono::steady_clock::time_point start)
+    : mStart(start) {}
+
+  bool eventFilter(QObject* watched, QEvent* event) override
+  {
+    if (event->type() == QEvent::Paint) {
+      watched->removeEventFilter(this);
+      Trace::addCompleteEvent("qt", "firstPaint", mStart, std::chrono::steady_clock::now());
+    }
+    return false;
+  }
+
+private:
+  std::chrono::steady_clock::time_point mStart;
+};
+
+static int runDaemon(int argc, char *argv[], const QString& serverName)
+{
+  QCoreApplication a(argc, argv);
+
+  CapabilityServer server;
+  VkResult res = server.capture();
+  if (res != VK_SUCCESS) {
+    fprintf(stderr, "Device capture failed (%d), serving what was captured\n", res);
+  }
+  if (! server.listen(serverName)) {
+    fprintf(stderr, "Unable to listen on %s: %s\n", qPrintable(serverName),
+            server.errorString().isEmpty() ? "another daemon is running" : qPrintable(server.errorString()));
+    return 1;
+  }
+  fprintf(stderr, "Listening on %s\n", qPrintable(server.fullServerName()));
+
+  int result = a.exec();
+  Trace::flush();
+  return result;
+}
+
+static int runQuery(int argc, char *argv[], const QString& serverName, const QString& request)
+{
+  QCoreApplication a(argc, argv);
+
+  QByteArray reply = CapabilityServer::query(serverName, request, 5000);
+  if (reply.isEmpty()) {
+    fprintf(stderr, "No reply from %s\n", qPrintable(serverName));
+    return 1;
+  }
+  fwrite(reply.constData(), 1, reply.size(), stdout);
+  return reply.startsWith("ok ") ? 0 : 1;
+}
+
+static int runArchive(int argc, char *argv[], const QString& archivePath, const QStringList& snapshots, const QString& extractMachine)
+{
+  QCoreApplication a(argc, argv);
+
+  SnapshotArchive archive;
+  if (! archive.open(archivePath)) {
+    fprintf(stderr, "Unable to open archive %s\n", qPrintable(archivePath));
+    return 1;
+  }
+
+  if (! extractMachine.isEmpty()) {
+    DeviceProfileSet profileSet;
+    if (! archive.load(extractMachine, &profileSet)) {
+      fprintf(stderr, "No machine %s in %s\n", qPrintable(extractMachine), qPrintable(archivePath));
+      return 1;
+    }
+    QByteArray json = QJsonDocument(deviceProfileSetToJson(profileSet)).toJson();
+    fwrite(json.constData(), 1, json.size(), stdout);
+    return 0;
+  }
+
+  // Snapshots are named after the machine they came from
+  int result = 0;
+  for (const auto& filePath : snapshots) {
+    DeviceProfileSet profileSet;
+    if ((! loadDeviceProfileSet(filePath, &profileSet)) || (! archive.ingest(QFileInfo(filePath).completeBaseName(), profileSet))) {
+      fprintf(stderr, "Unable to ingest %s\n", qPrintable(filePath));
+      result = 1;
+    }
+  }
+
+  SnapshotArchive::Stats stats = archive.stats();
+  fprintf(stderr, "%d machines, %d records (%lld bytes), %d sections (%lld bytes)\n",
+          stats.machineCount, stats.recordCount, static_cast<long long>(stats.recordBytes),
+          stats.sectionCount, static_cast<long long>(stats.sectionBytes));
+  return result;
+}
+
 int main(int argc, char *argv[])
 {
+  // The trace epoch is set on first use, so it comes before the start time
+  bool tracing = Trace::isEnabled();
+  auto mainStart = std::chrono::steady_clock::now();
+
+  // Parsed before the application exists, --daemon, --query and --startup-probe must not need a display
+  QStringList arguments;
+  for (int i = 0; i < argc; ++i) {
+    arguments << QString::fromLocal8Bit(argv[i]);
+  }
+  QCommandLineOption daemonOption("daemon", "Capture every device once and answer queries on a local socket, see CapabilityServer.h.");
+  QCommandLineOption queryOption("query", "Send <request> to a running daemon, print the reply and exit.", "request");
+  QCommandLineOption serverNameOption("server-name", "Local socket name used by --daemon and --query.", "name", CapabilityServer::defaultServerName());
+  QCommandLineOption archiveOption("archive", "Ingest the snapshot files given as arguments into the archive at <dir>, see SnapshotArchive.h.", "dir");
+  QCommandLineOption extractOption("extract", "With --archive, print the newest snapshot of <machine>.", "machine");
+  QCommandLineOption startupProbeOption("startup-probe", "Time vkCreateInstance with the layer given as argument, or none, print the result and exit. Run by the layer profiler, see StartupProfiler.h.");
+  QCommandLineOption probeApiVersionOption(kProbeApiVersionOption, "With --startup-probe, the instance apiVersion, 1.0 by default.", "version");
+  QCommandLineOption probeExtensionsOption(kProbeExtensionsOption, "With --startup-probe, comma separated instance extensions to enable.", "names");
+  QCommandLineParser parser;
+  parser.addOption(daemonOption);
+  parser.addOption(queryOption);
+  parser.addOption(serverNameOption);
+  parser.addOption(archiveOption);
+  parser.addOption(extractOption);
+  parser.addOption(startupProbeOption);
+  parser.addOption(probeApiVersionOption);
+  parser.addOption(probeExtensionsOption);
+  // Unknown options are left for QApplication (-style, -platform, ...)
+  parser.parse(arguments);
+
+  if (parser.isSet(daemonOption)) {
+    return runDaemon(argc, argv, parser.value(serverNameOption));
+  }
+  if (parser.isSet(queryOption)) {
+    return runQuery(argc, argv, parser.value(serverNameOption), parser.value(queryOption));
+  }
+  if (parser.isSet(archiveOption)) {
+    return runArchive(argc, argv, parser.value(archiveOption), parser.positionalArguments(), parser.value(extractOption));
+  }
+  if (parser.isSet(startupProbeOption)) {
+    // The lowest version every loader and driver accepts, unless asked for another
+    uint32_t apiVersion = parser.isSet(probeApiVersionOption) ? parser.value(probeApiVersionOption).toUInt() : VK_API_VERSION_1_0;
+    QStringList extensions = parser.value(probeExtensionsOption).split(',', QString::SkipEmptyParts);
+    return runStartupProbe(parser.positionalArguments().value(0), apiVersion, extensions);
+  }
+
   QCoreApplication::addLibraryPath(".");
 #if defined(_WIN32)
   QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
 #endif
   QApplication a(argc, argv);
-  MainWindow w;
-  w.show();
 
-  return a.exec();
+  int result = 0;
+  {
+    FirstPaintTracer firstPaintTracer(mainStart);
+    std::unique_ptr<MainWindow> w;
+    {
+      TRACE_SCOPE("qt", "MainWindow");
+      w.reset(new MainWindow());
+    }
+    if (tracing) {
+      w->installEventFilter(&firstPaintTracer);
+    }
+    {
+      TRACE_SCOPE("qt", "show");
+      w->show();
+    }
+
+    result = a.exec();
+
+    TRACE_SCOPE("qt", "teardown");
+    w.reset();
+  }
+
+  // Written after the window is gone so teardown is part of the trace
+  Trace::flush();
+
+  return result;
 }
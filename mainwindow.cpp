@@ -1,6 +1,34 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "ui_AboutPage.h"
+#include "ui_DeviceGroupsPage.h"
+#include "ui_DiagnosticsPage.h"
+#include "ui_ExtensionsPage.h"
+#include "ui_FeaturesPage.h"
+#include "ui_FormatsPage.h"
+#include "ui_GeneralPage.h"
+#include "ui_HistoryPage.h"
+#include "ui_LayersPage.h"
+#include "ui_LimitsPage.h"
+#include "ui_MemoryPage.h"
+#include "ui_PipelineCachePage.h"
+#include "ui_ProfilerPage.h"
+#include "ui_QueuesPage.h"
+#include "ui_SparsePage.h"
+#include "ui_SurfacePage.h"
+#include "CapabilityHistory.h"
+#include "DeviceCapture.h"
+#include "DeviceMonitor.h"
+#include "DeviceProfile.h"
+#include "FormatMatrixWidget.h"
+#include "FormatTable.h"
+#include "MemoryAccounting.h"
+#include "MemoryBudgetPlot.h"
+#include "SortableTreeWidgetItem.h"
 #include "ToString.h"
+#include "Trace.h"
+#include "TreeWidgetUpdater.h"
+#include "VkProfiler.h"
 
 #if defined(VK_USE_PLATFORM_WIN32_KHR)
   #include <Windows.h>
@@ -9,15 +37,92 @@
   //#include <X11/Xutil.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <sstream>
 
+#include <QCheckBox>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QPushButton>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QSignalBlocker>
+#include <QSpinBox>
 #include <QStandardItemModel>
+#include <QTextStream>
+#include <QTreeWidgetItemIterator>
 
 #define IHV_VENDOR_ID_AMD     0x1002
 #define IHV_VENDOR_ID_INTEL   0x8086
 #define IHV_VENDOR_ID_NVIDIA  0x10DE
 
+// Pages of tabWidget, each is an empty placeholder in mainwindow.ui and is
+// filled from its own form in pages/ the first time it is shown
+#define PAGE_GENERAL          "tab_4"
+#define PAGE_LAYERS           "tab"
+#define PAGE_EXTENSIONS       "tab_2"
+#define PAGE_LIMITS           "tab_7"
+#define PAGE_SPARSE           "tab_10"
+#define PAGE_FEATURES         "tab_9"
+#define PAGE_SURFACE          "tab_3"
+#define PAGE_QUEUES           "tab_8"
+#define PAGE_MEMORY           "tab_5"
+#define PAGE_FORMATS          "tab_6"
+#define PAGE_DEVICE_GROUPS    "tab_23"
+#define PAGE_PROFILER         "tab_18"
+#define PAGE_PIPELINE_CACHE   "tab_19"
+#define PAGE_HISTORY          "tab_22"
+#define PAGE_DIAGNOSTICS      "tab_21"
+#define PAGE_ABOUT            "tab_15"
+
+// Driver memory that doesn't belong to a page, see MemoryAccounting.h
+#define MEMORY_SCOPE_INSTANCE "Instance"
+
+template <typename Form>
+static void setupPage(QWidget* page)
+{
+  // The widgets belong to the page, the form object is only needed to create them
+  Form form;
+  form.setupUi(page);
+}
+
+struct PageForm {
+  const char* name;
+  void        (*setup)(QWidget* page);
+};
+
+static const PageForm sPageForms[] = {
+  { PAGE_GENERAL,         &setupPage<Ui::GeneralPage> },
+  { PAGE_LAYERS,          &setupPage<Ui::LayersPage> },
+  { PAGE_EXTENSIONS,      &setupPage<Ui::ExtensionsPage> },
+  { PAGE_LIMITS,          &setupPage<Ui::LimitsPage> },
+  { PAGE_SPARSE,          &setupPage<Ui::SparsePage> },
+  { PAGE_FEATURES,        &setupPage<Ui::FeaturesPage> },
+  { PAGE_SURFACE,         &setupPage<Ui::SurfacePage> },
+  { PAGE_QUEUES,          &setupPage<Ui::QueuesPage> },
+  { PAGE_MEMORY,          &setupPage<Ui::MemoryPage> },
+  { PAGE_FORMATS,         &setupPage<Ui::FormatsPage> },
+  { PAGE_DEVICE_GROUPS,   &setupPage<Ui::DeviceGroupsPage> },
+  { PAGE_PROFILER,        &setupPage<Ui::ProfilerPage> },
+  { PAGE_PIPELINE_CACHE,  &setupPage<Ui::PipelineCachePage> },
+  { PAGE_HISTORY,         &setupPage<Ui::HistoryPage> },
+  { PAGE_DIAGNOSTICS,     &setupPage<Ui::DiagnosticsPage> },
+  { PAGE_ABOUT,           &setupPage<Ui::AboutPage> },
+};
+
+// Page widgets don't exist when setupUi(this) auto-connects, so their slots
+// are named to stay out of its way and connectPageSlots() wires them by hand.
+// A typo in a name or signature still shows up as a QObject::connect warning.
+static void connectChild(QWidget* page, const char* name, const char* signal, QObject* receiver, const char* slot)
+{
+  QObject* child = page->findChild<QObject*>(name);
+  Q_ASSERT(child);
+  QObject::connect(child, signal, receiver, slot);
+}
 
 void HideItem(int row, QComboBox* cb)
 {
@@ -35,6 +140,14 @@ void MakeCheckable(QComboBox* cb)
   }
 }
 
+void resizeColumns(QTreeWidget* tw)
+{
+  TRACE_SCOPE("qt", "resizeColumns " + tw->objectName().toStdString());
+  for (int i = 0; i < tw->columnCount(); ++i) {
+    tw->resizeColumnToContents(i);
+  }
+}
+
 //! \class MainWindow
 //!
 //!
@@ -42,8 +155,158 @@ MainWindow::MainWindow(QWidget *parent) :
   QMainWindow(parent),
   ui(new Ui::MainWindow)
 {
-  ui->setupUi(this);
+  {
+    TRACE_SCOPE("qt", "setupUi");
+    ui->setupUi(this);
+  }
+
+  if (QString::fromLocal8Bit(qgetenv("VIV_INSTANCE_MODE")).compare("full", Qt::CaseInsensitive) == 0) {
+    mInstanceMode = INSTANCE_MODE_FULL;
+  }
+
+  createVulkanInstance();
+  createVulkanSurface();
+  enumerateGpus();
+  populateGpus();
+
+  // The sampler runs on its own thread, the plot only redraws at display rate
+  mMemoryBudgetTimer.setInterval(33);
+  connect(&mMemoryBudgetTimer, SIGNAL(timeout()), this, SLOT(onMemoryBudgetTimerTimeout()));
+
+  // Only runs while the Diagnostics page is shown
+  mDiagnosticsTimer.setInterval(1000);
+  connect(&mDiagnosticsTimer, SIGNAL(timeout()), this, SLOT(onDiagnosticsTimerTimeout()));
+
+  connect(&mMemoryBenchmark, SIGNAL(finished()), this, SLOT(onMemoryBenchmarkFinished()));
+  connect(&mQueueBenchmark, SIGNAL(finished()), this, SLOT(onQueueBenchmarkFinished()));
+  connect(&mFormatBenchmark, SIGNAL(finished()), this, SLOT(onFormatBenchmarkFinished()));
+  connect(&mPeerCopyBenchmark, SIGNAL(finished()), this, SLOT(onPeerCopyBenchmarkFinished()));
+  connect(&mPeerMemoryQuery, SIGNAL(finished()), this, SLOT(onPeerMemoryQueryFinished()));
+  connect(&mSparseImageFormats, SIGNAL(finished()), this, SLOT(onSparseImageFormatsFinished()));
+
+  connect(&mStartupProfile, SIGNAL(finished()), this, SLOT(onStartupProfileFinished()));
+
+  // Opt-in, every run and every driver change adds a snapshot. Captured
+  // once the instance modes are timed, see measureInstanceModes().
+  mHistoryDir = QString::fromLocal8Bit(qgetenv("VIV_HISTORY_DIR"));
+  connect(&mHistoryAppend, SIGNAL(finished()), this, SLOT(onHistoryAppendFinished()));
+
+  mDeviceMonitor = new DeviceMonitor(this);
+  connect(mDeviceMonitor, SIGNAL(devicesChanged()), this, SLOT(onDevicesChanged()));
+
+  // Suspends the monitor, its baseline probe runs once the timing is done
+  connect(&mInstanceModeTiming, SIGNAL(finished()), this, SLOT(onInstanceModeTimingFinished()));
+  measureInstanceModes();
+  mDeviceMonitor->start(true);
+  appendHistory();
+
+  QTabWidget* tabs = findChild<QTabWidget*>("tabWidget");
+  Q_ASSERT(tabs);
+  buildPage(tabs->currentWidget());
+}
+
+bool MainWindow::isPageBuilt(const QString& name) const
+{
+  return mBuiltPages.contains(name);
+}
+
+bool MainWindow::buildPage(QWidget* page)
+{
+  if ((page == nullptr) || isPageBuilt(page->objectName())) {
+    return false;
+  }
+
+  QString name = page->objectName();
+  auto it = std::find_if(std::begin(sPageForms), std::end(sPageForms),
+                         [&name](const PageForm& form) -> bool { return name == form.name; });
+  if (it == std::end(sPageForms)) {
+    return false;
+  }
+
+  {
+    TRACE_SCOPE("qt", "buildPage " + name.toStdString());
+    it->setup(page);
+  }
+  mBuiltPages.insert(name);
+  connectPageSlots(page);
+
+  // Every tree sorts on a header click, until then rows keep the order they were added in
+  for (auto tw : page->findChildren<QTreeWidget*>()) {
+    tw->header()->setSortIndicator(-1, Qt::AscendingOrder);
+    tw->setSortingEnabled(true);
+  }
+
+  if (name == PAGE_FORMATS) {
+    setupFormatFilters();
+  }
+
+  populateInstancePage(name);
+  if (mCurrentGpuProperties != nullptr) {
+    populateDevicePage(name, mCurrentGpuProperties);
+  }
+  return true;
+}
+
+void MainWindow::connectPageSlots(QWidget* page)
+{
+  QString name = page->objectName();
+  if (name == PAGE_LAYERS) {
+    connectChild(page, "layersProfileBtn", SIGNAL(clicked()), this, SLOT(onLayersProfileBtnClicked()));
+  }
+  else if (name == PAGE_LIMITS) {
+    connectChild(page, "limitsFilter", SIGNAL(textChanged(QString)), this, SLOT(onLimitsFilterTextChanged(QString)));
+  }
+  else if (name == PAGE_SPARSE) {
+    connectChild(page, "sparseImageFormatFilter", SIGNAL(textChanged(QString)), this, SLOT(onSparseImageFormatFilterTextChanged(QString)));
+  }
+  else if (name == PAGE_FEATURES) {
+    connectChild(page, "featuresFilter", SIGNAL(textChanged(QString)), this, SLOT(onFeaturesFilterTextChanged(QString)));
+  }
+  else if (name == PAGE_QUEUES) {
+    connectChild(page, "queueBenchmarkBtn", SIGNAL(clicked()), this, SLOT(onQueueBenchmarkBtnClicked()));
+  }
+  else if (name == PAGE_MEMORY) {
+    connectChild(page, "memoryBudgetEnabled", SIGNAL(toggled(bool)), this, SLOT(onMemoryBudgetEnabledToggled(bool)));
+    connectChild(page, "memoryBudgetRate", SIGNAL(valueChanged(int)), this, SLOT(onMemoryBudgetRateValueChanged(int)));
+    connectChild(page, "memoryBenchmarkBtn", SIGNAL(clicked()), this, SLOT(onMemoryBenchmarkBtnClicked()));
+  }
+  else if (name == PAGE_FORMATS) {
+    connectChild(page, "formatFilter", SIGNAL(textChanged(QString)), this, SLOT(onFormatFilterTextChanged(QString)));
+    connectChild(page, "tilingLinearImageType", SIGNAL(currentIndexChanged(int)), this, SLOT(onTilingLinearImageTypeCurrentIndexChanged(int)));
+    connectChild(page, "tilingOptimalImageType", SIGNAL(currentIndexChanged(int)), this, SLOT(onTilingOptimalImageTypeCurrentIndexChanged(int)));
+    connectChild(page, "tilingLinearFormatFilter", SIGNAL(textChanged(QString)), this, SLOT(onTilingLinearFormatFilterTextChanged(QString)));
+    connectChild(page, "tilingOptimalFormatFilter", SIGNAL(textChanged(QString)), this, SLOT(onTilingOptimalFormatFilterTextChanged(QString)));
+    connectChild(page, "bufferFormatFilter", SIGNAL(textChanged(QString)), this, SLOT(onBufferFormatFilterTextChanged(QString)));
+    connectChild(page, "formatMatrixFilter", SIGNAL(textChanged(QString)), this, SLOT(onFormatMatrixFilterTextChanged(QString)));
+    connectChild(page, "expandAllBtn", SIGNAL(clicked()), this, SLOT(onExpandAllBtnClicked()));
+    connectChild(page, "collapseAllBtn", SIGNAL(clicked()), this, SLOT(onCollapseAllBtnClicked()));
+    connectChild(page, "tilingOptimalBenchmarkBtn", SIGNAL(clicked()), this, SLOT(onTilingOptimalBenchmarkBtnClicked()));
+  }
+  else if (name == PAGE_DEVICE_GROUPS) {
+    connectChild(page, "peerCopyBenchmarkBtn", SIGNAL(clicked()), this, SLOT(onPeerCopyBenchmarkBtnClicked()));
+  }
+  else if (name == PAGE_PROFILER) {
+    connectChild(page, "profilerRefreshBtn", SIGNAL(clicked()), this, SLOT(onProfilerRefreshBtnClicked()));
+    connectChild(page, "profilerResetBtn", SIGNAL(clicked()), this, SLOT(onProfilerResetBtnClicked()));
+    connectChild(page, "profilerExportBtn", SIGNAL(clicked()), this, SLOT(onProfilerExportBtnClicked()));
+  }
+  else if (name == PAGE_PIPELINE_CACHE) {
+    connectChild(page, "pipelineCacheOpenBtn", SIGNAL(clicked()), this, SLOT(onPipelineCacheOpenBtnClicked()));
+    connectChild(page, "pipelineCacheOpenSnapshotsBtn", SIGNAL(clicked()), this, SLOT(onPipelineCacheOpenSnapshotsBtnClicked()));
+    connectChild(page, "pipelineCacheSaveSnapshotBtn", SIGNAL(clicked()), this, SLOT(onPipelineCacheSaveSnapshotBtnClicked()));
+    connectChild(page, "pipelineCacheClearBtn", SIGNAL(clicked()), this, SLOT(onPipelineCacheClearBtnClicked()));
+  }
+  else if (name == PAGE_HISTORY) {
+    connectChild(page, "historyFilter", SIGNAL(textChanged(QString)), this, SLOT(onHistoryFilterTextChanged(QString)));
+  }
+  else if (name == PAGE_DIAGNOSTICS) {
+    connectChild(page, "diagnosticsRefreshBtn", SIGNAL(clicked()), this, SLOT(onDiagnosticsRefreshBtnClicked()));
+    connectChild(page, "diagnosticsResetBtn", SIGNAL(clicked()), this, SLOT(onDiagnosticsResetBtnClicked()));
+  }
+}
 
+void MainWindow::setupFormatFilters()
+{
   mTilingLinearFilterInputs.tiling            = VK_IMAGE_TILING_LINEAR;
   mTilingLinearFilterInputs.formatFilter      = findChild<QLineEdit*>("tilingLinearFormatFilter");
   mTilingLinearFilterInputs.imageTypeFilter   = findChild<QComboBox*>("tilingLinearImageType");
@@ -84,76 +347,309 @@ MainWindow::MainWindow(QWidget *parent) :
   MakeCheckable(mTilingOptimalFilterInputs.usageFlagsFilter);
   MakeCheckable(mTilingOptimalFilterInputs.createFlagsFilter);
 
-  // Connect the check events to MainWindow::on_itemChanged
-  connect(mTilingLinearFilterInputs.usageFlagsFilter->model(), SIGNAL(itemChanged(QStandardItem*)), this, SLOT(on_itemChanged(QStandardItem*)));
-  connect(mTilingLinearFilterInputs.createFlagsFilter->model(), SIGNAL(itemChanged(QStandardItem*)), this, SLOT(on_itemChanged(QStandardItem*)));
-  connect(mTilingOptimalFilterInputs.usageFlagsFilter->model(), SIGNAL(itemChanged(QStandardItem*)), this, SLOT(on_itemChanged(QStandardItem*)));
-  connect(mTilingOptimalFilterInputs.createFlagsFilter->model(), SIGNAL(itemChanged(QStandardItem*)), this, SLOT(on_itemChanged(QStandardItem*)));
+  // Connect the check events to MainWindow::onItemChanged
+  connect(mTilingLinearFilterInputs.usageFlagsFilter->model(), SIGNAL(itemChanged(QStandardItem*)), this, SLOT(onItemChanged(QStandardItem*)));
+  connect(mTilingLinearFilterInputs.createFlagsFilter->model(), SIGNAL(itemChanged(QStandardItem*)), this, SLOT(onItemChanged(QStandardItem*)));
+  connect(mTilingOptimalFilterInputs.usageFlagsFilter->model(), SIGNAL(itemChanged(QStandardItem*)), this, SLOT(onItemChanged(QStandardItem*)));
+  connect(mTilingOptimalFilterInputs.createFlagsFilter->model(), SIGNAL(itemChanged(QStandardItem*)), this, SLOT(onItemChanged(QStandardItem*)));
+}
+
+//! Items in every tree of page, and optionally the bytes their text takes
+static void countTreeItems(QWidget* page, uint64_t* pItems, uint64_t* pTextBytes)
+{
+  *pItems = 0;
+  if (pTextBytes != nullptr) {
+    *pTextBytes = 0;
+  }
+  if (page == nullptr) {
+    return;
+  }
+  for (auto tw : page->findChildren<QTreeWidget*>()) {
+    for (QTreeWidgetItemIterator it(tw); *it; ++it) {
+      *pItems += 1;
+      for (int c = 0; (pTextBytes != nullptr) && (c < (*it)->columnCount()); ++c) {
+        *pTextBytes += (*it)->text(c).size() * sizeof(QChar);
+      }
+    }
+  }
+}
+
+void MainWindow::recordPagePopulated(const QString& name)
+{
+  uint64_t items = 0;
+  countTreeItems(findChild<QWidget*>(name), &items, nullptr);
+  MemoryAccounting::get().recordPopulate(name.toStdString(), MemoryAccounting::NO_GPU, "", items);
+}
 
-  createVulkanInstance();
-  createVulkanSurface();
-  enumerateGpus();
-  populateGpus();
+int MainWindow::getGpuIndex(const GpuProperties* pGpuProperties) const
+{
+  return static_cast<int>(pGpuProperties - mGpuProperties.data());
+}
+
+void MainWindow::populateInstancePage(const QString& name)
+{
+  MemoryScope memoryScope(name.toStdString(), MemoryAccounting::NO_GPU, "");
+
+  if (name == PAGE_LAYERS) {
+    populateInstanceLayers();
+    populateIcds();
+  }
+  else if (name == PAGE_EXTENSIONS) {
+    populateInstanceExtensions();
+  }
+  else if (name == PAGE_DEVICE_GROUPS) {
+    populateDeviceGroups();
+  }
+  else if (name == PAGE_PROFILER) {
+    populateInstanceTimings();
+    populateProfiler();
+  }
+  else if (name == PAGE_PIPELINE_CACHE) {
+    populatePipelineCaches();
+  }
+  else if (name == PAGE_HISTORY) {
+    populateHistory();
+  }
+  else if (name == PAGE_DIAGNOSTICS) {
+    populateDiagnostics();
+  }
+  else {
+    return;
+  }
+
+  recordPagePopulated(name);
+}
+
+void MainWindow::populateDevicePage(const QString& name, const GpuProperties* pGpuProperties)
+{
+  MemoryScope memoryScope(name.toStdString(), getGpuIndex(pGpuProperties), pGpuProperties->description);
+  uint64_t itemsCreated = TreeWidgetUpdater::itemsCreated();
+
+  if (name == PAGE_GENERAL) {
+    populateGeneral(pGpuProperties);
+  }
+  else if (name == PAGE_EXTENSIONS) {
+    populateDeviceExtensions(pGpuProperties);
+  }
+  else if (name == PAGE_LIMITS) {
+    populateLimits(pGpuProperties);
+  }
+  else if (name == PAGE_SPARSE) {
+    populateSparse(pGpuProperties);
+  }
+  else if (name == PAGE_FEATURES) {
+    populateFeatures(pGpuProperties);
+  }
+  else if (name == PAGE_SURFACE) {
+    populateSurface(pGpuProperties);
+  }
+  else if (name == PAGE_QUEUES) {
+    populateQueues(pGpuProperties);
+  }
+  else if (name == PAGE_MEMORY) {
+    populateMemory(pGpuProperties);
+  }
+  else if (name == PAGE_FORMATS) {
+    populateFormats(pGpuProperties);
+  }
+  else {
+    return;
+  }
 
+  // Rows reused from the previous device weren't created again
+  itemsCreated = TreeWidgetUpdater::itemsCreated() - itemsCreated;
+  MemoryAccounting::get().recordPopulate(name.toStdString(), getGpuIndex(pGpuProperties), pGpuProperties->description, itemsCreated);
 }
 
 MainWindow::~MainWindow()
 {
+  mMemoryBudgetMonitor.stop();
+  mMemoryBenchmark.waitForFinished();
+  mQueueBenchmark.waitForFinished();
+  mFormatBenchmark.waitForFinished();
+  mPeerCopyBenchmark.waitForFinished();
+  mPeerMemoryQuery.waitForFinished();
+  mSparseImageFormats.waitForFinished();
+  mInstanceModeTimingCancel = true;
+  mInstanceModeTiming.waitForFinished();
+  // Every layer and ICD in turn can take minutes, the probe running is killed
+  mStartupProfileCancel = true;
+  mStartupProfile.waitForFinished();
+  mHistoryAppend.waitForFinished();
+
   destroyVulkanSurface();
   destroyVulkanInstance();
 
   delete ui;
 }
 
-void MainWindow::createVulkanInstance()
+static VkResult createInstance(uint32_t apiVersion, const std::vector<const char*>& extensions, VkInstance* pInstance)
 {
-  enumerateInstanceLayers();
-  populateInstanceLayers();
-
-  enumerateInstanceExtensions();
-  populateInstanceExtensions();
-
   VkApplicationInfo appInfo = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
   appInfo.pApplicationName    = "Vulkan Info Viewer";
   appInfo.applicationVersion  = 1;
   appInfo.pEngineName         = "Vulkan Info Viewer";
   appInfo.engineVersion       = 1;
-  appInfo.apiVersion          = VK_MAKE_VERSION(1, 0, 3);
-
-  const auto& layerExtensions = mInstanceLayerExtensions[""];
-  std::vector<const char*> extensions;
-  for (const auto& ext : layerExtensions) {
-    extensions.push_back(ext.extensionName);
-  }
+  appInfo.apiVersion          = apiVersion;
 
   VkInstanceCreateInfo createInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
   createInfo.pApplicationInfo         = &appInfo;
   createInfo.enabledExtensionCount    = static_cast<uint32_t>(extensions.size());
   createInfo.ppEnabledExtensionNames  = extensions.empty() ? nullptr : extensions.data();
-  VkResult res = vkCreateInstance(&createInfo, nullptr, &mInstance);
+
+  TRACE_SCOPE("loader", "vkCreateInstance");
+  return VK_CALL(VK_NULL_HANDLE, vkCreateInstance, &createInfo, MemoryAccounting::get().allocator(), pInstance);
+}
+
+std::vector<const char*> MainWindow::getInstanceExtensions(InstanceMode mode) const
+{
+  std::vector<const char*> extensions;
+
+  auto it = mInstanceLayerExtensions.find("");
+  if (it == mInstanceLayerExtensions.end()) {
+    return extensions;
+  }
+
+  // Everything the viewer actually calls: the surface for the Surface tab,
+  // and properties2 and device groups for when the instance is created at 1.0.
+  static const char* sRequired[] = {
+    VK_KHR_SURFACE_EXTENSION_NAME,
+#if defined(VK_USE_PLATFORM_WIN32_KHR)
+    VK_KHR_WIN32_SURFACE_EXTENSION_NAME,
+#elif defined(VK_USE_PLATFORM_XCB_KHR)
+    VK_KHR_XCB_SURFACE_EXTENSION_NAME,
+#endif
+    VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME,
+    VK_KHR_DEVICE_GROUP_CREATION_EXTENSION_NAME,
+  };
+
+  for (const auto& ext : it->second) {
+    bool enable = (mode == INSTANCE_MODE_FULL);
+    for (const char* name : sRequired) {
+      enable |= (strcmp(ext.extensionName, name) == 0);
+    }
+    if (enable) {
+      extensions.push_back(ext.extensionName);
+    }
+  }
+  return extensions;
+}
+
+void MainWindow::createVulkanInstance()
+{
+  TRACE_SCOPE("loader", "createVulkanInstance");
+  MemoryScope memoryScope(MEMORY_SCOPE_INSTANCE, MemoryAccounting::NO_GPU, "");
+
+  enumerateInstanceLayers();
+  enumerateInstanceExtensions();
+
+  mInstanceApiVersion = getLoaderApiVersion();
+
+  std::vector<const char*> extensions = getInstanceExtensions(mInstanceMode);
+  VkResult res = createInstance(mInstanceApiVersion, extensions, &mInstance);
   assert(res == VK_SUCCESS);
 }
 
+void MainWindow::measureInstanceModes()
+{
+  if (mInstanceModeTiming.isRunning()) {
+    mInstanceModeTimingPending = true;
+    return;
+  }
+
+  // Same conditions for both: each mode in fresh processes, best of a few
+  // runs, so neither benefits from the other having loaded the ICDs. The
+  // monitor's probe and the history capture load every ICD too, they wait.
+  mDeviceMonitor->setSuspended(true);
+  std::vector<QStringList> extensions(INSTANCE_MODE_COUNT);
+  for (int mode = 0; mode < INSTANCE_MODE_COUNT; ++mode) {
+    for (const char* name : getInstanceExtensions(static_cast<InstanceMode>(mode))) {
+      extensions[mode] << QString::fromUtf8(name);
+    }
+    mInstanceCreateTimings[mode].extensionCount = static_cast<uint32_t>(extensions[mode].size());
+  }
+  uint32_t apiVersion = mInstanceApiVersion;
+
+  mInstanceModeTimingCancel = false;
+  const std::atomic<bool>* pCancel = &mInstanceModeTimingCancel;
+  mInstanceModeTiming.setFuture(QtConcurrent::run([apiVersion, extensions, pCancel]() -> std::vector<StartupProbe> {
+    std::vector<StartupProbe> probes;
+    for (const auto& modeExtensions : extensions) {
+      probes.push_back(runInstanceProbe(apiVersion, modeExtensions, pCancel));
+    }
+    return probes;
+  }));
+}
+
+void MainWindow::onInstanceModeTimingFinished()
+{
+  std::vector<StartupProbe> probes = mInstanceModeTiming.result();
+  for (size_t mode = 0; mode < probes.size(); ++mode) {
+    const StartupProbe& probe = probes[mode];
+    mInstanceCreateTimings[mode].milliseconds = (probe.result == VK_SUCCESS) ? probe.createMs : -1.0;
+  }
+  if (isPageBuilt(PAGE_PROFILER)) {
+    populateInstanceTimings();
+  }
+
+  if (mInstanceModeTimingPending) {
+    mInstanceModeTimingPending = false;
+    measureInstanceModes();
+    return;
+  }
+  mDeviceMonitor->setSuspended(false);
+  if (mHistoryAppendPending) {
+    mHistoryAppendPending = false;
+    appendHistory();
+  }
+}
+
+void MainWindow::populateInstanceTimings()
+{
+  QLabel* lb = findChild<QLabel*>("instanceTimingsValue");
+  Q_ASSERT(lb);
+
+  auto toString = [](const InstanceCreateTiming& timing) -> QString {
+    if (timing.milliseconds < 0.0) {
+      return "n/a";
+    }
+    return QString("%1 ms (%2 extensions)").arg(timing.milliseconds, 0, 'f', 2).arg(timing.extensionCount);
+  };
+
+  const InstanceCreateTiming& minimal = mInstanceCreateTimings[INSTANCE_MODE_MINIMAL];
+  const InstanceCreateTiming& full = mInstanceCreateTimings[INSTANCE_MODE_FULL];
+  QString text = QString("vkCreateInstance %1 %2: minimal %3, full %4")
+    .arg(toStringVersion(mInstanceApiVersion))
+    .arg((mInstanceMode == INSTANCE_MODE_FULL) ? "[full]" : "[minimal]")
+    .arg(toString(minimal))
+    .arg(toString(full));
+  if ((minimal.milliseconds >= 0.0) && (full.milliseconds >= 0.0)) {
+    text += QString(", difference %1 ms").arg(full.milliseconds - minimal.milliseconds, 0, 'f', 2);
+  }
+  lb->setText(text);
+}
+
 void MainWindow::destroyVulkanInstance()
 {
   if (mInstance != VK_NULL_HANDLE) {
-    vkDestroyInstance(mInstance, nullptr);
+    VK_CALL(VK_NULL_HANDLE, vkDestroyInstance, mInstance, MemoryAccounting::get().allocator());
     mInstance = VK_NULL_HANDLE;
   }
 }
 
 void MainWindow::createVulkanSurface()
 {
+  MemoryScope memoryScope(MEMORY_SCOPE_INSTANCE, MemoryAccounting::NO_GPU, "");
 #if defined(VK_USE_PLATFORM_WIN32_KHR)
   VkWin32SurfaceCreateInfoKHR createInfo = { VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR };
   createInfo.hinstance = ::GetModuleHandle(nullptr);
   createInfo.hwnd      = (HWND)(this->winId());
-  VkResult res = vkCreateWin32SurfaceKHR(mInstance, &createInfo, nullptr, &mSurface);
+  VkResult res = VK_CALL(VK_NULL_HANDLE, vkCreateWin32SurfaceKHR, mInstance, &createInfo, MemoryAccounting::get().allocator(), &mSurface);
 #elif defined(VK_USE_PLATFORM_XCB_KHR)
   VkXcbSurfaceCreateInfoKHR createInfo = { VK_STRUCTURE_TYPE_XCB_SURFACE_CREATE_INFO_KHR };
   createInfo.connection = QX11Info::connection();
   createInfo.window = static_cast<xcb_window_t>(this->winId());
-  VkResult res = vkCreateXcbSurfaceKHR(mInstance, &createInfo, nullptr, &mSurface);
+  VkResult res = VK_CALL(VK_NULL_HANDLE, vkCreateXcbSurfaceKHR, mInstance, &createInfo, MemoryAccounting::get().allocator(), &mSurface);
 #endif
   assert(res == VK_SUCCESS);
 }
@@ -164,73 +660,206 @@ void MainWindow::destroyVulkanSurface()
     return;
   }
 
-  vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
+  VK_CALL(VK_NULL_HANDLE, vkDestroySurfaceKHR, mInstance, mSurface, MemoryAccounting::get().allocator());
   mSurface = VK_NULL_HANDLE;
 }
 
 void MainWindow::enumerateInstanceLayers()
 {
-  mInstanceLayers.clear();
+  TRACE_SCOPE("loader", "enumerateInstanceLayers");
 
-  uint32_t count = 0;
-  VkResult res = vkEnumerateInstanceLayerProperties(&count, nullptr);
-  assert(res == VK_SUCCESS);
+  // Straight from the manifests, no layer library gets loaded
+  mManifestScanner.scan();
 
-  mInstanceLayers.resize(count);
-  res = vkEnumerateInstanceLayerProperties(&count, mInstanceLayers.data());
-  assert(res == VK_SUCCESS);
-//  std::sort(std::begin(mInstanceLayers),
-//      std::end(mInstanceLayers),
-//      [](const VkLayerProperties& a, const VkLayerProperties& b) -> bool {
-//          return (strcmp(a.layerName, b.layerName) < 0); });
+  mInstanceLayers.clear();
+  for (const auto& layer : mManifestScanner.layers()) {
+    mInstanceLayers.push_back(layer.properties);
+  }
+}
+
+//! Startup probe time, empty before profiling and "failed" for a probe that didn't get through
+static void setProbeTime(QTreeWidgetItem* item, int column, const StartupProbe* pProbe, double milliseconds)
+{
+  bool valid = (pProbe != nullptr) && (pProbe->result == VK_SUCCESS) && (pProbe->createMs >= 0.0);
+  if (pProbe == nullptr) {
+    item->setText(column, "");
+  }
+  else {
+    item->setText(column, valid ? QString::number(milliseconds, 'f', 2) : QString("failed"));
+  }
+  item->setData(column, SORT_ROLE, valid ? QVariant(milliseconds) : QVariant());
+  item->setTextAlignment(column, Qt::AlignRight);
 }
 
 void MainWindow::populateInstanceLayers()
 {  
+  TRACE_SCOPE("qt", "populateInstanceLayers");
+
   QTreeWidget* tw = findChild<QTreeWidget*>("layersWidget");
   Q_ASSERT(tw);
 
+  TreeSortingBlocker sortingBlocker(tw);
   tw->clear();
 
-  for (const auto& layer : mInstanceLayers) {
-    QTreeWidgetItem* item = new QTreeWidgetItem();
+  const StartupProbe& baseline = mStartupProfileResult.baseline;
+  bool hasBaseline = mHasStartupProfile && (baseline.result == VK_SUCCESS) && (baseline.createMs >= 0.0);
+  for (const auto& manifest : mManifestScanner.layers()) {
+    const VkLayerProperties& layer = manifest.properties;
+    QTreeWidgetItem* item = new SortableTreeWidgetItem();
     item->setText(0, QString::fromUtf8(layer.layerName));
     item->setText(1, toStringVersion(layer.specVersion));
     item->setText(2, QString::number(layer.implementationVersion));
     item->setText(3, QString::fromUtf8(layer.description));
+    item->setText(4, manifest.type);
+    item->setText(8, manifest.libraryPath);
+    item->setText(9, QDir::toNativeSeparators(manifest.path));
+    item->setData(1, SORT_ROLE, layer.specVersion);
+    item->setData(2, SORT_ROLE, layer.implementationVersion);
     item->setTextAlignment(1, Qt::AlignHCenter);              \
     item->setTextAlignment(2, Qt::AlignHCenter);
+    item->setTextAlignment(4, Qt::AlignHCenter);
+
+    const StartupProbe* pProbe = nullptr;
+    if (mHasStartupProfile) {
+      auto it = mStartupProfileResult.layers.find(manifest.path);
+      pProbe = (it != mStartupProfileResult.layers.end()) ? &it.value() : nullptr;
+    }
+    setProbeTime(item, 5, pProbe, (pProbe != nullptr) ? pProbe->createMs : 0.0);
+    setProbeTime(item, 6, hasBaseline ? pProbe : nullptr, (pProbe != nullptr) ? (pProbe->createMs - baseline.createMs) : 0.0);
+    setProbeTime(item, 7, pProbe, (pProbe != nullptr) ? pProbe->enumerateMs : 0.0);
     tw->addTopLevelItem(item);
   }
 
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
+  resizeColumns(tw);
+}
+
+void MainWindow::populateIcds()
+{
+  TRACE_SCOPE("qt", "populateIcds");
+
+  QTreeWidget* tw = findChild<QTreeWidget*>("icdsWidget");
+  Q_ASSERT(tw);
+
+  TreeSortingBlocker sortingBlocker(tw);
+  tw->clear();
+
+  for (const auto& icd : mManifestScanner.icds()) {
+    QTreeWidgetItem* item = new SortableTreeWidgetItem();
+    item->setText(0, QDir::toNativeSeparators(icd.path));
+    item->setText(1, icd.libraryPath);
+    item->setText(2, toStringVersion(icd.apiVersion));
+    item->setData(2, SORT_ROLE, icd.apiVersion);
+    item->setTextAlignment(2, Qt::AlignHCenter);
+
+    const StartupProbe* pProbe = nullptr;
+    if (mHasStartupProfile) {
+      auto it = mStartupProfileResult.icds.find(icd.path);
+      pProbe = (it != mStartupProfileResult.icds.end()) ? &it.value() : nullptr;
+    }
+    setProbeTime(item, 3, pProbe, (pProbe != nullptr) ? pProbe->createMs : 0.0);
+    setProbeTime(item, 4, pProbe, (pProbe != nullptr) ? pProbe->enumerateMs : 0.0);
+    if ((pProbe != nullptr) && (pProbe->result == VK_SUCCESS)) {
+      item->setText(5, QString::number(pProbe->gpuCount));
+      item->setData(5, SORT_ROLE, pProbe->gpuCount);
+    }
+    item->setTextAlignment(5, Qt::AlignHCenter);
+    tw->addTopLevelItem(item);
+  }
+
+  resizeColumns(tw);
+}
+
+void MainWindow::onLayersProfileBtnClicked()
+{
+  if (mStartupProfile.isRunning()) {
+    return;
+  }
+
+  QPushButton* btn = findChild<QPushButton*>("layersProfileBtn");
+  QLabel* status = findChild<QLabel*>("layersProfileStatus");
+  Q_ASSERT(btn && status);
+  btn->setEnabled(false);
+  status->setText("Running, every layer and ICD is loaded in its own process...");
+
+  std::vector<ManifestScanner::LayerManifest> layers = mManifestScanner.layers();
+  std::vector<ManifestScanner::IcdManifest> icds = mManifestScanner.icds();
+  mStartupProfileCancel = false;
+  const std::atomic<bool>* pCancel = &mStartupProfileCancel;
+  mStartupProfile.setFuture(QtConcurrent::run([layers, icds, pCancel]() -> StartupProfile {
+    return runStartupProfile(layers, icds, pCancel);
+  }));
+}
+
+void MainWindow::onStartupProfileFinished()
+{
+  mStartupProfileResult = mStartupProfile.result();
+  mHasStartupProfile = true;
+
+  QPushButton* btn = findChild<QPushButton*>("layersProfileBtn");
+  QLabel* status = findChild<QLabel*>("layersProfileStatus");
+  Q_ASSERT(btn && status);
+  btn->setEnabled(true);
+
+  const StartupProbe& baseline = mStartupProfileResult.baseline;
+  const StartupProbe& defaults = mStartupProfileResult.defaults;
+  if ((baseline.result != VK_SUCCESS) || (baseline.createMs < 0.0)) {
+    status->setText("vkCreateInstance failed without layers");
+  }
+  else {
+    // The layer that adds the most is the one to look at first
+    QString slowest;
+    double slowestMs = 0.0;
+    for (const auto& manifest : mManifestScanner.layers()) {
+      auto it = mStartupProfileResult.layers.find(manifest.path);
+      if (it == mStartupProfileResult.layers.end()) {
+        continue;
+      }
+      double addedMs = it.value().createMs - baseline.createMs;
+      if ((it.value().result == VK_SUCCESS) && (addedMs > slowestMs)) {
+        slowest = QString::fromUtf8(manifest.properties.layerName);
+        slowestMs = addedMs;
+      }
+    }
+
+    QString text = QString("vkCreateInstance %1 ms without layers").arg(baseline.createMs, 0, 'f', 2);
+    if ((defaults.result == VK_SUCCESS) && (defaults.createMs >= 0.0)) {
+      text += QString(", %1 ms with the implicit layers every application gets").arg(defaults.createMs, 0, 'f', 2);
+    }
+    if (! slowest.isEmpty()) {
+      text += QString("; slowest layer %1 (+%2 ms)").arg(slowest).arg(slowestMs, 0, 'f', 2);
+    }
+    status->setText(text);
   }
+
+  populateInstanceLayers();
+  populateIcds();
 }
 
 void enumerateInstanceExtensions(const char *layerName, std::vector<VkExtensionProperties>* extensions)
 {
+  // Per-layer queries make the loader load the layer, report them as layer cost
+  TRACE_SCOPE((layerName != nullptr) ? "layer" : "loader",
+              std::string("vkEnumerateInstanceExtensionProperties ") + ((layerName != nullptr) ? layerName : "(implementation)"));
+
   uint32_t count = 0;
-  VkResult res = vkEnumerateInstanceExtensionProperties(layerName, &count, nullptr);
+  VkResult res = VK_CALL(VK_NULL_HANDLE, vkEnumerateInstanceExtensionProperties, layerName, &count, nullptr);
   assert(res == VK_SUCCESS);
 
   extensions->resize(count);
-  res = vkEnumerateInstanceExtensionProperties(layerName, &count, extensions->data());
+  res = VK_CALL(VK_NULL_HANDLE, vkEnumerateInstanceExtensionProperties, layerName, &count, extensions->data());
 }
 
 void MainWindow::enumerateInstanceExtensions()
 {
   mInstanceLayerExtensions.clear();
 
-  for(const auto& layer : mInstanceLayers) {
-    std::string layerName = layer.layerName;
-    std::vector<VkExtensionProperties> extensions;
-    ::enumerateInstanceExtensions(layerName.c_str(), &extensions);
-    if (! extensions.empty()) {
-      mInstanceLayerExtensions[layerName] = extensions;
+  for (const auto& layer : mManifestScanner.layers()) {
+    if (! layer.instanceExtensions.empty()) {
+      mInstanceLayerExtensions[layer.properties.layerName] = layer.instanceExtensions;
     }
   }
 
+  // Only the loader knows what the drivers expose
   std::vector<VkExtensionProperties> extensions;
   ::enumerateInstanceExtensions(nullptr, &extensions);
   if (! extensions.empty()) {
@@ -240,14 +869,19 @@ void MainWindow::enumerateInstanceExtensions()
 
 void MainWindow::populateInstanceExtensions()
 {
+  TRACE_SCOPE("qt", "populateInstanceExtensions");
+
   QTreeWidget* tw = findChild<QTreeWidget*>("instanceExtensionsWidget");
   Q_ASSERT(tw);
 
+  TreeSortingBlocker sortingBlocker(tw);
+  tw->clear();
+
   for (const auto& it : mInstanceLayerExtensions) {
     const auto& layerName = it.first;
     const auto& extensions = it.second;
 
-    QTreeWidgetItem* topItem = new QTreeWidgetItem();
+    QTreeWidgetItem* topItem = new SortableTreeWidgetItem();
     if (! layerName.empty()) {
       topItem->setText(0, QString::fromStdString(layerName));
     }
@@ -257,9 +891,10 @@ void MainWindow::populateInstanceExtensions()
     tw->addTopLevelItem(topItem);
 
     for (const auto& ext : extensions) {
-      QTreeWidgetItem* item = new QTreeWidgetItem();
+      QTreeWidgetItem* item = new SortableTreeWidgetItem();
       item->setText(0, QString::fromUtf8(ext.extensionName));
       item->setText(1, QString::number(ext.specVersion));      
+      item->setData(1, SORT_ROLE, ext.specVersion);
       item->setTextAlignment(1, Qt::AlignHCenter);              \
       topItem->addChild(item);
     }
@@ -267,22 +902,24 @@ void MainWindow::populateInstanceExtensions()
 
   tw->expandAll();
 
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
-  }
+  resizeColumns(tw);
 }
 
 void MainWindow::enumerateGpus()
 {
+  TRACE_SCOPE("driver", "enumerateGpus");
+  MemoryScope memoryScope(MEMORY_SCOPE_INSTANCE, MemoryAccounting::NO_GPU, "");
+
   // Enumerate physical devices
   std::vector<VkPhysicalDevice> gpus;
   {
+    TRACE_SCOPE("driver", "vkEnumeratePhysicalDevices");
     uint32_t count = 0;
-    VkResult res = vkEnumeratePhysicalDevices(mInstance, &count, nullptr);
+    VkResult res = VK_CALL(VK_NULL_HANDLE, vkEnumeratePhysicalDevices, mInstance, &count, nullptr);
     assert(res == VK_SUCCESS);
 
     gpus.resize(count);
-    res = vkEnumeratePhysicalDevices(mInstance, &count, gpus.data());
+    res = VK_CALL(VK_NULL_HANDLE, vkEnumeratePhysicalDevices, mInstance, &count, gpus.data());
     assert(res == VK_SUCCESS);
   }
 
@@ -296,22 +933,15 @@ void MainWindow::enumerateGpus()
   for (size_t i = 0; i < mGpuProperties.size(); ++i) {
     GpuProperties& gpuProperties = mGpuProperties[i];
 
-    // Use VkPhysicalDeviceProperties to get device an descriptor indexing properties
-    VkPhysicalDeviceProperties2 deviceProperties2 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
-    gpuProperties.descriptorIndexingProperties = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT};
-    deviceProperties2.pNext = &gpuProperties.descriptorIndexingProperties;
-    // Call vkGetPhysicalDeviceProperties2
-    vkGetPhysicalDeviceProperties2(
+    // Core properties decide which core structs go in the chain
+    VK_CALL(gpuProperties.physicalDevice, vkGetPhysicalDeviceProperties,
       gpuProperties.physicalDevice,
-      &deviceProperties2);
-
-    // Copy device properties
-    gpuProperties.deviceProperties = deviceProperties2.properties;
+      &gpuProperties.deviceProperties);
 
     // Get device extensions
     {
       uint32_t count = 0;
-      VkResult res = vkEnumerateDeviceExtensionProperties(
+      VkResult res = VK_CALL(gpuProperties.physicalDevice, vkEnumerateDeviceExtensionProperties,
         gpuProperties.physicalDevice,
         nullptr,
         &count,
@@ -319,7 +949,7 @@ void MainWindow::enumerateGpus()
       assert(res == VK_SUCCESS);
 
       gpuProperties.extensions.resize(count);
-      res = vkEnumerateDeviceExtensionProperties(
+      res = VK_CALL(gpuProperties.physicalDevice, vkEnumerateDeviceExtensionProperties,
         gpuProperties.physicalDevice,
         nullptr,
         &count,
@@ -331,38 +961,29 @@ void MainWindow::enumerateGpus()
         std::end(gpuProperties.extensions),
         [](const VkExtensionProperties& a, const VkExtensionProperties& b) -> bool {
           return (strcmp(a.extensionName, b.extensionName) < 0); });
-    }
 
-    // Get AMD shader core properties
-    if (gpuProperties.deviceProperties.vendorID == IHV_VENDOR_ID_AMD) {
-      auto it = std::find_if(
-        std::begin(gpuProperties.extensions),
-        std::end(gpuProperties.extensions),
-        [](const VkExtensionProperties& elem) -> bool {
-          return std::string(elem.extensionName) == VK_AMD_SHADER_CORE_PROPERTIES_EXTENSION_NAME; });
-
-      if (it != std::end(gpuProperties.extensions)) {
-        VkPhysicalDeviceProperties2 deviceProperties2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
-        gpuProperties.amdShaderCoreProperties = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_CORE_PROPERTIES_AMD};
-        deviceProperties2.pNext = &gpuProperties.amdShaderCoreProperties;
-        // Call vkGetPhysicalDeviceProperties2
-        vkGetPhysicalDeviceProperties2(
-          gpuProperties.physicalDevice,
-          &deviceProperties2);
-      }
+      gpuProperties.extensionSet = ExtensionSet(gpuProperties.extensions);
     }
 
+    // Every extended property and feature struct in one call each
+    gpuProperties.chain.build(std::min(mInstanceApiVersion, gpuProperties.deviceProperties.apiVersion), gpuProperties.extensionSet);
+    gpuProperties.chain.query(gpuProperties.physicalDevice);
+
     // Description
     gpuProperties.description = gpuProperties.deviceProperties.deviceName;
     if (gpuProperties.deviceProperties.vendorID == IHV_VENDOR_ID_AMD) {
+      const auto* pShaderCore = gpuProperties.chain.find<VkPhysicalDeviceShaderCorePropertiesAMD>(
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_CORE_PROPERTIES_AMD);
       std::stringstream ss;
       ss << "AMD" << " ";
-      ss << gpuProperties.deviceProperties.deviceName << " ";
-      ss << "(";
-      ss << gpuProperties.amdShaderCoreProperties.shaderEngineCount *
-            gpuProperties.amdShaderCoreProperties.shaderArraysPerEngineCount *
-            gpuProperties.amdShaderCoreProperties.computeUnitsPerShaderArray;
-      ss << " Cores)";
+      ss << gpuProperties.deviceProperties.deviceName;
+      if (pShaderCore != nullptr) {
+        ss << " (";
+        ss << pShaderCore->shaderEngineCount *
+              pShaderCore->shaderArraysPerEngineCount *
+              pShaderCore->computeUnitsPerShaderArray;
+        ss << " Cores)";
+      }
       gpuProperties.description = ss.str();
     }
     else if(gpuProperties.deviceProperties.vendorID == IHV_VENDOR_ID_INTEL) {
@@ -378,6 +999,16 @@ void MainWindow::enumerateGpus()
       gpuProperties.description = ss.str();
     }
   }
+
+  // Groups hold the handles enumerated above; peer memory needs a logical
+  // device per group, it is queried when the Device Groups page is shown
+  mDeviceGroups.clear();
+  std::vector<const char*> extensions = getInstanceExtensions(mInstanceMode);
+  bool groupCreation = std::any_of(std::begin(extensions), std::end(extensions),
+    [](const char* name) -> bool { return (strcmp(name, VK_KHR_DEVICE_GROUP_CREATION_EXTENSION_NAME) == 0); });
+  if ((mInstanceApiVersion >= VK_API_VERSION_1_1) || groupCreation) {
+    mDeviceGroups = enumerateDeviceGroups(mInstance, mInstanceApiVersion);
+  }
 }
 
 QString MainWindow::getFullGpuName(const GpuProperties* pGpuProperties) const
@@ -391,6 +1022,8 @@ QString MainWindow::getFullGpuName(const GpuProperties* pGpuProperties) const
 
 void MainWindow::populateGpus()
 {
+  TRACE_SCOPE("qt", "populateGpus");
+
   QComboBox* cb = findChild<QComboBox*>("gpus");
   Q_ASSERT(cb);
 
@@ -404,13 +1037,237 @@ void MainWindow::populateGpus()
   }
 }
 
-void MainWindow::populateGeneral(const GpuProperties* pGpuProperties)
+static bool isSameLayers(const std::vector<VkLayerProperties>& a, const std::vector<VkLayerProperties>& b)
 {
-  const VkPhysicalDeviceProperties& properties = pGpuProperties->deviceProperties;
-
-  QLabel* lb = findChild<QLabel*>("descriptionValue");
-  Q_ASSERT(lb);
-  lb->setText(QString::fromStdString(pGpuProperties->description));
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if ((strcmp(a[i].layerName, b[i].layerName) != 0) ||
+        (a[i].specVersion != b[i].specVersion) ||
+        (a[i].implementationVersion != b[i].implementationVersion)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool isSameExtensions(const std::vector<VkExtensionProperties>& a, const std::vector<VkExtensionProperties>& b)
+{
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if ((strcmp(a[i].extensionName, b[i].extensionName) != 0) || (a[i].specVersion != b[i].specVersion)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool isSameLayerExtensions(const MainWindow::LayerExtensions& a, const MainWindow::LayerExtensions& b)
+{
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (auto itA = a.begin(), itB = b.begin(); itA != a.end(); ++itA, ++itB) {
+    if ((itA->first != itB->first) || (! isSameExtensions(itA->second, itB->second))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//! Stable across re-enumeration, physical device handles are not. The
+//! occurrence count tells identical boards apart.
+static std::vector<std::string> getGpuIdentities(const std::vector<MainWindow::GpuProperties>& gpus)
+{
+  std::vector<std::string> identities;
+  std::map<std::string, int> occurrences;
+  for (const auto& gpu : gpus) {
+    const VkPhysicalDeviceProperties& properties = gpu.deviceProperties;
+    std::stringstream ss;
+    ss << std::hex << properties.vendorID << ":" << properties.deviceID << ":" << properties.deviceName;
+    std::string key = ss.str();
+    identities.push_back(key + "#" + std::to_string(occurrences[key]++));
+  }
+  return identities;
+}
+
+static bool isSameGpu(const MainWindow::GpuProperties& a, const MainWindow::GpuProperties& b)
+{
+  return isSamePhysicalDeviceProperties(a.deviceProperties, b.deviceProperties) &&
+         (a.extensionSet == b.extensionSet) &&
+         (a.description == b.description);
+}
+
+void MainWindow::onDevicesChanged()
+{
+  TRACE_SCOPE("qt", "onDevicesChanged");
+
+  // Keep the previous state around to diff against, the combo box still
+  // points into oldGpuProperties until it is updated below.
+  std::vector<VkLayerProperties> oldInstanceLayers = mInstanceLayers;
+  LayerExtensions oldInstanceLayerExtensions = mInstanceLayerExtensions;
+  std::vector<GpuProperties> oldGpuProperties;
+  oldGpuProperties.swap(mGpuProperties);
+
+  // The sampler and benchmarks hold a physical device from the instance about to go away
+  ++mDeviceGeneration;
+  mMemoryBudgetMonitor.stop();
+  mMemoryBenchmark.waitForFinished();
+  mMemoryBenchmarkResults.clear();
+  mQueueBenchmark.waitForFinished();
+  mQueueBenchmarkResults.clear();
+  mFormatBenchmark.waitForFinished();
+  mFormatBenchmarkResults.clear();
+  mPeerCopyBenchmark.waitForFinished();
+  mPeerCopyBenchmarkResults.clear();
+  mPeerMemoryQuery.waitForFinished();
+  mSparseImageFormats.waitForFinished();
+  mSparseImageFormatResults.clear();
+
+  // Physical device handles belong to the instance, a new driver needs a new one
+  destroyVulkanSurface();
+  destroyVulkanInstance();
+  createVulkanInstance();
+  createVulkanSurface();
+  enumerateGpus();
+
+  // Pages that were never shown are filled from scratch when they are
+  if (isPageBuilt(PAGE_PROFILER)) {
+    populateInstanceTimings();
+  }
+  if (isPageBuilt(PAGE_LAYERS)) {
+    if (! isSameLayers(oldInstanceLayers, mInstanceLayers)) {
+      populateInstanceLayers();
+    }
+    populateIcds();
+  }
+  if (isPageBuilt(PAGE_EXTENSIONS) && (! isSameLayerExtensions(oldInstanceLayerExtensions, mInstanceLayerExtensions))) {
+    populateInstanceExtensions();
+  }
+
+  // Match new GPUs to old ones
+  std::vector<std::string> oldIdentities = getGpuIdentities(oldGpuProperties);
+  std::vector<std::string> newIdentities = getGpuIdentities(mGpuProperties);
+  std::vector<int> newToOld(mGpuProperties.size(), -1);
+  for (size_t j = 0; j < newIdentities.size(); ++j) {
+    auto it = std::find(std::begin(oldIdentities), std::end(oldIdentities), newIdentities[j]);
+    if (it != std::end(oldIdentities)) {
+      newToOld[j] = static_cast<int>(std::distance(std::begin(oldIdentities), it));
+    }
+  }
+
+  int currentOld = -1;
+  for (size_t i = 0; i < oldGpuProperties.size(); ++i) {
+    if (mCurrentGpuProperties == &oldGpuProperties[i]) {
+      currentOld = static_cast<int>(i);
+    }
+  }
+
+  QComboBox* cb = findChild<QComboBox*>("gpus");
+  Q_ASSERT(cb);
+
+  int added = 0;
+  int updated = 0;
+  int current = -1;
+  bool currentChanged = false;
+  {
+    QSignalBlocker blocker(cb);
+
+    // Rows are identified by the old pointer they carry, only rows that
+    // moved are removed and reinserted.
+    for (size_t j = 0; j < mGpuProperties.size(); ++j) {
+      GpuProperties* pGpuProperties = &mGpuProperties[j];
+      QString deviceName = QString::fromStdString(pGpuProperties->description);
+      QVariant userData = qVariantFromValue(static_cast<void*>(pGpuProperties));
+      int row = (newToOld[j] >= 0) ? cb->findData(qVariantFromValue(static_cast<void*>(&oldGpuProperties[newToOld[j]]))) : -1;
+      if (row == static_cast<int>(j)) {
+        if (cb->itemText(row) != deviceName) {
+          cb->setItemText(row, deviceName);
+        }
+        cb->setItemData(row, userData);
+      }
+      else {
+        if (row >= 0) {
+          cb->removeItem(row);
+        }
+        cb->insertItem(static_cast<int>(j), deviceName, userData);
+      }
+
+      if (newToOld[j] < 0) {
+        ++added;
+      }
+      else if (! isSameGpu(oldGpuProperties[newToOld[j]], *pGpuProperties)) {
+        ++updated;
+        currentChanged |= (newToOld[j] == currentOld);
+      }
+      if ((currentOld >= 0) && (newToOld[j] == currentOld)) {
+        current = static_cast<int>(j);
+      }
+    }
+
+    // Whatever is left over went away
+    while (cb->count() > static_cast<int>(mGpuProperties.size())) {
+      cb->removeItem(cb->count() - 1);
+    }
+
+    if (current >= 0) {
+      cb->setCurrentIndex(current);
+    }
+  }
+
+  int removed = static_cast<int>(oldGpuProperties.size()) - (static_cast<int>(mGpuProperties.size()) - added);
+  statusBar()->showMessage(QString("Devices changed: %1 added, %2 removed, %3 updated").arg(added).arg(removed).arg(updated), 10000);
+
+  if (current >= 0) {
+    mCurrentGpuProperties = &mGpuProperties[current];
+    if (currentChanged) {
+      on_gpus_currentIndexChanged(current);
+    }
+    else if (isPageBuilt(PAGE_SURFACE)) {
+      updateSurfaceExtents(mCurrentGpuProperties);
+    }
+  }
+  else if (cb->count() > 0) {
+    {
+      QSignalBlocker blocker(cb);
+      cb->setCurrentIndex(0);
+    }
+    on_gpus_currentIndexChanged(0);
+  }
+  else {
+    // Nothing left to show, the trees keep the last device
+    mCurrentGpuProperties = nullptr;
+  }
+
+  if (isPageBuilt(PAGE_DEVICE_GROUPS)) {
+    populateDeviceGroups();
+  }
+  if (isPageBuilt(PAGE_PIPELINE_CACHE)) {
+    populatePipelineCaches();
+  }
+  if (isPageBuilt(PAGE_MEMORY)) {
+    updateMemoryBudgetMonitor();
+  }
+
+  // A new driver or loader changes both
+  measureInstanceModes();
+
+  // A driver update shows up here as an updated device
+  appendHistory();
+}
+
+void MainWindow::populateGeneral(const GpuProperties* pGpuProperties)
+{
+  TRACE_SCOPE("qt", "populateGeneral");
+
+  const VkPhysicalDeviceProperties& properties = pGpuProperties->deviceProperties;
+
+  QLabel* lb = findChild<QLabel*>("descriptionValue");
+  Q_ASSERT(lb);
+  lb->setText(QString::fromStdString(pGpuProperties->description));
 
   lb = findChild<QLabel*>("apiVersionValue");
   Q_ASSERT(lb);
@@ -436,371 +1293,473 @@ void MainWindow::populateGeneral(const GpuProperties* pGpuProperties)
   Q_ASSERT(lb);
   lb->setText(properties.deviceName);
 
-  QString uuid;
-  for (size_t i = 0; i < VK_UUID_SIZE; ++i) {
-    uuid.append(QString::number(properties.pipelineCacheUUID[i], 16));
-  }
+  // Zero padded so it matches the Pipeline Cache tab
   lb = findChild<QLabel*>("pipelineCacheUuidValue");
   Q_ASSERT(lb);
-  lb->setText(uuid.toUpper());
+  lb->setText(toStringUuid(properties.pipelineCacheUUID));
 }
 
 void MainWindow::populateDeviceExtensions(const GpuProperties* pGpuProperties)
 {
+  TRACE_SCOPE("qt", "populateDeviceExtensions");
+
   QTreeWidget* tw = findChild<QTreeWidget*>("deviceExtensionsWidget");
   Q_ASSERT(tw);
 
-  tw->clear();
+  TreeWidgetUpdater updater(tw);
 
   auto& extension = pGpuProperties->extensions;
   for (const auto& extension : extension) {
-    QTreeWidgetItem* topItem = new QTreeWidgetItem();
-    topItem->setText(0, QString::fromUtf8(extension.extensionName));
+    QString name = QString::fromUtf8(extension.extensionName);
+    QTreeWidgetItem* topItem = updater.item(nullptr, name);
+    topItem->setText(0, name);
     topItem->setText(1, QString::number(extension.specVersion));
+    topItem->setData(1, SORT_ROLE, extension.specVersion);
     topItem->setTextAlignment(1, Qt::AlignHCenter);
-    tw->addTopLevelItem(topItem);
   }
+  updater.finish();
 
   tw->expandAll();
 
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
-  }
+  resizeColumns(tw);
 }
 
-#define ADD_LIMIT(locale, parent, limits, prop)                              \
+#define ADD_LIMIT(updater, locale, parent, limits, prop)                     \
   {                                                                          \
-    QTreeWidgetItem* item = new QTreeWidgetItem();                           \
+    QTreeWidgetItem* item = updater.item(parent, #prop);                     \
     item->setText(0, QString::fromUtf8(#prop));                              \
     item->setText(1, locale.toString(static_cast<qulonglong>(limits.prop))); \
+    item->setData(1, SORT_ROLE, static_cast<double>(limits.prop));           \
     item->setTextAlignment(1, Qt::AlignRight);                               \
-    parent->addChild(item);                                                  \
   }
 
 void MainWindow::populateLimits(const GpuProperties* pGpuProperties)
 {
+  TRACE_SCOPE("qt", "populateLimits");
+
   QTreeWidget* tw = findChild<QTreeWidget*>("limitsWidget");
-  Q_ASSERT(tw);
+  QLineEdit* filter = findChild<QLineEdit*>("limitsFilter");
+  Q_ASSERT(tw && filter);
 
-  tw->clear();
+  TreeWidgetUpdater updater(tw);
 
   QLocale locale;
 
   // Device limits
   {
-    QTreeWidgetItem* parent_item = new QTreeWidgetItem();
+    bool created = false;
+    QTreeWidgetItem* parent_item = updater.item(nullptr, "Device Limits", &created);
     parent_item->setText(0, "Device Limits");
-    tw->addTopLevelItem(parent_item);
 
     const auto &limits = pGpuProperties->deviceProperties.limits;
 
-    ADD_LIMIT(locale, parent_item, limits, maxImageDimension1D);
-    ADD_LIMIT(locale, parent_item, limits, maxImageDimension2D);
-    ADD_LIMIT(locale, parent_item, limits, maxImageDimension3D);
-    ADD_LIMIT(locale, parent_item, limits, maxImageDimensionCube);
-    ADD_LIMIT(locale, parent_item, limits, maxImageArrayLayers);
-    ADD_LIMIT(locale, parent_item, limits, maxTexelBufferElements);
-    ADD_LIMIT(locale, parent_item, limits, maxUniformBufferRange);
-    ADD_LIMIT(locale, parent_item, limits, maxStorageBufferRange);
-    ADD_LIMIT(locale, parent_item, limits, maxPushConstantsSize);
-    ADD_LIMIT(locale, parent_item, limits, maxMemoryAllocationCount);
-    ADD_LIMIT(locale, parent_item, limits, maxSamplerAllocationCount);
-    ADD_LIMIT(locale, parent_item, limits, bufferImageGranularity);
-    ADD_LIMIT(locale, parent_item, limits, sparseAddressSpaceSize);
-    ADD_LIMIT(locale, parent_item, limits, maxBoundDescriptorSets);
-    ADD_LIMIT(locale, parent_item, limits, maxPerStageDescriptorSamplers);
-    ADD_LIMIT(locale, parent_item, limits, maxPerStageDescriptorUniformBuffers);
-    ADD_LIMIT(locale, parent_item, limits, maxPerStageDescriptorStorageBuffers);
-    ADD_LIMIT(locale, parent_item, limits, maxPerStageDescriptorSampledImages);
-    ADD_LIMIT(locale, parent_item, limits, maxPerStageDescriptorStorageImages);
-    ADD_LIMIT(locale, parent_item, limits, maxPerStageDescriptorInputAttachments);
-    ADD_LIMIT(locale, parent_item, limits, maxPerStageResources);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetSamplers);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetUniformBuffers);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetUniformBuffersDynamic);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetStorageBuffers);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetStorageBuffersDynamic);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetSampledImages);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetStorageImages);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetInputAttachments);
-    ADD_LIMIT(locale, parent_item, limits, maxVertexInputAttributes);
-    ADD_LIMIT(locale, parent_item, limits, maxVertexInputBindings);
-    ADD_LIMIT(locale, parent_item, limits, maxVertexInputAttributeOffset);
-    ADD_LIMIT(locale, parent_item, limits, maxVertexInputBindingStride);
-    ADD_LIMIT(locale, parent_item, limits, maxVertexOutputComponents);
-    ADD_LIMIT(locale, parent_item, limits, maxTessellationGenerationLevel);
-    ADD_LIMIT(locale, parent_item, limits, maxTessellationPatchSize);
-    ADD_LIMIT(locale, parent_item, limits, maxTessellationControlPerVertexInputComponents);
-    ADD_LIMIT(locale, parent_item, limits, maxTessellationControlPerVertexOutputComponents);
-    ADD_LIMIT(locale, parent_item, limits, maxTessellationControlPerPatchOutputComponents);
-    ADD_LIMIT(locale, parent_item, limits, maxTessellationControlTotalOutputComponents);
-    ADD_LIMIT(locale, parent_item, limits, maxTessellationEvaluationInputComponents);
-    ADD_LIMIT(locale, parent_item, limits, maxTessellationEvaluationOutputComponents);
-    ADD_LIMIT(locale, parent_item, limits, maxGeometryShaderInvocations);
-    ADD_LIMIT(locale, parent_item, limits, maxGeometryInputComponents);
-    ADD_LIMIT(locale, parent_item, limits, maxGeometryOutputComponents);
-    ADD_LIMIT(locale, parent_item, limits, maxGeometryOutputVertices);
-    ADD_LIMIT(locale, parent_item, limits, maxGeometryTotalOutputComponents);
-    ADD_LIMIT(locale, parent_item, limits, maxFragmentInputComponents);
-    ADD_LIMIT(locale, parent_item, limits, maxFragmentOutputAttachments);
-    ADD_LIMIT(locale, parent_item, limits, maxFragmentDualSrcAttachments);
-    ADD_LIMIT(locale, parent_item, limits, maxFragmentCombinedOutputResources);
-    ADD_LIMIT(locale, parent_item, limits, maxComputeSharedMemorySize);
-    ADD_LIMIT(locale, parent_item, limits, maxComputeWorkGroupCount[3]);
-    ADD_LIMIT(locale, parent_item, limits, maxComputeWorkGroupInvocations);
-    ADD_LIMIT(locale, parent_item, limits, maxComputeWorkGroupSize[3]);
-    ADD_LIMIT(locale, parent_item, limits, subPixelPrecisionBits);
-    ADD_LIMIT(locale, parent_item, limits, subTexelPrecisionBits);
-    ADD_LIMIT(locale, parent_item, limits, mipmapPrecisionBits);
-    ADD_LIMIT(locale, parent_item, limits, maxDrawIndexedIndexValue);
-    ADD_LIMIT(locale, parent_item, limits, maxDrawIndirectCount);
-    ADD_LIMIT(locale, parent_item, limits, maxSamplerLodBias);
-    ADD_LIMIT(locale, parent_item, limits, maxSamplerAnisotropy);
-    ADD_LIMIT(locale, parent_item, limits, maxViewports);
-    ADD_LIMIT(locale, parent_item, limits, maxViewportDimensions[2]);
-    ADD_LIMIT(locale, parent_item, limits, viewportBoundsRange[2]);
-    ADD_LIMIT(locale, parent_item, limits, viewportSubPixelBits);
-    ADD_LIMIT(locale, parent_item, limits, minMemoryMapAlignment);
-    ADD_LIMIT(locale, parent_item, limits, minTexelBufferOffsetAlignment);
-    ADD_LIMIT(locale, parent_item, limits, minUniformBufferOffsetAlignment);
-    ADD_LIMIT(locale, parent_item, limits, minStorageBufferOffsetAlignment);
-    ADD_LIMIT(locale, parent_item, limits, minTexelOffset);
-    ADD_LIMIT(locale, parent_item, limits, maxTexelOffset);
-    ADD_LIMIT(locale, parent_item, limits, minTexelGatherOffset);
-    ADD_LIMIT(locale, parent_item, limits, maxTexelGatherOffset);
-    ADD_LIMIT(locale, parent_item, limits, minInterpolationOffset);
-    ADD_LIMIT(locale, parent_item, limits, maxInterpolationOffset);
-    ADD_LIMIT(locale, parent_item, limits, subPixelInterpolationOffsetBits);
-    ADD_LIMIT(locale, parent_item, limits, maxFramebufferWidth);
-    ADD_LIMIT(locale, parent_item, limits, maxFramebufferHeight);
-    ADD_LIMIT(locale, parent_item, limits, maxFramebufferLayers);
-    ADD_LIMIT(locale, parent_item, limits, framebufferColorSampleCounts);
-    ADD_LIMIT(locale, parent_item, limits, framebufferDepthSampleCounts);
-    ADD_LIMIT(locale, parent_item, limits, framebufferStencilSampleCounts);
-    ADD_LIMIT(locale, parent_item, limits, framebufferNoAttachmentsSampleCounts);
-    ADD_LIMIT(locale, parent_item, limits, maxColorAttachments);
-    ADD_LIMIT(locale, parent_item, limits, sampledImageColorSampleCounts);
-    ADD_LIMIT(locale, parent_item, limits, sampledImageIntegerSampleCounts);
-    ADD_LIMIT(locale, parent_item, limits, sampledImageDepthSampleCounts);
-    ADD_LIMIT(locale, parent_item, limits, sampledImageStencilSampleCounts);
-    ADD_LIMIT(locale, parent_item, limits, storageImageSampleCounts);
-    ADD_LIMIT(locale, parent_item, limits, maxSampleMaskWords);
-    ADD_LIMIT(locale, parent_item, limits, timestampComputeAndGraphics);
-    ADD_LIMIT(locale, parent_item, limits, timestampPeriod);
-    ADD_LIMIT(locale, parent_item, limits, maxClipDistances);
-    ADD_LIMIT(locale, parent_item, limits, maxCullDistances);
-    ADD_LIMIT(locale, parent_item, limits, maxCombinedClipAndCullDistances);
-    ADD_LIMIT(locale, parent_item, limits, discreteQueuePriorities);
-    ADD_LIMIT(locale, parent_item, limits, pointSizeRange[0]);
-    ADD_LIMIT(locale, parent_item, limits, pointSizeRange[1]);
-    ADD_LIMIT(locale, parent_item, limits, lineWidthRange[0]);
-    ADD_LIMIT(locale, parent_item, limits, lineWidthRange[1]);
-    ADD_LIMIT(locale, parent_item, limits, pointSizeGranularity);
-    ADD_LIMIT(locale, parent_item, limits, lineWidthGranularity);
-    ADD_LIMIT(locale, parent_item, limits, strictLines);
-    ADD_LIMIT(locale, parent_item, limits, standardSampleLocations);
-    ADD_LIMIT(locale, parent_item, limits, optimalBufferCopyOffsetAlignment);
-    ADD_LIMIT(locale, parent_item, limits, optimalBufferCopyRowPitchAlignment);
-    ADD_LIMIT(locale, parent_item, limits, nonCoherentAtomSize);
-
-    parent_item->setExpanded(true);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxImageDimension1D);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxImageDimension2D);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxImageDimension3D);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxImageDimensionCube);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxImageArrayLayers);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxTexelBufferElements);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxUniformBufferRange);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxStorageBufferRange);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPushConstantsSize);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxMemoryAllocationCount);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxSamplerAllocationCount);
+    ADD_LIMIT(updater, locale, parent_item, limits, bufferImageGranularity);
+    ADD_LIMIT(updater, locale, parent_item, limits, sparseAddressSpaceSize);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxBoundDescriptorSets);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPerStageDescriptorSamplers);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPerStageDescriptorUniformBuffers);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPerStageDescriptorStorageBuffers);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPerStageDescriptorSampledImages);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPerStageDescriptorStorageImages);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPerStageDescriptorInputAttachments);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPerStageResources);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetSamplers);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetUniformBuffers);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetUniformBuffersDynamic);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetStorageBuffers);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetStorageBuffersDynamic);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetSampledImages);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetStorageImages);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetInputAttachments);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxVertexInputAttributes);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxVertexInputBindings);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxVertexInputAttributeOffset);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxVertexInputBindingStride);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxVertexOutputComponents);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxTessellationGenerationLevel);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxTessellationPatchSize);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxTessellationControlPerVertexInputComponents);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxTessellationControlPerVertexOutputComponents);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxTessellationControlPerPatchOutputComponents);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxTessellationControlTotalOutputComponents);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxTessellationEvaluationInputComponents);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxTessellationEvaluationOutputComponents);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxGeometryShaderInvocations);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxGeometryInputComponents);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxGeometryOutputComponents);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxGeometryOutputVertices);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxGeometryTotalOutputComponents);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxFragmentInputComponents);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxFragmentOutputAttachments);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxFragmentDualSrcAttachments);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxFragmentCombinedOutputResources);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxComputeSharedMemorySize);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxComputeWorkGroupCount[3]);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxComputeWorkGroupInvocations);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxComputeWorkGroupSize[3]);
+    ADD_LIMIT(updater, locale, parent_item, limits, subPixelPrecisionBits);
+    ADD_LIMIT(updater, locale, parent_item, limits, subTexelPrecisionBits);
+    ADD_LIMIT(updater, locale, parent_item, limits, mipmapPrecisionBits);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDrawIndexedIndexValue);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDrawIndirectCount);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxSamplerLodBias);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxSamplerAnisotropy);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxViewports);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxViewportDimensions[2]);
+    ADD_LIMIT(updater, locale, parent_item, limits, viewportBoundsRange[2]);
+    ADD_LIMIT(updater, locale, parent_item, limits, viewportSubPixelBits);
+    ADD_LIMIT(updater, locale, parent_item, limits, minMemoryMapAlignment);
+    ADD_LIMIT(updater, locale, parent_item, limits, minTexelBufferOffsetAlignment);
+    ADD_LIMIT(updater, locale, parent_item, limits, minUniformBufferOffsetAlignment);
+    ADD_LIMIT(updater, locale, parent_item, limits, minStorageBufferOffsetAlignment);
+    ADD_LIMIT(updater, locale, parent_item, limits, minTexelOffset);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxTexelOffset);
+    ADD_LIMIT(updater, locale, parent_item, limits, minTexelGatherOffset);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxTexelGatherOffset);
+    ADD_LIMIT(updater, locale, parent_item, limits, minInterpolationOffset);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxInterpolationOffset);
+    ADD_LIMIT(updater, locale, parent_item, limits, subPixelInterpolationOffsetBits);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxFramebufferWidth);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxFramebufferHeight);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxFramebufferLayers);
+    ADD_LIMIT(updater, locale, parent_item, limits, framebufferColorSampleCounts);
+    ADD_LIMIT(updater, locale, parent_item, limits, framebufferDepthSampleCounts);
+    ADD_LIMIT(updater, locale, parent_item, limits, framebufferStencilSampleCounts);
+    ADD_LIMIT(updater, locale, parent_item, limits, framebufferNoAttachmentsSampleCounts);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxColorAttachments);
+    ADD_LIMIT(updater, locale, parent_item, limits, sampledImageColorSampleCounts);
+    ADD_LIMIT(updater, locale, parent_item, limits, sampledImageIntegerSampleCounts);
+    ADD_LIMIT(updater, locale, parent_item, limits, sampledImageDepthSampleCounts);
+    ADD_LIMIT(updater, locale, parent_item, limits, sampledImageStencilSampleCounts);
+    ADD_LIMIT(updater, locale, parent_item, limits, storageImageSampleCounts);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxSampleMaskWords);
+    ADD_LIMIT(updater, locale, parent_item, limits, timestampComputeAndGraphics);
+    ADD_LIMIT(updater, locale, parent_item, limits, timestampPeriod);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxClipDistances);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxCullDistances);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxCombinedClipAndCullDistances);
+    ADD_LIMIT(updater, locale, parent_item, limits, discreteQueuePriorities);
+    ADD_LIMIT(updater, locale, parent_item, limits, pointSizeRange[0]);
+    ADD_LIMIT(updater, locale, parent_item, limits, pointSizeRange[1]);
+    ADD_LIMIT(updater, locale, parent_item, limits, lineWidthRange[0]);
+    ADD_LIMIT(updater, locale, parent_item, limits, lineWidthRange[1]);
+    ADD_LIMIT(updater, locale, parent_item, limits, pointSizeGranularity);
+    ADD_LIMIT(updater, locale, parent_item, limits, lineWidthGranularity);
+    ADD_LIMIT(updater, locale, parent_item, limits, strictLines);
+    ADD_LIMIT(updater, locale, parent_item, limits, standardSampleLocations);
+    ADD_LIMIT(updater, locale, parent_item, limits, optimalBufferCopyOffsetAlignment);
+    ADD_LIMIT(updater, locale, parent_item, limits, optimalBufferCopyRowPitchAlignment);
+    ADD_LIMIT(updater, locale, parent_item, limits, nonCoherentAtomSize);
+
+    // Left as the user had it when reused
+    if (created) {
+      parent_item->setExpanded(true);
+    }
   }
 
   // Descriptor indexing limits
   {
-    QTreeWidgetItem* parent_item = new QTreeWidgetItem();
+    bool created = false;
+    QTreeWidgetItem* parent_item = updater.item(nullptr, "Descriptor Indexing Limits", &created);
     parent_item->setText(0, "Descriptor Indexing Limits");
-    tw->addTopLevelItem(parent_item);
-
-    const auto &limits = pGpuProperties->descriptorIndexingProperties;
-
-    ADD_LIMIT(locale, parent_item, limits, maxUpdateAfterBindDescriptorsInAllPools);
-    ADD_LIMIT(locale, parent_item, limits, shaderUniformBufferArrayNonUniformIndexingNative);
-    ADD_LIMIT(locale, parent_item, limits, shaderSampledImageArrayNonUniformIndexingNative);
-    ADD_LIMIT(locale, parent_item, limits, shaderStorageBufferArrayNonUniformIndexingNative);
-    ADD_LIMIT(locale, parent_item, limits, shaderStorageImageArrayNonUniformIndexingNative);
-    ADD_LIMIT(locale, parent_item, limits, shaderInputAttachmentArrayNonUniformIndexingNative);
-    ADD_LIMIT(locale, parent_item, limits, robustBufferAccessUpdateAfterBind);
-    ADD_LIMIT(locale, parent_item, limits, quadDivergentImplicitLod);
-    ADD_LIMIT(locale, parent_item, limits, maxPerStageDescriptorUpdateAfterBindSamplers);
-    ADD_LIMIT(locale, parent_item, limits, maxPerStageDescriptorUpdateAfterBindUniformBuffers);
-    ADD_LIMIT(locale, parent_item, limits, maxPerStageDescriptorUpdateAfterBindStorageBuffers);
-    ADD_LIMIT(locale, parent_item, limits, maxPerStageDescriptorUpdateAfterBindSampledImages);
-    ADD_LIMIT(locale, parent_item, limits, maxPerStageDescriptorUpdateAfterBindStorageImages);
-    ADD_LIMIT(locale, parent_item, limits, maxPerStageDescriptorUpdateAfterBindInputAttachments);
-    ADD_LIMIT(locale, parent_item, limits, maxPerStageUpdateAfterBindResources);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetUpdateAfterBindSamplers);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetUpdateAfterBindUniformBuffers);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetUpdateAfterBindUniformBuffersDynamic);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetUpdateAfterBindStorageBuffers);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetUpdateAfterBindStorageBuffersDynamic);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetUpdateAfterBindSampledImages);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetUpdateAfterBindStorageImages);
-    ADD_LIMIT(locale, parent_item, limits, maxDescriptorSetUpdateAfterBindInputAttachments);
-
-    parent_item->setExpanded(true);
-  }
 
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
+    // Zeros when the device doesn't have VK_EXT_descriptor_indexing
+    static const VkPhysicalDeviceDescriptorIndexingPropertiesEXT sNoDescriptorIndexing = {};
+    const auto* pDescriptorIndexing = pGpuProperties->chain.find<VkPhysicalDeviceDescriptorIndexingPropertiesEXT>(
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT);
+    const auto &limits = (pDescriptorIndexing != nullptr) ? *pDescriptorIndexing : sNoDescriptorIndexing;
+
+    ADD_LIMIT(updater, locale, parent_item, limits, maxUpdateAfterBindDescriptorsInAllPools);
+    ADD_LIMIT(updater, locale, parent_item, limits, shaderUniformBufferArrayNonUniformIndexingNative);
+    ADD_LIMIT(updater, locale, parent_item, limits, shaderSampledImageArrayNonUniformIndexingNative);
+    ADD_LIMIT(updater, locale, parent_item, limits, shaderStorageBufferArrayNonUniformIndexingNative);
+    ADD_LIMIT(updater, locale, parent_item, limits, shaderStorageImageArrayNonUniformIndexingNative);
+    ADD_LIMIT(updater, locale, parent_item, limits, shaderInputAttachmentArrayNonUniformIndexingNative);
+    ADD_LIMIT(updater, locale, parent_item, limits, robustBufferAccessUpdateAfterBind);
+    ADD_LIMIT(updater, locale, parent_item, limits, quadDivergentImplicitLod);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPerStageDescriptorUpdateAfterBindSamplers);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPerStageDescriptorUpdateAfterBindUniformBuffers);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPerStageDescriptorUpdateAfterBindStorageBuffers);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPerStageDescriptorUpdateAfterBindSampledImages);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPerStageDescriptorUpdateAfterBindStorageImages);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPerStageDescriptorUpdateAfterBindInputAttachments);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxPerStageUpdateAfterBindResources);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetUpdateAfterBindSamplers);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetUpdateAfterBindUniformBuffers);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetUpdateAfterBindUniformBuffersDynamic);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetUpdateAfterBindStorageBuffers);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetUpdateAfterBindStorageBuffersDynamic);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetUpdateAfterBindSampledImages);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetUpdateAfterBindStorageImages);
+    ADD_LIMIT(updater, locale, parent_item, limits, maxDescriptorSetUpdateAfterBindInputAttachments);
+
+    if (created) {
+      parent_item->setExpanded(true);
+    }
   }
+  updater.finish();
+
+  resizeColumns(tw);
+  filterTreeWidgetItemsSimple("limitsWidget", filter->text().trimmed());
 }
 
-#define ADD_SPARSE(tw, sparse, prop)                          \
+#define ADD_SPARSE(updater, sparse, prop)                     \
   {                                                           \
-    QTreeWidgetItem* item = new QTreeWidgetItem();            \
+    QTreeWidgetItem* item = updater.item(nullptr, #prop);     \
     item->setText(0, QString::fromUtf8(#prop));               \
     item->setText(1, (sparse.prop == VK_TRUE) ? "Y" : "");   \
     item->setTextAlignment(1, Qt::AlignHCenter);              \
-    tw->addTopLevelItem(item);                                \
   }
 
 void MainWindow::populateSparse(const GpuProperties* pGpuProperties)
 {
+  TRACE_SCOPE("qt", "populateSparse");
+
   VkPhysicalDevice gpu = pGpuProperties->physicalDevice;
 
   QTreeWidget* tw = findChild<QTreeWidget*>("sparsePropertiesWidget");
   Q_ASSERT(tw);
 
-  tw->clear();
+  TreeWidgetUpdater updater(tw);
 
   const auto &sparseProperties = pGpuProperties->deviceProperties.sparseProperties;
 
-  ADD_SPARSE(tw, sparseProperties, residencyStandard2DBlockShape);
-  ADD_SPARSE(tw, sparseProperties, residencyStandard2DMultisampleBlockShape);
-  ADD_SPARSE(tw, sparseProperties, residencyStandard3DBlockShape);
-  ADD_SPARSE(tw, sparseProperties, residencyAlignedMipSize);
-  ADD_SPARSE(tw, sparseProperties, residencyNonResidentStrict);
+  ADD_SPARSE(updater, sparseProperties, residencyStandard2DBlockShape);
+  ADD_SPARSE(updater, sparseProperties, residencyStandard2DMultisampleBlockShape);
+  ADD_SPARSE(updater, sparseProperties, residencyStandard3DBlockShape);
+  ADD_SPARSE(updater, sparseProperties, residencyAlignedMipSize);
+  ADD_SPARSE(updater, sparseProperties, residencyNonResidentStrict);
+  updater.finish();
 
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
+  resizeColumns(tw);
+
+  populateSparseImageFormats(pGpuProperties);
+}
+
+void MainWindow::populateSparseImageFormats(const GpuProperties* pGpuProperties)
+{
+  TRACE_SCOPE("qt", "populateSparseImageFormats");
+
+  VkPhysicalDevice gpu = pGpuProperties->physicalDevice;
+
+  QTreeWidget* tw = findChild<QTreeWidget*>("sparseImageFormatsWidget");
+  QLabel* status = findChild<QLabel*>("sparseImageFormatStatus");
+  Q_ASSERT(tw && status);
+
+  // A few thousand queries on some drivers, so the first visit runs in the background
+  auto it = mSparseImageFormatResults.find(gpu);
+  if (it == mSparseImageFormatResults.end()) {
+    if (! mSparseImageFormats.isRunning()) {
+      std::vector<VkFormat> formats = getSupportedFormats(pGpuProperties->deviceProperties.apiVersion, pGpuProperties->extensionSet);
+      mSparseImageFormatsGpu = gpu;
+      mSparseImageFormatsGeneration = mDeviceGeneration;
+      int gpuIndex = getGpuIndex(pGpuProperties);
+      std::string gpuName = pGpuProperties->description;
+      mSparseImageFormats.setFuture(QtConcurrent::run([gpu, gpuIndex, gpuName, formats]() -> SparseImageFormatResults {
+        MemoryScope memoryScope(PAGE_SPARSE, gpuIndex, gpuName);
+        return enumerateSparseImageFormats(gpu, formats);
+      }));
+    }
+    // The rows stay until the results are in, most of them are reused then
+    tw->setEnabled(false);
+    status->setText("Querying...");
+    return;
+  }
+
+  TreeWidgetUpdater updater(tw);
+  QLocale locale;
+  uint32_t index = 0;
+  for (const auto& entry : it->second) {
+    const VkExtent3D& granularity = entry.properties.imageGranularity;
+    QStringList usage;
+    for (uint32_t bit = 1; bit <= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT; bit <<= 1) {
+      if (entry.usage & bit) {
+        usage << toStringImageUsageFlagShort(static_cast<VkImageUsageFlagBits>(bit));
+      }
+    }
+
+    QString key = QString("%1 %2 %3 %4").arg(entry.format).arg(entry.type).arg(entry.samples).arg(entry.usage);
+    QTreeWidgetItem* item = updater.item(nullptr, key);
+    item->setText(0, toStringVkFormat(entry.format));
+    item->setData(0, SORT_ROLE, index++);
+    item->setText(1, toStringImageTypeShort(entry.type));
+    item->setText(2, QString::number(entry.samples));
+    item->setData(2, SORT_ROLE, static_cast<uint32_t>(entry.samples));
+    item->setText(3, usage.join(" / "));
+    item->setText(4, toStringImageAspectFlags(entry.properties.aspectMask));
+    item->setText(5, QString("%1 x %2 x %3").arg(granularity.width).arg(granularity.height).arg(granularity.depth));
+    item->setData(5, SORT_ROLE, static_cast<qulonglong>(granularity.width) * granularity.height * granularity.depth);
+    item->setText(6, toStringSparseImageFormatFlags(entry.properties.flags));
+    for (int c = 1; c <= 2; ++c) {
+      item->setTextAlignment(c, Qt::AlignHCenter);
+    }
+    item->setTextAlignment(5, Qt::AlignRight);
+  }
+  updater.finish();
+  tw->setEnabled(true);
+  resizeColumns(tw);
+
+  status->setText(QString("%1 combinations").arg(locale.toString(static_cast<qulonglong>(it->second.size()))));
+
+  QLineEdit* filter = findChild<QLineEdit*>("sparseImageFormatFilter");
+  Q_ASSERT(filter);
+  filterTreeWidgetItemsSimple("sparseImageFormatsWidget", filter->text().trimmed());
+}
+
+void MainWindow::onSparseImageFormatsFinished()
+{
+  // A handle from before a device change may be reused by the new instance
+  if (mSparseImageFormatsGeneration == mDeviceGeneration) {
+    mSparseImageFormatResults[mSparseImageFormatsGpu] = mSparseImageFormats.result();
+  }
+  if (mCurrentGpuProperties == nullptr) {
+    return;
   }
+  // Either the device that was queried or one selected while it ran, which starts its own query
+  populateSparseImageFormats(mCurrentGpuProperties);
 }
 
-#define ADD_FEATURE(parent, features, prop)                   \
+#define ADD_FEATURE(updater, parent, features, prop)          \
   {                                                           \
-    QTreeWidgetItem* item = new QTreeWidgetItem();            \
+    QTreeWidgetItem* item = updater.item(parent, #prop);      \
     item->setText(0, QString::fromUtf8(#prop));               \
     item->setText(1, (features.prop == VK_TRUE) ? "Y" : "");  \
     item->setTextAlignment(1, Qt::AlignHCenter);              \
-    parent->addChild(item);                                   \
   }
 
 void MainWindow::populateFeatures(const GpuProperties* pGpuProperties)
 {  
-  VkPhysicalDevice gpu = pGpuProperties->physicalDevice;
+  TRACE_SCOPE("qt", "populateFeatures");
 
   QTreeWidget* tw = findChild<QTreeWidget*>("featuresWidget");
-  Q_ASSERT(tw);
+  QLineEdit* filter = findChild<QLineEdit*>("featuresFilter");
+  Q_ASSERT(tw && filter);
 
-  tw->clear();
+  TreeWidgetUpdater updater(tw);
 
-  VkPhysicalDeviceFeatures2 features2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
-  VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptor_indexing_features
-      = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT };
-  features2.pNext= & descriptor_indexing_features;
-  vkGetPhysicalDeviceFeatures2(gpu, &features2);
+  // Queried with the rest of the chain in enumerateGpus
+  const VkPhysicalDeviceFeatures2& features2 = *pGpuProperties->chain.features2();
+  static const VkPhysicalDeviceDescriptorIndexingFeaturesEXT sNoDescriptorIndexing = {};
+  const auto* pDescriptorIndexing = pGpuProperties->chain.find<VkPhysicalDeviceDescriptorIndexingFeaturesEXT>(
+    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT);
+  const VkPhysicalDeviceDescriptorIndexingFeaturesEXT& descriptor_indexing_features
+      = (pDescriptorIndexing != nullptr) ? *pDescriptorIndexing : sNoDescriptorIndexing;
 
   // Device limits
   {
-    QTreeWidgetItem* parent_item = new QTreeWidgetItem();
+    bool created = false;
+    QTreeWidgetItem* parent_item = updater.item(nullptr, "Device Features", &created);
     parent_item->setText(0, "Device Features");
-    tw->addTopLevelItem(parent_item);
 
     const VkPhysicalDeviceFeatures& features = features2.features;
-    ADD_FEATURE(parent_item, features, robustBufferAccess);
-    ADD_FEATURE(parent_item, features, fullDrawIndexUint32);
-    ADD_FEATURE(parent_item, features, imageCubeArray);
-    ADD_FEATURE(parent_item, features, independentBlend);
-    ADD_FEATURE(parent_item, features, geometryShader);
-    ADD_FEATURE(parent_item, features, tessellationShader);
-    ADD_FEATURE(parent_item, features, sampleRateShading);
-    ADD_FEATURE(parent_item, features, dualSrcBlend);
-    ADD_FEATURE(parent_item, features, logicOp);
-    ADD_FEATURE(parent_item, features, multiDrawIndirect);
-    ADD_FEATURE(parent_item, features, drawIndirectFirstInstance);
-    ADD_FEATURE(parent_item, features, depthClamp);
-    ADD_FEATURE(parent_item, features, depthBiasClamp);
-    ADD_FEATURE(parent_item, features, fillModeNonSolid);
-    ADD_FEATURE(parent_item, features, depthBounds);
-    ADD_FEATURE(parent_item, features, wideLines);
-    ADD_FEATURE(parent_item, features, largePoints);
-    ADD_FEATURE(parent_item, features, alphaToOne);
-    ADD_FEATURE(parent_item, features, multiViewport);
-    ADD_FEATURE(parent_item, features, samplerAnisotropy);
-    ADD_FEATURE(parent_item, features, textureCompressionETC2);
-    ADD_FEATURE(parent_item, features, textureCompressionASTC_LDR);
-    ADD_FEATURE(parent_item, features, textureCompressionBC);
-    ADD_FEATURE(parent_item, features, occlusionQueryPrecise);
-    ADD_FEATURE(parent_item, features, pipelineStatisticsQuery);
-    ADD_FEATURE(parent_item, features, vertexPipelineStoresAndAtomics);
-    ADD_FEATURE(parent_item, features, fragmentStoresAndAtomics);
-    ADD_FEATURE(parent_item, features, shaderTessellationAndGeometryPointSize);
-    ADD_FEATURE(parent_item, features, shaderImageGatherExtended);
-    ADD_FEATURE(parent_item, features, shaderStorageImageExtendedFormats);
-    ADD_FEATURE(parent_item, features, shaderStorageImageMultisample);
-    ADD_FEATURE(parent_item, features, shaderStorageImageReadWithoutFormat);
-    ADD_FEATURE(parent_item, features, shaderStorageImageWriteWithoutFormat);
-    ADD_FEATURE(parent_item, features, shaderUniformBufferArrayDynamicIndexing);
-    ADD_FEATURE(parent_item, features, shaderSampledImageArrayDynamicIndexing);
-    ADD_FEATURE(parent_item, features, shaderStorageBufferArrayDynamicIndexing);
-    ADD_FEATURE(parent_item, features, shaderStorageImageArrayDynamicIndexing);
-    ADD_FEATURE(parent_item, features, shaderClipDistance);
-    ADD_FEATURE(parent_item, features, shaderCullDistance);
-    ADD_FEATURE(parent_item, features, shaderFloat64);
-    ADD_FEATURE(parent_item, features, shaderInt64);
-    ADD_FEATURE(parent_item, features, shaderInt16);
-    ADD_FEATURE(parent_item, features, shaderResourceResidency);
-    ADD_FEATURE(parent_item, features, shaderResourceMinLod);
-    ADD_FEATURE(parent_item, features, sparseBinding);
-    ADD_FEATURE(parent_item, features, sparseResidencyBuffer);
-    ADD_FEATURE(parent_item, features, sparseResidencyImage2D);
-    ADD_FEATURE(parent_item, features, sparseResidencyImage3D);
-    ADD_FEATURE(parent_item, features, sparseResidency2Samples);
-    ADD_FEATURE(parent_item, features, sparseResidency4Samples);
-    ADD_FEATURE(parent_item, features, sparseResidency8Samples);
-    ADD_FEATURE(parent_item, features, sparseResidency16Samples);
-    ADD_FEATURE(parent_item, features, sparseResidencyAliased);
-    ADD_FEATURE(parent_item, features, variableMultisampleRate);
-    ADD_FEATURE(parent_item, features, inheritedQueries);
-
-    parent_item->setExpanded(true);
+    ADD_FEATURE(updater, parent_item, features, robustBufferAccess);
+    ADD_FEATURE(updater, parent_item, features, fullDrawIndexUint32);
+    ADD_FEATURE(updater, parent_item, features, imageCubeArray);
+    ADD_FEATURE(updater, parent_item, features, independentBlend);
+    ADD_FEATURE(updater, parent_item, features, geometryShader);
+    ADD_FEATURE(updater, parent_item, features, tessellationShader);
+    ADD_FEATURE(updater, parent_item, features, sampleRateShading);
+    ADD_FEATURE(updater, parent_item, features, dualSrcBlend);
+    ADD_FEATURE(updater, parent_item, features, logicOp);
+    ADD_FEATURE(updater, parent_item, features, multiDrawIndirect);
+    ADD_FEATURE(updater, parent_item, features, drawIndirectFirstInstance);
+    ADD_FEATURE(updater, parent_item, features, depthClamp);
+    ADD_FEATURE(updater, parent_item, features, depthBiasClamp);
+    ADD_FEATURE(updater, parent_item, features, fillModeNonSolid);
+    ADD_FEATURE(updater, parent_item, features, depthBounds);
+    ADD_FEATURE(updater, parent_item, features, wideLines);
+    ADD_FEATURE(updater, parent_item, features, largePoints);
+    ADD_FEATURE(updater, parent_item, features, alphaToOne);
+    ADD_FEATURE(updater, parent_item, features, multiViewport);
+    ADD_FEATURE(updater, parent_item, features, samplerAnisotropy);
+    ADD_FEATURE(updater, parent_item, features, textureCompressionETC2);
+    ADD_FEATURE(updater, parent_item, features, textureCompressionASTC_LDR);
+    ADD_FEATURE(updater, parent_item, features, textureCompressionBC);
+    ADD_FEATURE(updater, parent_item, features, occlusionQueryPrecise);
+    ADD_FEATURE(updater, parent_item, features, pipelineStatisticsQuery);
+    ADD_FEATURE(updater, parent_item, features, vertexPipelineStoresAndAtomics);
+    ADD_FEATURE(updater, parent_item, features, fragmentStoresAndAtomics);
+    ADD_FEATURE(updater, parent_item, features, shaderTessellationAndGeometryPointSize);
+    ADD_FEATURE(updater, parent_item, features, shaderImageGatherExtended);
+    ADD_FEATURE(updater, parent_item, features, shaderStorageImageExtendedFormats);
+    ADD_FEATURE(updater, parent_item, features, shaderStorageImageMultisample);
+    ADD_FEATURE(updater, parent_item, features, shaderStorageImageReadWithoutFormat);
+    ADD_FEATURE(updater, parent_item, features, shaderStorageImageWriteWithoutFormat);
+    ADD_FEATURE(updater, parent_item, features, shaderUniformBufferArrayDynamicIndexing);
+    ADD_FEATURE(updater, parent_item, features, shaderSampledImageArrayDynamicIndexing);
+    ADD_FEATURE(updater, parent_item, features, shaderStorageBufferArrayDynamicIndexing);
+    ADD_FEATURE(updater, parent_item, features, shaderStorageImageArrayDynamicIndexing);
+    ADD_FEATURE(updater, parent_item, features, shaderClipDistance);
+    ADD_FEATURE(updater, parent_item, features, shaderCullDistance);
+    ADD_FEATURE(updater, parent_item, features, shaderFloat64);
+    ADD_FEATURE(updater, parent_item, features, shaderInt64);
+    ADD_FEATURE(updater, parent_item, features, shaderInt16);
+    ADD_FEATURE(updater, parent_item, features, shaderResourceResidency);
+    ADD_FEATURE(updater, parent_item, features, shaderResourceMinLod);
+    ADD_FEATURE(updater, parent_item, features, sparseBinding);
+    ADD_FEATURE(updater, parent_item, features, sparseResidencyBuffer);
+    ADD_FEATURE(updater, parent_item, features, sparseResidencyImage2D);
+    ADD_FEATURE(updater, parent_item, features, sparseResidencyImage3D);
+    ADD_FEATURE(updater, parent_item, features, sparseResidency2Samples);
+    ADD_FEATURE(updater, parent_item, features, sparseResidency4Samples);
+    ADD_FEATURE(updater, parent_item, features, sparseResidency8Samples);
+    ADD_FEATURE(updater, parent_item, features, sparseResidency16Samples);
+    ADD_FEATURE(updater, parent_item, features, sparseResidencyAliased);
+    ADD_FEATURE(updater, parent_item, features, variableMultisampleRate);
+    ADD_FEATURE(updater, parent_item, features, inheritedQueries);
+
+    if (created) {
+      parent_item->setExpanded(true);
+    }
   }
 
   // Device limits
   {
-    QTreeWidgetItem* parent_item = new QTreeWidgetItem();
+    bool created = false;
+    QTreeWidgetItem* parent_item = updater.item(nullptr, "Descriptor Indexing Features", &created);
     parent_item->setText(0, "Descriptor Indexing Features");
-    tw->addTopLevelItem(parent_item);
 
     const VkPhysicalDeviceDescriptorIndexingFeaturesEXT& features = descriptor_indexing_features;
-    ADD_FEATURE(parent_item, features, shaderInputAttachmentArrayDynamicIndexing);
-    ADD_FEATURE(parent_item, features, shaderUniformTexelBufferArrayDynamicIndexing);
-    ADD_FEATURE(parent_item, features, shaderStorageTexelBufferArrayDynamicIndexing);
-    ADD_FEATURE(parent_item, features, shaderUniformBufferArrayNonUniformIndexing);
-    ADD_FEATURE(parent_item, features, shaderSampledImageArrayNonUniformIndexing);
-    ADD_FEATURE(parent_item, features, shaderStorageBufferArrayNonUniformIndexing);
-    ADD_FEATURE(parent_item, features, shaderStorageImageArrayNonUniformIndexing);
-    ADD_FEATURE(parent_item, features, shaderInputAttachmentArrayNonUniformIndexing);
-    ADD_FEATURE(parent_item, features, shaderUniformTexelBufferArrayNonUniformIndexing);
-    ADD_FEATURE(parent_item, features, shaderStorageTexelBufferArrayNonUniformIndexing);
-    ADD_FEATURE(parent_item, features, descriptorBindingUniformBufferUpdateAfterBind);
-    ADD_FEATURE(parent_item, features, descriptorBindingSampledImageUpdateAfterBind);
-    ADD_FEATURE(parent_item, features, descriptorBindingStorageImageUpdateAfterBind);
-    ADD_FEATURE(parent_item, features, descriptorBindingStorageBufferUpdateAfterBind);
-    ADD_FEATURE(parent_item, features, descriptorBindingUniformTexelBufferUpdateAfterBind);
-    ADD_FEATURE(parent_item, features, descriptorBindingStorageTexelBufferUpdateAfterBind);
-    ADD_FEATURE(parent_item, features, descriptorBindingUpdateUnusedWhilePending);
-    ADD_FEATURE(parent_item, features, descriptorBindingPartiallyBound);
-    ADD_FEATURE(parent_item, features, descriptorBindingVariableDescriptorCount);
-    ADD_FEATURE(parent_item, features, runtimeDescriptorArray);
-
-    parent_item->setExpanded(true);
+    ADD_FEATURE(updater, parent_item, features, shaderInputAttachmentArrayDynamicIndexing);
+    ADD_FEATURE(updater, parent_item, features, shaderUniformTexelBufferArrayDynamicIndexing);
+    ADD_FEATURE(updater, parent_item, features, shaderStorageTexelBufferArrayDynamicIndexing);
+    ADD_FEATURE(updater, parent_item, features, shaderUniformBufferArrayNonUniformIndexing);
+    ADD_FEATURE(updater, parent_item, features, shaderSampledImageArrayNonUniformIndexing);
+    ADD_FEATURE(updater, parent_item, features, shaderStorageBufferArrayNonUniformIndexing);
+    ADD_FEATURE(updater, parent_item, features, shaderStorageImageArrayNonUniformIndexing);
+    ADD_FEATURE(updater, parent_item, features, shaderInputAttachmentArrayNonUniformIndexing);
+    ADD_FEATURE(updater, parent_item, features, shaderUniformTexelBufferArrayNonUniformIndexing);
+    ADD_FEATURE(updater, parent_item, features, shaderStorageTexelBufferArrayNonUniformIndexing);
+    ADD_FEATURE(updater, parent_item, features, descriptorBindingUniformBufferUpdateAfterBind);
+    ADD_FEATURE(updater, parent_item, features, descriptorBindingSampledImageUpdateAfterBind);
+    ADD_FEATURE(updater, parent_item, features, descriptorBindingStorageImageUpdateAfterBind);
+    ADD_FEATURE(updater, parent_item, features, descriptorBindingStorageBufferUpdateAfterBind);
+    ADD_FEATURE(updater, parent_item, features, descriptorBindingUniformTexelBufferUpdateAfterBind);
+    ADD_FEATURE(updater, parent_item, features, descriptorBindingStorageTexelBufferUpdateAfterBind);
+    ADD_FEATURE(updater, parent_item, features, descriptorBindingUpdateUnusedWhilePending);
+    ADD_FEATURE(updater, parent_item, features, descriptorBindingPartiallyBound);
+    ADD_FEATURE(updater, parent_item, features, descriptorBindingVariableDescriptorCount);
+    ADD_FEATURE(updater, parent_item, features, runtimeDescriptorArray);
+
+    if (created) {
+      parent_item->setExpanded(true);
+    }
   }
+  updater.finish();
 
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
-  }
+  resizeColumns(tw);
+  filterTreeWidgetItemsSimple("featuresWidget", filter->text().trimmed());
 }
 
 void setLabelValue(QLabel* lb, uint32_t value)
@@ -822,7 +1781,7 @@ void MainWindow::updateSurfaceExtents(const GpuProperties* pGpuProperties)
   VkPhysicalDevice gpu = pGpuProperties->physicalDevice;
 
   VkSurfaceCapabilitiesKHR surfCaps = {};
-  vkGetPhysicalDeviceSurfaceCapabilitiesKHR(gpu, mSurface, &surfCaps);
+  VK_CALL(gpu, vkGetPhysicalDeviceSurfaceCapabilitiesKHR, gpu, mSurface, &surfCaps);
 
   setLabelValue(findChild<QLabel*>("minImageExtentValue"), surfCaps.minImageExtent);
   setLabelValue(findChild<QLabel*>("maxImageExtentValue"), surfCaps.maxImageExtent);
@@ -831,16 +1790,18 @@ void MainWindow::updateSurfaceExtents(const GpuProperties* pGpuProperties)
 
 void MainWindow::populateSurface(const GpuProperties* pGpuProperties)
 {
+  TRACE_SCOPE("qt", "populateSurface");
+
   VkPhysicalDevice gpu = pGpuProperties->physicalDevice;
 
   VkSurfaceCapabilitiesKHR surfCaps = {};
-  vkGetPhysicalDeviceSurfaceCapabilitiesKHR(gpu, mSurface, &surfCaps);
+  VK_CALL(gpu, vkGetPhysicalDeviceSurfaceCapabilitiesKHR, gpu, mSurface, &surfCaps);
 
   uint32_t count = 0;
-  VkResult res = vkGetPhysicalDeviceSurfaceFormatsKHR(gpu, mSurface, &count, nullptr);
+  VkResult res = VK_CALL(gpu, vkGetPhysicalDeviceSurfaceFormatsKHR, gpu, mSurface, &count, nullptr);
   assert(res == VK_SUCCESS);
   std::vector<VkSurfaceFormatKHR> formats(count);
-  res = vkGetPhysicalDeviceSurfaceFormatsKHR(gpu, mSurface, &count, formats.data());
+  res = VK_CALL(gpu, vkGetPhysicalDeviceSurfaceFormatsKHR, gpu, mSurface, &count, formats.data());
   assert(res == VK_SUCCESS);
 
   setLabelValue(findChild<QLabel*>("minImageCountValue"), surfCaps.minImageCount);
@@ -850,63 +1811,58 @@ void MainWindow::populateSurface(const GpuProperties* pGpuProperties)
   updateSurfaceExtents(pGpuProperties);
 
   // Present modes
-  res = vkGetPhysicalDeviceSurfacePresentModesKHR(gpu, mSurface, &count, nullptr);
+  res = VK_CALL(gpu, vkGetPhysicalDeviceSurfacePresentModesKHR, gpu, mSurface, &count, nullptr);
   assert(res == VK_SUCCESS);
   std::vector<VkPresentModeKHR> presentModes(count);
-  res = vkGetPhysicalDeviceSurfacePresentModesKHR(gpu, mSurface, &count, presentModes.data());
+  res = VK_CALL(gpu, vkGetPhysicalDeviceSurfacePresentModesKHR, gpu, mSurface, &count, presentModes.data());
   assert(res == VK_SUCCESS);
   QTreeWidget* tw = findChild<QTreeWidget*>("presentModesWidget");
   Q_ASSERT(tw);
-  tw->clear();
+  TreeWidgetUpdater presentModesUpdater(tw);
   for (const auto& mode : presentModes) {
-    QTreeWidgetItem* item = new QTreeWidgetItem();
+    QTreeWidgetItem* item = presentModesUpdater.item(nullptr, toStringVkPresentMode(mode));
     item->setText(0, toStringVkPresentMode(mode));
-    tw->addTopLevelItem(item);
-  }
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
   }
+  presentModesUpdater.finish();
+  resizeColumns(tw);
 
   // Transforms
   tw = findChild<QTreeWidget*>("transformsWidget");
   Q_ASSERT(tw);
-  tw->clear();
+  TreeWidgetUpdater transformsUpdater(tw);
   for (uint32_t i = 0; i < 32; ++i) {
     VkSurfaceTransformFlagBitsKHR transform = static_cast<VkSurfaceTransformFlagBitsKHR>(1 << i);
     if ((surfCaps.supportedTransforms & transform) == 0) {
       continue;
     }
-    QTreeWidgetItem* item = new QTreeWidgetItem();
+    QTreeWidgetItem* item = transformsUpdater.item(nullptr, toStringVkTransform(transform));
     item->setText(0, toStringVkTransform(transform));
-    tw->addTopLevelItem(item);
-  }
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
   }
+  transformsUpdater.finish();
+  resizeColumns(tw);
 
   // Composite Alpha
   tw = findChild<QTreeWidget*>("compositeAlphaModesWidget");
   Q_ASSERT(tw);
-  tw->clear();
+  TreeWidgetUpdater compositeAlphaUpdater(tw);
   for (uint32_t i = 0; i < 32; ++i) {
     VkCompositeAlphaFlagBitsKHR mode = static_cast<VkCompositeAlphaFlagBitsKHR>(1 << i);
     if ((surfCaps.supportedCompositeAlpha & mode) == 0) {
       continue;
     }
-    QTreeWidgetItem* item = new QTreeWidgetItem();
+    QTreeWidgetItem* item = compositeAlphaUpdater.item(nullptr, toStringVkCompositeAlpha(mode));
     item->setText(0, toStringVkCompositeAlpha(mode));
-    tw->addTopLevelItem(item);
-  }
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
   }
+  compositeAlphaUpdater.finish();
+  resizeColumns(tw);
 
   // Formats and usage
   tw = findChild<QTreeWidget*>("surfaceFormatsWidget");
   Q_ASSERT(tw);
-  tw->clear();
+  TreeWidgetUpdater surfaceFormatsUpdater(tw);
   for (const auto& format : formats) {
-    QTreeWidgetItem* item = new QTreeWidgetItem();
+    QString key = QString("%1 %2").arg(format.format).arg(format.colorSpace);
+    QTreeWidgetItem* item = surfaceFormatsUpdater.item(nullptr, key);
     item->setText(0, toStringVkFormat(format.format));
     item->setText(1, toStringVkColorSpace(format.colorSpace));
     item->setText(2, ((surfCaps.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0) ? "Y" : "");
@@ -920,65 +1876,163 @@ void MainWindow::populateSurface(const GpuProperties* pGpuProperties)
     for (int c = 2; c < item->columnCount(); ++c) {
       item->setTextAlignment(c, Qt::AlignHCenter);
     }
-    tw->addTopLevelItem(item);
-  }
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
   }
+  surfaceFormatsUpdater.finish();
+  resizeColumns(tw);
 }
 
 void MainWindow::populateQueues(const GpuProperties* pGpuProperties)
 {
+  TRACE_SCOPE("qt", "populateQueues");
+
   VkPhysicalDevice gpu = pGpuProperties->physicalDevice;
 
   uint32_t count = 0;
-  vkGetPhysicalDeviceQueueFamilyProperties(gpu, &count, nullptr);
+  VK_CALL(gpu, vkGetPhysicalDeviceQueueFamilyProperties, gpu, &count, nullptr);
   std::vector<VkQueueFamilyProperties> properties(count);
-  vkGetPhysicalDeviceQueueFamilyProperties(gpu, &count, properties.data());
+  VK_CALL(gpu, vkGetPhysicalDeviceQueueFamilyProperties, gpu, &count, properties.data());
 
   QTreeWidget* tw = findChild<QTreeWidget*>("queuesWidget");
   Q_ASSERT(tw);
-  tw->clear();
+  TreeWidgetUpdater updater(tw);
   for (size_t i = 0; i < properties.size(); ++i) {
     VkBool32 presents = VK_FALSE;
-    VkResult res = vkGetPhysicalDeviceSurfaceSupportKHR(gpu, static_cast<uint32_t>(i), mSurface, &presents);
+    VkResult res = VK_CALL(gpu, vkGetPhysicalDeviceSurfaceSupportKHR, gpu, static_cast<uint32_t>(i), mSurface, &presents);
     assert(res == VK_SUCCESS);
 
-    QTreeWidgetItem* item = new QTreeWidgetItem();
+    QTreeWidgetItem* item = updater.item(nullptr, QString::number(i));
     item->setText(0, QString::number(i));
     item->setText(1, QString::number(properties[i].queueCount));
+    item->setData(0, Qt::UserRole, static_cast<uint32_t>(i));
+    item->setData(0, SORT_ROLE, static_cast<uint32_t>(i));
+    item->setData(1, SORT_ROLE, properties[i].queueCount);
     item->setText(2, (presents == VK_TRUE) ? "Y" : "");
     item->setText(3, ((properties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0) ? "Y" : "");
     item->setText(4, ((properties[i].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0) ? "Y" : "");
     item->setText(5, ((properties[i].queueFlags & VK_QUEUE_TRANSFER_BIT) != 0) ? "Y" : "");
     item->setText(6, ((properties[i].queueFlags & VK_QUEUE_SPARSE_BINDING_BIT) != 0) ? "Y" : "");
-    item->setText(7, " ");
+    item->setText(12, " ");
     for (int c = 0; c < item->columnCount(); ++c) {
       item->setTextAlignment(c, Qt::AlignHCenter);
     }
-    tw->addTopLevelItem(item);
   }
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
+  updater.finish();
+  resizeColumns(tw);
+
+  populateQueueBenchmark(pGpuProperties);
+}
+
+void MainWindow::populateQueueBenchmark(const GpuProperties* pGpuProperties)
+{
+  QTreeWidget* tw = findChild<QTreeWidget*>("queuesWidget");
+  Q_ASSERT(tw);
+
+  auto it = mQueueBenchmarkResults.find(pGpuProperties->physicalDevice);
+  // Each cell is set once, a reused row with the same result doesn't change
+  auto setValue = [](QTreeWidgetItem* item, int column, double value, int precision, const QString& suffix) {
+    item->setText(column, (value >= 0.0) ? (QString::number(value, 'f', precision) + suffix) : QString("n/a"));
+    item->setData(column, SORT_ROLE, (value >= 0.0) ? QVariant(value) : QVariant());
+  };
+
+  TreeSortingBlocker sortingBlocker(tw);
+  for (int i = 0; i < tw->topLevelItemCount(); ++i) {
+    QTreeWidgetItem* item = tw->topLevelItem(i);
+    uint32_t familyIndex = item->data(0, Qt::UserRole).value<uint32_t>();
+    if ((it == mQueueBenchmarkResults.end()) || (familyIndex >= it->second.size())) {
+      for (int c = 7; c <= 11; ++c) {
+        item->setText(c, "");
+        item->setData(c, SORT_ROLE, QVariant());
+      }
+      continue;
+    }
+
+    const QueueFamilyBenchmark& result = it->second[familyIndex];
+    setValue(item, 7, result.latencyUs, 1, "");
+    setValue(item, 8, result.jitterUs, 1, "");
+    setValue(item, 9, result.singleRate, 0, "");
+    setValue(item, 10, (result.sameFamilyThreads > 0) ? result.sameFamilyRate : -1.0, 0, QString(" (x%1)").arg(result.sameFamilyThreads));
+    setValue(item, 11, result.crossFamilyRate, 0, "");
+    for (int c = 7; c <= 11; ++c) {
+      item->setTextAlignment(c, Qt::AlignRight);
+    }
+  }
+
+  resizeColumns(tw);
+}
+
+void MainWindow::onQueueBenchmarkBtnClicked()
+{
+  if ((mCurrentGpuProperties == nullptr) || mQueueBenchmark.isRunning()) {
+    return;
+  }
+
+  QPushButton* btn = findChild<QPushButton*>("queueBenchmarkBtn");
+  QLabel* status = findChild<QLabel*>("queueBenchmarkStatus");
+  Q_ASSERT(btn && status);
+  btn->setEnabled(false);
+  status->setText("Running...");
+
+  VkPhysicalDevice gpu = mCurrentGpuProperties->physicalDevice;
+  mQueueBenchmarkGpu = gpu;
+  mQueueBenchmarkGeneration = mDeviceGeneration;
+  int gpuIndex = getGpuIndex(mCurrentGpuProperties);
+  std::string gpuName = mCurrentGpuProperties->description;
+  mQueueBenchmark.setFuture(QtConcurrent::run([gpu, gpuIndex, gpuName]() -> QueueBenchmarkResults {
+    MemoryScope memoryScope(PAGE_QUEUES, gpuIndex, gpuName);
+    BenchmarkContext context;
+    if (context.create(gpu) != VK_SUCCESS) {
+      return QueueBenchmarkResults();
+    }
+    return runQueueBenchmark(context);
+  }));
+}
+
+void MainWindow::onQueueBenchmarkFinished()
+{
+  QPushButton* btn = findChild<QPushButton*>("queueBenchmarkBtn");
+  QLabel* status = findChild<QLabel*>("queueBenchmarkStatus");
+  Q_ASSERT(btn && status);
+  btn->setEnabled(true);
+
+  if (mQueueBenchmarkGeneration != mDeviceGeneration) {
+    status->setText("Devices changed, run again");
+    return;
+  }
+
+  QueueBenchmarkResults results = mQueueBenchmark.result();
+  if (results.empty()) {
+    status->setText("Unable to create a device");
+    return;
+  }
+
+  status->setText("Empty submits with a fence wait; Same Family uses one thread per queue");
+  mQueueBenchmarkResults[mQueueBenchmarkGpu] = results;
+  if ((mCurrentGpuProperties != nullptr) && (mCurrentGpuProperties->physicalDevice == mQueueBenchmarkGpu)) {
+    populateQueueBenchmark(mCurrentGpuProperties);
   }
 }
 
 void MainWindow::populateMemory(const GpuProperties* pGpuProperties)
 {
+  TRACE_SCOPE("qt", "populateMemory");
+
   VkPhysicalDevice gpu = pGpuProperties->physicalDevice;
 
   VkPhysicalDeviceMemoryProperties properties = {};
-  vkGetPhysicalDeviceMemoryProperties(gpu, &properties);
+  VK_CALL(gpu, vkGetPhysicalDeviceMemoryProperties, gpu, &properties);
 
   // Memory types
   QTreeWidget* tw = findChild<QTreeWidget*>("memoryTypesWidget");
   Q_ASSERT(tw);
-  tw->clear();
+  TreeWidgetUpdater memoryTypesUpdater(tw);
   for (uint32_t i = 0; i < properties.memoryTypeCount; ++i) {
     const auto& type = properties.memoryTypes[i];
-    auto item = new QTreeWidgetItem();
+    auto item = memoryTypesUpdater.item(nullptr, QString::number(i));
     item->setText(0, QString::number(i));
     item->setText(1, QString::number(type.heapIndex));
+    item->setData(0, Qt::UserRole, i);
+    item->setData(0, SORT_ROLE, i);
+    item->setData(1, SORT_ROLE, type.heapIndex);
     item->setText(2, ((type.propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0) ? "Y" : "");
     item->setText(3, ((type.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0) ? "Y" : "");
     item->setText(4, ((type.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0) ? "Y" : "");
@@ -987,109 +2041,282 @@ void MainWindow::populateMemory(const GpuProperties* pGpuProperties)
     for (int c = 0; c < item->columnCount(); ++c) {
       item->setTextAlignment(c, Qt::AlignHCenter);
     }
-    tw->addTopLevelItem(item);
-  }
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
   }
+  memoryTypesUpdater.finish();
+  resizeColumns(tw);
 
   // Memory heaps
   QLocale locale;
   tw = findChild<QTreeWidget*>("memoryHeapsWidget");
   Q_ASSERT(tw);
-  tw->clear();
+  TreeWidgetUpdater memoryHeapsUpdater(tw);
   for (uint32_t i = 0; i < properties.memoryHeapCount; ++i) {
     const auto& heap = properties.memoryHeaps[i];
     QString bytes = locale.toString(static_cast<qulonglong>(heap.size)) + " bytes";
     QString mbytes = locale.toString(heap.size / 1048576.0f) + " MB";
 
-    auto item = new QTreeWidgetItem();
+    auto item = memoryHeapsUpdater.item(nullptr, QString::number(i));
     item->setText(0, QString::number(i));
     //item->setText(1, QString::number(heap.size));
     item->setText(1, mbytes + " (" + bytes +")");
+    item->setData(0, SORT_ROLE, i);
+    item->setData(1, SORT_ROLE, static_cast<double>(heap.size));
     item->setText(2, ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0) ? "Y" : "");
     item->setTextAlignment(0, Qt::AlignHCenter);
     item->setTextAlignment(1, Qt::AlignRight);
     item->setTextAlignment(2, Qt::AlignHCenter);
-    tw->addTopLevelItem(item);
-  }
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
   }
+  memoryHeapsUpdater.finish();
+  resizeColumns(tw);
+
+  populateMemoryBenchmark(pGpuProperties);
+  updateMemoryBudgetMonitor();
 }
 
-QTreeWidgetItem* buildFormatFeatures(QTreeWidgetItem* parentItem, const VkFormatProperties& properties)
-{
-  std::vector<VkFormatFeatureFlagBits> flags = {
-    VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT,
-    VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT,
-    VK_FORMAT_FEATURE_STORAGE_IMAGE_ATOMIC_BIT,
-    VK_FORMAT_FEATURE_UNIFORM_TEXEL_BUFFER_BIT,
-    VK_FORMAT_FEATURE_STORAGE_TEXEL_BUFFER_BIT,
-    VK_FORMAT_FEATURE_STORAGE_TEXEL_BUFFER_ATOMIC_BIT,
-    VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT,
-    VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT,
-    VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT,
-    VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT,
-    VK_FORMAT_FEATURE_BLIT_SRC_BIT,
-    VK_FORMAT_FEATURE_BLIT_DST_BIT,
-    VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT,
-    VK_FORMAT_FEATURE_TRANSFER_SRC_BIT_KHR,
-    VK_FORMAT_FEATURE_TRANSFER_DST_BIT_KHR,
+void MainWindow::populateMemoryBenchmark(const GpuProperties* pGpuProperties)
+{
+  QTreeWidget* tw = findChild<QTreeWidget*>("memoryTypesWidget");
+  Q_ASSERT(tw);
+
+  auto it = mMemoryBenchmarkResults.find(pGpuProperties->physicalDevice);
+  // Each cell is set once, a reused row with the same result doesn't change
+  auto setValue = [](QTreeWidgetItem* item, int column, double value, int precision, const QString& suffix) {
+    item->setText(column, (value >= 0.0) ? (QString::number(value, 'f', precision) + suffix) : QString("n/a"));
+    item->setData(column, SORT_ROLE, (value >= 0.0) ? QVariant(value) : QVariant());
   };
 
-  for (const auto& flag : flags) {
-    QTreeWidgetItem* item = new QTreeWidgetItem();
-    item->setText(0, toStringFormatFeature(flag));
+  TreeSortingBlocker sortingBlocker(tw);
+  for (int i = 0; i < tw->topLevelItemCount(); ++i) {
+    QTreeWidgetItem* item = tw->topLevelItem(i);
+    uint32_t typeIndex = item->data(0, Qt::UserRole).value<uint32_t>();
+    if ((it == mMemoryBenchmarkResults.end()) || (typeIndex >= it->second.size())) {
+      for (int c = 7; c <= 12; ++c) {
+        item->setText(c, "");
+        item->setData(c, SORT_ROLE, QVariant());
+      }
+      continue;
+    }
 
-    item->setText(1, ((properties.linearTilingFeatures & flag) != 0) ? "Y" : "");
-    item->setText(2, ((properties.optimalTilingFeatures & flag) != 0) ? "Y" : "");
-    item->setText(3, ((properties.bufferFeatures & flag) != 0) ? "Y" : "");
+    const MemoryTypeBenchmark& result = it->second[typeIndex];
+    setValue(item, 7, result.writeGBs, 2, "");
+    setValue(item, 8, result.readGBs, 2, "");
+    setValue(item, 9, ((result.writeGBs > 0.0) && (result.readGBs > 0.0)) ? (result.writeGBs / result.readGBs) : -1.0, 1, "x");
+    setValue(item, 10, result.flushUs, 1, "");
+    setValue(item, 11, result.invalidateUs, 1, "");
+    setValue(item, 12, result.copyGBs, 2, "");
+    for (int c = 7; c <= 12; ++c) {
+      item->setTextAlignment(c, Qt::AlignRight);
+    }
+  }
 
-    item->setTextAlignment(1, Qt::AlignHCenter);
-    item->setTextAlignment(2, Qt::AlignHCenter);
-    item->setTextAlignment(3, Qt::AlignHCenter);
+  resizeColumns(tw);
+}
 
-    parentItem->addChild(item);
+void MainWindow::onMemoryBenchmarkBtnClicked()
+{
+  if ((mCurrentGpuProperties == nullptr) || mMemoryBenchmark.isRunning()) {
+    return;
   }
 
-  return nullptr;
+  QPushButton* btn = findChild<QPushButton*>("memoryBenchmarkBtn");
+  QLabel* status = findChild<QLabel*>("memoryBenchmarkStatus");
+  Q_ASSERT(btn && status);
+  btn->setEnabled(false);
+  status->setText("Running...");
+
+  // Own device on a worker thread, the UI stays responsive
+  VkPhysicalDevice gpu = mCurrentGpuProperties->physicalDevice;
+  mMemoryBenchmarkGpu = gpu;
+  mMemoryBenchmarkGeneration = mDeviceGeneration;
+  int gpuIndex = getGpuIndex(mCurrentGpuProperties);
+  std::string gpuName = mCurrentGpuProperties->description;
+  mMemoryBenchmark.setFuture(QtConcurrent::run([gpu, gpuIndex, gpuName]() -> MemoryBenchmarkResults {
+    MemoryScope memoryScope(PAGE_MEMORY, gpuIndex, gpuName);
+    BenchmarkContext context;
+    if (context.create(gpu) != VK_SUCCESS) {
+      return MemoryBenchmarkResults();
+    }
+    return runMemoryBenchmark(context, 64 * 1024 * 1024);
+  }));
 }
 
-void populateImageFormats(
-  VkPhysicalDevice  gpu,
-  QTreeWidget*      tw,
-  VkImageTiling     tiling
-)
+void MainWindow::onMemoryBenchmarkFinished()
 {
-  uint32_t start = static_cast<uint32_t>(VK_FORMAT_BEGIN_RANGE);
-  uint32_t end = static_cast<uint32_t>(VK_FORMAT_END_RANGE);
+  QPushButton* btn = findChild<QPushButton*>("memoryBenchmarkBtn");
+  QLabel* status = findChild<QLabel*>("memoryBenchmarkStatus");
+  Q_ASSERT(btn && status);
+  btn->setEnabled(true);
 
-  tw->clear();
-  for (uint32_t i = start; i <= end; ++i) {
-    VkFormat format = static_cast<VkFormat>(i);
-    VkFormatProperties properties = {};
-    vkGetPhysicalDeviceFormatProperties(gpu, format, &properties);
-    VkFormatFeatureFlags features = static_cast<VkFormatFeatureFlags>(0);
-    if (tiling == VK_IMAGE_TILING_LINEAR) {
-      features = properties.linearTilingFeatures;
-    }
-    else if (tiling == VK_IMAGE_TILING_OPTIMAL) {
-      features = properties.optimalTilingFeatures;
-    }
-    else {
-      features = properties.bufferFeatures;
-    }
+  if (mMemoryBenchmarkGeneration != mDeviceGeneration) {
+    status->setText("Devices changed, run again");
+    return;
+  }
 
-    if (features == 0) {
-      continue;
-    }
+  MemoryBenchmarkResults results = mMemoryBenchmark.result();
+  if (results.empty()) {
+    status->setText("Unable to create a device");
+    return;
+  }
 
-    QTreeWidgetItem* item = new QTreeWidgetItem();
-    item->setData(0, Qt::UserRole, QVariant::fromValue(i));
-    item->setText(0, toStringVkFormat(format));
+  status->setText("Read Penalty is write over read bandwidth");
+  mMemoryBenchmarkResults[mMemoryBenchmarkGpu] = results;
+  if ((mCurrentGpuProperties != nullptr) && (mCurrentGpuProperties->physicalDevice == mMemoryBenchmarkGpu)) {
+    populateMemoryBenchmark(mCurrentGpuProperties);
+  }
+}
 
-    // Populate the buffer usages
+void MainWindow::updateMemoryBudgetMonitor()
+{
+  QCheckBox* enabled = findChild<QCheckBox*>("memoryBudgetEnabled");
+  QSpinBox* rate = findChild<QSpinBox*>("memoryBudgetRate");
+  QLabel* status = findChild<QLabel*>("memoryBudgetStatus");
+  MemoryBudgetPlot* plot = findChild<MemoryBudgetPlot*>("memoryBudgetPlot");
+  Q_ASSERT(enabled && rate && status && plot);
+
+  mMemoryBudgetMonitor.stop();
+  mMemoryBudgetTimer.stop();
+  plot->clear();
+
+  bool supported = (mCurrentGpuProperties != nullptr) && MemoryBudgetMonitor::isSupported(mCurrentGpuProperties->extensionSet);
+  enabled->setEnabled(supported);
+  if (! supported) {
+    status->setText("VK_EXT_memory_budget not supported");
+    return;
+  }
+
+  if (! enabled->isChecked()) {
+    status->setText("-");
+    return;
+  }
+
+  mMemoryBudgetMonitor.start(mCurrentGpuProperties->physicalDevice, static_cast<uint32_t>(rate->value()));
+  mMemoryBudgetTimer.start();
+}
+
+void MainWindow::onMemoryBudgetEnabledToggled(bool checked)
+{
+  (void)checked;
+  updateMemoryBudgetMonitor();
+}
+
+void MainWindow::onMemoryBudgetRateValueChanged(int value)
+{
+  (void)value;
+  if (mMemoryBudgetMonitor.isRunning()) {
+    updateMemoryBudgetMonitor();
+  }
+}
+
+void MainWindow::onMemoryBudgetTimerTimeout()
+{
+  MemoryBudgetPlot* plot = findChild<MemoryBudgetPlot*>("memoryBudgetPlot");
+  QLabel* status = findChild<QLabel*>("memoryBudgetStatus");
+  Q_ASSERT(plot && status);
+
+  mMemoryBudgetSamples.clear();
+  mMemoryBudgetMonitor.drain(&mMemoryBudgetSamples);
+  plot->appendSamples(mMemoryBudgetSamples);
+
+  status->setText(QString("Shared memory: %1, dropped %2")
+    .arg(mMemoryBudgetMonitor.sharedMemoryKey())
+    .arg(mMemoryBudgetMonitor.droppedCount()));
+}
+
+QTreeWidgetItem* buildFormatFeatures(TreeWidgetUpdater& updater, QTreeWidgetItem* parentItem, const VkFormatProperties& properties)
+{
+  for (const auto& flag : getFormatFeatureFlags()) {
+    QTreeWidgetItem* item = updater.item(parentItem, toStringFormatFeature(flag));
+    item->setText(0, toStringFormatFeature(flag));
+
+    item->setText(1, ((properties.linearTilingFeatures & flag) != 0) ? "Y" : "");
+    item->setText(2, ((properties.optimalTilingFeatures & flag) != 0) ? "Y" : "");
+    item->setText(3, ((properties.bufferFeatures & flag) != 0) ? "Y" : "");
+
+    item->setTextAlignment(1, Qt::AlignHCenter);
+    item->setTextAlignment(2, Qt::AlignHCenter);
+    item->setTextAlignment(3, Qt::AlignHCenter);
+  }
+
+  return nullptr;
+}
+
+VkImageType getImageType(QComboBox* cb)
+{
+  VkImageType type = static_cast<VkImageType>(cb->currentIndex());
+  return type;
+}
+
+bool isChecked(QStandardItemModel* model, int row)
+{
+  int n = model->rowCount();
+  Qt::CheckState value = model->item(row)->data(Qt::CheckStateRole).value<Qt::CheckState>();
+  return value == Qt::Checked;
+}
+
+VkImageUsageFlags getUsageFlags(QComboBox* cb)
+{
+  QStandardItemModel* model = qobject_cast<QStandardItemModel*>(cb->model());
+
+  VkImageUsageFlags result = static_cast<VkImageUsageFlags>(0);
+  result |= isChecked(model, 1) ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0;
+  result |= isChecked(model, 2) ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : 0;
+  result |= isChecked(model, 3) ? VK_IMAGE_USAGE_SAMPLED_BIT : 0;
+  result |= isChecked(model, 4) ? VK_IMAGE_USAGE_STORAGE_BIT : 0;
+  result |= isChecked(model, 5) ? VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT : 0;
+  result |= isChecked(model, 6) ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT : 0;
+  result |= isChecked(model, 7) ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : 0;
+  result |= isChecked(model, 8) ? VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT : 0;
+  return result;
+}
+
+VkImageCreateFlags getCreateFlags(QComboBox* cb)
+{
+  QStandardItemModel* model = qobject_cast<QStandardItemModel*>(cb->model());
+
+  VkImageCreateFlags result = static_cast<VkImageCreateFlags>(0);
+  result |= isChecked(model, 1) ? VK_IMAGE_CREATE_SPARSE_BINDING_BIT : 0;
+  result |= isChecked(model, 2) ? VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT : 0;
+  result |= isChecked(model, 3) ? VK_IMAGE_CREATE_SPARSE_ALIASED_BIT : 0;
+  result |= isChecked(model, 4) ? VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT : 0;
+  result |= isChecked(model, 5) ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
+  result |= isChecked(model, 6) ? VK_IMAGE_CREATE_2D_ARRAY_COMPATIBLE_BIT_KHR : 0;
+  return result;
+}
+
+void populateImageFormats(
+  QTreeWidget*                                  tw,
+  VkImageTiling                                 tiling,
+  const std::map<VkFormat, VkFormatProperties>& formatProperties
+)
+{
+  TRACE_SCOPE("qt", "populateImageFormats");
+
+  TreeWidgetUpdater updater(tw);
+  for (const auto& it : formatProperties) {
+    VkFormat format = it.first;
+    uint32_t i = static_cast<uint32_t>(format);
+    const VkFormatProperties& properties = it.second;
+    VkFormatFeatureFlags features = static_cast<VkFormatFeatureFlags>(0);
+    if (tiling == VK_IMAGE_TILING_LINEAR) {
+      features = properties.linearTilingFeatures;
+    }
+    else if (tiling == VK_IMAGE_TILING_OPTIMAL) {
+      features = properties.optimalTilingFeatures;
+    }
+    else {
+      features = properties.bufferFeatures;
+    }
+
+    if (features == 0) {
+      continue;
+    }
+
+    QTreeWidgetItem* item = updater.item(nullptr, toStringVkFormat(format));
+    item->setData(0, Qt::UserRole, QVariant::fromValue(i));
+    item->setData(0, SORT_ROLE, QVariant::fromValue(i));
+    item->setText(0, toStringVkFormat(format));
+
+    // Populate the buffer usages
     if ((tiling != VK_IMAGE_TILING_LINEAR) && (tiling != VK_IMAGE_TILING_OPTIMAL)) {
       item->setText(1, ((features & VK_FORMAT_FEATURE_UNIFORM_TEXEL_BUFFER_BIT) != 0) ? "Y" : "");
       item->setText(2, ((features & VK_FORMAT_FEATURE_STORAGE_TEXEL_BUFFER_BIT) != 0) ? "Y" : "");
@@ -1100,13 +2327,10 @@ void populateImageFormats(
       item->setTextAlignment(3, Qt::AlignHCenter);
       item->setTextAlignment(4, Qt::AlignHCenter);
     }
-
-    tw->addTopLevelItem(item);
   }
+  updater.finish();
 
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
-  }
+  resizeColumns(tw);
 }
 
 void updateImageFormats(
@@ -1118,22 +2342,26 @@ void updateImageFormats(
     VkImageCreateFlags  createFlags
 )
 {
+  TRACE_SCOPE("qt", "updateImageFormats");
+
   QLocale locale;
 
+  // Rows would move under the index while sorting on an updated column
+  TreeSortingBlocker sortingBlocker(tw);
+
   int n = tw->topLevelItemCount();
   for (int i = 0; i < n; ++i) {
     auto item = tw->topLevelItem(i);
-    item->setText(1, "");
-    item->setText(2, "");
-    item->setText(3, "");
-    item->setText(4, "");
-    item->setText(5, "");
-
     VkFormat format = static_cast<VkFormat>(item->data(0, Qt::UserRole).value<uint32_t>());
     VkImageFormatProperties imageFormatProperties = {};
-    VkResult res = vkGetPhysicalDeviceImageFormatProperties(gpu, format,
+    VkResult res = VK_CALL(gpu, vkGetPhysicalDeviceImageFormatProperties, gpu, format,
         type, tiling, usageFlags, createFlags, &imageFormatProperties);
+    // Cleared only here, rewriting an unchanged cell of a reused row costs nothing
     if (res != VK_SUCCESS) {
+      for (int c = 1; c <= 5; ++c) {
+        item->setText(c, "");
+        item->setData(c, SORT_ROLE, QVariant());
+      }
       continue;
     }
 
@@ -1150,6 +2378,13 @@ void updateImageFormats(
     item->setText(4, toStringSampleCounts(imageFormatProperties.sampleCounts));
     item->setText(5, gbytes + " (" + bytes + ")");
 
+    item->setData(1, SORT_ROLE, static_cast<double>(imageFormatProperties.maxExtent.width) *
+                                imageFormatProperties.maxExtent.height * imageFormatProperties.maxExtent.depth);
+    item->setData(2, SORT_ROLE, imageFormatProperties.maxMipLevels);
+    item->setData(3, SORT_ROLE, imageFormatProperties.maxArrayLayers);
+    item->setData(4, SORT_ROLE, imageFormatProperties.sampleCounts);
+    item->setData(5, SORT_ROLE, static_cast<double>(imageFormatProperties.maxResourceSize));
+
     item->setTextAlignment(1, Qt::AlignHCenter);
     item->setTextAlignment(2, Qt::AlignHCenter);
     item->setTextAlignment(3, Qt::AlignHCenter);
@@ -1157,63 +2392,417 @@ void updateImageFormats(
     item->setTextAlignment(5, Qt::AlignRight);
   }
 
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
-  }
+  resizeColumns(tw);
 }
 
 void MainWindow::populateFormats(const GpuProperties* pGpuProperties)
 {
+  TRACE_SCOPE("qt", "populateFormats");
+
   VkPhysicalDevice gpu = pGpuProperties->physicalDevice;
 
-  uint32_t start = static_cast<uint32_t>(VK_FORMAT_BEGIN_RANGE);
-  uint32_t end = static_cast<uint32_t>(VK_FORMAT_END_RANGE);
+  // Queried once for all four trees, core plus the extension ranges the device has
+  std::map<VkFormat, VkFormatProperties> formatProperties;
+  for (VkFormat format : getSupportedFormats(pGpuProperties->deviceProperties.apiVersion, pGpuProperties->extensionSet)) {
+    VK_CALL(gpu, vkGetPhysicalDeviceFormatProperties, gpu, format, &formatProperties[format]);
+  }
 
-  // Initial values
-  VkImageType imageType = VK_IMAGE_TYPE_2D;
-  VkImageUsageFlags usageFlags = static_cast<VkImageUsageFlags>(0);
-  VkImageCreateFlags createFlags = static_cast<VkImageCreateFlags>(0);
+  // Matrix
+  FormatMatrixWidget* matrix = findChild<FormatMatrixWidget*>("formatMatrix");
+  QLabel* matrixStatus = findChild<QLabel*>("formatMatrixStatus");
+  Q_ASSERT(matrix && matrixStatus);
+  matrix->setFormats(formatProperties);
+  matrixStatus->setText(QString("%1 formats x %2 features").arg(formatProperties.size()).arg(3 * getFormatFeatureFlags().size()));
 
   QTreeWidget* tw = findChild<QTreeWidget*>("formatsWidget");
-  Q_ASSERT(tw);
-  tw->clear();
-  for (uint32_t i = start; i <= end; ++i) {
-    VkFormat format = static_cast<VkFormat>(i);
-    VkFormatProperties properties = {};
-    vkGetPhysicalDeviceFormatProperties(gpu, format, &properties);
-
-    QTreeWidgetItem* item = new QTreeWidgetItem();
+  QLineEdit* filter = findChild<QLineEdit*>("formatFilter");
+  Q_ASSERT(tw && filter);
+  TreeWidgetUpdater formatsUpdater(tw);
+  for (const auto& it : formatProperties) {
+    VkFormat format = it.first;
+    uint32_t i = static_cast<uint32_t>(format);
+    const VkFormatProperties& properties = it.second;
+
+    QTreeWidgetItem* item = formatsUpdater.item(nullptr, toStringVkFormat(format));
     item->setData(0, Qt::UserRole, QVariant::fromValue(i));
+    item->setData(0, SORT_ROLE, QVariant::fromValue(i));
     item->setText(0, toStringVkFormat(format));
     item->setText(1, (properties.linearTilingFeatures != 0) ? "Y" : "");
     item->setText(2, (properties.optimalTilingFeatures != 0) ? "Y" : "");
     item->setText(3, (properties.bufferFeatures != 0) ? "Y" : "");
-    buildFormatFeatures(item, properties);
+    buildFormatFeatures(formatsUpdater, item, properties);
     for (int c = 1; c < item->columnCount(); ++c) {
       item->setTextAlignment(c, Qt::AlignHCenter);
     }
-    tw->addTopLevelItem(item);
   }
-  for (int i = 0; i < tw->columnCount(); ++i) {
-    tw->resizeColumnToContents(i);
+  formatsUpdater.finish();
+  resizeColumns(tw);
+  onFormatFilterTextChanged(filter->text());
+
+  // Tiling, queried for what the filters above each tree are set to
+  for (FilterInputs* inputs : { &mTilingLinearFilterInputs, &mTilingOptimalFilterInputs }) {
+    tw = inputs->target;
+    Q_ASSERT(tw);
+    populateImageFormats(tw, inputs->tiling, formatProperties);
+    updateImageFormats(gpu, tw, getImageType(inputs->imageTypeFilter), inputs->tiling,
+                       getUsageFlags(inputs->usageFlagsFilter), getCreateFlags(inputs->createFlagsFilter));
+    filterTreeWidgetItemsSimple(tw->objectName(), inputs->formatFilter->text().trimmed());
   }
+  populateFormatBenchmark(pGpuProperties);
 
-  // Tiling Linear
-  tw = findChild<QTreeWidget*>("tilingLinearFormatsWidget");
+  // Buffer
+  tw = findChild<QTreeWidget*>("bufferFormatsWidget");
+  filter = findChild<QLineEdit*>("bufferFormatFilter");
+  Q_ASSERT(tw && filter);
+  populateImageFormats(tw, static_cast<VkImageTiling>(UINT32_MAX), formatProperties);
+  filterTreeWidgetItemsSimple("bufferFormatsWidget", filter->text().trimmed());
+}
+
+void MainWindow::populateFormatBenchmark(const GpuProperties* pGpuProperties)
+{
+  QTreeWidget* tw = findChild<QTreeWidget*>("tilingOptimalFormatsWidget");
   Q_ASSERT(tw);
-  populateImageFormats(gpu, tw, VK_IMAGE_TILING_LINEAR);
-  updateImageFormats(gpu, tw, imageType, VK_IMAGE_TILING_LINEAR, usageFlags, createFlags);
 
-  // Tiling Optimal
-  tw = findChild<QTreeWidget*>("tilingOptimalFormatsWidget");
+  auto it = mFormatBenchmarkResults.find(pGpuProperties->physicalDevice);
+  TreeSortingBlocker sortingBlocker(tw);
+
+  for (int i = 0; i < tw->topLevelItemCount(); ++i) {
+    QTreeWidgetItem* item = tw->topLevelItem(i);
+    VkFormat format = static_cast<VkFormat>(item->data(0, Qt::UserRole).value<uint32_t>());
+    const FormatBenchmark* pResult = nullptr;
+    if (it != mFormatBenchmarkResults.end()) {
+      auto result = it->second.find(format);
+      pResult = (result != it->second.end()) ? &result->second : nullptr;
+    }
+
+    // Each cell is set once, a reused row with the same result doesn't change
+    const double values[] = {
+      (pResult != nullptr) ? pResult->uploadGBs : 0.0,
+      (pResult != nullptr) ? pResult->copyGBs : 0.0,
+      (pResult != nullptr) ? pResult->blitGBs : 0.0,
+      (pResult != nullptr) ? pResult->clearGBs : 0.0
+    };
+    for (int c = 6; c <= 9; ++c) {
+      double value = values[c - 6];
+      if (pResult == nullptr) {
+        item->setText(c, "");
+        item->setData(c, SORT_ROLE, QVariant());
+        continue;
+      }
+      item->setText(c, (value >= 0.0) ? QString::number(value, 'f', 2) : QString("n/a"));
+      item->setData(c, SORT_ROLE, (value >= 0.0) ? QVariant(value) : QVariant());
+      item->setTextAlignment(c, Qt::AlignRight);
+    }
+  }
+
+  resizeColumns(tw);
+}
+
+void MainWindow::onTilingOptimalBenchmarkBtnClicked()
+{
+  if ((mCurrentGpuProperties == nullptr) || mFormatBenchmark.isRunning()) {
+    return;
+  }
+
+  // Only the formats that pass the current type, usage and name filters
+  QTreeWidget* tw = findChild<QTreeWidget*>("tilingOptimalFormatsWidget");
   Q_ASSERT(tw);
-  populateImageFormats(gpu, tw, VK_IMAGE_TILING_OPTIMAL);
-  updateImageFormats(gpu, tw, imageType, VK_IMAGE_TILING_OPTIMAL, usageFlags, createFlags);
+  std::vector<VkFormat> formats;
+  for (int i = 0; i < tw->topLevelItemCount(); ++i) {
+    QTreeWidgetItem* item = tw->topLevelItem(i);
+    if (item->isHidden() || item->text(1).isEmpty()) {
+      continue;
+    }
+    formats.push_back(static_cast<VkFormat>(item->data(0, Qt::UserRole).value<uint32_t>()));
+  }
 
-  // Buffer
-  tw = findChild<QTreeWidget*>("bufferFormatsWidget");
+  QPushButton* btn = findChild<QPushButton*>("tilingOptimalBenchmarkBtn");
+  QLabel* status = findChild<QLabel*>("tilingOptimalBenchmarkStatus");
+  Q_ASSERT(btn && status);
+  if (formats.empty()) {
+    status->setText("No formats pass the current filter");
+    return;
+  }
+  btn->setEnabled(false);
+  status->setText(QString("Running %1 formats...").arg(formats.size()));
+
+  VkPhysicalDevice gpu = mCurrentGpuProperties->physicalDevice;
+  mFormatBenchmarkGpu = gpu;
+  mFormatBenchmarkGeneration = mDeviceGeneration;
+  int gpuIndex = getGpuIndex(mCurrentGpuProperties);
+  std::string gpuName = mCurrentGpuProperties->description;
+  mFormatBenchmark.setFuture(QtConcurrent::run([gpu, gpuIndex, gpuName, formats]() -> FormatBenchmarkResults {
+    MemoryScope memoryScope(PAGE_FORMATS, gpuIndex, gpuName);
+    BenchmarkContext context;
+    if (context.create(gpu) != VK_SUCCESS) {
+      return FormatBenchmarkResults();
+    }
+    return runFormatBenchmark(context, formats);
+  }));
+}
+
+void MainWindow::onFormatBenchmarkFinished()
+{
+  QPushButton* btn = findChild<QPushButton*>("tilingOptimalBenchmarkBtn");
+  QLabel* status = findChild<QLabel*>("tilingOptimalBenchmarkStatus");
+  Q_ASSERT(btn && status);
+  btn->setEnabled(true);
+
+  if (mFormatBenchmarkGeneration != mDeviceGeneration) {
+    status->setText("Devices changed, run again");
+    return;
+  }
+
+  FormatBenchmarkResults results = mFormatBenchmark.result();
+  if (results.empty()) {
+    status->setText("Unable to create a device");
+    return;
+  }
+
+  // Merge so several filtered runs add up
+  status->setText("2D images up to 1024x1024 in GENERAL layout; compressed and multi-planar formats are skipped");
+  auto& stored = mFormatBenchmarkResults[mFormatBenchmarkGpu];
+  for (const auto& result : results) {
+    stored[result.first] = result.second;
+  }
+  if ((mCurrentGpuProperties != nullptr) && (mCurrentGpuProperties->physicalDevice == mFormatBenchmarkGpu)) {
+    populateFormatBenchmark(mCurrentGpuProperties);
+  }
+}
+
+void MainWindow::populateDeviceGroups()
+{
+  TRACE_SCOPE("qt", "populateDeviceGroups");
+
+  QTreeWidget* tw = findChild<QTreeWidget*>("deviceGroupsWidget");
+  Q_ASSERT(tw);
+  {
+    TreeSortingBlocker sortingBlocker(tw);
+    tw->clear();
+    if (mDeviceGroups.empty()) {
+      QTreeWidgetItem* item = new SortableTreeWidgetItem();
+      item->setText(0, "No groups, needs Vulkan 1.1 or VK_KHR_device_group_creation");
+      tw->addTopLevelItem(item);
+    }
+    for (size_t i = 0; i < mDeviceGroups.size(); ++i) {
+      const DeviceGroup& group = mDeviceGroups[i];
+      QTreeWidgetItem* parent = new SortableTreeWidgetItem();
+      parent->setText(0, QString("Group %1").arg(i));
+      parent->setText(1, QString::number(group.physicalDevices.size()));
+      parent->setText(2, (group.subsetAllocation == VK_TRUE) ? "Y" : "");
+      parent->setText(3, toStringVersion(group.apiVersion));
+      parent->setText(4, " ");
+      for (int c = 1; c <= 3; ++c) {
+        parent->setTextAlignment(c, Qt::AlignHCenter);
+      }
+      tw->addTopLevelItem(parent);
+
+      for (size_t j = 0; j < group.physicalDevices.size(); ++j) {
+        QTreeWidgetItem* item = new SortableTreeWidgetItem();
+        item->setText(0, QString("%1: %2").arg(j).arg(getGpuName(group.physicalDevices[j])));
+        item->setText(4, " ");
+        parent->addChild(item);
+      }
+      parent->setExpanded(true);
+    }
+  }
+  resizeColumns(tw);
+
+  // Each group with peers needs its own logical device for the query
+  bool queryPeerMemory = std::any_of(std::begin(mDeviceGroups), std::end(mDeviceGroups),
+    [](const DeviceGroup& group) -> bool { return (group.peerMemoryResult == VK_NOT_READY); });
+  if (queryPeerMemory && (! mPeerMemoryQuery.isRunning())) {
+    std::vector<DeviceGroup> groups = mDeviceGroups;
+    mPeerMemoryQueryGeneration = mDeviceGeneration;
+    mPeerMemoryQuery.setFuture(QtConcurrent::run([groups]() -> std::vector<DeviceGroup> {
+      MemoryScope memoryScope(PAGE_DEVICE_GROUPS, MemoryAccounting::NO_GPU, "");
+      std::vector<DeviceGroup> results = groups;
+      for (auto& group : results) {
+        if (group.peerMemoryResult == VK_NOT_READY) {
+          queryPeerMemoryFeatures(&group);
+        }
+      }
+      return results;
+    }));
+  }
+
+  tw = findChild<QTreeWidget*>("peerMemoryWidget");
   Q_ASSERT(tw);
-  populateImageFormats(gpu, tw, static_cast<VkImageTiling>(UINT32_MAX));
+  {
+    TreeSortingBlocker sortingBlocker(tw);
+    tw->clear();
+    QLocale locale;
+    for (size_t i = 0; i < mDeviceGroups.size(); ++i) {
+      const DeviceGroup& group = mDeviceGroups[i];
+      uint32_t deviceCount = static_cast<uint32_t>(group.physicalDevices.size());
+      QTreeWidgetItem* parent = new SortableTreeWidgetItem();
+      parent->setText(0, QString("Group %1").arg(i));
+      parent->setText(6, " ");
+      tw->addTopLevelItem(parent);
+      if (deviceCount < 2) {
+        parent->setText(0, QString("Group %1: one device, no peers").arg(i));
+        continue;
+      }
+      if (group.peerMemoryResult == VK_NOT_READY) {
+        parent->setText(0, QString("Group %1: querying...").arg(i));
+        continue;
+      }
+      // Enumerating groups only needs VK_KHR_device_group_creation, the query needs a 1.1 device
+      if (group.apiVersion < VK_API_VERSION_1_1) {
+        parent->setText(0, QString("Group %1: peer memory needs Vulkan 1.1").arg(i));
+        continue;
+      }
+      if (group.peerMemoryResult != VK_SUCCESS) {
+        parent->setText(0, QString("Group %1: unable to create a device (%2)").arg(i).arg(static_cast<int>(group.peerMemoryResult)));
+        continue;
+      }
+
+      // A copy within one device is only listed once it has been measured
+      const std::vector<PeerCopyBenchmark>* pBenchmark = (i < mPeerCopyBenchmarkResults.size()) ? &mPeerCopyBenchmarkResults[i] : nullptr;
+      auto getCopyGBs = [pBenchmark](uint32_t heapIndex, uint32_t local, uint32_t remote) -> double {
+        if (pBenchmark != nullptr) {
+          for (const auto& result : *pBenchmark) {
+            if ((result.heapIndex == heapIndex) && (result.localDeviceIndex == local) && (result.remoteDeviceIndex == remote)) {
+              return result.copyGBs;
+            }
+          }
+        }
+        return -1.0;
+      };
+
+      VkPhysicalDeviceMemoryProperties memoryProperties = {};
+      VK_CALL(group.physicalDevices[0], vkGetPhysicalDeviceMemoryProperties, group.physicalDevices[0], &memoryProperties);
+      for (uint32_t heapIndex = 0; heapIndex < memoryProperties.memoryHeapCount; ++heapIndex) {
+        const VkMemoryHeap& heap = memoryProperties.memoryHeaps[heapIndex];
+        QStringList flags;
+        if ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0) {
+          flags << "device local";
+        }
+        if ((heap.flags & VK_MEMORY_HEAP_MULTI_INSTANCE_BIT) != 0) {
+          flags << "multi-instance";
+        }
+        QString text = QString("Heap %1 (%2 MB").arg(heapIndex).arg(locale.toString(heap.size / 1048576.0f));
+        text += flags.isEmpty() ? QString(")") : (", " + flags.join(", ") + ")");
+
+        QTreeWidgetItem* heapItem = new SortableTreeWidgetItem();
+        heapItem->setText(0, text);
+        heapItem->setText(6, " ");
+        parent->addChild(heapItem);
+
+        for (uint32_t local = 0; local < deviceCount; ++local) {
+          for (uint32_t remote = 0; remote < deviceCount; ++remote) {
+            double copyGBs = getCopyGBs(heapIndex, local, remote);
+            if ((local == remote) && (copyGBs < 0.0)) {
+              continue;
+            }
+
+            QTreeWidgetItem* item = new SortableTreeWidgetItem();
+            item->setText(0, (local == remote) ? QString("%1 -> %1 (same device)").arg(local) : QString("%1 -> %2").arg(local).arg(remote));
+            for (const auto& entry : group.peerMemory) {
+              if ((entry.heapIndex != heapIndex) || (entry.localDeviceIndex != local) || (entry.remoteDeviceIndex != remote)) {
+                continue;
+              }
+              item->setText(1, ((entry.features & VK_PEER_MEMORY_FEATURE_COPY_SRC_BIT) != 0) ? "Y" : "");
+              item->setText(2, ((entry.features & VK_PEER_MEMORY_FEATURE_COPY_DST_BIT) != 0) ? "Y" : "");
+              item->setText(3, ((entry.features & VK_PEER_MEMORY_FEATURE_GENERIC_SRC_BIT) != 0) ? "Y" : "");
+              item->setText(4, ((entry.features & VK_PEER_MEMORY_FEATURE_GENERIC_DST_BIT) != 0) ? "Y" : "");
+            }
+            if (copyGBs >= 0.0) {
+              item->setText(5, QString::number(copyGBs, 'f', 2));
+              item->setData(5, SORT_ROLE, copyGBs);
+            }
+            item->setText(6, " ");
+            for (int c = 1; c <= 4; ++c) {
+              item->setTextAlignment(c, Qt::AlignHCenter);
+            }
+            item->setTextAlignment(5, Qt::AlignRight);
+            heapItem->addChild(item);
+          }
+        }
+        heapItem->setExpanded(true);
+      }
+      parent->setExpanded(true);
+    }
+  }
+  resizeColumns(tw);
+}
+
+void MainWindow::onPeerCopyBenchmarkBtnClicked()
+{
+  if (mPeerCopyBenchmark.isRunning()) {
+    return;
+  }
+
+  QPushButton* btn = findChild<QPushButton*>("peerCopyBenchmarkBtn");
+  QLabel* status = findChild<QLabel*>("peerCopyBenchmarkStatus");
+  Q_ASSERT(btn && status);
+
+  std::vector<DeviceGroup> groups = mDeviceGroups;
+  bool hasPeers = std::any_of(std::begin(groups), std::end(groups),
+    [](const DeviceGroup& group) -> bool { return (group.physicalDevices.size() >= 2); });
+  if (! hasPeers) {
+    status->setText("No group has more than one device");
+    return;
+  }
+  bool hasPeerMemory = std::any_of(std::begin(groups), std::end(groups),
+    [](const DeviceGroup& group) -> bool { return (group.physicalDevices.size() >= 2) && (group.apiVersion >= VK_API_VERSION_1_1); });
+  if (! hasPeerMemory) {
+    status->setText("Peer memory needs Vulkan 1.1");
+    return;
+  }
+  btn->setEnabled(false);
+  status->setText("Running...");
+
+  mPeerCopyBenchmarkGeneration = mDeviceGeneration;
+  mPeerCopyBenchmark.setFuture(QtConcurrent::run([groups]() -> PeerCopyBenchmarkResults {
+    MemoryScope memoryScope(PAGE_DEVICE_GROUPS, MemoryAccounting::NO_GPU, "");
+    PeerCopyBenchmarkResults results(groups.size());
+    for (size_t i = 0; i < groups.size(); ++i) {
+      if ((groups[i].physicalDevices.size() >= 2) && (groups[i].apiVersion >= VK_API_VERSION_1_1)) {
+        results[i] = runPeerCopyBenchmark(groups[i], 64 * 1024 * 1024);
+      }
+    }
+    return results;
+  }));
+}
+
+void MainWindow::onPeerCopyBenchmarkFinished()
+{
+  QPushButton* btn = findChild<QPushButton*>("peerCopyBenchmarkBtn");
+  QLabel* status = findChild<QLabel*>("peerCopyBenchmarkStatus");
+  Q_ASSERT(btn && status);
+  btn->setEnabled(true);
+
+  if (mPeerCopyBenchmarkGeneration != mDeviceGeneration) {
+    status->setText("Devices changed, run again");
+    return;
+  }
+
+  PeerCopyBenchmarkResults results = mPeerCopyBenchmark.result();
+  bool measured = std::any_of(std::begin(results), std::end(results),
+    [](const std::vector<PeerCopyBenchmark>& groupResults) -> bool { return (! groupResults.empty()); });
+  if (! measured) {
+    status->setText("Unable to create a device, or no multi-instance device local heap");
+    return;
+  }
+
+  status->setText("64 MiB vkCmdCopyBuffer on the local device into the remote device's instance, host timed");
+  mPeerCopyBenchmarkResults = results;
+  if (isPageBuilt(PAGE_DEVICE_GROUPS)) {
+    populateDeviceGroups();
+  }
+}
+
+void MainWindow::onPeerMemoryQueryFinished()
+{
+  // Groups from before a device change hold handles of the old instance,
+  // the populate below queries the current ones instead
+  if (mPeerMemoryQueryGeneration == mDeviceGeneration) {
+    mDeviceGroups = mPeerMemoryQuery.result();
+  }
+  if (isPageBuilt(PAGE_DEVICE_GROUPS)) {
+    populateDeviceGroups();
+  }
 }
 
 void MainWindow::on_gpus_currentIndexChanged(int index)
@@ -1225,20 +2814,21 @@ void MainWindow::on_gpus_currentIndexChanged(int index)
 
   void* pUserData = cb->itemData(index).value<void*>();
   mCurrentGpuProperties = static_cast<const GpuProperties*>(pUserData);
+  if (mCurrentGpuProperties == nullptr) {
+    return;
+  }
 
-  populateGeneral(mCurrentGpuProperties);
-  populateDeviceExtensions(mCurrentGpuProperties);
-  populateLimits(mCurrentGpuProperties);
-  populateSparse(mCurrentGpuProperties);
-  populateFeatures(mCurrentGpuProperties);
-  populateSurface(mCurrentGpuProperties);
-  populateQueues(mCurrentGpuProperties);
-  populateMemory(mCurrentGpuProperties);
-  populateFormats(mCurrentGpuProperties);
+  for (const auto& form : sPageForms) {
+    if (isPageBuilt(form.name)) {
+      populateDevicePage(form.name, mCurrentGpuProperties);
+    }
+  }
 }
 
 void MainWindow::filterTreeWidgetItemsSimple(const QString &widgetName, const QString &filterText)
 {
+  TRACE_SCOPE("qt", "filter " + widgetName.toStdString());
+
   QTreeWidget* tw = findChild<QTreeWidget*>(widgetName);
   Q_ASSERT(tw);
 
@@ -1274,23 +2864,27 @@ void MainWindow::filterTreeWidgetItemsSimple(const QString &widgetName, const QS
 
 void MainWindow::resizeEvent(QResizeEvent *event)
 {
-  if (mInstance == VK_NULL_HANDLE) {
+  if ((mInstance == VK_NULL_HANDLE) || (mCurrentGpuProperties == nullptr)) {
     return;
   }
 
   destroyVulkanSurface();
   createVulkanSurface();
 
-  updateSurfaceExtents(mCurrentGpuProperties);
+  if (isPageBuilt(PAGE_SURFACE)) {
+    updateSurfaceExtents(mCurrentGpuProperties);
+  }
 }
 
-void MainWindow::on_limitsFilter_textChanged(const QString &arg1)
+void MainWindow::onLimitsFilterTextChanged(const QString &arg1)
 {
   filterTreeWidgetItemsSimple("limitsWidget", arg1.trimmed());
 }
 
-void MainWindow::on_formatFilter_textChanged(const QString &arg1)
+void MainWindow::onFormatFilterTextChanged(const QString &arg1)
 {
+  TRACE_SCOPE("qt", "filter formatsWidget");
+
   QTreeWidget* tw = findChild<QTreeWidget*>("formatsWidget");
   Q_ASSERT(tw);
 
@@ -1315,55 +2909,12 @@ void MainWindow::on_formatFilter_textChanged(const QString &arg1)
   }
 }
 
-void MainWindow::on_featuresFilter_textChanged(const QString &arg1)
+void MainWindow::onFeaturesFilterTextChanged(const QString &arg1)
 {
   filterTreeWidgetItemsSimple("featuresWidget", arg1.trimmed());
 }
 
-VkImageType getImageType(QComboBox* cb)
-{
-  VkImageType type = static_cast<VkImageType>(cb->currentIndex());
-  return type;
-}
-
-bool isChecked(QStandardItemModel* model, int row)
-{
-  int n = model->rowCount();
-  Qt::CheckState value = model->item(row)->data(Qt::CheckStateRole).value<Qt::CheckState>();
-  return value == Qt::Checked;
-}
-
-VkImageUsageFlags getUsageFlags(QComboBox* cb)
-{
-  QStandardItemModel* model = qobject_cast<QStandardItemModel*>(cb->model());
-
-  VkImageUsageFlags result = static_cast<VkImageUsageFlags>(0);
-  result |= isChecked(model, 1) ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0;
-  result |= isChecked(model, 2) ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : 0;
-  result |= isChecked(model, 3) ? VK_IMAGE_USAGE_SAMPLED_BIT : 0;
-  result |= isChecked(model, 4) ? VK_IMAGE_USAGE_STORAGE_BIT : 0;
-  result |= isChecked(model, 5) ? VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT : 0;
-  result |= isChecked(model, 6) ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT : 0;
-  result |= isChecked(model, 7) ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : 0;
-  result |= isChecked(model, 8) ? VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT : 0;
-  return result;
-}
-
-VkImageCreateFlags getCreateFlags(QComboBox* cb)
-{
-  QStandardItemModel* model = qobject_cast<QStandardItemModel*>(cb->model());
-
-  VkImageCreateFlags result = static_cast<VkImageCreateFlags>(0);
-  result |= isChecked(model, 1) ? VK_IMAGE_CREATE_SPARSE_BINDING_BIT : 0;
-  result |= isChecked(model, 2) ? VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT : 0;
-  result |= isChecked(model, 3) ? VK_IMAGE_CREATE_SPARSE_ALIASED_BIT : 0;
-  result |= isChecked(model, 4) ? VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT : 0;
-  result |= isChecked(model, 5) ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
-  result |= isChecked(model, 6) ? VK_IMAGE_CREATE_2D_ARRAY_COMPATIBLE_BIT_KHR : 0;
-  return result;
-}
-
-void MainWindow::on_itemChanged(QStandardItem *item)
+void MainWindow::onItemChanged(QStandardItem *item)
 {
   auto& inputs = mFilterInputTargets[item->model()];
   auto& tw = inputs->target;
@@ -1374,7 +2925,7 @@ void MainWindow::on_itemChanged(QStandardItem *item)
   updateImageFormats(mCurrentGpuProperties->physicalDevice, tw, type, tiling, usageFlags, createFlags);
 }
 
-void MainWindow::on_tilingLinearImageType_currentIndexChanged(int index)
+void MainWindow::onTilingLinearImageTypeCurrentIndexChanged(int index)
 {
   auto inputs = &mTilingLinearFilterInputs;
   auto& tw = inputs->target;
@@ -1385,7 +2936,7 @@ void MainWindow::on_tilingLinearImageType_currentIndexChanged(int index)
   updateImageFormats(mCurrentGpuProperties->physicalDevice, tw, type, tiling, usageFlags, createFlags);
 }
 
-void MainWindow::on_tilingOptimalImageType_currentIndexChanged(int index)
+void MainWindow::onTilingOptimalImageTypeCurrentIndexChanged(int index)
 {
   auto inputs = &mTilingOptimalFilterInputs;
   auto& tw = inputs->target;
@@ -1396,22 +2947,34 @@ void MainWindow::on_tilingOptimalImageType_currentIndexChanged(int index)
   updateImageFormats(mCurrentGpuProperties->physicalDevice, tw, type, tiling, usageFlags, createFlags);
 }
 
-void MainWindow::on_tilingLinearFormatFilter_textChanged(const QString &arg1)
+void MainWindow::onTilingLinearFormatFilterTextChanged(const QString &arg1)
 {
   filterTreeWidgetItemsSimple("tilingLinearFormatsWidget", arg1.trimmed());
 }
 
-void MainWindow::on_tilingOptimalFormatFilter_textChanged(const QString &arg1)
+void MainWindow::onTilingOptimalFormatFilterTextChanged(const QString &arg1)
 {
   filterTreeWidgetItemsSimple("tilingOptimalFormatsWidget", arg1.trimmed());
 }
 
-void MainWindow::on_bufferFormatFilter_textChanged(const QString &arg1)
+void MainWindow::onFormatMatrixFilterTextChanged(const QString &arg1)
+{
+  FormatMatrixWidget* matrix = findChild<FormatMatrixWidget*>("formatMatrix");
+  Q_ASSERT(matrix);
+  matrix->setFilter(arg1.trimmed());
+}
+
+void MainWindow::onSparseImageFormatFilterTextChanged(const QString &arg1)
+{
+  filterTreeWidgetItemsSimple("sparseImageFormatsWidget", arg1.trimmed());
+}
+
+void MainWindow::onBufferFormatFilterTextChanged(const QString &arg1)
 {
   filterTreeWidgetItemsSimple("bufferFormatsWidget", arg1.trimmed());
 }
 
-void MainWindow::on_expandAllBtn_clicked()
+void MainWindow::onExpandAllBtnClicked()
 {
   QTreeWidget* tw = findChild<QTreeWidget*>("formatsWidget");
   Q_ASSERT(tw);
@@ -1420,7 +2983,7 @@ void MainWindow::on_expandAllBtn_clicked()
   }
 }
 
-void MainWindow::on_collapseAllBtn_clicked()
+void MainWindow::onCollapseAllBtnClicked()
 {
   QTreeWidget* tw = findChild<QTreeWidget*>("formatsWidget");
   Q_ASSERT(tw);
@@ -1428,3 +2991,511 @@ void MainWindow::on_collapseAllBtn_clicked()
     tw->topLevelItem(i)->setExpanded(false);
   }
 }
+
+void MainWindow::on_tabWidget_currentChanged(int index)
+{
+  QTabWidget* tabs = findChild<QTabWidget*>("tabWidget");
+  Q_ASSERT(tabs);
+  QWidget* page = tabs->widget(index);
+  // A page built just now was populated with everything it shows
+  if (! buildPage(page)) {
+    if (page->objectName() == PAGE_PROFILER) {
+      populateProfiler();
+    }
+    else if (page->objectName() == PAGE_DIAGNOSTICS) {
+      populateDiagnostics();
+    }
+  }
+
+  if (page->objectName() == PAGE_DIAGNOSTICS) {
+    mDiagnosticsTimer.start();
+  }
+  else {
+    mDiagnosticsTimer.stop();
+  }
+}
+
+QString MainWindow::getGpuName(VkPhysicalDevice gpu) const
+{
+  if (gpu == VK_NULL_HANDLE) {
+    return "Instance";
+  }
+
+  for (const auto& gpuProperties : mGpuProperties) {
+    if (gpuProperties.physicalDevice == gpu) {
+      return QString::fromStdString(gpuProperties.description);
+    }
+  }
+  return "Unknown";
+}
+
+QString toStringHistogram(const VkProfiler::Stats& stats)
+{
+  // Non-empty buckets as log2(ns):count
+  QString result;
+  for (size_t i = 0; i < stats.histogram.size(); ++i) {
+    if (stats.histogram[i] == 0) {
+      continue;
+    }
+    result += result.isEmpty() ? "" : "  ";
+    result += QString::number(i) + ":" + QString::number(stats.histogram[i]);
+  }
+  return result;
+}
+
+void MainWindow::populateProfiler()
+{
+  QTreeWidget* tw = findChild<QTreeWidget*>("profilerWidget");
+  Q_ASSERT(tw);
+
+  TreeSortingBlocker sortingBlocker(tw);
+  tw->clear();
+
+  QLocale locale;
+
+  VkProfiler::StatsMap statsMap = VkProfiler::get().snapshot();
+  for (const auto& it : statsMap) {
+    const auto& stats = it.second;
+
+    QTreeWidgetItem* item = new SortableTreeWidgetItem();
+    item->setText(0, QString::fromStdString(it.first.first));
+    item->setText(1, getGpuName(it.first.second));
+    item->setText(2, locale.toString(static_cast<qulonglong>(stats.count)));
+    item->setText(3, locale.toString(stats.totalNs / 1000000.0, 'f', 3));
+    item->setText(4, locale.toString(stats.totalNs / (1000.0 * stats.count), 'f', 2));
+    item->setText(5, locale.toString(stats.minNs / 1000.0, 'f', 2));
+    item->setText(6, locale.toString(stats.maxNs / 1000.0, 'f', 2));
+    item->setText(7, locale.toString(stats.percentileNs(0.50) / 1000.0, 'f', 2));
+    item->setText(8, locale.toString(stats.percentileNs(0.95) / 1000.0, 'f', 2));
+    item->setText(9, toStringHistogram(stats));
+    item->setData(2, SORT_ROLE, static_cast<double>(stats.count));
+    item->setData(3, SORT_ROLE, static_cast<double>(stats.totalNs));
+    item->setData(4, SORT_ROLE, stats.totalNs / static_cast<double>(stats.count));
+    item->setData(5, SORT_ROLE, static_cast<double>(stats.minNs));
+    item->setData(6, SORT_ROLE, static_cast<double>(stats.maxNs));
+    item->setData(7, SORT_ROLE, static_cast<double>(stats.percentileNs(0.50)));
+    item->setData(8, SORT_ROLE, static_cast<double>(stats.percentileNs(0.95)));
+    for (int c = 2; c < 9; ++c) {
+      item->setTextAlignment(c, Qt::AlignRight);
+    }
+    tw->addTopLevelItem(item);
+  }
+
+  resizeColumns(tw);
+}
+
+void MainWindow::onProfilerRefreshBtnClicked()
+{
+  populateProfiler();
+}
+
+void MainWindow::onProfilerResetBtnClicked()
+{
+  VkProfiler::get().reset();
+  populateProfiler();
+}
+
+void MainWindow::onProfilerExportBtnClicked()
+{
+  QString filePath = QFileDialog::getSaveFileName(this, "Export Profile", "vulkan_profile.csv", "CSV (*.csv)");
+  if (filePath.isEmpty()) {
+    return;
+  }
+
+  QFile file(filePath);
+  if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+    return;
+  }
+
+  QTextStream ts(&file);
+  ts << "function,gpu,calls,total_ns,min_ns,max_ns,p50_ns,p95_ns";
+  for (int i = 0; i < VkProfiler::kBucketCount; ++i) {
+    ts << ",bucket_" << i;
+  }
+  ts << "\n";
+
+  VkProfiler::StatsMap statsMap = VkProfiler::get().snapshot();
+  for (const auto& it : statsMap) {
+    const auto& stats = it.second;
+    ts << QString::fromStdString(it.first.first) << ",";
+    ts << "\"" << getGpuName(it.first.second) << "\",";
+    ts << stats.count << "," << stats.totalNs << "," << stats.minNs << "," << stats.maxNs << ",";
+    ts << stats.percentileNs(0.50) << "," << stats.percentileNs(0.95);
+    for (const auto& bucket : stats.histogram) {
+      ts << "," << bucket;
+    }
+    ts << "\n";
+  }
+}
+
+static PipelineCacheTarget toPipelineCacheTarget(const VkPhysicalDeviceProperties& properties, const QString& source)
+{
+  PipelineCacheTarget target;
+  target.name     = QString::fromUtf8(properties.deviceName);
+  target.source   = source;
+  target.vendorID = properties.vendorID;
+  target.deviceID = properties.deviceID;
+  std::memcpy(target.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+  return target;
+}
+
+void MainWindow::populatePipelineCaches()
+{
+  TRACE_SCOPE("qt", "populatePipelineCaches");
+
+  // Live devices first, then every device from the loaded snapshots
+  std::vector<PipelineCacheTarget> targets;
+  for (const auto& gpuProperties : mGpuProperties) {
+    targets.push_back(toPipelineCacheTarget(gpuProperties.deviceProperties, "This machine"));
+  }
+  targets.insert(targets.end(), mPipelineCacheSnapshotTargets.begin(), mPipelineCacheSnapshotTargets.end());
+
+  QTreeWidget* tw = findChild<QTreeWidget*>("pipelineCachesWidget");
+  Q_ASSERT(tw);
+  TreeSortingBlocker cachesSorting(tw);
+  tw->clear();
+  QLocale locale;
+  for (const auto& header : mPipelineCaches) {
+    QTreeWidgetItem* item = new SortableTreeWidgetItem();
+    item->setText(0, QFileInfo(header.filePath).fileName());
+    item->setToolTip(0, header.filePath);
+    item->setText(1, locale.toString(header.fileSize) + " bytes");
+    item->setData(1, SORT_ROLE, static_cast<double>(header.fileSize));
+    if (header.valid) {
+      item->setText(2, QString::number(header.headerVersion));
+      item->setText(3, QString::number(header.vendorID));
+      item->setText(4, QString::number(header.deviceID));
+      item->setText(5, toStringUuid(header.pipelineCacheUUID));
+
+      QStringList validFor;
+      for (const auto& target : targets) {
+        if (isPipelineCacheCompatible(header, target)) {
+          validFor.append(target.name + " (" + target.source + ")");
+        }
+      }
+      item->setText(6, validFor.isEmpty() ? QString("No known device") : validFor.join(", "));
+    }
+    else {
+      item->setText(6, header.error);
+    }
+    item->setText(7, " ");
+    for (int c = 1; c <= 5; ++c) {
+      item->setTextAlignment(c, Qt::AlignHCenter);
+    }
+    tw->addTopLevelItem(item);
+  }
+  resizeColumns(tw);
+
+  // One group per distinct vendor/device/UUID, i.e. per prebuilt cache to ship
+  std::vector<PipelineCacheGroup> groups = groupPipelineCacheTargets(targets, mPipelineCaches);
+  int covered = 0;
+  tw = findChild<QTreeWidget*>("pipelineCacheGroupsWidget");
+  Q_ASSERT(tw);
+  TreeSortingBlocker groupsSorting(tw);
+  tw->clear();
+  for (const auto& group : groups) {
+    QStringList devices;
+    for (size_t i : group.targets) {
+      devices.append(targets[i].name + " (" + targets[i].source + ")");
+    }
+    QStringList caches;
+    for (size_t i : group.caches) {
+      caches.append(QFileInfo(mPipelineCaches[i].filePath).fileName());
+    }
+    covered += caches.isEmpty() ? 0 : 1;
+
+    QTreeWidgetItem* item = new SortableTreeWidgetItem();
+    item->setText(0, toStringUuid(group.pipelineCacheUUID));
+    item->setText(1, QString::number(group.vendorID));
+    item->setText(2, QString::number(group.deviceID));
+    item->setText(3, devices.join(", "));
+    item->setText(4, caches.isEmpty() ? QString("Missing") : caches.join(", "));
+    item->setText(5, " ");
+    item->setTextAlignment(1, Qt::AlignHCenter);
+    item->setTextAlignment(2, Qt::AlignHCenter);
+    tw->addTopLevelItem(item);
+  }
+  resizeColumns(tw);
+
+  QLabel* lb = findChild<QLabel*>("pipelineCacheSummary");
+  Q_ASSERT(lb);
+  lb->setText(QString("%1 devices need %2 distinct caches, %3 covered by the loaded blobs")
+              .arg(targets.size()).arg(groups.size()).arg(covered));
+}
+
+void MainWindow::onPipelineCacheOpenBtnClicked()
+{
+  QStringList filePaths = QFileDialog::getOpenFileNames(this, "Open Pipeline Caches", QString(), "Pipeline Caches (*.bin *.cache *.vkpc);;All Files (*)");
+  for (const auto& filePath : filePaths) {
+    PipelineCacheHeader header;
+    readPipelineCacheHeader(filePath, &header);
+    mPipelineCaches.push_back(header);
+  }
+  populatePipelineCaches();
+}
+
+void MainWindow::onPipelineCacheOpenSnapshotsBtnClicked()
+{
+  QStringList filePaths = QFileDialog::getOpenFileNames(this, "Open Snapshots", QString(), "Snapshots (*.json)");
+  QStringList failed;
+  for (const auto& filePath : filePaths) {
+    DeviceProfileSet profileSet;
+    if (! loadDeviceProfileSet(filePath, &profileSet)) {
+      failed.append(QFileInfo(filePath).fileName());
+      continue;
+    }
+    QString source = QFileInfo(filePath).fileName();
+    for (const auto& device : profileSet.devices) {
+      mPipelineCacheSnapshotTargets.push_back(toPipelineCacheTarget(device.properties, source));
+    }
+  }
+  populatePipelineCaches();
+
+  if (! failed.isEmpty()) {
+    statusBar()->showMessage("Unable to load " + failed.join(", "), 10000);
+  }
+}
+
+void MainWindow::onPipelineCacheSaveSnapshotBtnClicked()
+{
+  QString filePath = QFileDialog::getSaveFileName(this, "Save Snapshot", "vulkan_snapshot.json", "Snapshots (*.json)");
+  if (filePath.isEmpty()) {
+    return;
+  }
+
+  // Same format as the mock ICD profiles, a snapshot can be served back by it
+  DeviceProfileSet profileSet;
+  for (const auto& gpuProperties : mGpuProperties) {
+    profileSet.devices.push_back(captureDeviceProfile(gpuProperties.physicalDevice, gpuProperties.deviceProperties, gpuProperties.extensions));
+  }
+  if (! saveDeviceProfileSet(filePath, profileSet)) {
+    statusBar()->showMessage("Unable to save " + filePath, 10000);
+  }
+}
+
+void MainWindow::onPipelineCacheClearBtnClicked()
+{
+  mPipelineCaches.clear();
+  mPipelineCacheSnapshotTargets.clear();
+  populatePipelineCaches();
+}
+
+void MainWindow::populateDiagnostics()
+{
+  QTreeWidget* tw = findChild<QTreeWidget*>("memoryAccountingWidget");
+  QLabel* summary = findChild<QLabel*>("diagnosticsSummary");
+  QTabWidget* tabs = findChild<QTabWidget*>("tabWidget");
+  Q_ASSERT(tw && summary && tabs);
+
+  std::vector<MemoryAccounting::Row> rows = MemoryAccounting::get().snapshot();
+
+  // Trees only hold the current GPU, a page's live items go on its row for
+  // that GPU, or on its instance row if it has no device content
+  int currentGpu = (mCurrentGpuProperties != nullptr) ? getGpuIndex(mCurrentGpuProperties) : MemoryAccounting::NO_GPU;
+  std::map<std::string, int> liveRows;
+  for (const auto& row : rows) {
+    if ((row.gpu != MemoryAccounting::NO_GPU) && (row.gpu == currentGpu)) {
+      liveRows[row.scope] = row.gpu;
+    }
+  }
+  for (const auto& row : rows) {
+    if ((row.gpu == MemoryAccounting::NO_GPU) && (liveRows.find(row.scope) == liveRows.end())) {
+      liveRows[row.scope] = row.gpu;
+    }
+  }
+
+  TreeSortingBlocker sortingBlocker(tw);
+  tw->clear();
+
+  QLocale locale;
+  int64_t totalLiveBytes = 0;
+  int64_t totalLiveAllocations = 0;
+  int64_t totalInternalBytes = 0;
+  uint64_t totalItems = 0;
+  uint64_t totalTextBytes = 0;
+  for (const auto& row : rows) {
+    QString name = QString::fromStdString(row.scope);
+    // An empty name would match the first unnamed child
+    QWidget* page = name.isEmpty() ? nullptr : tabs->findChild<QWidget*>(name);
+    int index = (page != nullptr) ? tabs->indexOf(page) : -1;
+
+    uint64_t items = 0;
+    uint64_t textBytes = 0;
+    auto liveRow = liveRows.find(row.scope);
+    bool live = (index >= 0) && isPageBuilt(name) && (liveRow != liveRows.end()) && (liveRow->second == row.gpu);
+    if (live) {
+      countTreeItems(page, &items, &textBytes);
+    }
+
+    QTreeWidgetItem* item = new SortableTreeWidgetItem();
+    item->setText(0, (index >= 0) ? tabs->tabText(index) : (name.isEmpty() ? "Unscoped" : name));
+    item->setText(1, (row.gpu == MemoryAccounting::NO_GPU) ? "Instance" : QString("%1: %2").arg(row.gpu).arg(QString::fromStdString(row.gpuName)));
+    item->setText(2, locale.toString(static_cast<qlonglong>(row.liveBytes)));
+    item->setText(3, locale.toString(static_cast<qlonglong>(row.liveAllocations)));
+    item->setText(4, locale.toString(static_cast<qulonglong>(row.allocations)));
+    item->setText(5, locale.toString(static_cast<qlonglong>(row.internalBytes)));
+    item->setText(6, locale.toString(static_cast<qulonglong>(row.populates)));
+    item->setText(7, locale.toString(static_cast<qulonglong>(row.itemsCreated)));
+    item->setText(8, live ? locale.toString(static_cast<qulonglong>(items)) : "");
+    item->setText(9, live ? locale.toString(static_cast<qulonglong>(textBytes)) : "");
+    item->setData(2, SORT_ROLE, static_cast<double>(row.liveBytes));
+    item->setData(3, SORT_ROLE, static_cast<double>(row.liveAllocations));
+    item->setData(4, SORT_ROLE, static_cast<double>(row.allocations));
+    item->setData(5, SORT_ROLE, static_cast<double>(row.internalBytes));
+    item->setData(6, SORT_ROLE, static_cast<double>(row.populates));
+    item->setData(7, SORT_ROLE, static_cast<double>(row.itemsCreated));
+    item->setData(8, SORT_ROLE, static_cast<double>(items));
+    item->setData(9, SORT_ROLE, static_cast<double>(textBytes));
+    for (int c = 2; c < 10; ++c) {
+      item->setTextAlignment(c, Qt::AlignRight);
+    }
+    tw->addTopLevelItem(item);
+
+    totalLiveBytes += row.liveBytes;
+    totalLiveAllocations += row.liveAllocations;
+    totalInternalBytes += row.internalBytes;
+    totalItems += items;
+    totalTextBytes += textBytes;
+  }
+
+  summary->setText(QString("Driver: %1 bytes in %2 allocations, %3 bytes internal. Trees: %4 items, %5 bytes of text")
+    .arg(locale.toString(static_cast<qlonglong>(totalLiveBytes)))
+    .arg(locale.toString(static_cast<qlonglong>(totalLiveAllocations)))
+    .arg(locale.toString(static_cast<qlonglong>(totalInternalBytes)))
+    .arg(locale.toString(static_cast<qulonglong>(totalItems)))
+    .arg(locale.toString(static_cast<qulonglong>(totalTextBytes))));
+
+  resizeColumns(tw);
+}
+
+void MainWindow::onDiagnosticsRefreshBtnClicked()
+{
+  populateDiagnostics();
+}
+
+void MainWindow::onDiagnosticsResetBtnClicked()
+{
+  MemoryAccounting::get().resetTotals();
+  populateDiagnostics();
+}
+
+void MainWindow::onDiagnosticsTimerTimeout()
+{
+  populateDiagnostics();
+}
+
+void MainWindow::appendHistory()
+{
+  if (mHistoryDir.isEmpty()) {
+    return;
+  }
+  if (mHistoryAppend.isRunning() || mInstanceModeTiming.isRunning()) {
+    mHistoryAppendPending = true;
+    return;
+  }
+
+  // Captured on its own instance, the worker doesn't touch mInstance
+  QString dirPath = mHistoryDir;
+  mHistoryAppend.setFuture(QtConcurrent::run([dirPath]() -> int {
+    DeviceProfileSet profileSet;
+    if (captureDeviceProfileSet(&profileSet) != VK_SUCCESS) {
+      return -1;
+    }
+    CapabilityHistory history;
+    if (! history.open(dirPath)) {
+      return -1;
+    }
+    return history.append(CapabilityHistory::defaultMachine(), profileSet);
+  }));
+}
+
+void MainWindow::onHistoryAppendFinished()
+{
+  int changeCount = mHistoryAppend.result();
+  if (changeCount < 0) {
+    statusBar()->showMessage("Unable to append to the history in " + mHistoryDir, 10000);
+  }
+  else if (changeCount > 0) {
+    statusBar()->showMessage(QString("%1 capability changes recorded").arg(changeCount), 10000);
+  }
+
+  if (mHistoryAppendPending) {
+    mHistoryAppendPending = false;
+    appendHistory();
+  }
+  if (isPageBuilt(PAGE_HISTORY)) {
+    populateHistory();
+  }
+}
+
+void MainWindow::populateHistory()
+{
+  TRACE_SCOPE("qt", "populateHistory");
+
+  QTreeWidget* tw = findChild<QTreeWidget*>("historyWidget");
+  QLabel* status = findChild<QLabel*>("historyStatus");
+  QLineEdit* filter = findChild<QLineEdit*>("historyFilter");
+  Q_ASSERT(tw && status && filter);
+
+  if (mHistoryDir.isEmpty()) {
+    status->setText("Set VIV_HISTORY_DIR to record capability history");
+    return;
+  }
+
+  std::vector<CapabilityHistory::Change> changes;
+  CapabilityHistory::loadChanges(mHistoryDir, &mHistoryChangesEnd, &changes);
+
+  TreeSortingBlocker sortingBlocker(tw);
+
+  // One entry per GPU per append, newest first. Changes come oldest first,
+  // so each new entry and row goes on top.
+  for (const auto& change : changes) {
+    bool sameEvent = (mHistoryEventItem != nullptr) &&
+                     (change.time == mHistoryLastChange.time) &&
+                     (change.machine == mHistoryLastChange.machine) &&
+                     (change.gpu == mHistoryLastChange.gpu) &&
+                     (change.oldDriverVersion == mHistoryLastChange.oldDriverVersion) &&
+                     (change.newDriverVersion == mHistoryLastChange.newDriverVersion);
+    if (! sameEvent) {
+      QString driverVersion = change.newDriverVersion.isEmpty() ? change.oldDriverVersion : change.newDriverVersion;
+      if ((! change.oldDriverVersion.isEmpty()) && (! change.newDriverVersion.isEmpty()) && (change.oldDriverVersion != change.newDriverVersion)) {
+        driverVersion = change.oldDriverVersion + " -> " + change.newDriverVersion;
+      }
+
+      QDateTime time = QDateTime::fromString(change.time, Qt::ISODate);
+      mHistoryEventItem = new SortableTreeWidgetItem();
+      mHistoryEventItem->setText(0, time.toLocalTime().toString("yyyy-MM-dd HH:mm:ss"));
+      mHistoryEventItem->setData(0, SORT_ROLE, static_cast<double>(time.toMSecsSinceEpoch()));
+      mHistoryEventItem->setText(1, change.gpu);
+      mHistoryEventItem->setText(2, driverVersion);
+      mHistoryEventItem->setTextAlignment(2, Qt::AlignHCenter);
+      tw->insertTopLevelItem(0, mHistoryEventItem);
+      ++mHistoryEventCount;
+    }
+
+    QTreeWidgetItem* item = new SortableTreeWidgetItem();
+    item->setText(0, change.key);
+    item->setText(3, change.oldValue);
+    item->setText(4, change.newValue);
+    item->setText(5, CapabilityHistory::describeChange(change));
+    item->setTextAlignment(3, Qt::AlignHCenter);
+    item->setTextAlignment(4, Qt::AlignHCenter);
+    mHistoryEventItem->insertChild(0, item);
+    mHistoryEventItem->setText(5, QString("%1 changes").arg(mHistoryEventItem->childCount()));
+    mHistoryLastChange = change;
+  }
+  mHistoryChangeCount += changes.size();
+
+  status->setText(QString("%1 changes in %2 updates").arg(mHistoryChangeCount).arg(mHistoryEventCount));
+  if (changes.empty()) {
+    return;
+  }
+
+  resizeColumns(tw);
+  filterTreeWidgetItemsSimple("historyWidget", filter->text().trimmed());
+}
+
+void MainWindow::onHistoryFilterTextChanged(const QString &arg1)
+{
+  filterTreeWidgetItemsSimple("historyWidget", arg1.trimmed());
+}
@@ -2,10 +2,13 @@
 #define MAINWINDOW_H
 
 #include <QComboBox>
+#include <QFutureWatcher>
 #include <QLineEdit>
 #include <QMainWindow>
+#include <QSet>
 #include <QTreeWidget>
 #include <QStandardItem>
+#include <QTimer>
 
 #if defined(_WIN32)
   #define VK_USE_PLATFORM_WIN32_KHR
@@ -14,6 +17,21 @@
 #endif
 #include <vulkan/vulkan.h>
 
+#include "CapabilityHistory.h"
+#include "DeviceGroups.h"
+#include "ExtensionSet.h"
+#include "FormatBenchmark.h"
+#include "ManifestScanner.h"
+#include "MemoryBenchmark.h"
+#include "MemoryBudgetMonitor.h"
+#include "PNextChain.h"
+#include "PipelineCacheInspector.h"
+#include "QueueBenchmark.h"
+#include "SparseImageFormats.h"
+#include "StartupProfiler.h"
+
+#include <array>
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -21,6 +39,8 @@ namespace Ui {
 class MainWindow;
 }
 
+class DeviceMonitor;
+
 //! \class MainWindow
 //!
 //!
@@ -30,6 +50,15 @@ private:
 public:
   using LayerExtensions = std::map<std::string, std::vector<VkExtensionProperties>>;
 
+  //! Minimal enables only the instance extensions the viewer calls into,
+  //! full enables everything the implementation reports
+  //! (VIV_INSTANCE_MODE=full).
+  enum InstanceMode {
+    INSTANCE_MODE_MINIMAL = 0,
+    INSTANCE_MODE_FULL    = 1,
+    INSTANCE_MODE_COUNT   = 2,
+  };
+
 //  struct GpuPropertiesData {
 //    VkPhysicalDeviceProperties                      device_properties;
 //    VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptor_indexing_properties;
@@ -40,10 +69,10 @@ public:
   struct GpuProperties {
     VkPhysicalDevice                                physicalDevice;
     VkPhysicalDeviceProperties                      deviceProperties;
-    VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptorIndexingProperties;
     std::vector<VkExtensionProperties>              extensions;
-    // Extra properties
-    VkPhysicalDeviceShaderCorePropertiesAMD         amdShaderCoreProperties;
+    ExtensionSet                                    extensionSet;
+    // Extended properties and features
+    PNextChain                                      chain;
     std::string                                     description;
   };
 
@@ -59,29 +88,96 @@ protected:
 private slots:
   void on_gpus_currentIndexChanged(int index);
 
-  void on_limitsFilter_textChanged(const QString &arg1);
+  void onLimitsFilterTextChanged(const QString &arg1);
+
+  void onFormatFilterTextChanged(const QString &arg1);
+
+  void onFeaturesFilterTextChanged(const QString &arg1);
+
+  void onItemChanged(QStandardItem* item);
+  void onTilingLinearImageTypeCurrentIndexChanged(int index);
+
+  void onTilingOptimalImageTypeCurrentIndexChanged(int index);
+
+  void onTilingLinearFormatFilterTextChanged(const QString &arg1);
+
+  void onTilingOptimalFormatFilterTextChanged(const QString &arg1);
+
+  void onBufferFormatFilterTextChanged(const QString &arg1);
+
+  void onFormatMatrixFilterTextChanged(const QString &arg1);
+
+  void onSparseImageFormatFilterTextChanged(const QString &arg1);
+
+  void onExpandAllBtnClicked();
+
+  void onCollapseAllBtnClicked();
+
+  void on_tabWidget_currentChanged(int index);
+
+  void onProfilerRefreshBtnClicked();
+
+  void onProfilerResetBtnClicked();
+
+  void onProfilerExportBtnClicked();
+
+  void onDevicesChanged();
+
+  void onInstanceModeTimingFinished();
+
+  void onLayersProfileBtnClicked();
 
-  void on_formatFilter_textChanged(const QString &arg1);
+  void onStartupProfileFinished();
 
-  void on_featuresFilter_textChanged(const QString &arg1);
+  void onMemoryBudgetEnabledToggled(bool checked);
 
-  void on_itemChanged(QStandardItem* item);
-  void on_tilingLinearImageType_currentIndexChanged(int index);
+  void onMemoryBudgetRateValueChanged(int value);
 
-  void on_tilingOptimalImageType_currentIndexChanged(int index);
+  void onMemoryBudgetTimerTimeout();
 
-  void on_tilingLinearFormatFilter_textChanged(const QString &arg1);
+  void onMemoryBenchmarkBtnClicked();
 
-  void on_tilingOptimalFormatFilter_textChanged(const QString &arg1);
+  void onMemoryBenchmarkFinished();
 
-  void on_bufferFormatFilter_textChanged(const QString &arg1);
+  void onQueueBenchmarkBtnClicked();
 
-  void on_expandAllBtn_clicked();
+  void onQueueBenchmarkFinished();
 
-  void on_collapseAllBtn_clicked();
+  void onTilingOptimalBenchmarkBtnClicked();
+
+  void onFormatBenchmarkFinished();
+
+  void onPeerCopyBenchmarkBtnClicked();
+
+  void onPeerCopyBenchmarkFinished();
+
+  void onPeerMemoryQueryFinished();
+
+  void onSparseImageFormatsFinished();
+
+  void onPipelineCacheOpenBtnClicked();
+
+  void onPipelineCacheOpenSnapshotsBtnClicked();
+
+  void onPipelineCacheSaveSnapshotBtnClicked();
+
+  void onPipelineCacheClearBtnClicked();
+
+  void onHistoryFilterTextChanged(const QString &arg1);
+
+  void onHistoryAppendFinished();
+
+  void onDiagnosticsRefreshBtnClicked();
+
+  void onDiagnosticsResetBtnClicked();
+
+  void onDiagnosticsTimerTimeout();
 
 private:
+  std::vector<const char*> getInstanceExtensions(InstanceMode mode) const;
   void  createVulkanInstance();
+  void  measureInstanceModes();
+  void  populateInstanceTimings();
   void  destroyVulkanInstance();
   void  createVulkanSurface();
   void  destroyVulkanSurface();
@@ -89,11 +185,24 @@ private:
 private:
   void  enumerateInstanceLayers();
   void  populateInstanceLayers();
+  void  populateIcds();
 
   void  enumerateInstanceExtensions();
   void  populateInstanceExtensions();
   void  enumerateDeviceExtensions();
 
+  //! Fills a tab page from its form on first show, false if it already was
+  bool  buildPage(QWidget* page);
+  bool  isPageBuilt(const QString& name) const;
+  void  connectPageSlots(QWidget* page);
+  void  setupFormatFilters();
+  void  populateInstancePage(const QString& name);
+  void  populateDevicePage(const QString& name, const GpuProperties* pGpuProperties);
+  //! Counts what a populate left in the page's trees, see MemoryAccounting.h
+  void  recordPagePopulated(const QString& name);
+  //! Position in mGpuProperties, which is vkEnumeratePhysicalDevices order
+  int   getGpuIndex(const GpuProperties* pGpuProperties) const;
+
   void  enumerateGpus();
   QString getFullGpuName(const GpuProperties* pProperties) const;
   void  populateGpus();
@@ -102,6 +211,7 @@ private:
   void  populateDeviceExtensions(const GpuProperties* pGpuProperties);
   void  populateLimits(const GpuProperties* pGpuProperties);
   void  populateSparse(const GpuProperties* pGpuProperties);
+  void  populateSparseImageFormats(const GpuProperties* pGpuProperties);
   void  populateFeatures(const GpuProperties* pGpuProperties);
   void  populateSurface(const GpuProperties* pGpuProperties);
   void  populateQueues(const GpuProperties* pGpuProperties);
@@ -109,18 +219,54 @@ private:
   void  populateFormats(const GpuProperties* pGpuProperties);
 
   void  updateSurfaceExtents(const GpuProperties* pGpuProperties);
+  void  updateMemoryBudgetMonitor();
+  void  populateMemoryBenchmark(const GpuProperties* pGpuProperties);
+  void  populateQueueBenchmark(const GpuProperties* pGpuProperties);
+  void  populateFormatBenchmark(const GpuProperties* pGpuProperties);
+  void  populateDeviceGroups();
+
+  QString getGpuName(VkPhysicalDevice gpu) const;
+  void  populateProfiler();
+  void  populatePipelineCaches();
+  void  appendHistory();
+  void  populateHistory();
+  void  populateDiagnostics();
 
 private:
   Ui::MainWindow *ui;
+  QSet<QString>                       mBuiltPages;
 
+  ManifestScanner                     mManifestScanner;
   std::vector<VkLayerProperties>      mInstanceLayers;
   LayerExtensions                     mInstanceLayerExtensions;
 
+  struct InstanceCreateTiming {
+    double    milliseconds = -1.0;
+    uint32_t  extensionCount = 0;
+  };
+
+  InstanceMode                        mInstanceMode = INSTANCE_MODE_MINIMAL;
+  uint32_t                            mInstanceApiVersion = VK_API_VERSION_1_0;
+  std::array<InstanceCreateTiming, INSTANCE_MODE_COUNT> mInstanceCreateTimings;
+  // Both modes are timed in fresh processes, in-process numbers depend on what is already loaded
+  QFutureWatcher<std::vector<StartupProbe>> mInstanceModeTiming;
+  std::atomic<bool>                   mInstanceModeTimingCancel{false};
+  bool                                mInstanceModeTimingPending = false;
+
+  QFutureWatcher<StartupProfile>      mStartupProfile;
+  std::atomic<bool>                   mStartupProfileCancel{false};
+  StartupProfile                      mStartupProfileResult;
+  bool                                mHasStartupProfile = false;
+
   VkInstance                          mInstance = VK_NULL_HANDLE;
   VkSurfaceKHR                        mSurface = VK_NULL_HANDLE;
 
   std::vector<GpuProperties>          mGpuProperties;
   const GpuProperties*                mCurrentGpuProperties = nullptr;
+  std::vector<DeviceGroup>            mDeviceGroups;
+  // Bumped by onDevicesChanged; a worker started before that holds handles
+  // of the old instance and its queued finished() is dropped
+  uint64_t                            mDeviceGeneration = 0;
 
   struct FilterInputs {
     VkImageTiling tiling = static_cast<VkImageTiling>(UINT32_MAX);
@@ -135,6 +281,62 @@ private:
   FilterInputs  mTilingOptimalFilterInputs = {};
 
   std::map<QAbstractItemModel*, FilterInputs*> mFilterInputTargets;
+
+  DeviceMonitor*  mDeviceMonitor = nullptr;
+
+  MemoryBudgetMonitor                       mMemoryBudgetMonitor;
+  QTimer                                    mMemoryBudgetTimer;
+  std::vector<MemoryBudgetMonitor::Sample>  mMemoryBudgetSamples;
+
+  using MemoryBenchmarkResults = std::vector<MemoryTypeBenchmark>;
+  QFutureWatcher<MemoryBenchmarkResults>              mMemoryBenchmark;
+  VkPhysicalDevice                                    mMemoryBenchmarkGpu = VK_NULL_HANDLE;
+  uint64_t                                            mMemoryBenchmarkGeneration = 0;
+  std::map<VkPhysicalDevice, MemoryBenchmarkResults>  mMemoryBenchmarkResults;
+
+  using QueueBenchmarkResults = std::vector<QueueFamilyBenchmark>;
+  QFutureWatcher<QueueBenchmarkResults>               mQueueBenchmark;
+  VkPhysicalDevice                                    mQueueBenchmarkGpu = VK_NULL_HANDLE;
+  uint64_t                                            mQueueBenchmarkGeneration = 0;
+  std::map<VkPhysicalDevice, QueueBenchmarkResults>   mQueueBenchmarkResults;
+
+  using FormatBenchmarkResults = std::map<VkFormat, FormatBenchmark>;
+  QFutureWatcher<FormatBenchmarkResults>              mFormatBenchmark;
+  VkPhysicalDevice                                    mFormatBenchmarkGpu = VK_NULL_HANDLE;
+  uint64_t                                            mFormatBenchmarkGeneration = 0;
+  std::map<VkPhysicalDevice, FormatBenchmarkResults>  mFormatBenchmarkResults;
+
+  // By group index, empty for groups of one device
+  using PeerCopyBenchmarkResults = std::vector<std::vector<PeerCopyBenchmark>>;
+  QFutureWatcher<PeerCopyBenchmarkResults>            mPeerCopyBenchmark;
+  uint64_t                                            mPeerCopyBenchmarkGeneration = 0;
+  PeerCopyBenchmarkResults                            mPeerCopyBenchmarkResults;
+
+  // Every group needs its own logical device for the query, that runs in the background
+  QFutureWatcher<std::vector<DeviceGroup>>            mPeerMemoryQuery;
+  uint64_t                                            mPeerMemoryQueryGeneration = 0;
+
+  // Enumerated once per device in the background, then served from here
+  using SparseImageFormatResults = std::vector<SparseImageFormat>;
+  QFutureWatcher<SparseImageFormatResults>              mSparseImageFormats;
+  VkPhysicalDevice                                      mSparseImageFormatsGpu = VK_NULL_HANDLE;
+  uint64_t                                              mSparseImageFormatsGeneration = 0;
+  std::map<VkPhysicalDevice, SparseImageFormatResults>  mSparseImageFormatResults;
+
+  std::vector<PipelineCacheHeader>  mPipelineCaches;
+  std::vector<PipelineCacheTarget>  mPipelineCacheSnapshotTargets;
+
+  QString                           mHistoryDir;
+  QFutureWatcher<int>               mHistoryAppend;
+  bool                              mHistoryAppendPending = false;
+  // changes.idx is read from where the last populate stopped, the tree only gets the new lines
+  qint64                            mHistoryChangesEnd = 0;
+  size_t                            mHistoryChangeCount = 0;
+  int                               mHistoryEventCount = 0;
+  QTreeWidgetItem*                  mHistoryEventItem = nullptr;    // Newest event
+  CapabilityHistory::Change         mHistoryLastChange;
+
+  QTimer                            mDiagnosticsTimer;
 };
 
 #endif // MAINWINDOW_H
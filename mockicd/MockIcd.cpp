@@ -0,0 +1,745 @@
+//! \file MockIcd.cpp
+//!
+//! Minimal Vulkan ICD that serves physical device data from a JSON profile
+//! (see DeviceProfile.h). It never creates a logical device; it exists so the
+//! enumeration and population paths of the viewer can run without a GPU.
+//!
+//! Environment:
+//!   VIV_MOCK_ICD_PROFILE          - path of the profile, built-in device if unset
+//!   VIV_MOCK_ICD_LATENCY_US       - overrides profile latencyUs
+//!   VIV_MOCK_ICD_DEVICE_COUNT     - overrides profile deviceCount
+//!   VIV_MOCK_ICD_EXTRA_EXTENSIONS - overrides profile extraExtensionCount
+//!
+
+#include "DeviceProfile.h"
+
+#include <QtGlobal>
+
+#include <vulkan/vk_icd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#define MOCK_ICD_INTERFACE_VERSION  5
+#define MOCK_ICD_API_VERSION        VK_MAKE_VERSION(1, 1, 0)
+
+struct MockPhysicalDevice {
+  VK_LOADER_DATA        loaderData;
+  uint32_t              index;
+  const DeviceProfile*  profile;
+};
+
+struct MockInstance {
+  VK_LOADER_DATA                    loaderData;
+  std::vector<MockPhysicalDevice*>  physicalDevices;
+};
+
+static std::once_flag    sProfileOnce;
+static DeviceProfileSet  sProfileSet;
+
+// -------------------------------------------------------------------------------------------------
+// Profile
+// -------------------------------------------------------------------------------------------------
+static DeviceProfile makeDefaultDevice()
+{
+  DeviceProfile device = {};
+
+  VkPhysicalDeviceProperties& props = device.properties;
+  props.apiVersion    = MOCK_ICD_API_VERSION;
+  props.driverVersion = VK_MAKE_VERSION(1, 0, 0);
+  props.vendorID      = 0xFFFF;
+  props.deviceID      = 0x0001;
+  props.deviceType    = VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU;
+  strncpy(props.deviceName, "Mock GPU", VK_MAX_PHYSICAL_DEVICE_NAME_SIZE - 1);
+
+  VkPhysicalDeviceLimits& limits = props.limits;
+  limits.maxImageDimension1D            = 16384;
+  limits.maxImageDimension2D            = 16384;
+  limits.maxImageDimension3D            = 2048;
+  limits.maxImageDimensionCube          = 16384;
+  limits.maxImageArrayLayers            = 2048;
+  limits.maxTexelBufferElements         = 128 * 1024 * 1024;
+  limits.maxUniformBufferRange          = 65536;
+  limits.maxStorageBufferRange          = 0xFFFFFFFF;
+  limits.maxPushConstantsSize           = 256;
+  limits.maxMemoryAllocationCount       = 4096;
+  limits.maxSamplerAllocationCount      = 4000;
+  limits.bufferImageGranularity         = 1024;
+  limits.maxBoundDescriptorSets         = 8;
+  limits.maxColorAttachments            = 8;
+  limits.maxViewports                   = 16;
+  limits.maxViewportDimensions[0]       = 16384;
+  limits.maxViewportDimensions[1]       = 16384;
+  limits.viewportBoundsRange[0]         = -32768.0f;
+  limits.viewportBoundsRange[1]         = 32767.0f;
+  limits.maxFramebufferWidth            = 16384;
+  limits.maxFramebufferHeight           = 16384;
+  limits.maxFramebufferLayers           = 2048;
+  limits.framebufferColorSampleCounts   = VK_SAMPLE_COUNT_1_BIT | VK_SAMPLE_COUNT_4_BIT;
+  limits.framebufferDepthSampleCounts   = VK_SAMPLE_COUNT_1_BIT | VK_SAMPLE_COUNT_4_BIT;
+  limits.sampledImageColorSampleCounts  = VK_SAMPLE_COUNT_1_BIT | VK_SAMPLE_COUNT_4_BIT;
+  limits.storageImageSampleCounts       = VK_SAMPLE_COUNT_1_BIT;
+  limits.minMemoryMapAlignment          = 64;
+  limits.timestampComputeAndGraphics    = VK_TRUE;
+  limits.timestampPeriod                = 1.0f;
+  limits.discreteQueuePriorities        = 2;
+  limits.optimalBufferCopyOffsetAlignment   = 1;
+  limits.optimalBufferCopyRowPitchAlignment = 1;
+  limits.nonCoherentAtomSize            = 64;
+
+  device.features.robustBufferAccess  = VK_TRUE;
+  device.features.samplerAnisotropy   = VK_TRUE;
+  device.features.textureCompressionBC = VK_TRUE;
+  device.features.sparseBinding       = VK_TRUE;
+  device.features.sparseResidencyImage2D = VK_TRUE;
+
+  VkQueueFamilyProperties universal = {};
+  universal.queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+  universal.queueCount = 1;
+  universal.timestampValidBits = 64;
+  universal.minImageTransferGranularity = { 1, 1, 1 };
+  VkQueueFamilyProperties transfer = universal;
+  transfer.queueFlags = VK_QUEUE_TRANSFER_BIT;
+  transfer.queueCount = 2;
+  device.queueFamilies = { universal, transfer };
+
+  VkPhysicalDeviceMemoryProperties& memory = device.memoryProperties;
+  memory.memoryHeapCount = 2;
+  memory.memoryHeaps[0] = { 4ULL * 1024 * 1048576, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT };
+  memory.memoryHeaps[1] = { 8ULL * 1024 * 1048576, 0 };
+  memory.memoryTypeCount = 3;
+  memory.memoryTypes[0] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0 };
+  memory.memoryTypes[1] = { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1 };
+  memory.memoryTypes[2] = { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, 1 };
+
+  // Core formats only, every one sampleable and copyable
+  for (uint32_t i = VK_FORMAT_R4G4_UNORM_PACK8; i <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK; ++i) {
+    VkFormatProperties properties = {};
+    properties.linearTilingFeatures  = VK_FORMAT_FEATURE_TRANSFER_SRC_BIT_KHR | VK_FORMAT_FEATURE_TRANSFER_DST_BIT_KHR;
+    properties.optimalTilingFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+                                       VK_FORMAT_FEATURE_TRANSFER_SRC_BIT_KHR | VK_FORMAT_FEATURE_TRANSFER_DST_BIT_KHR;
+    properties.bufferFeatures        = VK_FORMAT_FEATURE_UNIFORM_TEXEL_BUFFER_BIT | VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT;
+    device.formats[static_cast<VkFormat>(i)] = properties;
+  }
+
+  return device;
+}
+
+static void addExtension(std::vector<VkExtensionProperties>* pExtensions, const char* name, uint32_t specVersion)
+{
+  VkExtensionProperties ext = {};
+  strncpy(ext.extensionName, name, VK_MAX_EXTENSION_NAME_SIZE - 1);
+  ext.specVersion = specVersion;
+  pExtensions->push_back(ext);
+}
+
+static uint32_t envValue(const char* name, uint32_t defaultValue)
+{
+  bool ok = false;
+  uint32_t value = qEnvironmentVariableIntValue(name, &ok);
+  return ok ? value : defaultValue;
+}
+
+static void loadProfile()
+{
+  sProfileSet.devices.push_back(makeDefaultDevice());
+#if defined(VK_EXT_memory_budget)
+  addExtension(&sProfileSet.devices[0].extensions, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, 1);
+#endif
+  addExtension(&sProfileSet.instanceExtensions, VK_KHR_SURFACE_EXTENSION_NAME, 25);
+#if defined(_WIN32)
+  addExtension(&sProfileSet.instanceExtensions, VK_KHR_WIN32_SURFACE_EXTENSION_NAME, 6);
+#elif defined(__linux__)
+  addExtension(&sProfileSet.instanceExtensions, VK_KHR_XCB_SURFACE_EXTENSION_NAME, 6);
+#endif
+  addExtension(&sProfileSet.instanceExtensions, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME, 1);
+
+  QString filePath = QString::fromLocal8Bit(qgetenv("VIV_MOCK_ICD_PROFILE"));
+  if (! filePath.isEmpty() && ! loadDeviceProfileSet(filePath, &sProfileSet)) {
+    qWarning("VkMockIcd: failed to load profile %s", qPrintable(filePath));
+  }
+
+  sProfileSet.latencyUs           = envValue("VIV_MOCK_ICD_LATENCY_US", sProfileSet.latencyUs);
+  sProfileSet.deviceCount         = envValue("VIV_MOCK_ICD_DEVICE_COUNT", sProfileSet.deviceCount);
+  sProfileSet.extraExtensionCount = envValue("VIV_MOCK_ICD_EXTRA_EXTENSIONS", sProfileSet.extraExtensionCount);
+
+  // Scale: replicate devices round robin, then pad every device's extension list
+  std::vector<DeviceProfile>& devices = sProfileSet.devices;
+  size_t profileDeviceCount = devices.size();
+  for (size_t i = profileDeviceCount; (profileDeviceCount > 0) && (i < sProfileSet.deviceCount); ++i) {
+    devices.push_back(devices[i % profileDeviceCount]);
+  }
+  for (auto& device : devices) {
+    for (uint32_t i = 0; i < sProfileSet.extraExtensionCount; ++i) {
+      std::string name = "VK_MOCK_extension_" + std::to_string(i);
+      addExtension(&device.extensions, name.c_str(), 1);
+    }
+    std::sort(
+      std::begin(device.extensions),
+      std::end(device.extensions),
+      [](const VkExtensionProperties& a, const VkExtensionProperties& b) -> bool {
+        return (strcmp(a.extensionName, b.extensionName) < 0); });
+  }
+}
+
+static const DeviceProfileSet& profileSet()
+{
+  std::call_once(sProfileOnce, loadProfile);
+  return sProfileSet;
+}
+
+//! Simulates driver cost. Short delays spin so they stay accurate.
+static void simulateLatency()
+{
+  uint32_t latencyUs = profileSet().latencyUs;
+  if (latencyUs == 0) {
+    return;
+  }
+
+  auto duration = std::chrono::microseconds(latencyUs);
+  if (latencyUs >= 1000) {
+    std::this_thread::sleep_for(duration);
+    return;
+  }
+
+  auto end = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+template <typename T>
+static VkResult copyArray(const std::vector<T>& src, uint32_t* pCount, T* pDst)
+{
+  uint32_t size = static_cast<uint32_t>(src.size());
+  if (pDst == nullptr) {
+    *pCount = size;
+    return VK_SUCCESS;
+  }
+
+  uint32_t n = std::min(*pCount, size);
+  std::copy(src.begin(), src.begin() + n, pDst);
+  *pCount = n;
+  return (n < size) ? VK_INCOMPLETE : VK_SUCCESS;
+}
+
+static const DeviceProfile& getProfile(VkPhysicalDevice physicalDevice)
+{
+  return *reinterpret_cast<MockPhysicalDevice*>(physicalDevice)->profile;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Instance
+// -------------------------------------------------------------------------------------------------
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkEnumerateInstanceExtensionProperties(
+  const char* pLayerName, uint32_t* pPropertyCount, VkExtensionProperties* pProperties)
+{
+  simulateLatency();
+  if (pLayerName != nullptr) {
+    return VK_ERROR_LAYER_NOT_PRESENT;
+  }
+  return copyArray(profileSet().instanceExtensions, pPropertyCount, pProperties);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkEnumerateInstanceVersion(uint32_t* pApiVersion)
+{
+  *pApiVersion = MOCK_ICD_API_VERSION;
+  return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateInstance(
+  const VkInstanceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkInstance* pInstance)
+{
+  (void)pCreateInfo;
+  (void)pAllocator;
+  simulateLatency();
+
+  const DeviceProfileSet& profiles = profileSet();
+
+  MockInstance* instance = new MockInstance();
+  set_loader_magic_value(instance);
+  for (size_t i = 0; i < profiles.devices.size(); ++i) {
+    MockPhysicalDevice* physicalDevice = new MockPhysicalDevice();
+    set_loader_magic_value(physicalDevice);
+    physicalDevice->index = static_cast<uint32_t>(i);
+    physicalDevice->profile = &profiles.devices[i];
+    instance->physicalDevices.push_back(physicalDevice);
+  }
+
+  *pInstance = reinterpret_cast<VkInstance>(instance);
+  return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyInstance(VkInstance instance, const VkAllocationCallbacks* pAllocator)
+{
+  (void)pAllocator;
+  MockInstance* mockInstance = reinterpret_cast<MockInstance*>(instance);
+  if (mockInstance == nullptr) {
+    return;
+  }
+  for (auto physicalDevice : mockInstance->physicalDevices) {
+    delete physicalDevice;
+  }
+  delete mockInstance;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkEnumeratePhysicalDevices(
+  VkInstance instance, uint32_t* pPhysicalDeviceCount, VkPhysicalDevice* pPhysicalDevices)
+{
+  // copyArray writes at most *pPhysicalDeviceCount handles and returns VK_INCOMPLETE for the rest
+  simulateLatency();
+  MockInstance* mockInstance = reinterpret_cast<MockInstance*>(instance);
+  std::vector<VkPhysicalDevice> handles;
+  for (auto physicalDevice : mockInstance->physicalDevices) {
+    handles.push_back(reinterpret_cast<VkPhysicalDevice>(physicalDevice));
+  }
+  return copyArray(handles, pPhysicalDeviceCount, pPhysicalDevices);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkEnumeratePhysicalDeviceGroups(
+  VkInstance instance, uint32_t* pPhysicalDeviceGroupCount, VkPhysicalDeviceGroupProperties* pPhysicalDeviceGroupProperties)
+{
+  simulateLatency();
+  // Every device is a group of its own, like separate boards without a link
+  MockInstance* mockInstance = reinterpret_cast<MockInstance*>(instance);
+  std::vector<VkPhysicalDeviceGroupProperties> groups;
+  for (auto physicalDevice : mockInstance->physicalDevices) {
+    VkPhysicalDeviceGroupProperties group = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GROUP_PROPERTIES };
+    group.physicalDeviceCount = 1;
+    group.physicalDevices[0]  = reinterpret_cast<VkPhysicalDevice>(physicalDevice);
+    group.subsetAllocation    = VK_FALSE;
+    groups.push_back(group);
+  }
+  if (pPhysicalDeviceGroupProperties == nullptr) {
+    *pPhysicalDeviceGroupCount = static_cast<uint32_t>(groups.size());
+    return VK_SUCCESS;
+  }
+  // The caller's pNext is kept
+  uint32_t count = std::min(*pPhysicalDeviceGroupCount, static_cast<uint32_t>(groups.size()));
+  for (uint32_t i = 0; i < count; ++i) {
+    void* pNext = pPhysicalDeviceGroupProperties[i].pNext;
+    pPhysicalDeviceGroupProperties[i] = groups[i];
+    pPhysicalDeviceGroupProperties[i].pNext = pNext;
+  }
+  *pPhysicalDeviceGroupCount = count;
+  return (count < groups.size()) ? VK_INCOMPLETE : VK_SUCCESS;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Physical device
+// -------------------------------------------------------------------------------------------------
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceProperties(
+  VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties* pProperties)
+{
+  simulateLatency();
+  *pProperties = getProfile(physicalDevice).properties;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceProperties2(
+  VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties2* pProperties)
+{
+  simulateLatency();
+  pProperties->properties = getProfile(physicalDevice).properties;
+
+  // Structures in the chain are left as the caller initialized them, the
+  // viewer zeroes them like a driver that reports nothing would. The ID
+  // properties are filled completely, with a stable per-device UUID.
+  VkBaseOutStructure* pNext = reinterpret_cast<VkBaseOutStructure*>(pProperties->pNext);
+  for (; pNext != nullptr; pNext = pNext->pNext) {
+    if (pNext->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES) {
+      auto pIdProperties = reinterpret_cast<VkPhysicalDeviceIDProperties*>(pNext);
+      uint32_t index = reinterpret_cast<MockPhysicalDevice*>(physicalDevice)->index;
+      memset(pIdProperties->deviceUUID, 0, VK_UUID_SIZE);
+      memcpy(pIdProperties->deviceUUID, &index, sizeof(index));
+      memset(pIdProperties->driverUUID, 0, VK_UUID_SIZE);
+      memset(pIdProperties->deviceLUID, 0, VK_LUID_SIZE);
+      pIdProperties->deviceNodeMask   = 0;
+      pIdProperties->deviceLUIDValid  = VK_FALSE;
+    }
+  }
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceFeatures(
+  VkPhysicalDevice physicalDevice, VkPhysicalDeviceFeatures* pFeatures)
+{
+  simulateLatency();
+  *pFeatures = getProfile(physicalDevice).features;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceFeatures2(
+  VkPhysicalDevice physicalDevice, VkPhysicalDeviceFeatures2* pFeatures)
+{
+  simulateLatency();
+  // Like the properties, chained feature structs keep what the caller put there
+  pFeatures->features = getProfile(physicalDevice).features;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceQueueFamilyProperties(
+  VkPhysicalDevice physicalDevice, uint32_t* pQueueFamilyPropertyCount, VkQueueFamilyProperties* pQueueFamilyProperties)
+{
+  simulateLatency();
+  copyArray(getProfile(physicalDevice).queueFamilies, pQueueFamilyPropertyCount, pQueueFamilyProperties);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceQueueFamilyProperties2(
+  VkPhysicalDevice physicalDevice, uint32_t* pQueueFamilyPropertyCount, VkQueueFamilyProperties2* pQueueFamilyProperties)
+{
+  simulateLatency();
+  const auto& queueFamilies = getProfile(physicalDevice).queueFamilies;
+  uint32_t size = static_cast<uint32_t>(queueFamilies.size());
+  if (pQueueFamilyProperties == nullptr) {
+    *pQueueFamilyPropertyCount = size;
+    return;
+  }
+  *pQueueFamilyPropertyCount = std::min(*pQueueFamilyPropertyCount, size);
+  for (uint32_t i = 0; i < *pQueueFamilyPropertyCount; ++i) {
+    pQueueFamilyProperties[i].queueFamilyProperties = queueFamilies[i];
+  }
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceMemoryProperties(
+  VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties* pMemoryProperties)
+{
+  simulateLatency();
+  *pMemoryProperties = getProfile(physicalDevice).memoryProperties;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceMemoryProperties2(
+  VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties2* pMemoryProperties)
+{
+  simulateLatency();
+  const VkPhysicalDeviceMemoryProperties& memoryProperties = getProfile(physicalDevice).memoryProperties;
+  pMemoryProperties->memoryProperties = memoryProperties;
+
+  // The whole heap is the budget and nothing is in use, so the budget monitor has samples
+  VkBaseOutStructure* pNext = reinterpret_cast<VkBaseOutStructure*>(pMemoryProperties->pNext);
+  for (; pNext != nullptr; pNext = pNext->pNext) {
+#if defined(VK_EXT_memory_budget)
+    if (pNext->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT) {
+      auto pBudget = reinterpret_cast<VkPhysicalDeviceMemoryBudgetPropertiesEXT*>(pNext);
+      for (uint32_t i = 0; i < VK_MAX_MEMORY_HEAPS; ++i) {
+        pBudget->heapBudget[i] = (i < memoryProperties.memoryHeapCount) ? memoryProperties.memoryHeaps[i].size : 0;
+        pBudget->heapUsage[i]  = 0;
+      }
+    }
+#endif
+  }
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceFormatProperties(
+  VkPhysicalDevice physicalDevice, VkFormat format, VkFormatProperties* pFormatProperties)
+{
+  simulateLatency();
+  const auto& formats = getProfile(physicalDevice).formats;
+  auto it = formats.find(format);
+  *pFormatProperties = (it != formats.end()) ? it->second : VkFormatProperties{};
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceFormatProperties2(
+  VkPhysicalDevice physicalDevice, VkFormat format, VkFormatProperties2* pFormatProperties)
+{
+  mock_vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &pFormatProperties->formatProperties);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkGetPhysicalDeviceImageFormatProperties(
+  VkPhysicalDevice physicalDevice, VkFormat format, VkImageType type, VkImageTiling tiling,
+  VkImageUsageFlags usage, VkImageCreateFlags flags, VkImageFormatProperties* pImageFormatProperties)
+{
+  (void)usage;
+  simulateLatency();
+
+  const DeviceProfile& profile = getProfile(physicalDevice);
+  auto it = profile.formats.find(format);
+  VkFormatFeatureFlags features = 0;
+  if (it != profile.formats.end()) {
+    features = (tiling == VK_IMAGE_TILING_LINEAR) ? it->second.linearTilingFeatures : it->second.optimalTilingFeatures;
+  }
+  bool residency = ((type == VK_IMAGE_TYPE_2D) && profile.features.sparseResidencyImage2D) ||
+                   ((type == VK_IMAGE_TYPE_3D) && profile.features.sparseResidencyImage3D);
+  if ((features == 0) ||
+      ((flags & VK_IMAGE_CREATE_SPARSE_BINDING_BIT) && ! profile.features.sparseBinding) ||
+      ((flags & VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT) && ! residency)) {
+    *pImageFormatProperties = {};
+    return VK_ERROR_FORMAT_NOT_SUPPORTED;
+  }
+
+  const VkPhysicalDeviceLimits& limits = profile.properties.limits;
+  VkImageFormatProperties properties = {};
+  switch (type) {
+    case VK_IMAGE_TYPE_1D : properties.maxExtent = { limits.maxImageDimension1D, 1, 1 }; break;
+    case VK_IMAGE_TYPE_2D : properties.maxExtent = { limits.maxImageDimension2D, limits.maxImageDimension2D, 1 }; break;
+    case VK_IMAGE_TYPE_3D : properties.maxExtent = { limits.maxImageDimension3D, limits.maxImageDimension3D, limits.maxImageDimension3D }; break;
+    default: break;
+  }
+  uint32_t maxDimension = std::max(properties.maxExtent.width, std::max(properties.maxExtent.height, properties.maxExtent.depth));
+  while ((maxDimension >> properties.maxMipLevels) != 0) {
+    ++properties.maxMipLevels;
+  }
+  properties.maxArrayLayers = (type == VK_IMAGE_TYPE_3D) ? 1 : limits.maxImageArrayLayers;
+  properties.sampleCounts = ((type == VK_IMAGE_TYPE_2D) && (tiling == VK_IMAGE_TILING_OPTIMAL))
+                            ? limits.framebufferColorSampleCounts : VK_SAMPLE_COUNT_1_BIT;
+  properties.maxResourceSize = 1ULL << 31;
+
+  *pImageFormatProperties = properties;
+  return VK_SUCCESS;
+}
+
+//! One entry per aspect when the profile has residency for the image type
+//! and sample count, with the standard block shapes of 32 bit texels
+static std::vector<VkSparseImageFormatProperties> getSparseImageFormats(
+  const DeviceProfile& profile, VkFormat format, VkImageType type, VkSampleCountFlagBits samples, VkImageTiling tiling)
+{
+  std::vector<VkSparseImageFormatProperties> result;
+  auto it = profile.formats.find(format);
+  if ((tiling != VK_IMAGE_TILING_OPTIMAL) || (it == profile.formats.end()) || (it->second.optimalTilingFeatures == 0)) {
+    return result;
+  }
+
+  const VkPhysicalDeviceFeatures& features = profile.features;
+  bool residency = false;
+  switch (type) {
+    case VK_IMAGE_TYPE_2D : residency = features.sparseResidencyImage2D; break;
+    case VK_IMAGE_TYPE_3D : residency = features.sparseResidencyImage3D && (samples == VK_SAMPLE_COUNT_1_BIT); break;
+    default: break;
+  }
+  switch (samples) {
+    case VK_SAMPLE_COUNT_1_BIT  : break;
+    case VK_SAMPLE_COUNT_2_BIT  : residency = residency && features.sparseResidency2Samples; break;
+    case VK_SAMPLE_COUNT_4_BIT  : residency = residency && features.sparseResidency4Samples; break;
+    case VK_SAMPLE_COUNT_8_BIT  : residency = residency && features.sparseResidency8Samples; break;
+    case VK_SAMPLE_COUNT_16_BIT : residency = residency && features.sparseResidency16Samples; break;
+    default: residency = false; break;
+  }
+  if (! residency) {
+    return result;
+  }
+
+  std::vector<VkImageAspectFlags> aspects;
+  switch (format) {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+      aspects = { VK_IMAGE_ASPECT_DEPTH_BIT };
+      break;
+    case VK_FORMAT_S8_UINT:
+      aspects = { VK_IMAGE_ASPECT_STENCIL_BIT };
+      break;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+      aspects = { VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_ASPECT_STENCIL_BIT };
+      break;
+    default:
+      aspects = { VK_IMAGE_ASPECT_COLOR_BIT };
+      break;
+  }
+
+  for (VkImageAspectFlags aspect : aspects) {
+    VkSparseImageFormatProperties properties = {};
+    properties.aspectMask       = aspect;
+    properties.imageGranularity = (type == VK_IMAGE_TYPE_3D) ? VkExtent3D{ 32, 32, 32 } : VkExtent3D{ 128, 128, 1 };
+    result.push_back(properties);
+  }
+  return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceSparseImageFormatProperties(
+  VkPhysicalDevice physicalDevice, VkFormat format, VkImageType type, VkSampleCountFlagBits samples,
+  VkImageUsageFlags usage, VkImageTiling tiling, uint32_t* pPropertyCount, VkSparseImageFormatProperties* pProperties)
+{
+  (void)usage;
+  simulateLatency();
+  copyArray(getSparseImageFormats(getProfile(physicalDevice), format, type, samples, tiling), pPropertyCount, pProperties);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceSparseImageFormatProperties2(
+  VkPhysicalDevice physicalDevice, const VkPhysicalDeviceSparseImageFormatInfo2* pFormatInfo,
+  uint32_t* pPropertyCount, VkSparseImageFormatProperties2* pProperties)
+{
+  simulateLatency();
+  std::vector<VkSparseImageFormatProperties> formats = getSparseImageFormats(
+    getProfile(physicalDevice), pFormatInfo->format, pFormatInfo->type, pFormatInfo->samples, pFormatInfo->tiling);
+  uint32_t size = static_cast<uint32_t>(formats.size());
+  if (pProperties == nullptr) {
+    *pPropertyCount = size;
+    return;
+  }
+  // The caller's pNext is kept
+  *pPropertyCount = std::min(*pPropertyCount, size);
+  for (uint32_t i = 0; i < *pPropertyCount; ++i) {
+    pProperties[i].properties = formats[i];
+  }
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkEnumerateDeviceExtensionProperties(
+  VkPhysicalDevice physicalDevice, const char* pLayerName, uint32_t* pPropertyCount, VkExtensionProperties* pProperties)
+{
+  simulateLatency();
+  if (pLayerName != nullptr) {
+    return VK_ERROR_LAYER_NOT_PRESENT;
+  }
+  return copyArray(getProfile(physicalDevice).extensions, pPropertyCount, pProperties);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkEnumerateDeviceLayerProperties(
+  VkPhysicalDevice physicalDevice, uint32_t* pPropertyCount, VkLayerProperties* pProperties)
+{
+  (void)physicalDevice;
+  (void)pProperties;
+  *pPropertyCount = 0;
+  return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateDevice(
+  VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo,
+  const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
+{
+  (void)physicalDevice; (void)pCreateInfo; (void)pAllocator; (void)pDevice;
+  // Logical devices are out of scope, benchmarks need a real or software ICD
+  return VK_ERROR_INITIALIZATION_FAILED;
+}
+
+static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL mock_vkGetDeviceProcAddr(VkDevice device, const char* pName)
+{
+  (void)device;
+  (void)pName;
+  return nullptr;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Surface - the loader owns surface creation, the ICD only answers queries
+// -------------------------------------------------------------------------------------------------
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroySurfaceKHR(
+  VkInstance instance, VkSurfaceKHR surface, const VkAllocationCallbacks* pAllocator)
+{
+  (void)instance; (void)surface; (void)pAllocator;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkGetPhysicalDeviceSurfaceSupportKHR(
+  VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, VkSurfaceKHR surface, VkBool32* pSupported)
+{
+  (void)surface;
+  simulateLatency();
+  const auto& queueFamilies = getProfile(physicalDevice).queueFamilies;
+  *pSupported = (queueFamilyIndex < queueFamilies.size()) &&
+                ((queueFamilies[queueFamilyIndex].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0);
+  return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
+  VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, VkSurfaceCapabilitiesKHR* pSurfaceCapabilities)
+{
+  (void)surface;
+  simulateLatency();
+  const VkPhysicalDeviceLimits& limits = getProfile(physicalDevice).properties.limits;
+  VkSurfaceCapabilitiesKHR caps = {};
+  caps.minImageCount           = 2;
+  caps.maxImageCount           = 8;
+  caps.currentExtent           = { 0xFFFFFFFF, 0xFFFFFFFF };
+  caps.minImageExtent          = { 1, 1 };
+  caps.maxImageExtent          = { limits.maxImageDimension2D, limits.maxImageDimension2D };
+  caps.maxImageArrayLayers     = 1;
+  caps.supportedTransforms     = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+  caps.currentTransform        = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+  caps.supportedCompositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+  caps.supportedUsageFlags     = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                                 VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+  *pSurfaceCapabilities = caps;
+  return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkGetPhysicalDeviceSurfaceFormatsKHR(
+  VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, uint32_t* pSurfaceFormatCount, VkSurfaceFormatKHR* pSurfaceFormats)
+{
+  (void)physicalDevice; (void)surface;
+  simulateLatency();
+  std::vector<VkSurfaceFormatKHR> formats = {
+    { VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR },
+    { VK_FORMAT_B8G8R8A8_SRGB,  VK_COLOR_SPACE_SRGB_NONLINEAR_KHR },
+  };
+  return copyArray(formats, pSurfaceFormatCount, pSurfaceFormats);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkGetPhysicalDeviceSurfacePresentModesKHR(
+  VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, uint32_t* pPresentModeCount, VkPresentModeKHR* pPresentModes)
+{
+  (void)physicalDevice; (void)surface;
+  simulateLatency();
+  std::vector<VkPresentModeKHR> modes = {
+    VK_PRESENT_MODE_FIFO_KHR,
+    VK_PRESENT_MODE_MAILBOX_KHR,
+    VK_PRESENT_MODE_IMMEDIATE_KHR,
+  };
+  return copyArray(modes, pPresentModeCount, pPresentModes);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Dispatch
+// -------------------------------------------------------------------------------------------------
+#define MOCK_PROC(name, func) \
+  if (strcmp(pName, name) == 0) return reinterpret_cast<PFN_vkVoidFunction>(func)
+
+static PFN_vkVoidFunction getProcAddr(const char* pName)
+{
+  MOCK_PROC("vkCreateInstance", mock_vkCreateInstance);
+  MOCK_PROC("vkDestroyInstance", mock_vkDestroyInstance);
+  MOCK_PROC("vkEnumerateInstanceExtensionProperties", mock_vkEnumerateInstanceExtensionProperties);
+  MOCK_PROC("vkEnumerateInstanceVersion", mock_vkEnumerateInstanceVersion);
+  MOCK_PROC("vkEnumeratePhysicalDevices", mock_vkEnumeratePhysicalDevices);
+  MOCK_PROC("vkEnumeratePhysicalDeviceGroups", mock_vkEnumeratePhysicalDeviceGroups);
+  MOCK_PROC("vkEnumeratePhysicalDeviceGroupsKHR", mock_vkEnumeratePhysicalDeviceGroups);
+  MOCK_PROC("vkGetPhysicalDeviceProperties", mock_vkGetPhysicalDeviceProperties);
+  MOCK_PROC("vkGetPhysicalDeviceProperties2", mock_vkGetPhysicalDeviceProperties2);
+  MOCK_PROC("vkGetPhysicalDeviceProperties2KHR", mock_vkGetPhysicalDeviceProperties2);
+  MOCK_PROC("vkGetPhysicalDeviceFeatures", mock_vkGetPhysicalDeviceFeatures);
+  MOCK_PROC("vkGetPhysicalDeviceFeatures2", mock_vkGetPhysicalDeviceFeatures2);
+  MOCK_PROC("vkGetPhysicalDeviceFeatures2KHR", mock_vkGetPhysicalDeviceFeatures2);
+  MOCK_PROC("vkGetPhysicalDeviceQueueFamilyProperties", mock_vkGetPhysicalDeviceQueueFamilyProperties);
+  MOCK_PROC("vkGetPhysicalDeviceQueueFamilyProperties2", mock_vkGetPhysicalDeviceQueueFamilyProperties2);
+  MOCK_PROC("vkGetPhysicalDeviceQueueFamilyProperties2KHR", mock_vkGetPhysicalDeviceQueueFamilyProperties2);
+  MOCK_PROC("vkGetPhysicalDeviceMemoryProperties", mock_vkGetPhysicalDeviceMemoryProperties);
+  MOCK_PROC("vkGetPhysicalDeviceMemoryProperties2", mock_vkGetPhysicalDeviceMemoryProperties2);
+  MOCK_PROC("vkGetPhysicalDeviceMemoryProperties2KHR", mock_vkGetPhysicalDeviceMemoryProperties2);
+  MOCK_PROC("vkGetPhysicalDeviceFormatProperties", mock_vkGetPhysicalDeviceFormatProperties);
+  MOCK_PROC("vkGetPhysicalDeviceFormatProperties2", mock_vkGetPhysicalDeviceFormatProperties2);
+  MOCK_PROC("vkGetPhysicalDeviceFormatProperties2KHR", mock_vkGetPhysicalDeviceFormatProperties2);
+  MOCK_PROC("vkGetPhysicalDeviceImageFormatProperties", mock_vkGetPhysicalDeviceImageFormatProperties);
+  MOCK_PROC("vkGetPhysicalDeviceSparseImageFormatProperties", mock_vkGetPhysicalDeviceSparseImageFormatProperties);
+  MOCK_PROC("vkGetPhysicalDeviceSparseImageFormatProperties2", mock_vkGetPhysicalDeviceSparseImageFormatProperties2);
+  MOCK_PROC("vkGetPhysicalDeviceSparseImageFormatProperties2KHR", mock_vkGetPhysicalDeviceSparseImageFormatProperties2);
+  MOCK_PROC("vkEnumerateDeviceExtensionProperties", mock_vkEnumerateDeviceExtensionProperties);
+  MOCK_PROC("vkEnumerateDeviceLayerProperties", mock_vkEnumerateDeviceLayerProperties);
+  MOCK_PROC("vkCreateDevice", mock_vkCreateDevice);
+  MOCK_PROC("vkGetDeviceProcAddr", mock_vkGetDeviceProcAddr);
+  MOCK_PROC("vkDestroySurfaceKHR", mock_vkDestroySurfaceKHR);
+  MOCK_PROC("vkGetPhysicalDeviceSurfaceSupportKHR", mock_vkGetPhysicalDeviceSurfaceSupportKHR);
+  MOCK_PROC("vkGetPhysicalDeviceSurfaceCapabilitiesKHR", mock_vkGetPhysicalDeviceSurfaceCapabilitiesKHR);
+  MOCK_PROC("vkGetPhysicalDeviceSurfaceFormatsKHR", mock_vkGetPhysicalDeviceSurfaceFormatsKHR);
+  MOCK_PROC("vkGetPhysicalDeviceSurfacePresentModesKHR", mock_vkGetPhysicalDeviceSurfacePresentModesKHR);
+  return nullptr;
+}
+
+extern "C" {
+
+Q_DECL_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vk_icdNegotiateLoaderICDInterfaceVersion(uint32_t* pSupportedVersion)
+{
+  *pSupportedVersion = std::min<uint32_t>(*pSupportedVersion, MOCK_ICD_INTERFACE_VERSION);
+  return VK_SUCCESS;
+}
+
+Q_DECL_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vk_icdGetInstanceProcAddr(VkInstance instance, const char* pName)
+{
+  (void)instance;
+  return getProcAddr(pName);
+}
+
+Q_DECL_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vk_icdGetPhysicalDeviceProcAddr(VkInstance instance, const char* pName)
+{
+  (void)instance;
+  return getProcAddr(pName);
+}
+
+} // extern "C"
@@ -0,0 +1,37 @@
+#-------------------------------------------------
+#
+# Mock Vulkan ICD serving device data from a JSON profile.
+#
+# Usage (Linux):
+#   VK_ICD_FILENAMES=<build dir>/VkMockIcd.json \
+#   VIV_MOCK_ICD_PROFILE=<source dir>/mockicd/profiles/default.json \
+#   ./VulkanInfoViewer
+#
+#-------------------------------------------------
+
+QT       = core
+
+TARGET = VkMockIcd
+TEMPLATE = lib
+CONFIG += plugin c++11
+
+INCLUDEPATH += ..
+
+SOURCES += MockIcd.cpp \
+    ../DeviceProfile.cpp
+
+HEADERS += ../DeviceProfile.h
+
+unix:INCLUDEPATH += "$$(VULKAN_SDK)/include"
+win32:INCLUDEPATH += "$$(VULKAN_SDK)/Include"
+
+# The manifest points at the library with a relative path, keep them side by side
+unix:MANIFEST = VkMockIcd.json
+win32:MANIFEST = VkMockIcd_windows.json
+QMAKE_POST_LINK += $$QMAKE_COPY $$shell_path($$PWD/$$MANIFEST) $$shell_path($$OUT_PWD/VkMockIcd.json)
+
+DISTFILES += \
+    VkMockIcd.json \
+    VkMockIcd_windows.json \
+    profiles/default.json \
+    profiles/scale.json